@@ -18,9 +18,14 @@
 
 #include "RamTypes.h"
 #include "utility/MiscUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 namespace souffle {
 
@@ -146,4 +151,292 @@ inline AggregateOp convertOverloadedAggregator(const AggregateOp op, const TypeA
 #undef CASE_NUMERIC
 }
 
+/**
+ * The sum of floats, rounded once from the exact sum of its summands.
+ *
+ * The exact sum is kept as a list of non-overlapping partial sums in
+ * increasing magnitude (Shewchuk's algorithm), such that the result is
+ * independent of the order in which values are added and sums are merged;
+ * e.g. a sum computed by threads over partitions of a relation does not
+ * depend on the partitioning. Magnitudes beyond half the range of floats are
+ * carried into a count of units, such that partial sums never overflow and
+ * the sum is infinite only if its exact value is. Infinite and NaN values
+ * are summed as is.
+ */
+class ExactFloatSum {
+public:
+    /** Add a value to the sum */
+    void add(RamFloat x) {
+        if (!std::isfinite(x)) {
+            special += x;
+            return;
+        }
+        grow(partials, x, &units);
+    }
+
+    /** Add another sum */
+    void merge(const ExactFloatSum& other) {
+        for (RamFloat x : other.partials) {
+            add(x);
+        }
+        units += other.units;
+        special += other.special;
+    }
+
+    /** Return the exact sum rounded to the nearest float */
+    RamFloat getResult() const {
+        if (special != 0 || std::isnan(special)) {
+            return special;
+        }
+        if (units == 0) {
+            return round(partials);
+        }
+
+        // the partials sum up to less than two units, so more than three units are out of range
+        const RamFloat unit = std::copysign(getUnit(), static_cast<RamFloat>(units));
+        const std::int64_t count = std::abs(units);
+        if (count > 3) {
+            return unit * 2;
+        }
+
+        // fold the units into the partials unless that overflows
+        std::vector<RamFloat> sum(partials);
+        bool inRange = true;
+        for (std::int64_t i = 0; i < count && inRange; ++i) {
+            inRange = grow(sum, unit, nullptr);
+        }
+        if (inRange) {
+            return round(sum);
+        }
+
+        // the sum is close to the largest float => round it at half the scale, doubling it afterwards;
+        // halving is exact but for the least subnormals, of which only the sign affects the rounding
+        std::vector<RamFloat> half;
+        for (RamFloat x : partials) {
+            const RamFloat h = x / 2;
+            half.push_back(h != 0 ? h : x);
+        }
+        for (std::int64_t i = 0; i < count; ++i) {
+            if (!grow(half, unit / 2, nullptr)) {
+                return unit * 2;
+            }
+        }
+        return round(half) * 2;
+    }
+
+private:
+    /** the magnitude carried out of the partials, i.e. half of the range of floats */
+    static RamFloat getUnit() {
+        return std::ldexp(RamFloat(1), std::numeric_limits<RamFloat>::max_exponent - 1);
+    }
+
+    /**
+     * Add a finite value to the given partials. If units are given, magnitudes of
+     * a unit and above are carried into them; otherwise, the addition fails if a
+     * partial sum overflows.
+     */
+    static bool grow(std::vector<RamFloat>& partials, RamFloat x, std::int64_t* units) {
+        // clearing the leading bit of a carried value is exact and keeps it apart from lower partials
+        auto carry = [&](RamFloat& value) {
+            if (units != nullptr && std::abs(value) >= getUnit()) {
+                *units += value > 0 ? 1 : -1;
+                value -= std::copysign(getUnit(), value);
+            }
+        };
+        carry(x);
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < partials.size(); ++i) {
+            RamFloat y = partials[i];
+            if (std::abs(x) < std::abs(y)) {
+                std::swap(x, y);
+            }
+            RamFloat hi = x + y;
+            if (!std::isfinite(hi)) {
+                return false;
+            }
+            RamFloat lo = y - (hi - x);
+            if (lo != 0) {
+                partials[count++] = lo;
+            }
+            x = hi;
+            carry(x);
+        }
+        partials.resize(count);
+        partials.push_back(x);
+        return true;
+    }
+
+    /** Round the sum of the given partials to the nearest float */
+    static RamFloat round(const std::vector<RamFloat>& partials) {
+        if (partials.empty()) {
+            return 0;
+        }
+
+        // add the partials from the largest down until the sum becomes inexact
+        std::size_t n = partials.size() - 1;
+        RamFloat hi = partials[n];
+        RamFloat lo = 0;
+        while (n > 0) {
+            RamFloat x = hi;
+            RamFloat y = partials[--n];
+            hi = x + y;
+            lo = y - (hi - x);
+            if (lo != 0) {
+                break;
+            }
+        }
+
+        // round half to even correctly if the remaining partials push the sum off the midpoint
+        if (n > 0 && ((lo < 0 && partials[n - 1] < 0) || (lo > 0 && partials[n - 1] > 0))) {
+            RamFloat y = lo * 2;
+            RamFloat x = hi + y;
+            if (y == x - hi) {
+                hi = x;
+            }
+        }
+        return hi;
+    }
+
+    /** the non-overlapping partial sums of the finite values, in increasing magnitude, each below a unit */
+    std::vector<RamFloat> partials;
+
+    /** the number of units carried out of the partials, signed */
+    std::int64_t units = 0;
+
+    /** the sum of the infinite and NaN values */
+    RamFloat special = 0;
+};
+
+/**
+ * The state of an aggregate while folding the values of a group of tuples.
+ * Accumulators of disjoint parts of a group can be merged.
+ */
+class AggregateAccumulator {
+public:
+    explicit AggregateAccumulator(AggregateOp op) : op(op) {
+        switch (op) {
+            case AggregateOp::MIN: res = ramBitCast(MAX_RAM_SIGNED); break;
+            case AggregateOp::UMIN: res = ramBitCast(MAX_RAM_UNSIGNED); break;
+            case AggregateOp::FMIN: res = ramBitCast(MAX_RAM_FLOAT); break;
+
+            case AggregateOp::MAX: res = ramBitCast(MIN_RAM_SIGNED); break;
+            case AggregateOp::UMAX: res = ramBitCast(MIN_RAM_UNSIGNED); break;
+            case AggregateOp::FMAX: res = ramBitCast(MIN_RAM_FLOAT); break;
+
+            case AggregateOp::SUM: res = ramBitCast(static_cast<RamSigned>(0)); break;
+            case AggregateOp::USUM: res = ramBitCast(static_cast<RamUnsigned>(0)); break;
+            case AggregateOp::FSUM: res = ramBitCast(static_cast<RamFloat>(0)); break;
+
+            case AggregateOp::MEAN:
+            case AggregateOp::COUNT: res = 0; break;
+        }
+    }
+
+    /** Add the value of a tuple of the group; count ignores the value */
+    void add(RamDomain val) {
+        empty = false;
+        switch (op) {
+            case AggregateOp::MIN: res = std::min(res, val); break;
+            case AggregateOp::FMIN:
+                res = ramBitCast(std::min(ramBitCast<RamFloat>(res), ramBitCast<RamFloat>(val)));
+                break;
+            case AggregateOp::UMIN:
+                res = ramBitCast(std::min(ramBitCast<RamUnsigned>(res), ramBitCast<RamUnsigned>(val)));
+                break;
+
+            case AggregateOp::MAX: res = std::max(res, val); break;
+            case AggregateOp::FMAX:
+                res = ramBitCast(std::max(ramBitCast<RamFloat>(res), ramBitCast<RamFloat>(val)));
+                break;
+            case AggregateOp::UMAX:
+                res = ramBitCast(std::max(ramBitCast<RamUnsigned>(res), ramBitCast<RamUnsigned>(val)));
+                break;
+
+            case AggregateOp::SUM: res += val; break;
+            case AggregateOp::FSUM: floatSum.add(ramBitCast<RamFloat>(val)); break;
+            case AggregateOp::USUM:
+                res = ramBitCast(ramBitCast<RamUnsigned>(res) + ramBitCast<RamUnsigned>(val));
+                break;
+
+            case AggregateOp::MEAN:
+                floatSum.add(ramBitCast<RamFloat>(val));
+                meanCount++;
+                break;
+
+            case AggregateOp::COUNT: ++res; break;
+        }
+    }
+
+    /** Add the values of another part of the group */
+    void merge(const AggregateAccumulator& other) {
+        if (other.empty) {
+            return;
+        }
+        switch (op) {
+            case AggregateOp::MIN:
+            case AggregateOp::FMIN:
+            case AggregateOp::UMIN:
+            case AggregateOp::MAX:
+            case AggregateOp::FMAX:
+            case AggregateOp::UMAX:
+            case AggregateOp::SUM:
+            case AggregateOp::USUM: add(other.res); break;
+
+            case AggregateOp::FSUM:
+                empty = false;
+                floatSum.merge(other.floatSum);
+                break;
+
+            case AggregateOp::MEAN:
+                empty = false;
+                floatSum.merge(other.floatSum);
+                meanCount += other.meanCount;
+                break;
+
+            case AggregateOp::COUNT:
+                empty = false;
+                res += other.res;
+                break;
+        }
+    }
+
+    /** Return true if the aggregate has a value, i.e. a sum or count, or the group is non-empty */
+    bool hasResult() const {
+        switch (op) {
+            case AggregateOp::SUM:
+            case AggregateOp::FSUM:
+            case AggregateOp::USUM:
+            case AggregateOp::COUNT: return true;
+            default: return !empty;
+        }
+    }
+
+    /** Return the value of the aggregate */
+    RamDomain getResult() const {
+        if (op == AggregateOp::FSUM) {
+            return ramBitCast(floatSum.getResult());
+        }
+        if (op == AggregateOp::MEAN && meanCount != 0) {
+            return ramBitCast(floatSum.getResult() / static_cast<RamFloat>(meanCount));
+        }
+        return res;
+    }
+
+private:
+    /** the aggregation function */
+    AggregateOp op;
+
+    /** the value folded so far */
+    RamDomain res;
+
+    /** the sum of a float sum or mean */
+    ExactFloatSum floatSum;
+
+    /** the number of values of a mean */
+    std::size_t meanCount = 0;
+
+    /** true if no value has been added */
+    bool empty = true;
+};
+
 }  // namespace souffle
@@ -61,4 +61,26 @@ size_t AstProfileUse::getRelationSize(const AstQualifiedName& rel) {
     }
 }
 
+/**
+ * Get number of iterations of a recursive relation from profile
+ */
+size_t AstProfileUse::getIterations(const AstQualifiedName& rel) {
+    if (const auto* profRel = programRun->getRelation(rel.toString())) {
+        return profRel->getIterations().size();
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * Get number of distinct values of an attribute from profile
+ */
+size_t AstProfileUse::getDistinctValues(const AstQualifiedName& rel, size_t attribute) {
+    if (const auto* profRel = programRun->getRelation(rel.toString())) {
+        return profRel->getDistinctValues(attribute);
+    } else {
+        return 0;
+    }
+}
+
 }  // end of namespace souffle
@@ -51,6 +51,12 @@ public:
     /** Return size of relation in the profile */
     size_t getRelationSize(const AstQualifiedName& rel);
 
+    /** Return the number of fixpoint iterations of a relation in the profile, or 0 if there are none */
+    size_t getIterations(const AstQualifiedName& rel);
+
+    /** Return the number of distinct values of an attribute in the profile, or 0 if it is unknown */
+    size_t getDistinctValues(const AstQualifiedName& rel, size_t attribute);
+
 private:
     /** performance model of profile run */
     std::shared_ptr<profile::ProgramRun> programRun;
@@ -102,6 +102,7 @@ private:
     void checkIO();
     void checkWitnessProblem();
     void checkInlining();
+    void checkIncremental();
 };
 
 bool AstSemanticChecker::transform(AstTranslationUnit& translationUnit) {
@@ -172,6 +173,7 @@ AstSemanticCheckerImpl::AstSemanticCheckerImpl(AstTranslationUnit& tu) : tu(tu)
     checkIO();
     checkWitnessProblem();
     checkInlining();
+    checkIncremental();
 
     // Run grounded terms checker
     GroundedTermsChecker().verify(tu);
@@ -1225,6 +1227,37 @@ std::vector<AstQualifiedName> findInlineCycle(const PrecedenceGraph& precedenceG
     return result;
 }
 
+void AstSemanticCheckerImpl::checkIncremental() {
+    if (!Global::config().has("incremental")) {
+        return;
+    }
+
+    if (Global::config().has("provenance")) {
+        report.addDiagnostic(Diagnostic(Diagnostic::ERROR,
+                DiagnosticMessage("Provenance is not supported in incremental evaluation")));
+    }
+
+    for (const AstRelation* rel : program.getRelations()) {
+        if (rel->getRepresentation() == RelationRepresentation::EQREL) {
+            report.addError("Equivalence relation " + toString(rel->getQualifiedName()) +
+                                    " is not supported in incremental evaluation",
+                    rel->getSrcLoc());
+        }
+
+        // the changes of an input relation are determined from its facts alone
+        if (ioTypes.isInput(rel) && !getClauses(program, *rel).empty()) {
+            report.addError("Input relation " + toString(rel->getQualifiedName()) +
+                                    " with rules or facts is not supported in incremental evaluation",
+                    rel->getSrcLoc());
+        }
+    }
+
+    // counters are not reproducible when tuples are rederived
+    visitDepthFirst(program, [&](const AstCounter& counter) {
+        report.addError("Counter is not supported in incremental evaluation", counter.getSrcLoc());
+    });
+}
+
 void AstSemanticCheckerImpl::checkInlining() {
     auto isInline = [&](const AstRelation* rel) { return rel->hasQualifier(RelationQualifier::INLINE); };
 
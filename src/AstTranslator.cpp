@@ -20,6 +20,7 @@
 #include "AstAttribute.h"
 #include "AstClause.h"
 #include "AstIO.h"
+#include "AstIOTypeAnalysis.h"
 #include "AstLiteral.h"
 #include "AstNode.h"
 #include "AstProgram.h"
@@ -80,6 +81,97 @@ inline void appendStmt(
     }
 }
 
+/** add a condition to a conjunction */
+inline void addCondition(std::unique_ptr<RamCondition>& cond, std::unique_ptr<RamCondition> clause) {
+    cond = ((cond) ? std::make_unique<RamConjunction>(std::move(cond), std::move(clause))
+                   : std::move(clause));
+}
+
+/** merge the tuples of a relation into another relation */
+inline std::unique_ptr<RamStatement> genMerge(
+        const RamRelationReference* dest, const RamRelationReference* src) {
+    std::vector<std::unique_ptr<RamExpression>> values;
+    if (src->get()->getArity() == 0) {
+        return std::make_unique<RamQuery>(std::make_unique<RamFilter>(
+                std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(clone(src))),
+                std::make_unique<RamProject>(clone(dest), std::move(values))));
+    }
+    for (std::size_t i = 0; i < dest->get()->getArity(); i++) {
+        values.push_back(std::make_unique<RamTupleElement>(0, i));
+    }
+    std::unique_ptr<RamStatement> stmt = std::make_unique<RamQuery>(std::make_unique<RamScan>(
+            clone(src), 0, std::make_unique<RamProject>(clone(dest), std::move(values))));
+    if (dest->get()->getRepresentation() == RelationRepresentation::EQREL) {
+        stmt = std::make_unique<RamSequence>(
+                std::make_unique<RamExtend>(clone(dest), clone(src)), std::move(stmt));
+    }
+    return stmt;
+}
+
+/** insert the tuples of a relation which are not contained in an excluded relation into another one */
+inline std::unique_ptr<RamStatement> genDifference(const RamRelationReference* dest,
+        const RamRelationReference* src, const RamRelationReference* excluded) {
+    std::vector<std::unique_ptr<RamExpression>> values;
+    if (src->get()->getArity() == 0) {
+        return std::make_unique<RamQuery>(std::make_unique<RamFilter>(
+                std::make_unique<RamConjunction>(
+                        std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(clone(src))),
+                        std::make_unique<RamEmptinessCheck>(clone(excluded))),
+                std::make_unique<RamProject>(clone(dest), std::move(values))));
+    }
+    std::vector<std::unique_ptr<RamExpression>> tuple;
+    for (std::size_t i = 0; i < src->get()->getArity(); i++) {
+        values.push_back(std::make_unique<RamTupleElement>(0, i));
+        tuple.push_back(std::make_unique<RamTupleElement>(0, i));
+    }
+    return std::make_unique<RamQuery>(std::make_unique<RamScan>(clone(src), 0,
+            std::make_unique<RamFilter>(std::make_unique<RamNegation>(std::make_unique<RamExistenceCheck>(
+                                                clone(excluded), std::move(tuple))),
+                    std::make_unique<RamProject>(clone(dest), std::move(values)))));
+}
+
+/**
+ * remove the tuples of a relation which are contained in another relation by rebuilding it from a
+ * temporary relation; the loop is left within its first iteration, skipping the rebuild if there
+ * is nothing to remove. The relation is not swapped with the temporary one, since the compiled
+ * program interface refers to the data structure of a relation.
+ */
+inline std::unique_ptr<RamStatement> genRemoval(const RamRelationReference* rel,
+        const RamRelationReference* removed, const RamRelationReference* temp) {
+    return std::make_unique<RamLoop>(std::make_unique<RamSequence>(
+            std::make_unique<RamExit>(std::make_unique<RamEmptinessCheck>(clone(removed))),
+            genDifference(temp, rel, removed), std::make_unique<RamClear>(clone(rel)), genMerge(rel, temp),
+            std::make_unique<RamClear>(clone(temp)), std::make_unique<RamExit>(std::make_unique<RamTrue>())));
+}
+
+/** restrict a query to be evaluated only if a condition holds */
+inline std::unique_ptr<RamStatement> genGuard(std::unique_ptr<RamStatement> stmt, const RamCondition& cond) {
+    const auto* query = dynamic_cast<const RamQuery*>(stmt.get());
+    assert(query != nullptr && "only queries can be guarded");
+    return std::make_unique<RamQuery>(
+            std::make_unique<RamFilter>(clone(&cond), clone(&query->getOperation())));
+}
+
+/** move a body atom of a clause to the front, such that the evaluation of the clause starts from it */
+inline std::unique_ptr<AstClause> moveAtomToFront(const AstClause& clause, unsigned int pos) {
+    std::vector<unsigned int> order{pos};
+    for (unsigned int i = 0; i < getBodyLiterals<AstAtom>(clause).size(); i++) {
+        if (i != pos) {
+            order.push_back(i);
+        }
+    }
+    std::unique_ptr<AstClause> res(reorderAtoms(&clause, order));
+    res->clearExecutionPlan();
+    return res;
+}
+
+/** negate an atom over the given relation */
+inline std::unique_ptr<AstNegation> negateAtom(const AstAtom& atom, const std::string& relation) {
+    std::unique_ptr<AstAtom> res(atom.clone());
+    res->setQualifiedName(relation);
+    return std::make_unique<AstNegation>(std::move(res));
+}
+
 std::unique_ptr<RamTupleElement> AstTranslator::makeRamTupleElement(const Location& loc) {
     return std::make_unique<RamTupleElement>(loc.identifier, loc.element);
 }
@@ -114,6 +206,10 @@ void AstTranslator::translateDirectives(std::map<std::string, std::string>& dire
             directives["filename"] = directives.at("name") + fileExt;
         }
     }
+    // binary files are named alike for input and output, such that they can be reloaded
+    if (directives.at("IO") == "binary" && directives.find("filename") == directives.end()) {
+        directives["filename"] = directives.at("name") + ".bin";
+    }
     // legacy support for SQLite prior to 2020-03-18
     // convert dbname to filename
     if (directives.at("IO") == "sqlite" && directives.find("dbname") != directives.end()) {
@@ -922,7 +1018,7 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
                                     std::make_unique<RamEmptinessCheck>(translator.translateRelation(head))),
                             std::move(op));
                 }
-                if (Global::config().has("profile")) {
+                if (profileFrequencies && Global::config().has("profile")) {
                     std::stringstream ss;
                     ss << head->getQualifiedName();
                     ss.str("");
@@ -1086,32 +1182,6 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
     std::vector<std::unique_ptr<RamStatement>> updateTable;
     std::vector<std::unique_ptr<RamStatement>> postamble;
 
-    auto genMerge = [](const RamRelationReference* dest,
-                            const RamRelationReference* src) -> std::unique_ptr<RamStatement> {
-        std::vector<std::unique_ptr<RamExpression>> values;
-        if (src->get()->getArity() == 0) {
-            return std::make_unique<RamQuery>(std::make_unique<RamFilter>(
-                    std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(
-                            std::unique_ptr<RamRelationReference>(src->clone()))),
-                    std::make_unique<RamProject>(
-                            std::unique_ptr<RamRelationReference>(dest->clone()), std::move(values))));
-        }
-        for (std::size_t i = 0; i < dest->get()->getArity(); i++) {
-            values.push_back(std::make_unique<RamTupleElement>(0, i));
-        }
-        std::unique_ptr<RamStatement> stmt = std::make_unique<RamQuery>(
-                std::make_unique<RamScan>(std::unique_ptr<RamRelationReference>(src->clone()), 0,
-                        std::make_unique<RamProject>(
-                                std::unique_ptr<RamRelationReference>(dest->clone()), std::move(values))));
-        if (dest->get()->getRepresentation() == RelationRepresentation::EQREL) {
-            stmt = std::make_unique<RamSequence>(
-                    std::make_unique<RamExtend>(std::unique_ptr<RamRelationReference>(dest->clone()),
-                            std::unique_ptr<RamRelationReference>(src->clone())),
-                    std::move(stmt));
-        }
-        return stmt;
-    };
-
     // --- create preamble ---
 
     /* Compute non-recursive clauses for relations in scc and push
@@ -1152,6 +1222,11 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
         return std::find(scc.begin(), scc.end(), rel) != scc.end();
     };
 
+    // if enabled, the interpreter chooses the join order of a recursive rule in each iteration, among
+    // orders leading with different relations of the SCC, as their sizes change over the fixpoint
+    const bool adaptive = Global::config().has("adaptive-join-order");
+    const size_t maxJoinOrders = 3;
+
     /* Compute temp for the current tables */
     for (const AstRelation* rel : scc) {
         std::vector<std::unique_ptr<RamStatement>> loopRelSeq;
@@ -1207,6 +1282,26 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 std::unique_ptr<RamStatement> rule =
                         ClauseTranslator(*this).translateClause(*r1, *cl, version);
 
+                // add alternative join orders unless the order is fixed by a plan; the atom
+                // frequencies are profiled for the given order only, as in a compiled program
+                if (adaptive && cl->getExecutionPlan() == nullptr) {
+                    std::vector<std::unique_ptr<RamStatement>> alternatives;
+                    alternatives.push_back(std::move(rule));
+                    for (size_t k = 1; k < atoms.size() && alternatives.size() < maxJoinOrders; ++k) {
+                        if (isInSameSCC(getAtomRelation(atoms[k], program))) {
+                            alternatives.push_back(ClauseTranslator(*this, false).translateClause(
+                                    *moveAtomToFront(*r1, k), *cl, version));
+                        }
+                    }
+                    if (alternatives.size() > 1) {
+                        rule = std::make_unique<RamAdaptiveQuery>(std::move(alternatives),
+                                LogStatement::aRecursiveRule(toString(rel->getQualifiedName()), version,
+                                        cl->getSrcLoc(), stringify(toString(*cl))));
+                    } else {
+                        rule = std::move(alternatives.front());
+                    }
+                }
+
                 /* add logging */
                 if (Global::config().has("profile")) {
                     const std::string& relationName = toString(rel->getQualifiedName());
@@ -1267,11 +1362,6 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
     std::unique_ptr<RamParallel> loop = std::make_unique<RamParallel>(std::move(loopSeq));
 
     /* construct exit conditions for odd and even iteration */
-    auto addCondition = [](std::unique_ptr<RamCondition>& cond, std::unique_ptr<RamCondition> clause) {
-        cond = ((cond) ? std::make_unique<RamConjunction>(std::move(cond), std::move(clause))
-                       : std::move(clause));
-    };
-
     std::unique_ptr<RamCondition> exitCond;
     for (const AstRelation* rel : scc) {
         addCondition(exitCond, std::make_unique<RamEmptinessCheck>(translateNewRelation(rel)));
@@ -1285,7 +1375,7 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
     if (!loop->getStatements().empty() && exitCond && updateTable.size() > 0) {
         appendStmt(res, std::make_unique<RamLoop>(std::make_unique<RamSequence>(std::move(loop),
                                 std::make_unique<RamExit>(std::move(exitCond)),
-                                std::make_unique<RamSequence>(std::move(updateTable)))));
+                                std::make_unique<RamParallel>(std::move(updateTable)))));
     }
     if (postamble.size() > 0) {
         appendStmt(res, std::make_unique<RamSequence>(std::move(postamble)));
@@ -1297,6 +1387,328 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
     fatal("Not Implemented");
 }
 
+/*
+ * The incremental evaluation (--incremental) keeps the relations of the preceding run and updates
+ * them by the changes of the input relations, following the delete-and-rederive algorithm. An
+ * update consists of two phases, each of which visits the strata in order:
+ *  - the over-deletion collects in @del_R the tuples of a relation R having a derivation which
+ *    uses a deleted tuple. Its rules are evaluated over the preceding state, in which an input
+ *    relation R is represented by its preceding facts @previous_R.
+ *  - the second phase removes the over-deleted tuples from a relation, rederives those which are
+ *    still derivable and derives the tuples following from the insertions into lower strata.
+ *    The tuples it adds that have not been contained before are collected in @ins_R.
+ * Both phases are semi-naive evaluations starting from the changes, hence an update costs roughly
+ * in proportion to the change, except for the removal, which rebuilds a relation losing tuples.
+ * Negations and aggregates are not monotone; hence the relations of a stratum are recomputed if
+ * they negate or aggregate a relation that may have changed.
+ */
+
+/** make the condition under which the relations of a stratum are recomputed in an incremental update */
+std::unique_ptr<RamCondition> AstTranslator::makeRecomputeCondition(
+        const std::set<const AstRelation*>& scc, const AstTranslationUnit& translationUnit) {
+    const auto& graph = translationUnit.getAnalysis<PrecedenceGraph>()->graph();
+
+    // collect the relations negated or aggregated by the stratum, which may not be updated incrementally
+    std::set<const AstRelation*> nonMonotone;
+    for (const AstRelation* rel : scc) {
+        for (const AstClause* cl : getClauses(*program, *rel)) {
+            visitDepthFirst(*cl, [&](const AstNegation& negation) {
+                nonMonotone.insert(getAtomRelation(negation.getAtom(), program));
+            });
+            visitDepthFirst(*cl, [&](const AstAggregator& aggregator) {
+                visitDepthFirst(aggregator,
+                        [&](const AstAtom& atom) { nonMonotone.insert(getAtomRelation(&atom, program)); });
+            });
+        }
+    }
+
+    // the stratum is recomputed if an input relation on which those depend has changed
+    std::unique_ptr<RamCondition> unchanged;
+    for (const AstRelation* input : program->getRelations()) {
+        if (!ioTypes->isInput(input) ||
+                none_of(nonMonotone, [&](const AstRelation* rel) {
+                    return rel == input || graph.reaches(input, rel);
+                })) {
+            continue;
+        }
+        for (const std::string prefix : {"@ins_", "@del_"}) {
+            addCondition(unchanged, std::make_unique<RamEmptinessCheck>(translateRelation(input, prefix)));
+        }
+    }
+    if (unchanged == nullptr) {
+        return nullptr;
+    }
+    return std::make_unique<RamNegation>(std::move(unchanged));
+}
+
+/** generate RAM code for the over-deletion of an incremental update */
+std::unique_ptr<RamStatement> AstTranslator::translateOverdeletion(const std::set<const AstRelation*>& scc,
+        const RecursiveClauses* recursiveClauses, const RamCondition* recompute) {
+    std::vector<std::unique_ptr<RamStatement>> preamble;
+    std::vector<std::unique_ptr<RamStatement>> loopSeq;
+    std::vector<std::unique_ptr<RamStatement>> postamble;
+    std::unique_ptr<RamCondition> exitCond;
+
+    auto isInSameSCC = [&](const AstRelation* rel) { return scc.count(rel) != 0; };
+    auto getName = [&](const std::string& prefix, const AstRelation* rel) {
+        return prefix + getRelationName(rel->getQualifiedName());
+    };
+
+    // create the updates of the deleted tuples, executed after each round of derivations
+    auto genUpdate = [&]() {
+        std::vector<std::unique_ptr<RamStatement>> updateTable;
+        for (const AstRelation* rel : scc) {
+            appendStmt(updateTable,
+                    std::make_unique<RamSequence>(genMerge(translateRelation(rel, "@del_").get(),
+                                                          translateNewRelation(rel).get()),
+                            std::make_unique<RamSwap>(translateDeltaRelation(rel), translateNewRelation(rel)),
+                            std::make_unique<RamClear>(translateNewRelation(rel))));
+        }
+        return std::make_unique<RamParallel>(std::move(updateTable));
+    };
+
+    for (const AstRelation* rel : scc) {
+        std::vector<std::unique_ptr<RamStatement>> loopRelSeq;
+
+        // drop the changes of the preceding update
+        appendStmt(preamble, std::make_unique<RamClear>(translateRelation(rel, "@ins_")));
+        appendStmt(preamble, std::make_unique<RamClear>(translateRelation(rel, "@del_")));
+
+        // a recomputed relation is deleted entirely
+        if (recompute != nullptr) {
+            appendStmt(preamble,
+                    genGuard(genMerge(translateRelation(rel, "@del_").get(), translateRelation(rel).get()),
+                            *recompute));
+        }
+
+        for (const AstClause* cl : getClauses(*program, *rel)) {
+            const auto& atoms = getBodyLiterals<AstAtom>(*cl);
+            for (size_t j = 0; j < atoms.size(); ++j) {
+                const AstRelation* atomRelation = getAtomRelation(atoms[j], program);
+
+                // deletions from lower strata start the evaluation; the deletions from the
+                // same SCC are propagated by the fixpoint loop
+                const bool isRecursive = isInSameSCC(atomRelation);
+                if (isRecursive && !recursiveClauses->recursive(cl)) {
+                    continue;
+                }
+                const std::string changes = isRecursive ? "@delta_" : "@del_";
+
+                std::unique_ptr<AstClause> r1(cl->clone());
+                r1->getHead()->setQualifiedName(translateNewRelation(rel)->get()->getName());
+                nameUnnamedVariables(r1.get());
+                const auto& versionAtoms = getBodyLiterals<AstAtom>(*r1);
+
+                // reduce R to P ...
+                for (size_t k = 0; k < atoms.size(); ++k) {
+                    const AstRelation* cur = getAtomRelation(atoms[k], program);
+                    if (isRecursive ? k > j && isInSameSCC(cur) : k < j && !isInSameSCC(cur)) {
+                        r1->addToBody(negateAtom(*versionAtoms[k], getName(changes, cur)));
+                    }
+                }
+
+                // input relations are represented by their preceding facts
+                visitDepthFirst(*r1, [&](const AstAtom& atom) {
+                    const AstRelation* cur = getAtomRelation(&atom, program);
+                    if (&atom != r1->getHead() && cur != nullptr && ioTypes->isInput(cur)) {
+                        const_cast<AstAtom&>(atom).setQualifiedName(getName("@previous_", cur));
+                    }
+                });
+                versionAtoms[j]->setQualifiedName(getName(changes, atomRelation));
+                r1->addToBody(negateAtom(*cl->getHead(), getName("@del_", rel)));
+                r1 = moveAtomToFront(*r1, j);
+
+                std::unique_ptr<RamStatement> rule = ClauseTranslator(*this).translateClause(*r1, *r1);
+
+                // add debug info
+                std::ostringstream ds;
+                ds << toString(*cl) << "\nin file ";
+                ds << cl->getSrcLoc();
+                rule = std::make_unique<RamDebugInfo>(std::move(rule), ds.str());
+
+                appendStmt(isRecursive ? loopRelSeq : preamble, std::move(rule));
+            }
+        }
+
+        if (!loopRelSeq.empty()) {
+            appendStmt(loopSeq, std::make_unique<RamSequence>(std::move(loopRelSeq)));
+        }
+
+        addCondition(exitCond, std::make_unique<RamEmptinessCheck>(translateNewRelation(rel)));
+
+        /* drop temporary tables after recursion */
+        appendStmt(postamble, std::make_unique<RamClear>(translateDeltaRelation(rel)));
+        appendStmt(postamble, std::make_unique<RamClear>(translateNewRelation(rel)));
+    }
+
+    std::vector<std::unique_ptr<RamStatement>> res;
+    appendStmt(res, std::make_unique<RamSequence>(std::move(preamble)));
+    appendStmt(res, genUpdate());
+    if (!loopSeq.empty()) {
+        appendStmt(res, std::make_unique<RamLoop>(std::make_unique<RamSequence>(
+                                std::make_unique<RamParallel>(std::move(loopSeq)),
+                                std::make_unique<RamExit>(std::move(exitCond)), genUpdate())));
+    }
+    appendStmt(res, std::make_unique<RamSequence>(std::move(postamble)));
+    return std::make_unique<RamSequence>(std::move(res));
+}
+
+/** generate RAM code for the removal, rederivation and insertion of an incremental update */
+std::unique_ptr<RamStatement> AstTranslator::translateIncrementalRelation(
+        const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses,
+        const RamCondition* recompute) {
+    std::vector<std::unique_ptr<RamStatement>> removal;
+    std::vector<std::unique_ptr<RamStatement>> preamble;
+    std::vector<std::unique_ptr<RamStatement>> loopSeq;
+    std::vector<std::unique_ptr<RamStatement>> postamble;
+    std::unique_ptr<RamCondition> exitCond;
+
+    auto isInSameSCC = [&](const AstRelation* rel) { return scc.count(rel) != 0; };
+    auto getName = [&](const std::string& prefix, const AstRelation* rel) {
+        return prefix + getRelationName(rel->getQualifiedName());
+    };
+
+    // the rules updating a relation by the changes are skipped if it is recomputed
+    std::unique_ptr<RamCondition> unchanged;
+    if (recompute != nullptr) {
+        unchanged = std::make_unique<RamNegation>(clone(recompute));
+    }
+
+    // create a version of a clause of a relation deriving its new tuples
+    auto makeVersion = [&](const AstClause& cl, const AstRelation* rel) {
+        std::unique_ptr<AstClause> r1(cl.clone());
+        r1->getHead()->setQualifiedName(translateNewRelation(rel)->get()->getName());
+        r1->addToBody(negateAtom(*cl.getHead(), getName("", rel)));
+        nameUnnamedVariables(r1.get());
+        return r1;
+    };
+
+    // translate a version of a clause and add it to a list
+    auto addRule = [&](std::vector<std::unique_ptr<RamStatement>>& list, const AstClause& version,
+                           const AstClause& cl, const RamCondition* guard) {
+        std::unique_ptr<RamStatement> rule = ClauseTranslator(*this).translateClause(version, cl);
+        if (guard != nullptr) {
+            rule = genGuard(std::move(rule), *guard);
+        }
+
+        // add debug info
+        std::ostringstream ds;
+        ds << toString(cl) << "\nin file ";
+        ds << cl.getSrcLoc();
+        appendStmt(list, std::make_unique<RamDebugInfo>(std::move(rule), ds.str()));
+    };
+
+    // create the updates of the relations by their new tuples, executed after each round of derivations
+    auto genUpdate = [&]() {
+        std::vector<std::unique_ptr<RamStatement>> updateTable;
+        for (const AstRelation* rel : scc) {
+            appendStmt(updateTable,
+                    std::make_unique<RamSequence>(
+                            genMerge(translateRelation(rel).get(), translateNewRelation(rel).get()),
+                            genDifference(translateRelation(rel, "@ins_").get(),
+                                    translateNewRelation(rel).get(), translateRelation(rel, "@del_").get()),
+                            std::make_unique<RamSwap>(translateDeltaRelation(rel), translateNewRelation(rel)),
+                            std::make_unique<RamClear>(translateNewRelation(rel))));
+        }
+        return std::make_unique<RamParallel>(std::move(updateTable));
+    };
+
+    for (const AstRelation* rel : scc) {
+        std::vector<std::unique_ptr<RamStatement>> loopRelSeq;
+
+        // remove the over-deleted tuples
+        appendStmt(removal, genRemoval(translateRelation(rel).get(), translateRelation(rel, "@del_").get(),
+                                    translateNewRelation(rel).get()));
+
+        for (const AstClause* cl : getClauses(*program, *rel)) {
+            const auto& atoms = getBodyLiterals<AstAtom>(*cl);
+
+            // a recomputed relation is derived from scratch
+            if (recompute != nullptr) {
+                addRule(preamble, *makeVersion(*cl, rel), *cl, recompute);
+            }
+
+            // clauses without atoms are evaluated in each update
+            if (atoms.empty()) {
+                addRule(preamble, *makeVersion(*cl, rel), *cl, unchanged.get());
+                continue;
+            }
+
+            // rederive the over-deleted tuples, which are bound by an atom over the head arguments
+            {
+                std::unique_ptr<AstClause> r1 = makeVersion(*cl, rel);
+                auto deleted = std::make_unique<AstAtom>(getName("@del_", rel));
+                size_t pos = 0;
+                for (const AstArgument* arg : cl->getHead()->getArguments()) {
+                    if (dynamic_cast<const AstVariable*>(arg) != nullptr) {
+                        deleted->addArgument(std::unique_ptr<AstArgument>(arg->clone()));
+                    } else {
+                        const std::string var = " _head_var" + toString(pos);
+                        deleted->addArgument(std::make_unique<AstVariable>(var));
+                        r1->addToBody(std::make_unique<AstBinaryConstraint>(BinaryConstraintOp::EQ,
+                                std::make_unique<AstVariable>(var),
+                                std::unique_ptr<AstArgument>(arg->clone())));
+                    }
+                    ++pos;
+                }
+                r1->addToBody(std::move(deleted));
+                addRule(preamble, *moveAtomToFront(*r1, atoms.size()), *cl, unchanged.get());
+            }
+
+            for (size_t j = 0; j < atoms.size(); ++j) {
+                const AstRelation* atomRelation = getAtomRelation(atoms[j], program);
+                const bool isRecursive = isInSameSCC(atomRelation);
+                if (isRecursive && !recursiveClauses->recursive(cl)) {
+                    continue;
+                }
+
+                // insertions into lower strata start the evaluation; the insertions into the
+                // same SCC are propagated by the fixpoint loop
+                const std::string changes = isRecursive ? "@delta_" : "@ins_";
+                std::unique_ptr<AstClause> r1 = makeVersion(*cl, rel);
+                const auto& versionAtoms = getBodyLiterals<AstAtom>(*r1);
+
+                // reduce R to P ...
+                for (size_t k = j + 1; k < atoms.size(); ++k) {
+                    const AstRelation* cur = getAtomRelation(atoms[k], program);
+                    if (isInSameSCC(cur) == isRecursive) {
+                        r1->addToBody(negateAtom(*versionAtoms[k], getName(changes, cur)));
+                    }
+                }
+                versionAtoms[j]->setQualifiedName(getName(changes, atomRelation));
+
+                if (isRecursive) {
+                    addRule(loopRelSeq, *moveAtomToFront(*r1, j), *cl, nullptr);
+                } else {
+                    addRule(preamble, *moveAtomToFront(*r1, j), *cl, unchanged.get());
+                }
+            }
+        }
+
+        if (!loopRelSeq.empty()) {
+            appendStmt(loopSeq, std::make_unique<RamSequence>(std::move(loopRelSeq)));
+        }
+
+        addCondition(exitCond, std::make_unique<RamEmptinessCheck>(translateNewRelation(rel)));
+
+        /* drop temporary tables after recursion */
+        appendStmt(postamble, std::make_unique<RamClear>(translateDeltaRelation(rel)));
+        appendStmt(postamble, std::make_unique<RamClear>(translateNewRelation(rel)));
+    }
+
+    std::vector<std::unique_ptr<RamStatement>> res;
+    appendStmt(res, std::make_unique<RamSequence>(std::move(removal)));
+    appendStmt(res, std::make_unique<RamSequence>(std::move(preamble)));
+    appendStmt(res, genUpdate());
+    if (!loopSeq.empty()) {
+        appendStmt(res, std::make_unique<RamLoop>(std::make_unique<RamSequence>(
+                                std::make_unique<RamParallel>(std::move(loopSeq)),
+                                std::make_unique<RamExit>(std::move(exitCond)), genUpdate())));
+    }
+    appendStmt(res, std::make_unique<RamSequence>(std::move(postamble)));
+    return std::make_unique<RamSequence>(std::move(res));
+}
+
 /** make a subroutine to search for subproofs */
 std::unique_ptr<RamStatement> AstTranslator::makeSubproofSubroutine(const AstClause& clause) {
     // make intermediate clause with constraints
@@ -1554,6 +1966,12 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     // get auxiliary arity analysis
     auxArityAnalysis = translationUnit.getAnalysis<AuxiliaryArity>();
 
+    // get IO type analysis
+    ioTypes = translationUnit.getAnalysis<IOType>();
+
+    // incremental evaluation updates the relations of the preceding run by the changes of the inputs
+    const bool incremental = Global::config().has("incremental");
+
     // handle the case of an empty SCC graph
     if (sccGraph.getNumberOfSCCs() == 0) return;
 
@@ -1561,8 +1979,14 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     const auto& makeRamLoad = [&](std::vector<std::unique_ptr<RamStatement>>& current,
                                       const AstRelation* relation, const std::string& inputDirectory,
                                       const std::string& fileExtension) {
+        // an incremental run replaces the facts of the preceding run
+        bool replace = incremental;
         for (auto directives :
                 getInputDirectives(relation, Global::config().get(inputDirectory), fileExtension)) {
+            if (replace) {
+                directives["clear"] = "true";
+                replace = false;
+            }
             std::unique_ptr<RamStatement> statement = std::make_unique<RamIO>(
                     std::unique_ptr<RamRelationReference>(translateRelation(relation)), directives);
             if (Global::config().has("profile")) {
@@ -1621,15 +2045,22 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                             getTypeQualifier(typeEnv->getType(attributes[i]->getTypeName())));
                 }
             }
-            ramRels[name] = std::make_unique<RamRelation>(
-                    name, arity, auxiliaryArity, attributeNames, attributeTypeQualifiers, representation);
-            if (isRecursive) {
-                std::string deltaName = "@delta_" + name;
-                std::string newName = "@new_" + name;
-                ramRels[deltaName] = std::make_unique<RamRelation>(deltaName, arity, auxiliaryArity,
-                        attributeNames, attributeTypeQualifiers, representation);
-                ramRels[newName] = std::make_unique<RamRelation>(newName, arity, auxiliaryArity,
+            auto addRelation = [&](const std::string& relName) {
+                ramRels[relName] = std::make_unique<RamRelation>(relName, arity, auxiliaryArity,
                         attributeNames, attributeTypeQualifiers, representation);
+            };
+            addRelation(name);
+            if (isRecursive || incremental) {
+                addRelation("@delta_" + name);
+                addRelation("@new_" + name);
+            }
+            if (incremental) {
+                // the changes of the relation in an update
+                addRelation("@ins_" + name);
+                addRelation("@del_" + name);
+                if (ioTypes->isInput(rel)) {
+                    addRelation("@previous_" + name);
+                }
             }
         }
     }
@@ -1650,25 +2081,66 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
         // make a variable for all relations that are expired at the current SCC
         const auto& internExps = expirySchedule.at(indexOfScc).expired();
 
-        // load all internal input relations from the facts dir with a .facts extension
-        for (const auto& relation : internIns) {
-            makeRamLoad(current, relation, "fact-dir", ".facts");
+        if (incremental) {
+            // the over-deletions of all strata precede the updates of the relations
+            std::vector<std::unique_ptr<RamStatement>> overdeletion;
+            for (const auto& relation : internIns) {
+                // the changes of an input relation are the differences to the preceding facts
+                auto rel = translateRelation(relation);
+                auto previous = translateRelation(relation, "@previous_");
+                auto ins = translateRelation(relation, "@ins_");
+                auto del = translateRelation(relation, "@del_");
+                appendStmt(overdeletion, std::make_unique<RamClear>(clone(ins)));
+                appendStmt(overdeletion, std::make_unique<RamClear>(clone(del)));
+                makeRamLoad(overdeletion, relation, "fact-dir", ".facts");
+                appendStmt(overdeletion, genDifference(ins.get(), rel.get(), previous.get()));
+                appendStmt(overdeletion, genDifference(del.get(), previous.get(), rel.get()));
+
+                appendStmt(current,
+                        genRemoval(previous.get(), del.get(), translateNewRelation(relation).get()));
+                appendStmt(current, genMerge(previous.get(), ins.get()));
+            }
+            if (internIns.empty()) {
+                auto recompute = makeRecomputeCondition(allInterns, translationUnit);
+                appendStmt(overdeletion,
+                        translateOverdeletion(allInterns, recursiveClauses, recompute.get()));
+                appendStmt(current,
+                        translateIncrementalRelation(allInterns, recursiveClauses, recompute.get()));
+            }
+            ramSubs["overdeletion_" + std::to_string(indexOfScc)] =
+                    std::make_unique<RamSequence>(std::move(overdeletion));
+        } else {
+            // load all internal input relations from the facts dir with a .facts extension
+            for (const auto& relation : internIns) {
+                makeRamLoad(current, relation, "fact-dir", ".facts");
+            }
+
+            // compute the relations themselves
+            std::unique_ptr<RamStatement> bodyStatement =
+                    (!isRecursive) ? translateNonRecursiveRelation(
+                                             *((const AstRelation*)*allInterns.begin()), recursiveClauses)
+                                   : translateRecursiveRelation(allInterns, recursiveClauses);
+            appendStmt(current, std::move(bodyStatement));
         }
 
-        // compute the relations themselves
-        std::unique_ptr<RamStatement> bodyStatement =
-                (!isRecursive) ? translateNonRecursiveRelation(
-                                         *((const AstRelation*)*allInterns.begin()), recursiveClauses)
-                               : translateRecursiveRelation(allInterns, recursiveClauses);
-        appendStmt(current, std::move(bodyStatement));
+        // log the statistics of the relations for the cost model of a profile-guided join order
+        if (Global::config().has("profile")) {
+            for (const auto& relation : allInterns) {
+                if (relation->getArity() > 0) {
+                    appendStmt(current, std::make_unique<RamLogStatistics>(translateRelation(relation),
+                                                LogStatement::sRelationStatistics(
+                                                        toString(relation->getQualifiedName()))));
+                }
+            }
+        }
 
         // store all internal output relations to the output dir with a .csv extension
         for (const auto& relation : internOuts) {
             makeRamStore(current, relation, "output-dir", ".csv");
         }
 
-        // if provenance is not enabled...
-        if (!Global::config().has("provenance")) {
+        // if provenance is not enabled and the relations are not kept for an incremental update...
+        if (!Global::config().has("provenance") && !incremental) {
             // otherwise, drop all  relations expired as per the topological order
             for (const auto& relation : internExps) {
                 makeRamClear(current, relation);
@@ -1682,6 +2154,9 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
 
     // invoke all strata
     std::vector<std::unique_ptr<RamStatement>> res;
+    for (size_t i = 0; incremental && i < indexOfScc; i++) {
+        appendStmt(res, std::make_unique<RamCall>("overdeletion_" + std::to_string(i)));
+    }
     for (size_t i = 0; i < indexOfScc; i++) {
         appendStmt(res, std::make_unique<RamCall>("stratum_" + std::to_string(i)));
     }
@@ -51,6 +51,7 @@ class AstProgram;
 class AstRelation;
 class AstTranslationUnit;
 class AuxiliaryArity;
+class IOType;
 class RamCondition;
 class RamTupleElement;
 class RamOperation;
@@ -94,6 +95,9 @@ private:
     /** Auxiliary Arity Analysis */
     const AuxiliaryArity* auxArityAnalysis = nullptr;
 
+    /** IO Type Analysis */
+    const IOType* ioTypes = nullptr;
+
     /**
      * Concrete attribute
      */
@@ -370,9 +374,13 @@ private:
 
         const AuxiliaryArity* auxArityAnalysis;
 
+        // whether the scans count their iterations when profiling
+        bool profileFrequencies;
+
     public:
-        ClauseTranslator(AstTranslator& translator)
-                : translator(translator), auxArityAnalysis(translator.auxArityAnalysis) {}
+        ClauseTranslator(AstTranslator& translator, bool profileFrequencies = true)
+                : translator(translator), auxArityAnalysis(translator.auxArityAnalysis),
+                  profileFrequencies(profileFrequencies) {}
 
         std::unique_ptr<RamStatement> translateClause(
                 const AstClause& clause, const AstClause& originalClause, const int version = 0);
@@ -435,6 +443,32 @@ private:
     std::unique_ptr<RamStatement> translateRecursiveRelation(
             const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses);
 
+    /**
+     * make the condition under which the relations of a strongly-connected component are
+     * recomputed in an incremental update, or null if they are always updated incrementally
+     */
+    std::unique_ptr<RamCondition> makeRecomputeCondition(
+            const std::set<const AstRelation*>& scc, const AstTranslationUnit& translationUnit);
+
+    /**
+     * translate RAM code for the first phase of an incremental update of the relations in a
+     * strongly-connected component, over-approximating the tuples to be deleted
+     *
+     * @param recompute condition under which the relations are recomputed, or null
+     */
+    std::unique_ptr<RamStatement> translateOverdeletion(const std::set<const AstRelation*>& scc,
+            const RecursiveClauses* recursiveClauses, const RamCondition* recompute);
+
+    /**
+     * translate RAM code for the second phase of an incremental update of the relations in a
+     * strongly-connected component, removing the over-deleted tuples, rederiving those which
+     * are still derivable and inserting the new ones
+     *
+     * @param recompute condition under which the relations are recomputed, or null
+     */
+    std::unique_ptr<RamStatement> translateIncrementalRelation(const std::set<const AstRelation*>& scc,
+            const RecursiveClauses* recursiveClauses, const RamCondition* recompute);
+
     /** translate RAM code for subroutine to get subproofs */
     std::unique_ptr<RamStatement> makeSubproofSubroutine(const AstClause& clause);
 
@@ -21,16 +21,30 @@
 #include "utility/ContainerUtil.h"
 #include "utility/ParallelUtil.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <iterator>
+#include <mutex>
+#include <new>
 #include <string>
 #include <tuple>
 #include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace souffle {
 
@@ -234,20 +248,297 @@ struct updater {
     void update(T& /* old_t */, const T& /* new_t */) {}
 };
 
+// ---------- node pool --------------
+
+/**
+ * A memory pool for the nodes of a b-tree. Nodes are carved out of large
+ * slabs, such that the nodes of a tree are released in bulk rather than
+ * one by one. Each thread allocates from its own page-aligned chunk of a
+ * slab, which places the nodes it creates on its NUMA node under the
+ * first-touch policy; if SOUFFLE_NUMA_LOCAL is set, chunks are explicitly
+ * bound to the local node, overriding the memory policy of the process.
+ *
+ * The chunks of the threads are kept by the pool, indexed by the slots of the
+ * running threads, such that no chunk is abandoned while its pool is in use.
+ * On release, one slab stays mapped for the following allocations, such that
+ * trees cleared and refilled repeatedly do not map and unmap their memory each
+ * time.
+ *
+ * Allocations may happen concurrently; release and swap may not.
+ */
+class node_pool {
+public:
+    node_pool() = default;
+
+    node_pool(node_pool&& other) {
+        swap(other);
+    }
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    ~node_pool() {
+        for (const auto& slab : slabs) {
+            freeSlab(slab.first, slab.second);
+        }
+        for (auto& block : cursorBlocks) {
+            delete[] block.load(std::memory_order_relaxed);
+        }
+    }
+
+    /** Allocate a block of the given size */
+    void* allocate(std::size_t size) {
+        size = roundUp(size, alignment);
+        Cursor* cursor = getCursor();
+        if (cursor == nullptr) {
+            // more threads than cursors: allocate from a shared chunk
+            std::lock_guard<std::mutex> guard(mutex);
+            return take(sharedCursor, size);
+        }
+        if (cursor->next == nullptr || size > static_cast<std::size_t>(cursor->end - cursor->next)) {
+            std::lock_guard<std::mutex> guard(mutex);
+            refill(*cursor, size);
+        }
+        void* res = cursor->next;
+        cursor->next += size;
+        return res;
+    }
+
+    /** Free all blocks allocated so far; one slab is kept for the following allocations */
+    void release() {
+        // keep the largest slab up to the retained size
+        auto kept = slabs.end();
+        for (auto it = slabs.begin(); it != slabs.end(); ++it) {
+            if (it->second <= maxRetainedSize && (kept == slabs.end() || kept->second < it->second)) {
+                kept = it;
+            }
+        }
+        for (auto it = slabs.begin(); it != slabs.end(); ++it) {
+            if (it != kept) {
+                freeSlab(it->first, it->second);
+            }
+        }
+        if (kept != slabs.end()) {
+            slabs = {*kept};
+            slabNext = kept->first;
+            slabEnd = kept->first + kept->second;
+            reserved = kept->second;
+        } else {
+            slabs.clear();
+            slabNext = nullptr;
+            slabEnd = nullptr;
+            reserved = 0;
+        }
+
+        // the chunks of the threads are released with their slabs
+        for (auto& block : cursorBlocks) {
+            if (Cursor* cursors = block.load(std::memory_order_relaxed)) {
+                std::fill(cursors, cursors + cursorsPerBlock, Cursor());
+            }
+        }
+        sharedCursor = Cursor();
+    }
+
+    /** Swap the blocks of this pool with those of the given pool */
+    void swap(node_pool& other) {
+        std::swap(slabs, other.slabs);
+        std::swap(slabNext, other.slabNext);
+        std::swap(slabEnd, other.slabEnd);
+        std::swap(reserved, other.reserved);
+        for (std::size_t i = 0; i < numCursorBlocks; ++i) {
+            Cursor* block = cursorBlocks[i].load(std::memory_order_relaxed);
+            cursorBlocks[i].store(other.cursorBlocks[i].load(std::memory_order_relaxed));
+            other.cursorBlocks[i].store(block);
+        }
+        std::swap(sharedCursor, other.sharedCursor);
+    }
+
+    /** Return the number of bytes reserved by this pool */
+    std::size_t getReservedSize() const {
+        return reserved;
+    }
+
+    /** the largest slab kept on release */
+    static constexpr std::size_t maxRetainedSize = 1 << 20;
+
+private:
+    /** the alignment of allocated blocks */
+    static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+    /** the granularity of chunks, the smallest unit of NUMA placement */
+    static constexpr std::size_t pageSize = 4096;
+
+    /** the largest chunk handed to a thread at once */
+    static constexpr std::size_t maxChunkSize = 16 * pageSize;
+
+    /** the largest slab, slabs grow geometrically up to this size */
+    static constexpr std::size_t maxSlabSize = 1 << 24;
+
+    /** the cursors of threads are allocated in blocks on demand, for up to 1024 running threads */
+    static constexpr std::size_t cursorsPerBlock = 32;
+    static constexpr std::size_t numCursorBlocks = 32;
+
+    /** The unused part of the chunk a thread allocates from */
+    struct alignas(64) Cursor {
+        char* next = nullptr;
+        char* end = nullptr;
+    };
+
+    /** Return the cursor of the calling thread, or null if there are too many threads */
+    Cursor* getCursor() {
+        const std::size_t slot = getThreadSlot();
+        if (slot >= numCursorBlocks * cursorsPerBlock) {
+            return nullptr;
+        }
+        std::atomic<Cursor*>& block = cursorBlocks[slot / cursorsPerBlock];
+        Cursor* cursors = block.load(std::memory_order_acquire);
+        if (cursors == nullptr) {
+            std::lock_guard<std::mutex> guard(mutex);
+            cursors = block.load(std::memory_order_relaxed);
+            if (cursors == nullptr) {
+                cursors = new Cursor[cursorsPerBlock];
+                block.store(cursors, std::memory_order_release);
+            }
+        }
+        return &cursors[slot % cursorsPerBlock];
+    }
+
+    /**
+     * Return the slot of the calling thread, the smallest number not used by another
+     * running thread; the slots of exited threads are reused.
+     */
+    static std::size_t getThreadSlot() {
+        struct Slots {
+            std::mutex mutex;
+            std::vector<std::size_t> free;
+            std::size_t used = 0;
+        };
+        // not destroyed, threads may exit after the static objects have been destroyed
+        static auto* slots = new Slots();
+
+        struct Slot {
+            std::size_t index;
+            Slot() {
+                std::lock_guard<std::mutex> guard(slots->mutex);
+                if (slots->free.empty()) {
+                    index = slots->used++;
+                } else {
+                    std::pop_heap(slots->free.begin(), slots->free.end(), std::greater<std::size_t>());
+                    index = slots->free.back();
+                    slots->free.pop_back();
+                }
+            }
+            ~Slot() {
+                std::lock_guard<std::mutex> guard(slots->mutex);
+                slots->free.push_back(index);
+                std::push_heap(slots->free.begin(), slots->free.end(), std::greater<std::size_t>());
+            }
+        };
+        thread_local Slot slot;
+        return slot.index;
+    }
+
+    /** Take a block of the given size from the given cursor, refilling it if necessary; requires the lock */
+    void* take(Cursor& cursor, std::size_t size) {
+        if (cursor.next == nullptr || size > static_cast<std::size_t>(cursor.end - cursor.next)) {
+            refill(cursor, size);
+        }
+        void* res = cursor.next;
+        cursor.next += size;
+        return res;
+    }
+
+    /** Hand a new chunk of at least the given size to the given cursor; requires the lock */
+    void refill(Cursor& cursor, std::size_t size) {
+        const std::size_t chunk =
+                std::max(roundUp(size, pageSize), std::min(maxChunkSize, roundUp(reserved / 64, pageSize)));
+        if (slabNext == nullptr || chunk > static_cast<std::size_t>(slabEnd - slabNext)) {
+            const std::size_t slabSize = std::max(chunk, std::min(maxSlabSize, reserved));
+            slabNext = allocateSlab(slabSize);
+            slabEnd = slabNext + slabSize;
+            slabs.emplace_back(slabNext, slabSize);
+            reserved += slabSize;
+        }
+        bindLocal(slabNext, chunk);
+        cursor.next = slabNext;
+        cursor.end = slabNext + chunk;
+        slabNext += chunk;
+    }
+
+    static std::size_t roundUp(std::size_t size, std::size_t unit) {
+        return (size + unit - 1) / unit * unit;
+    }
+
+    static char* allocateSlab(std::size_t size) {
+#ifndef _WIN32
+        // fresh pages are placed by the first thread touching them
+        void* res = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (res == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(res);
+#else
+        return static_cast<char*>(::operator new(size, std::align_val_t(pageSize)));
+#endif
+    }
+
+    static void freeSlab(char* slab, std::size_t size) {
+#ifndef _WIN32
+        munmap(slab, size);
+#else
+        ::operator delete(slab, std::align_val_t(pageSize));
+#endif
+    }
+
+    static void bindLocal(char* chunk, std::size_t size) {
+#ifdef __linux__
+        static const bool numaLocal = std::getenv("SOUFFLE_NUMA_LOCAL") != nullptr;
+        if (numaLocal) {
+            // MPOL_LOCAL; on failure the policy of the process applies
+            syscall(SYS_mbind, chunk, size, 4, nullptr, 0, 0);
+        }
+#else
+        (void)chunk;
+        (void)size;
+#endif
+    }
+
+    /** the slabs of this pool */
+    std::vector<std::pair<char*, std::size_t>> slabs;
+
+    /** the unused part of the last slab */
+    char* slabNext = nullptr;
+    char* slabEnd = nullptr;
+
+    /** the number of bytes in slabs */
+    std::size_t reserved = 0;
+
+    /** the blocks of cursors of the threads, indexed by their slots */
+    std::array<std::atomic<Cursor*>, numCursorBlocks> cursorBlocks{};
+
+    /** the cursor of threads beyond the slots of the cursors */
+    Cursor sharedCursor;
+
+    /** a lock for handing out chunks */
+    std::mutex mutex;
+};
+
 /**
  * The actual implementation of a b-tree data structure.
  *
  * @tparam Key             .. the element type to be stored in this tree
  * @tparam Comparator     .. a class defining an order on the stored elements
- * @tparam Allocator     .. utilized for allocating memory for required nodes
+ * @tparam Allocator     .. ignored, nodes are allocated from the node_pool of the tree
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
  * @tparam isSet        .. true = set, false = multiset
+ * @tparam isCounted    .. true = inner nodes cache the sizes of their sub-trees, such that
+ *                         ranks and range counts are computed in logarithmic time
  */
 template <typename Key, typename Comparator,
-        typename Allocator,  // is ignored so far - TODO: add support
+        typename Allocator,  // is ignored - nodes are allocated from a node_pool
         unsigned blockSize, typename SearchStrategy, bool isSet, typename WeakComparator = Comparator,
-        typename Updater = detail::updater<Key>>
+        typename Updater = detail::updater<Key>, bool isCounted = false>
 class btree {
 public:
     class iterator;
@@ -382,12 +673,19 @@ protected:
         node(bool inner) : base(inner) {}
 
         /**
-         * A deep-copy operation creating a clone of this node.
+         * Creates a new inner or leaf node within the given pool.
          */
-        node* clone() const {
+        static node* create(node_pool& pool, bool inner) {
+            return inner ? static_cast<node*>(new (pool.allocate(sizeof(inner_node))) inner_node())
+                         : static_cast<node*>(new (pool.allocate(sizeof(leaf_node))) leaf_node());
+        }
+
+        /**
+         * A deep-copy operation creating a clone of this node within the given pool.
+         */
+        node* clone(node_pool& pool) const {
             // create a clone of this node
-            node* res = (this->isInner()) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* res = create(pool, this->isInner());
 
             // copy basic fields
             res->position = this->position;
@@ -405,7 +703,7 @@ protected:
             // copy child nodes recursively
             auto* ires = (inner_node*)res;
             for (size_type i = 0; i <= this->numElements; ++i) {
-                ires->children[i] = this->getChild(i)->clone();
+                ires->children[i] = this->getChild(i)->clone(pool);
                 ires->children[i]->parent = res;
             }
 
@@ -543,14 +841,15 @@ protected:
          * @param idx  .. the position of the insert causing the split
          */
 #ifdef IS_PARALLEL
-        void split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        void split(node** root, lock_type& root_lock, node_pool& pool, int idx,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void split(node** root, lock_type& root_lock, int idx) {
+        void split(node** root, lock_type& root_lock, node_pool& pool, int idx) {
 #endif
             assert(this->numElements == maxKeys);
 
@@ -558,8 +857,7 @@ protected:
             int split_point = getSplitPoint(idx);
 
             // create a new sibling node
-            node* sibling = (this->inner) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* sibling = create(pool, this->inner);
 
 #ifdef IS_PARALLEL
             // lock sibling
@@ -589,9 +887,9 @@ protected:
 
             // update parent
 #ifdef IS_PARALLEL
-            grow_parent(root, root_lock, sibling, locked_nodes);
+            grow_parent(root, root_lock, pool, sibling, locked_nodes);
 #else
-            grow_parent(root, root_lock, sibling);
+            grow_parent(root, root_lock, pool, sibling);
 #endif
         }
 
@@ -608,14 +906,15 @@ protected:
          */
         // TODO: remove root_lock ... no longer needed
 #ifdef IS_PARALLEL
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        int rebalance_or_split(node** root, lock_type& root_lock, node_pool& pool, int idx,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx) {
+        int rebalance_or_split(node** root, lock_type& root_lock, node_pool& pool, int idx) {
 #endif
 
             // this node is full ... and needs some space
@@ -633,7 +932,7 @@ protected:
                 // lock access to left sibling
                 if (!left->lock.try_start_write()) {
                     // left node is currently updated => skip balancing and split
-                    split(root, root_lock, idx, locked_nodes);
+                    split(root, root_lock, pool, idx, locked_nodes);
                     return 0;
                 }
 #endif
@@ -704,9 +1003,9 @@ protected:
 
             // Option B) split node
 #ifdef IS_PARALLEL
-            split(root, root_lock, idx, locked_nodes);
+            split(root, root_lock, pool, idx, locked_nodes);
 #else
-            split(root, root_lock, idx);
+            split(root, root_lock, pool, idx);
 #endif
             return 0;  // = no re-balancing
         }
@@ -721,21 +1020,22 @@ protected:
          * @param sibling .. the new right-sibling to be add to the parent node
          */
 #ifdef IS_PARALLEL
-        void grow_parent(node** root, lock_type& root_lock, node* sibling, std::vector<node*>& locked_nodes) {
+        void grow_parent(node** root, lock_type& root_lock, node_pool& pool, node* sibling,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void grow_parent(node** root, lock_type& root_lock, node* sibling) {
+        void grow_parent(node** root, lock_type& root_lock, node_pool& pool, node* sibling) {
 #endif
 
             if (this->parent == nullptr) {
                 assert(*root == this);
 
                 // create a new root node
-                auto* new_root = new inner_node();
+                auto* new_root = static_cast<inner_node*>(create(pool, true));
                 new_root->numElements = 1;
                 new_root->keys[0] = keys[this->numElements];
 
@@ -757,9 +1057,9 @@ protected:
 
 #ifdef IS_PARALLEL
                 parent->insert_inner(
-                        root, root_lock, pos, this, keys[this->numElements], sibling, locked_nodes);
+                        root, root_lock, pool, pos, this, keys[this->numElements], sibling, locked_nodes);
 #else
-                parent->insert_inner(root, root_lock, pos, this, keys[this->numElements], sibling);
+                parent->insert_inner(root, root_lock, pool, pos, this, keys[this->numElements], sibling);
 #endif
             }
         }
@@ -773,13 +1073,13 @@ protected:
          * @param newNode .. the new right-child of the inserted key
          */
 #ifdef IS_PARALLEL
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode, std::vector<node*>& locked_nodes) {
+        void insert_inner(node** root, lock_type& root_lock, node_pool& pool, unsigned pos, node* predecessor,
+                const Key& key, node* newNode, std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(souffle::contains(locked_nodes, this));
 #else
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode) {
+        void insert_inner(node** root, lock_type& root_lock, node_pool& pool, unsigned pos, node* predecessor,
+                const Key& key, node* newNode) {
 #endif
 
             // check capacity
@@ -792,9 +1092,9 @@ protected:
 
                 // split this node
 #ifdef IS_PARALLEL
-                pos -= rebalance_or_split(root, root_lock, pos, locked_nodes);
+                pos -= rebalance_or_split(root, root_lock, pool, pos, locked_nodes);
 #else
-                pos -= rebalance_or_split(root, root_lock, pos);
+                pos -= rebalance_or_split(root, root_lock, pool, pos);
 #endif
 
                 // complete insertion within new sibling if necessary
@@ -819,9 +1119,9 @@ protected:
                     }
 
                     pos = (i > other->numElements) ? 0 : i;
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode, locked_nodes);
+                    other->insert_inner(root, root_lock, pool, pos, predecessor, key, newNode, locked_nodes);
 #else
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode);
+                    other->insert_inner(root, root_lock, pool, pos, predecessor, key, newNode);
 #endif
                     return;
                 }
@@ -1052,30 +1352,28 @@ protected:
         }
     };  // namespace detail
 
+    /**
+     * The cached number of keys in the sub-tree of an inner node of a counted
+     * tree, valid if it has been computed in the current counting epoch.
+     */
+    struct subtree_count {
+        mutable std::atomic<size_type> subtreeSize{0};
+        mutable std::atomic<uint64_t> subtreeEpoch{0};
+    };
+
+    struct no_subtree_count {};
+
     /**
      * The data type representing inner nodes of the b-tree. It extends
      * the generic implementation of a node by the storage locations
      * of child pointers.
      */
-    struct inner_node : public node {
+    struct inner_node : public node, public std::conditional_t<isCounted, subtree_count, no_subtree_count> {
         // references to child nodes owned by this node
         node* children[node::maxKeys + 1];
 
         // a simple default constructor initializing member fields
         inner_node() : node(true) {}
-
-        // clear up child nodes recursively
-        ~inner_node() {
-            for (unsigned i = 0; i <= this->numElements; ++i) {
-                if (children[i] != nullptr) {
-                    if (children[i]->isLeaf()) {
-                        delete static_cast<leaf_node*>(children[i]);
-                    } else {
-                        delete static_cast<inner_node*>(children[i]);
-                    }
-                }
-            }
-        }
     };
 
     /**
@@ -1224,6 +1522,12 @@ protected:
     // a pointer to the left-most node of this tree (initial note for iteration)
     leaf_node* leftmost;
 
+    // the pool owning all nodes of this tree
+    node_pool pool;
+
+    // the epoch in which the cached sub-tree sizes of a counted tree are valid, 0 if stale
+    mutable std::atomic<uint64_t> countEpoch{0};
+
     /* -------------- operator hint statistics ----------------- */
 
     // an aggregation of statistical values of the hint utilization
@@ -1248,6 +1552,12 @@ public:
     // the maximum number of keys stored per node
     static constexpr size_t max_keys_per_node = node::maxKeys;
 
+    // the size ratio beyond which insertAll inserts elements one by one rather than merging
+    static constexpr size_t merge_ratio = 16;
+
+    // the combined number of elements from which insertAll merges in parallel
+    static constexpr size_t parallel_merge_size = 1 << 16;
+
     // -- ctors / dtors --
 
     // the default constructor creating an empty tree
@@ -1262,7 +1572,8 @@ public:
 
     // a move constructor
     btree(btree&& other)
-            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost) {
+            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost),
+              pool(std::move(other.pool)) {
         other.root = nullptr;
         other.leftmost = nullptr;
     }
@@ -1273,13 +1584,6 @@ public:
         *this = set;
     }
 
-protected:
-    /**
-     * An internal constructor enabling the specific creation of a tree
-     * based on internal parameters.
-     */
-    btree(size_type /* size */, node* root, leaf_node* leftmost) : root(root), leftmost(leftmost) {}
-
 public:
     // the destructor freeing all contained nodes
     ~btree() {
@@ -1295,7 +1599,11 @@ public:
 
     // determines the number of elements in this tree
     size_type size() const {
-        return (root) ? root->countEntries() : 0;
+        if constexpr (isCounted) {
+            return (root) ? countSubtree(root, getCountEpoch()) : 0;
+        } else {
+            return (root) ? root->countEntries() : 0;
+        }
     }
 
     /**
@@ -1328,7 +1636,7 @@ public:
             }
 
             // create new node
-            leftmost = new leaf_node();
+            leftmost = static_cast<leaf_node*>(node::create(pool, false));
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1338,6 +1646,7 @@ public:
 
             hints.last_insert.access(leftmost);
 
+            markModified();
             return true;
         }
 
@@ -1526,7 +1835,7 @@ public:
 
                 // split this node
                 auto old_root = root;
-                idx -= cur->rebalance_or_split(const_cast<node**>(&root), root_lock, idx, parents);
+                idx -= cur->rebalance_or_split(const_cast<node**>(&root), root_lock, pool, idx, parents);
 
                 // release parent lock
                 for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
@@ -1571,6 +1880,8 @@ public:
 
             // remember last insertion position
             hints.last_insert.access(cur);
+
+            markModified();
             return true;
         }
 
@@ -1578,13 +1889,14 @@ public:
         // special handling for inserting first element
         if (empty()) {
             // create new node
-            leftmost = new leaf_node();
+            leftmost = static_cast<leaf_node*>(node::create(pool, false));
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
 
             hints.last_insert.access(leftmost);
 
+            markModified();
             return true;
         }
 
@@ -1653,7 +1965,7 @@ public:
 
             if (cur->numElements >= node::maxKeys) {
                 // split this node
-                idx -= cur->rebalance_or_split(&root, root_lock, idx);
+                idx -= cur->rebalance_or_split(&root, root_lock, pool, idx);
 
                 // insert element in right fragment
                 if (((size_type)idx) > cur->numElements) {
@@ -1677,6 +1989,7 @@ public:
             // remember last insertion position
             hints.last_insert.access(cur);
 
+            markModified();
             return true;
         }
 #endif
@@ -1696,6 +2009,108 @@ public:
         }
     }
 
+    /**
+     * Inserts all elements of the given tree, which has to be ordered by the same
+     * comparator. Unless the other tree is much smaller than this tree, the elements
+     * of both trees are merged in a single linear pass and this tree is rebuilt
+     * bottom-up; otherwise the elements are inserted one by one. Large merges are
+     * split into key ranges processed in parallel unless invoked within a parallel
+     * region.
+     *
+     * Note: this operation is not thread safe, invalidates all iterators and
+     * operation hints of this tree, and does not apply the updater.
+     *
+     * @param other .. the tree whose elements are to be inserted
+     * @param fill .. the fraction of the capacity of nodes used when rebuilding
+     */
+    void insertAll(const btree& other, double fill = 1.0) {
+        if (other.empty()) {
+            return;
+        }
+#ifdef IS_PARALLEL
+        const bool parallel = size() + other.size() >= parallel_merge_size && !omp_in_parallel() &&
+                              omp_get_max_threads() > 1;
+#else
+        const bool parallel = false;
+#endif
+        // for small insertions the hinted insertion of the sorted elements is cheaper
+        if (other.size() * merge_ratio < size()) {
+            if (!parallel) {
+                insert(other.begin(), other.end());
+                return;
+            }
+            const auto chunks = other.getChunks(4 * MAX_THREADS);
+            PARALLEL_START
+                operation_hints hints;
+                pfor(size_type i = 0; i < chunks.size(); ++i) {
+                    for (const auto& cur : chunks[i]) {
+                        insert(cur, hints);
+                    }
+                }
+            PARALLEL_END
+            return;
+        }
+        if (!parallel) {
+            insertSorted(other.begin(), other.end(), fill);
+            return;
+        }
+
+        // split the elements of the other tree into chunks and this tree at their boundaries
+        std::vector<chunk> chunks;
+        for (const auto& cur : other.getChunks(4 * MAX_THREADS)) {
+            if (!cur.empty()) {
+                chunks.push_back(cur);
+            }
+        }
+        const size_type numChunks = chunks.size();
+        std::vector<iterator> bounds(numChunks + 1);
+        std::vector<std::vector<Key>> parts(numChunks);
+        bounds[0] = begin();
+        bounds[numChunks] = end();
+        PARALLEL_START
+            pfor(size_type i = 1; i < numChunks; ++i) {
+                bounds[i] = lower_bound(*chunks[i].begin());
+            }
+            pfor(size_type i = 0; i < numChunks; ++i) {
+                merge(bounds[i], bounds[i + 1], chunks[i].begin(), chunks[i].end(), parts[i]);
+            }
+        PARALLEL_END
+
+        // concatenate the merged key ranges
+        std::vector<size_type> offsets(numChunks + 1, 0);
+        for (size_type i = 0; i < numChunks; ++i) {
+            offsets[i + 1] = offsets[i] + parts[i].size();
+        }
+        std::vector<Key> keys(offsets[numChunks]);
+        PARALLEL_START
+            pfor(size_type i = 0; i < numChunks; ++i) {
+                std::copy(parts[i].begin(), parts[i].end(), keys.begin() + offsets[i]);
+                std::vector<Key>().swap(parts[i]);
+            }
+        PARALLEL_END
+
+        buildBottomUp(keys, fill);
+    }
+
+    /**
+     * Inserts the elements of the given sorted range by merging them with the
+     * elements of this tree and rebuilding the tree bottom-up, packing each node
+     * to the given fill factor.
+     *
+     * Note: this operation is not thread safe, invalidates all iterators and
+     * operation hints of this tree, and does not apply the updater.
+     *
+     * @tparam Iter .. the type of iterator specifying the range; it has to
+     *                 enumerate the elements in the order of this tree
+     * @param fill .. the fraction of the capacity of nodes used when rebuilding
+     */
+    template <typename Iter>
+    void insertSorted(Iter a, const Iter& b, double fill = 1.0) {
+        std::vector<Key> keys;
+        merge(begin(), end(), std::move(a), b, keys);
+        buildBottomUp(keys, fill);
+    }
+
     // Obtains an iterator referencing the first element of the tree.
     iterator begin() const {
         return iterator(leftmost, 0);
@@ -1919,18 +2334,90 @@ public:
     }
 
     /**
-     * Clears this tree.
+     * Determines the number of elements less than the given key, i.e. the number
+     * of elements preceding lower_bound(k). Counted trees compute the rank in
+     * logarithmic time, other trees enumerate the preceding elements.
+     */
+    size_type rank(const Key& k) const {
+        return rank(k, false);
+    }
+
+    /**
+     * Determines the number of elements within the range [lower_bound(lower),
+     * upper_bound(upper)), i.e. the elements neither less than lower nor
+     * greater than upper. Counted trees compute the count in logarithmic time,
+     * other trees enumerate the range.
+     */
+    size_type count(const Key& lower, const Key& upper) const {
+        if (empty() || less(upper, lower)) {
+            return 0;
+        }
+        if constexpr (isCounted) {
+            return rank(upper, true) - rank(lower, false);
+        } else {
+            size_type res = 0;
+            for (auto it = lower_bound(lower), end = upper_bound(upper); it != end; ++it) {
+                ++res;
+            }
+            return res;
+        }
+    }
+
+    /**
+     * Obtains an iterator referencing the element of the given rank, i.e. the
+     * element preceded by n elements, or an end-iterator if there is no such
+     * element. Counted trees locate the element in logarithmic time, other
+     * trees enumerate the preceding elements.
+     */
+    iterator select(size_type n) const {
+        if constexpr (!isCounted) {
+            auto it = begin();
+            for (; n > 0 && it != end(); --n) {
+                ++it;
+            }
+            return it;
+        } else {
+            if (empty()) {
+                return end();
+            }
+            const uint64_t epoch = getCountEpoch();
+            const node* cur = root;
+            while (cur->isInner()) {
+                size_type i = 0;
+                for (;; ++i) {
+                    const size_type size = countSubtree(cur->getChild(i), epoch);
+                    if (n < size) {
+                        break;
+                    }
+                    n -= size;
+                    if (i == cur->numElements) {
+                        return end();
+                    }
+                    if (n == 0) {
+                        return iterator(cur, i);
+                    }
+                    --n;
+                }
+                cur = cur->getChild(i);
+            }
+            return (n < cur->numElements) ? iterator(cur, n) : end();
+        }
+    }
+
+    /**
+     * Clears this tree. The nodes are freed in bulk by releasing the pool.
      */
     void clear() {
-        if (root != nullptr) {
-            if (root->isLeaf()) {
-                delete static_cast<leaf_node*>(root);
-            } else {
-                delete static_cast<inner_node*>(root);
+        if constexpr (!std::is_trivially_destructible<leaf_node>::value ||
+                      !std::is_trivially_destructible<inner_node>::value) {
+            if (root != nullptr) {
+                destroy(root);
             }
         }
         root = nullptr;
         leftmost = nullptr;
+        pool.release();
+        markModified();
     }
 
     /**
@@ -1942,6 +2429,9 @@ public:
         // swap the content
         std::swap(root, other.root);
         std::swap(leftmost, other.leftmost);
+        pool.swap(other.pool);
+        markModified();
+        other.markModified();
     }
 
     // Implementation of the assignment operation for trees.
@@ -1951,6 +2441,9 @@ public:
             return *this;
         }
 
+        // drop the old content
+        clear();
+
         // create a deep-copy of the content of the other tree
         // shortcut for empty sets
         if (other.empty()) {
@@ -1958,7 +2451,7 @@ public:
         }
 
         // clone content (deep copy)
-        root = other.root->clone();
+        root = other.root->clone(pool);
 
         // update leftmost reference
         auto tmp = root;
@@ -2088,20 +2581,111 @@ public:
             return R();
         }
 
-        // resolve tree recursively
-        auto root = buildSubTree(a, b - 1);
+        // resolve tree recursively within the pool of the result
+        R res;
+        btree& tree = res;
+        tree.root = buildSubTree(tree.pool, a, b - 1);
 
         // find leftmost node
-        node* leftmost = root;
+        node* leftmost = tree.root;
         while (!leftmost->isLeaf()) {
             leftmost = leftmost->getChild(0);
         }
+        tree.leftmost = static_cast<leaf_node*>(leftmost);
 
-        // build result
-        return R(b - a, root, static_cast<leaf_node*>(leftmost));
+        // done
+        return res;
     }
 
 protected:
+    /**
+     * Invalidates the cached sub-tree sizes of a counted tree after a modification.
+     * The epoch is only written once per modification phase, such that concurrent
+     * insertions do not contend on it.
+     */
+    void markModified() {
+        if constexpr (isCounted) {
+            if (countEpoch.load(std::memory_order_relaxed) != 0) {
+                countEpoch.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Obtains the epoch in which the cached sub-tree sizes of this tree are valid,
+     * starting a new one after a modification. Epochs are unique across trees,
+     * such that sizes cached in nodes moved between trees by swap() are not reused.
+     */
+    uint64_t getCountEpoch() const {
+        static std::atomic<uint64_t> nextEpoch{1};
+        uint64_t epoch = countEpoch.load(std::memory_order_acquire);
+        if (epoch == 0) {
+            const uint64_t fresh = nextEpoch.fetch_add(1, std::memory_order_relaxed);
+            if (countEpoch.compare_exchange_strong(epoch, fresh, std::memory_order_acq_rel)) {
+                epoch = fresh;
+            }
+        }
+        return epoch;
+    }
+
+    /**
+     * Determines the number of keys in the sub-tree rooted by the given node,
+     * caching the sizes of stale inner nodes in the given epoch.
+     */
+    static size_type countSubtree(const node* cur, uint64_t epoch) {
+        if (cur->isLeaf()) {
+            return cur->numElements;
+        }
+        const inner_node& inner = cur->asInnerNode();
+        if (inner.subtreeEpoch.load(std::memory_order_acquire) == epoch) {
+            return inner.subtreeSize.load(std::memory_order_relaxed);
+        }
+        size_type sum = cur->numElements;
+        for (size_type i = 0; i <= cur->numElements; ++i) {
+            sum += countSubtree(cur->getChild(i), epoch);
+        }
+        inner.subtreeSize.store(sum, std::memory_order_relaxed);
+        inner.subtreeEpoch.store(epoch, std::memory_order_release);
+        return sum;
+    }
+
+    /**
+     * Determines the number of elements less than the given key, or not greater
+     * than the given key if inclusive.
+     */
+    size_type rank(const Key& k, bool inclusive) const {
+        if constexpr (!isCounted) {
+            size_type res = 0;
+            for (auto it = begin(), end = inclusive ? upper_bound(k) : lower_bound(k); it != end; ++it) {
+                ++res;
+            }
+            return res;
+        } else {
+            if (empty()) {
+                return 0;
+            }
+            const uint64_t epoch = getCountEpoch();
+            size_type res = 0;
+            const node* cur = root;
+            while (true) {
+                auto a = &(cur->keys[0]);
+                auto b = &(cur->keys[cur->numElements]);
+                auto pos = inclusive ? search.upper_bound(k, a, b, comp) : search.lower_bound(k, a, b, comp);
+                auto idx = pos - a;
+
+                // the keys before the position and, in inner nodes, their sub-trees precede the key
+                res += idx;
+                if (cur->isLeaf()) {
+                    return res;
+                }
+                for (decltype(idx) i = 0; i < idx; ++i) {
+                    res += countSubtree(cur->getChild(i), epoch);
+                }
+                cur = cur->getChild(idx);
+            }
+        }
+    }
+
     /**
      * Determines whether the range covered by the given node is also
      * covering the given key value.
@@ -2140,9 +2724,123 @@ private:
         return !node->isEmpty() && !less(k, node->keys[0]) && less(k, node->keys[node->numElements - 1]);
     }
 
+    /**
+     * Appends the merge of the range [a,ae) of this tree and the sorted range [b,be)
+     * to the given keys, dropping duplicates in sets.
+     */
+    template <typename Iter>
+    void merge(iterator a, const iterator& ae, Iter b, const Iter& be, std::vector<Key>& keys) const {
+        auto append = [&](const Key& k) {
+            if (isSet && !keys.empty() && equal(keys.back(), k)) {
+                return;
+            }
+            keys.push_back(k);
+        };
+        while (a != ae) {
+            if (b != be && less(*b, *a)) {
+                append(*b);
+                ++b;
+            } else {
+                append(*a);
+                ++a;
+            }
+        }
+        for (; b != be; ++b) {
+            append(*b);
+        }
+    }
+
+    /**
+     * Replaces the content of this tree by the given sorted keys. Leaves are
+     * packed from left to right; the key following each leaf becomes a key of
+     * the level above, which is formed alike until a single root remains.
+     */
+    void buildBottomUp(const std::vector<Key>& keys, double fill) {
+        clear();
+        if (keys.empty()) {
+            return;
+        }
+
+        // the number of keys per node; at least two keeps inner nodes binary
+        const size_type maxKeys = node::maxKeys;
+        const size_type perNode =
+                std::max<size_type>(2, std::min<size_type>(maxKeys, static_cast<size_type>(fill * maxKeys)));
+
+        // create the leaves
+        const size_type n = keys.size();
+        const size_type numLeaves = (n + perNode + 1) / (perNode + 1);
+        const size_type numLeafKeys = n - (numLeaves - 1);
+        std::vector<node*> level;
+        std::vector<Key> separators;
+        level.reserve(numLeaves);
+        separators.reserve(numLeaves - 1);
+        size_type pos = 0;
+        for (size_type i = 0; i < numLeaves; ++i) {
+            node* leaf = node::create(pool, false);
+            const size_type count = numLeafKeys / numLeaves + ((i < numLeafKeys % numLeaves) ? 1 : 0);
+            for (size_type j = 0; j < count; ++j) {
+                leaf->keys[j] = keys[pos++];
+            }
+            leaf->numElements = count;
+            level.push_back(leaf);
+            if (i + 1 < numLeaves) {
+                separators.push_back(keys[pos++]);
+            }
+        }
+        leftmost = static_cast<leaf_node*>(level[0]);
+
+        // create the inner levels
+        while (level.size() > 1) {
+            const size_type numChildren = level.size();
+            const size_type numNodes = (numChildren + perNode) / (perNode + 1);
+            std::vector<node*> nextLevel;
+            std::vector<Key> nextSeparators;
+            nextLevel.reserve(numNodes);
+            nextSeparators.reserve(numNodes - 1);
+            size_type child = 0;
+            for (size_type i = 0; i < numNodes; ++i) {
+                auto* inner = static_cast<inner_node*>(node::create(pool, true));
+                const size_type count = numChildren / numNodes + ((i < numChildren % numNodes) ? 1 : 0);
+                for (size_type j = 0; j < count; ++j, ++child) {
+                    level[child]->parent = inner;
+                    level[child]->position = j;
+                    inner->children[j] = level[child];
+                    if (j + 1 < count) {
+                        inner->keys[j] = separators[child];
+                    }
+                }
+                inner->numElements = count - 1;
+                nextLevel.push_back(inner);
+                if (i + 1 < numNodes) {
+                    nextSeparators.push_back(separators[child - 1]);
+                }
+            }
+            level.swap(nextLevel);
+            separators.swap(nextSeparators);
+        }
+
+        root = level[0];
+        root->parent = nullptr;
+    }
+
+    // Runs the destructors of the given node and its descendants; the memory is owned by the pool.
+    static void destroy(node* cur) {
+        if (cur->isLeaf()) {
+            static_cast<leaf_node*>(cur)->~leaf_node();
+            return;
+        }
+        auto* inner = static_cast<inner_node*>(cur);
+        for (unsigned i = 0; i <= inner->numElements; ++i) {
+            if (inner->children[i] != nullptr) {
+                destroy(inner->children[i]);
+            }
+        }
+        inner->~inner_node();
+    }
+
     // Utility function for the load operation above.
     template <typename Iter>
-    static node* buildSubTree(const Iter& a, const Iter& b) {
+    static node* buildSubTree(node_pool& pool, const Iter& a, const Iter& b) {
         const int N = node::maxKeys;
 
         // divide range in N+1 sub-ranges
@@ -2151,7 +2849,7 @@ private:
         // terminal case: length is less then maxKeys
         if (length <= N) {
             // create a leaf node
-            node* res = new leaf_node();
+            node* res = node::create(pool, false);
             res->numElements = length;
 
             for (int i = 0; i < length; ++i) {
@@ -2171,7 +2869,7 @@ private:
         }
 
         // create inner node
-        node* res = new inner_node();
+        node* res = node::create(pool, true);
         res->numElements = numKeys;
 
         Iter c = a;
@@ -2180,7 +2878,7 @@ private:
             res->keys[i] = c[step];
 
             // get sub-tree
-            auto child = buildSubTree(c, c + (step - 1));
+            auto child = buildSubTree(pool, c, c + (step - 1));
             child->parent = res;
             child->position = i;
             res->getChildren()[i] = child;
@@ -2189,7 +2887,7 @@ private:
         }
 
         // and the remaining part
-        auto child = buildSubTree(c, b);
+        auto child = buildSubTree(pool, c, b);
         child->parent = res;
         child->position = numKeys;
         res->getChildren()[numKeys] = child;
@@ -2201,9 +2899,9 @@ private:
 
 // Instantiation of static member search.
 template <typename Key, typename Comparator, typename Allocator, unsigned blockSize, typename SearchStrategy,
-        bool isSet, typename WeakComparator, typename Updater>
-const SearchStrategy
-        btree<Key, Comparator, Allocator, blockSize, SearchStrategy, isSet, WeakComparator, Updater>::search;
+        bool isSet, typename WeakComparator, typename Updater, bool isCounted>
+const SearchStrategy btree<Key, Comparator, Allocator, blockSize, SearchStrategy, isSet, WeakComparator,
+        Updater, isCounted>::search;
 
 }  // end namespace detail
 
@@ -2215,19 +2913,21 @@ const SearchStrategy
  * @tparam Allocator     .. utilized for allocating memory for required nodes
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
+ * @tparam isCounted      .. enables logarithmic ranks and range counts by caching sub-tree sizes
  */
 template <typename Key, typename Comparator = detail::comparator<Key>,
         typename Allocator = std::allocator<Key>,  // is ignored so far
         unsigned blockSize = 256,
         typename SearchStrategy = typename souffle::detail::default_strategy<Key>::type,
-        typename WeakComparator = Comparator, typename Updater = souffle::detail::updater<Key>>
+        typename WeakComparator = Comparator, typename Updater = souffle::detail::updater<Key>,
+        bool isCounted = false>
 class btree_set : public souffle::detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, true,
-                          WeakComparator, Updater> {
+                          WeakComparator, Updater, isCounted> {
     using super = souffle::detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, true,
-            WeakComparator, Updater>;
+            WeakComparator, Updater, isCounted>;
 
     friend class souffle::detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, true,
-            WeakComparator, Updater>;
+            WeakComparator, Updater, isCounted>;
 
 public:
     /**
@@ -2250,12 +2950,6 @@ public:
     // A move constructor.
     btree_set(btree_set&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    btree_set(s size, n* root, l* leftmost) : super(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     btree_set& operator=(const btree_set& other) {
         super::operator=(other);
@@ -2277,19 +2971,21 @@ public:
  * @tparam Allocator     .. utilized for allocating memory for required nodes
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
+ * @tparam isCounted      .. enables logarithmic ranks and range counts by caching sub-tree sizes
  */
 template <typename Key, typename Comparator = detail::comparator<Key>,
         typename Allocator = std::allocator<Key>,  // is ignored so far
         unsigned blockSize = 256,
         typename SearchStrategy = typename souffle::detail::default_strategy<Key>::type,
-        typename WeakComparator = Comparator, typename Updater = souffle::detail::updater<Key>>
+        typename WeakComparator = Comparator, typename Updater = souffle::detail::updater<Key>,
+        bool isCounted = false>
 class btree_multiset : public souffle::detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy,
-                               false, WeakComparator, Updater> {
+                               false, WeakComparator, Updater, isCounted> {
     using super = souffle::detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, false,
-            WeakComparator, Updater>;
+            WeakComparator, Updater, isCounted>;
 
     friend class souffle::detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, false,
-            WeakComparator, Updater>;
+            WeakComparator, Updater, isCounted>;
 
 public:
     /**
@@ -2312,12 +3008,6 @@ public:
     // A move constructor.
     btree_multiset(btree_multiset&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    btree_multiset(s size, n* root, l* leftmost) : super(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     btree_multiset& operator=(const btree_multiset& other) {
         super::operator=(other);
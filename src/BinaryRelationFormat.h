@@ -0,0 +1,100 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BinaryRelationFormat.h
+ *
+ * Layout of the binary, column-oriented relation files of IO=binary.
+ *
+ * A file consists of the following sections, each starting at a multiple
+ * of 8 bytes such that a mapped file can be accessed in place:
+ *
+ *  - the header (see BinaryRelationHeader);
+ *  - the type tag of each attribute (e.g. 'i', 's'), one byte each;
+ *  - numSymbols + 1 offsets (uint64_t) into the symbol data, delimiting
+ *    the symbols of the dictionary;
+ *  - the symbol data, i.e., the concatenated symbols;
+ *  - a column of numTuples values (RamDomain) per attribute.
+ *
+ * Numbers are stored in their internal representation and symbols by their
+ * position in the dictionary of the file. The dictionary is ordered by the
+ * ids the symbols had in the writing program, such that the tuples of a
+ * relation sorted by their values are sorted in the file as well, as stated
+ * by the SORTED flag. All values are in the byte order of the machine that
+ * wrote the file.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace souffle {
+
+/** Header of a binary relation file */
+struct BinaryRelationHeader {
+    /** current version of the format */
+    static constexpr uint32_t VERSION = 1;
+
+    /** flag stating that the tuples are sorted lexicographically by their values in the file */
+    static constexpr uint64_t SORTED = 1;
+
+    char magic[8] = {'S', 'O', 'U', 'F', 'B', 'I', 'N', '\0'};
+    uint32_t version = VERSION;
+    uint32_t domainSize = sizeof(RamDomain);
+    uint64_t flags = 0;
+    uint64_t width = 0;
+    uint64_t numTuples = 0;
+    uint64_t numSymbols = 0;
+    uint64_t symbolBytes = 0;
+
+    /** Check whether the header has been written by a compatible writer */
+    bool isCompatible() const {
+        return std::memcmp(magic, BinaryRelationHeader().magic, sizeof(magic)) == 0 &&
+               version == VERSION && domainSize == sizeof(RamDomain);
+    }
+
+    /** Round a section size up to the alignment of the sections */
+    static uint64_t align(uint64_t size) {
+        return (size + 7) & ~uint64_t(7);
+    }
+
+    /** Offset of the type tags */
+    static uint64_t typesOffset() {
+        return align(sizeof(BinaryRelationHeader));
+    }
+
+    /** Offset of the symbol offsets */
+    uint64_t symbolOffsetsOffset() const {
+        return typesOffset() + align(width);
+    }
+
+    /** Offset of the symbol data */
+    uint64_t symbolDataOffset() const {
+        return symbolOffsetsOffset() + (numSymbols + 1) * sizeof(uint64_t);
+    }
+
+    /** Offset of the column of the given attribute */
+    uint64_t columnOffset(size_t attribute) const {
+        return symbolDataOffset() + align(symbolBytes) + attribute * align(numTuples * sizeof(RamDomain));
+    }
+
+    /** Size of the whole file */
+    uint64_t fileSize() const {
+        return columnOffset(width);
+    }
+};
+
+static_assert(sizeof(BinaryRelationHeader) % 8 == 0, "sections must stay aligned");
+
+}  // namespace souffle
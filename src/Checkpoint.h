@@ -0,0 +1,629 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Checkpoint.h
+ *
+ * Whole-program checkpoints between strata (--checkpoint-dir).
+ *
+ * A checkpoint directory holds a log of entries and a manifest. The entry
+ * stratum_<i>.bin records the state added by the strata finished since the
+ * preceding entry up to stratum i: the new symbols, the new records, and
+ * the relations whose size has changed, where an empty relation has been
+ * cleared. A relation is computed or loaded by a single stratum and only
+ * cleared afterwards, hence the tuples of a relation are written once.
+ *
+ * The incremental evaluation (--incremental) instead keeps a snapshot of the
+ * whole state after a run in the single entry snapshot.bin, from which the
+ * following run continues without skipping any strata.
+ *
+ * The manifest lists the fingerprint of the program and its input files, the
+ * number of finished strata and the entries. It is replaced atomically after an entry has been
+ * completed, such that an interrupted run leaves the preceding checkpoint
+ * intact. Entries are written by a background thread while the next stratum
+ * is evaluated; only the tuples of the changed relations are copied in the
+ * mean-time, since symbols and records are never moved or modified. Once all
+ * strata have been finished, the checkpoints are removed, such that the next
+ * run of the program starts from scratch.
+ *
+ * An entry consists of a CheckpointEntryHeader followed by
+ *  - numSymbols + 1 offsets (uint64_t) delimiting the symbols within
+ *  - the concatenated symbols (symbolBytes bytes);
+ *  - per arity of records: the arity, the number of preceding records and
+ *    the number of new records (uint64_t each), followed by the new records;
+ *  - per relation: the length of the name (uint64_t), the name, the arity
+ *    and the number of tuples (uint64_t each), followed by the tuples.
+ * All values are stored in the byte order of the machine.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+#include "RecordTable.h"
+#include "SouffleInterface.h"
+#include "SymbolTable.h"
+#include "utility/FileUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+
+namespace souffle {
+
+/** Header of a checkpoint entry */
+struct CheckpointEntryHeader {
+    /** current version of the format */
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8] = {'S', 'O', 'U', 'F', 'C', 'H', 'K', '\0'};
+    uint32_t version = VERSION;
+    uint32_t domainSize = sizeof(RamDomain);
+    uint64_t firstSymbol = 0;
+    uint64_t numSymbols = 0;
+    uint64_t symbolBytes = 0;
+    uint64_t numArities = 0;
+    uint64_t numRelations = 0;
+
+    /** Check whether the header has been written by a compatible writer */
+    bool isCompatible() const {
+        return std::memcmp(magic, CheckpointEntryHeader().magic, sizeof(magic)) == 0 &&
+               version == VERSION && domainSize == sizeof(RamDomain);
+    }
+};
+
+/**
+ * Writes checkpoints of a program after its strata and restores the newest one.
+ *
+ * The program has to evaluate its strata in sequence, reporting each finished
+ * stratum by save(). A checkpoint with an empty directory is disabled.
+ */
+class Checkpoint {
+public:
+    Checkpoint(std::string directory, std::string fingerprint, SymbolTable& symbolTable,
+            RecordTable& recordTable, std::vector<Relation*> relations)
+            : directory(std::move(directory)), fingerprint(std::move(fingerprint)), symbolTable(symbolTable),
+              recordTable(recordTable), relations(std::move(relations)), saved(this->relations.size()) {}
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    /** Wait for the pending entries to be written */
+    ~Checkpoint() {
+        close();
+    }
+
+    /** Compute the fingerprint identifying the checkpoints of a program from its text */
+    static std::string getFingerprint(const std::string& program) {
+        // 64-bit FNV-1a, independent of the standard library
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : program) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+        }
+        std::stringstream ss;
+        ss << std::hex << hash;
+        return ss.str();
+    }
+
+    /**
+     * Add an input file of the program to the fingerprint by its path, size and modification
+     * time, such that the checkpoints are discarded once the facts have changed. Inputs are
+     * added before restoring.
+     */
+    void addInput(const std::string& path) {
+        std::stringstream input;
+        input << fingerprint << "\n" << path;
+        struct stat buffer = {};
+        if (stat(path.c_str(), &buffer) == 0) {
+            input << " " << buffer.st_size << " " << buffer.st_mtime;
+        }
+        fingerprint = getFingerprint(input.str());
+    }
+
+    /**
+     * Restore the newest checkpoint of the program, if any, into the symbol table,
+     * the record table and the relations, which have to be empty besides the
+     * symbols of the program itself.
+     *
+     * @return the number of finished strata, i.e., the index of the first stratum to evaluate
+     */
+    size_t restore() {
+        if (directory.empty()) {
+            return 0;
+        }
+        if (!existDir(directory) && mkdir(directory.c_str(), 0755) != 0) {
+            return disable("cannot create checkpoint directory " + directory);
+        }
+
+        std::ifstream manifest(getPath(MANIFEST));
+        std::string format;
+        std::string fileFingerprint;
+        size_t numStrata = 0;
+        std::vector<std::string> files;
+        if (!manifest) {
+            return 0;
+        }
+        manifest >> format >> fileFingerprint >> numStrata;
+        for (std::string file; manifest >> file;) {
+            files.push_back(file);
+        }
+        if (format != FORMAT || !manifest.eof()) {
+            return discard("corrupt manifest");
+        }
+        if (fileFingerprint != fingerprint) {
+            return discard("checkpoint of a different program or of different inputs");
+        }
+
+        // all entries are read and checked before any state is changed
+        std::vector<LoadedEntry> loaded(files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!readEntry(files[i], loaded[i])) {
+                return discard("corrupt entry " + files[i]);
+            }
+        }
+        if (!isConsistent(loaded)) {
+            return discard("checkpoint does not match the program");
+        }
+
+        // restore the symbols and records in the order of their creation
+        std::map<size_t, const RelationContents*> contents;
+        for (auto& entry : loaded) {
+            for (size_t i = symbolTable.size() - entry.header.firstSymbol; i < entry.symbols.size(); ++i) {
+                symbolTable.lookup(entry.symbols[i]);
+            }
+            for (const auto& records : entry.records) {
+                const RamDomain* record = records.data.data();
+                for (size_t i = 0; i < records.count; ++i, record += records.arity) {
+                    recordTable.pack(record, records.arity);
+                }
+            }
+            for (const auto& relation : entry.relations) {
+                contents[relation.relation] = &relation;
+            }
+        }
+
+        // only the newest contents of each relation are restored
+        for (const auto& cur : contents) {
+            Relation* rel = relations[cur.first];
+            const size_t arity = rel->getArity();
+            const RamDomain* values = cur.second->tuples.data();
+            tuple t(rel);
+            for (size_t n = 0; n < cur.second->size; ++n, values += arity) {
+                for (size_t i = 0; i < arity; ++i) {
+                    t[i] = values[i];
+                }
+                rel->insert(t);
+            }
+        }
+        for (size_t i = 0; i < relations.size(); ++i) {
+            saved[i] = relations[i]->size();
+        }
+        savedSymbols = symbolTable.size();
+        for (size_t arity : recordTable.getArities()) {
+            savedRecords[arity] = recordTable.size(arity);
+        }
+        entries = std::move(files);
+        return finished = numStrata;
+    }
+
+    /** Check whether a stratum has been finished by a restored checkpoint */
+    bool isFinished(size_t stratum) const {
+        return stratum < finished;
+    }
+
+    /**
+     * Checkpoint the state after a stratum. The changes since the preceding checkpoint
+     * are collected and written in the background.
+     */
+    void save(size_t stratum) {
+        if (directory.empty() || failed) {
+            return;
+        }
+        auto entry = std::make_unique<Entry>();
+        entry->stratum = stratum;
+        submit(std::move(entry));
+    }
+
+    /**
+     * Write a snapshot of the whole state in the background, replacing the preceding
+     * checkpoints. A restored snapshot does not finish any strata.
+     */
+    void saveAll() {
+        if (directory.empty() || failed) {
+            return;
+        }
+        savedSymbols = 0;
+        savedRecords.clear();
+        std::fill(saved.begin(), saved.end(), 0);
+        auto entry = std::make_unique<Entry>();
+        entry->snapshot = true;
+        submit(std::move(entry));
+    }
+
+    /**
+     * Remove the checkpoints once the program has finished all strata, after the pending
+     * entries have been written, such that the next run evaluates all strata again.
+     */
+    void finish() {
+        if (directory.empty()) {
+            return;
+        }
+        close();
+        std::remove(getPath(MANIFEST).c_str());
+        for (const auto& file : entries) {
+            std::remove(getPath(file).c_str());
+        }
+        entries.clear();
+        finished = 0;
+    }
+
+private:
+    static constexpr const char* FORMAT = "souffle-checkpoint-1";
+    static constexpr const char* MANIFEST = "manifest";
+
+    /** new records of an arity */
+    struct RecordRange {
+        size_t arity;
+        size_t first;
+        size_t last;
+    };
+
+    /** tuples of a relation */
+    struct RelationContents {
+        /** position of the relation in the relations of the program */
+        size_t relation;
+        size_t size;
+        std::vector<RamDomain> tuples;
+    };
+
+    /** changes to be written by an entry */
+    struct Entry {
+        size_t stratum = 0;
+        /** whether the entry holds the whole state, replacing the preceding entries */
+        bool snapshot = false;
+        size_t firstSymbol = 0;
+        size_t lastSymbol = 0;
+        std::vector<RecordRange> records;
+        std::vector<RelationContents> relations;
+    };
+
+    /** Collect the changes since the preceding checkpoint into an entry and hand it over to the writer */
+    void submit(std::unique_ptr<Entry> entry) {
+        entry->firstSymbol = savedSymbols;
+        entry->lastSymbol = savedSymbols = symbolTable.size();
+        for (size_t arity : recordTable.getArities()) {
+            const size_t count = recordTable.size(arity);
+            size_t& first = savedRecords[arity];
+            if (count > first) {
+                entry->records.push_back({arity, first, count});
+                first = count;
+            }
+        }
+
+        // the relations may be cleared by the next stratum, hence their tuples are copied
+        for (size_t i = 0; i < relations.size(); ++i) {
+            const Relation& rel = *relations[i];
+            const size_t size = rel.size();
+            if (size == saved[i]) {
+                continue;
+            }
+            std::vector<RamDomain> tuples(size * rel.getArity());
+            auto it = rel.begin();
+            const auto end = rel.end();
+            for (size_t n = 0; n < size;) {
+                n += rel.read(it, end, tuples.data() + n * rel.getArity(), size - n);
+            }
+            entry->relations.push_back({i, size, std::move(tuples)});
+            saved[i] = size;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            pending.push_back(std::move(entry));
+        }
+        changed.notify_one();
+        if (!writer.joinable()) {
+            writer = std::thread([this]() { write(); });
+        }
+    }
+
+    /** new records of an arity read from an entry */
+    struct LoadedRecords {
+        size_t arity = 0;
+        size_t first = 0;
+        size_t count = 0;
+        std::vector<RamDomain> data;
+    };
+
+    /** changes read from an entry */
+    struct LoadedEntry {
+        CheckpointEntryHeader header;
+        std::vector<std::string> symbols;
+        std::vector<LoadedRecords> records;
+        std::vector<RelationContents> relations;
+    };
+
+    /** Wait for the writer to finish the pending entries */
+    void close() {
+        if (writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                closed = true;
+            }
+            changed.notify_one();
+            writer.join();
+            closed = false;
+        }
+    }
+
+    std::string getPath(const std::string& file) const {
+        return directory + "/" + file;
+    }
+
+    /** Disable checkpoints after an error */
+    size_t disable(const std::string& reason) {
+        std::cerr << "Warning: checkpoints disabled: " << reason << "\n";
+        failed = true;
+        return 0;
+    }
+
+    /** Ignore an unusable checkpoint; the program starts from scratch */
+    size_t discard(const std::string& reason) {
+        std::cerr << "Warning: ignoring checkpoint in " << directory << ": " << reason << "\n";
+        std::remove(getPath(MANIFEST).c_str());
+        return 0;
+    }
+
+    /** Read an entry; returns false if it is corrupt */
+    bool readEntry(const std::string& file, LoadedEntry& entry) const {
+        std::ifstream in(getPath(file), std::ios::in | std::ios::binary);
+        in.seekg(0, std::ios::end);
+        const std::streamoff fileSize = in.tellg();
+        in.seekg(0);
+        auto read = [&](void* data, uint64_t size) {
+            return static_cast<bool>(in.read(static_cast<char*>(data), static_cast<std::streamsize>(size)));
+        };
+        auto readValues = [&](std::vector<RamDomain>& values, uint64_t count, uint64_t arity) {
+            // the count is checked against the remaining size before allocating the values
+            const std::streamoff remaining = fileSize - in.tellg();
+            if (arity != 0 && count > static_cast<uint64_t>(remaining) / sizeof(RamDomain) / arity) {
+                return false;
+            }
+            values.resize(count * arity);
+            return read(values.data(), values.size() * sizeof(RamDomain));
+        };
+        CheckpointEntryHeader& header = entry.header;
+        if (!in || !read(&header, sizeof(header)) || !header.isCompatible() ||
+                header.numSymbols > static_cast<uint64_t>(fileSize) / sizeof(uint64_t) ||
+                header.symbolBytes > static_cast<uint64_t>(fileSize)) {
+            return false;
+        }
+        std::vector<uint64_t> offsets(header.numSymbols + 1);
+        std::string symbolData(header.symbolBytes, '\0');
+        if (!read(offsets.data(), offsets.size() * sizeof(uint64_t)) ||
+                !read(&symbolData[0], symbolData.size())) {
+            return false;
+        }
+        for (uint64_t i = 0; i < header.numSymbols; ++i) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.symbolBytes) {
+                return false;
+            }
+            entry.symbols.push_back(symbolData.substr(offsets[i], offsets[i + 1] - offsets[i]));
+        }
+
+        for (uint64_t i = 0; i < header.numArities; ++i) {
+            LoadedRecords records;
+            uint64_t range[3];
+            if (!read(range, sizeof(range)) || !readValues(records.data, range[2], range[0])) {
+                return false;
+            }
+            records.arity = range[0];
+            records.first = range[1];
+            records.count = range[2];
+            entry.records.push_back(std::move(records));
+        }
+
+        for (uint64_t i = 0; i < header.numRelations; ++i) {
+            uint64_t length;
+            if (!read(&length, sizeof(length)) || length > static_cast<uint64_t>(fileSize)) {
+                return false;
+            }
+            std::string name(length, '\0');
+            uint64_t shape[2];
+            if (!read(&name[0], length) || !read(shape, sizeof(shape))) {
+                return false;
+            }
+            size_t pos = 0;
+            while (pos < relations.size() && relations[pos]->getName() != name) {
+                ++pos;
+            }
+            if (pos == relations.size() || relations[pos]->getArity() != shape[0]) {
+                return false;
+            }
+            entry.relations.push_back({pos, shape[1], {}});
+            if (!readValues(entry.relations.back().tuples, shape[1], shape[0])) {
+                return false;
+            }
+        }
+        return in.peek() == EOF;
+    }
+
+    /** Check whether the entries continue the current symbol and record tables */
+    bool isConsistent(const std::vector<LoadedEntry>& loaded) const {
+        size_t numSymbols = 0;
+        std::map<size_t, size_t> numRecords;
+        for (const auto& entry : loaded) {
+            if (entry.header.firstSymbol != numSymbols) {
+                return false;
+            }
+            for (const auto& symbol : entry.symbols) {
+                // the symbols of the program itself have to be at their places already
+                if (numSymbols < symbolTable.size() ? symbolTable.unsafeResolve(numSymbols) != symbol
+                                                    : symbolTable.contains(symbol)) {
+                    return false;
+                }
+                ++numSymbols;
+            }
+            for (const auto& records : entry.records) {
+                if (records.first != numRecords[records.arity]) {
+                    return false;
+                }
+                numRecords[records.arity] += records.count;
+            }
+        }
+        if (numSymbols < symbolTable.size()) {
+            return false;
+        }
+        for (size_t arity : recordTable.getArities()) {
+            if (recordTable.size(arity) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Write the entries handed over by save() */
+    void write() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            changed.wait(guard, [&]() { return !pending.empty() || closed; });
+            if (pending.empty()) {
+                return;
+            }
+            std::unique_ptr<Entry> entry = std::move(pending.front());
+            pending.pop_front();
+            guard.unlock();
+            if (!failed) {
+                writeEntry(*entry);
+            }
+            guard.lock();
+        }
+    }
+
+    /** Write an entry and then the manifest listing it */
+    void writeEntry(const Entry& entry) {
+        const std::string file =
+                entry.snapshot ? "snapshot.bin" : "stratum_" + std::to_string(entry.stratum) + ".bin";
+        const std::string path = getPath(file);
+        std::ofstream out(path + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+        auto write = [&](const void* data, uint64_t size) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+
+        CheckpointEntryHeader header;
+        header.firstSymbol = entry.firstSymbol;
+        header.numSymbols = entry.lastSymbol - entry.firstSymbol;
+        header.numArities = entry.records.size();
+        header.numRelations = entry.relations.size();
+        std::vector<uint64_t> offsets{0};
+        std::string symbolData;
+        for (size_t i = entry.firstSymbol; i < entry.lastSymbol; ++i) {
+            symbolData += symbolTable.unsafeResolve(static_cast<RamDomain>(i));
+            offsets.push_back(symbolData.size());
+        }
+        header.symbolBytes = symbolData.size();
+        write(&header, sizeof(header));
+        write(offsets.data(), offsets.size() * sizeof(uint64_t));
+        write(symbolData.data(), symbolData.size());
+
+        for (const auto& records : entry.records) {
+            const uint64_t range[3] = {records.arity, records.first, records.last - records.first};
+            write(range, sizeof(range));
+            for (size_t ref = records.first + 1; ref <= records.last; ++ref) {
+                write(recordTable.unpack(static_cast<RamDomain>(ref), records.arity),
+                        records.arity * sizeof(RamDomain));
+            }
+        }
+
+        for (const auto& relation : entry.relations) {
+            const Relation& rel = *relations[relation.relation];
+            const std::string name = rel.getName();
+            const uint64_t length = name.size();
+            const uint64_t shape[2] = {rel.getArity(), relation.size};
+            write(&length, sizeof(length));
+            write(name.data(), length);
+            write(shape, sizeof(shape));
+            write(relation.tuples.data(), relation.tuples.size() * sizeof(RamDomain));
+        }
+        out.close();
+        if (!out || std::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+            disable("cannot write " + path);
+            return;
+        }
+
+        if (entry.snapshot) {
+            entries.clear();
+        }
+        entries.push_back(file);
+        std::ofstream manifest(getPath(MANIFEST) + ".tmp", std::ios::out | std::ios::trunc);
+        manifest << FORMAT << "\n" << fingerprint << "\n" << (entry.snapshot ? 0 : entry.stratum + 1) << "\n";
+        for (const auto& cur : entries) {
+            manifest << cur << "\n";
+        }
+        manifest.close();
+        if (!manifest ||
+                std::rename((getPath(MANIFEST) + ".tmp").c_str(), getPath(MANIFEST).c_str()) != 0) {
+            disable("cannot write " + getPath(MANIFEST));
+        }
+    }
+
+    /** directory of the checkpoints; empty if disabled */
+    const std::string directory;
+
+    /** fingerprint of the program and its inputs */
+    std::string fingerprint;
+
+    SymbolTable& symbolTable;
+    RecordTable& recordTable;
+
+    /** relations of the program */
+    const std::vector<Relation*> relations;
+
+    /** size of each relation at the preceding checkpoint */
+    std::vector<size_t> saved;
+
+    /** number of symbols at the preceding checkpoint */
+    size_t savedSymbols = 0;
+
+    /** number of records of each arity at the preceding checkpoint */
+    std::map<size_t, size_t> savedRecords;
+
+    /** number of strata finished by the restored checkpoint */
+    size_t finished = 0;
+
+    /** entries of the manifest; accessed by the writer once restored */
+    std::vector<std::string> entries;
+
+    /** set once checkpoints cannot be written */
+    std::atomic<bool> failed{false};
+
+    /** entries to be written */
+    std::deque<std::unique_ptr<Entry>> pending;
+    bool closed = false;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread writer;
+};
+
+}  // namespace souffle
@@ -17,8 +17,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <initializer_list>
 #include <ostream>
+#include <vector>
 
 namespace souffle {
 
@@ -151,6 +154,21 @@ struct print<First, Second, Rest...> {
     }
 };
 
+// ----- a utility for selecting an index for a lookup -------
+
+/**
+ * Determines whether the bound columns are the leading columns of the given
+ * index order, such that the index supports a range query on them.
+ */
+inline bool isBoundPrefix(std::initializer_list<std::size_t> order, const std::vector<bool>& bound) {
+    auto numBound = static_cast<std::size_t>(std::count(bound.begin(), bound.end(), true));
+    if (numBound > order.size()) {
+        return false;
+    }
+    return std::all_of(
+            order.begin(), order.begin() + numBound, [&](std::size_t column) { return bound[column]; });
+}
+
 }  // namespace index_utils
 
 /**
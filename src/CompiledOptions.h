@@ -62,10 +62,22 @@ protected:
      */
     size_t num_jobs;
 
+    /**
+     * checkpointing flag
+     */
+    bool checkpointing;
+
+    /**
+     * checkpoint directory
+     */
+    std::string checkpoint_dir;
+
 public:
     // all argument constructor
-    CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, size_t nj)
-            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj) {}
+    CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, size_t nj,
+            bool ce = false, const char* cd = "")
+            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj),
+              checkpointing(ce), checkpoint_dir(cd) {}
 
     /**
      * get source code name
@@ -109,6 +121,13 @@ public:
         return num_jobs;
     }
 
+    /**
+     * get checkpoint directory
+     */
+    const std::string& getCheckpointDir() const {
+        return checkpoint_dir;
+    }
+
     /**
      * Parses the given command line parameters, handles -h help requests or errors
      * and returns whether the parsing was successful or not.
@@ -130,6 +149,7 @@ public:
         // long options
         option longOptions[] = {{"facts", true, nullptr, 'F'}, {"output", true, nullptr, 'D'},
                 {"profile", true, nullptr, 'p'}, {"jobs", true, nullptr, 'j'}, {"index", true, nullptr, 'i'},
+                {"checkpoint", true, nullptr, 'c'},
                 // the terminal option -- needs to be null
                 {nullptr, false, nullptr, 0}};
 #pragma GCC diagnostic pop
@@ -138,7 +158,7 @@ public:
         bool ok = true;
 
         int c; /* command-line arguments processing */
-        while ((c = getopt_long(argc, argv, "D:F:hp:j:i:", longOptions, nullptr)) != EOF) {
+        while ((c = getopt_long(argc, argv, "D:F:hp:j:i:c:", longOptions, nullptr)) != EOF) {
             switch (c) {
                 /* Fact directories */
                 case 'F':
@@ -164,6 +184,14 @@ public:
                     }
                     profile_name = optarg;
                     break;
+                case 'c':
+                    if (!checkpointing) {
+                        std::cerr << "\nError: checkpoints were not enabled in compilation\n\n";
+                        printHelpPage(exec_name);
+                        exit(EXIT_FAILURE);
+                    }
+                    checkpoint_dir = optarg;
+                    break;
                 case 'j':
 #ifdef _OPENMP
                     if (std::string(optarg) == "auto") {
@@ -211,6 +239,11 @@ private:
             std::cerr << "    -p <file>, --profile=<file>  -- Specify filename for profiling\n";
             std::cerr << "                                    (default: " << profile_name << ")\n";
         }
+        if (checkpointing) {
+            std::cerr << "    -c <DIR>, --checkpoint=<DIR> -- Specify directory for checkpoints\n";
+            std::cerr << "                                    (default: " << checkpoint_dir << ")\n";
+            std::cerr << "                                    (disable with \"\")\n";
+        }
 #ifdef _OPENMP
         std::cerr << "    -j <NUM>, --jobs=<NUM>       -- Specify number of threads\n";
         if (num_jobs > 0) {
@@ -20,6 +20,7 @@
 #include "souffle/CompiledIndexUtils.h"
 #include "souffle/CompiledTuple.h"
 #include "souffle/EquivalenceRelation.h"
+#include "souffle/GroupTable.h"
 #include "souffle/IOSystem.h"
 #include "souffle/IterUtils.h"
 #include "souffle/RamTypes.h"
@@ -43,6 +44,7 @@
 #include "souffle/Logger.h"
 #include "souffle/ProfileEvent.h"
 #endif
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
@@ -55,6 +57,7 @@
 #include <memory>
 #include <regex>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -71,24 +74,36 @@ inline souffle::SouffleProgram* getInstance(const char* p) {
 }
 
 /**
- * Relation wrapper used internally in the generated Datalog program
+ * Relation wrapper used internally in the generated Datalog program; relations of the same type
+ * share its instantiation
  */
-template <uint32_t id, class RelType, class TupleType, size_t Arity, size_t NumAuxAttributes>
+template <class RelType, class TupleType, size_t Arity, size_t NumAuxAttributes>
 class RelationWrapper : public souffle::Relation {
 private:
+    uint32_t id;
     RelType& relation;
     SymbolTable& symTable;
     std::string name;
     std::array<const char*, Arity> tupleType;
     std::array<const char*, Arity> tupleName;
 
+    /** Address of the elements of a tuple referenced by an iterator of the relation */
+    static const RamDomain* address(const RamDomain* t) {
+        return t;
+    }
+    template <typename T>
+    static const RamDomain* address(const T& t) {
+        return t.data;
+    }
+
+    template <typename Iter>
     class iterator_wrapper : public iterator_base {
-        typename RelType::iterator it;
+        Iter it;
         const Relation* relation;
         tuple t;
 
     public:
-        iterator_wrapper(uint32_t arg_id, const Relation* rel, const typename RelType::iterator& arg_it)
+        iterator_wrapper(uint32_t arg_id, const Relation* rel, const Iter& arg_it)
                 : iterator_base(arg_id), it(arg_it), relation(rel), t(rel) {}
         void operator++() override {
             ++it;
@@ -100,6 +115,20 @@ private:
             }
             return t;
         }
+        const RamDomain* data() override {
+            return address(*it);
+        }
+        size_t read(RamDomain* buffer, size_t maxTuples, size_t arity, const iterator_base& end) override {
+            const auto* last = dynamic_cast<const iterator_wrapper*>(&end);
+            if (last == nullptr) {
+                return iterator_base::read(buffer, maxTuples, arity, end);
+            }
+            size_t n = 0;
+            for (; n < maxTuples && it != last->it; ++n, ++it) {
+                std::copy_n(address(*it), Arity, buffer + n * Arity);
+            }
+            return n;
+        }
         iterator_base* clone() const override {
             return new iterator_wrapper(*this);
         }
@@ -111,15 +140,55 @@ private:
         }
     };
 
+    /** Look up the bound columns in an index of the relation, if the relation type supports it */
+    template <typename R, typename Callback>
+    static auto lookupIndex(const R& rel, const std::vector<bool>& bound, const TupleType& low,
+            const TupleType& high, Callback&& callback, int)
+            -> decltype(rel.lookup(bound, low, high, callback)) {
+        return rel.lookup(bound, low, high, callback);
+    }
+    template <typename R, typename Callback>
+    static bool lookupIndex(
+            const R&, const std::vector<bool>&, const TupleType&, const TupleType&, Callback&&, long) {
+        return false;
+    }
+
 public:
-    RelationWrapper(RelType& r, SymbolTable& s, std::string name, const std::array<const char*, Arity>& t,
-            const std::array<const char*, Arity>& n)
-            : relation(r), symTable(s), name(std::move(name)), tupleType(t), tupleName(n) {}
+    RelationWrapper(uint32_t id, RelType& r, SymbolTable& s, std::string name,
+            const std::array<const char*, Arity>& t, const std::array<const char*, Arity>& n)
+            : id(id), relation(r), symTable(s), name(std::move(name)), tupleType(t), tupleName(n) {}
     iterator begin() const override {
-        return iterator(new iterator_wrapper(id, this, relation.begin()));
+        return iterator(new iterator_wrapper<typename RelType::iterator>(id, this, relation.begin()));
     }
     iterator end() const override {
-        return iterator(new iterator_wrapper(id, this, relation.end()));
+        return iterator(new iterator_wrapper<typename RelType::iterator>(id, this, relation.end()));
+    }
+    std::pair<iterator, iterator> lowerUpperBound(const std::vector<RamDomain>& low,
+            const std::vector<RamDomain>& high, const std::vector<bool>& bound) const override {
+        assert(low.size() == Arity && high.size() == Arity && bound.size() == Arity &&
+                "query does not match the arity of the relation");
+        TupleType lower;
+        TupleType upper;
+        for (size_t i = 0; i < Arity; i++) {
+            lower[i] = bound[i] ? low[i] : MIN_RAM_SIGNED;
+            upper[i] = bound[i] ? high[i] : MAX_RAM_SIGNED;
+        }
+        std::pair<iterator, iterator> res;
+        auto wrap = [&](const auto& range) {
+            using Iter = std::decay_t<decltype(range.begin())>;
+            res.first = iterator(new iterator_wrapper<Iter>(id, this, range.begin()));
+            res.second = iterator(new iterator_wrapper<Iter>(id, this, range.end()));
+        };
+        if (!lookupIndex(relation, bound, lower, upper, wrap, 0)) {
+            return Relation::lowerUpperBound(low, high, bound);
+        }
+        // the index range covers all tuples between the bounds in the order of the index, which
+        // coincides with the query if the bound elements are bound to single values
+        if (isEqualityQuery(low, high, bound)) {
+            return res;
+        }
+        return {iterator(new bound_filter(std::move(res.first), res.second, low, high, bound)),
+                iterator(new bound_filter(res.second, res.second, {}, {}, {}))};
     }
     void insert(const tuple& arg) override {
         TupleType t;
@@ -263,7 +332,7 @@ public:
     public:
         iterator(const typename std::vector<t_tuple>::const_iterator& o) : it(o) {}
 
-        const t_tuple operator*() {
+        const t_tuple& operator*() {
             return *it;
         }
 
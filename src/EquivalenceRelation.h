@@ -24,12 +24,14 @@
 #include "UnionFind.h"
 #include "utility/ContainerUtil.h"
 #include "utility/ParallelUtil.h"
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <set>
 #include <shared_mutex>
 #include <stdexcept>
@@ -98,9 +100,11 @@ public:
      * @return true if the pair is new to the data structure
      */
     bool insert(value_type x, value_type y, operation_hints) {
+        bool retval = contains(x, y);
+        // the sets are unchanged, so the cache remains valid
+        if (retval) return retval;
         // indicate that iterators will have to generate on request
         this->statesMapStale.store(true, std::memory_order_relaxed);
-        bool retval = contains(x, y);
         sds.unionNodes(x, y);
         return retval;
     }
@@ -110,21 +114,31 @@ public:
      * @param other the binary relation from which to add elements from
      */
     void insertAll(const EquivalenceRelation<TupleType>& other) {
-        other.genAllDisjointSetLists();
-
-        // iterate over partitions at a time
-        for (typename StatesMap::chunk it : other.equivalencePartition.getChunks(MAX_THREADS)) {
-            for (auto& p : it) {
-                value_type rep = p.first;
-                StatesList& pl = *p.second;
-                const size_t ksize = pl.size();
-                for (size_t i = 0; i < ksize; ++i) {
-                    this->sds.unionNodes(rep, pl.get(i));
-                }
+        // union each node of the other relation with its representative, which does not
+        // require the cache of the other relation to be generated
+        auto& ds = other.sds.ds;
+        const size_t otherSize = ds.size();
+
+        // maintain a valid cache of this relation if the other relation is the smaller one
+        if (!this->statesMapStale.load(std::memory_order_acquire) && otherSize <= this->sds.size()) {
+            std::lock_guard<std::shared_mutex> guard(statesLock);
+            for (size_t i = 0; i < otherSize; ++i) {
+                unionCached(other.sds.toSparse(i), other.sds.toSparse(ds.findNode(i)));
+            }
+            // regenerate the cache once it is mostly made up of merged sets
+            if (2 * numMergedSets > this->sds.size()) {
+                this->statesMapStale.store(true, std::memory_order_relaxed);
             }
+            return;
         }
+
         // invalidate iterators unconditionally
         this->statesMapStale.store(true, std::memory_order_relaxed);
+        forEachChunk(otherSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                this->sds.unionNodes(other.sds.toSparse(i), other.sds.toSparse(ds.findNode(i)));
+            }
+        });
     }
 
     /**
@@ -135,9 +149,8 @@ public:
      */
     void extend(const EquivalenceRelation<TupleType>& other) {
         // nothing to extend if there's no new/original knowledge
-        if (other.size() == 0 || this->size() == 0) return;
+        if (other.sds.size() == 0 || this->sds.size() == 0) return;
 
-        this->genAllDisjointSetLists();
         other.genAllDisjointSetLists();
 
         std::set<value_type> repsCovered;
@@ -151,28 +164,31 @@ public:
             for (; it != end; ++it) {
                 std::tie(el, std::ignore) = *it;
                 if (other.containsElement(el)) {
-                    value_type rep = other.sds.findNode(el);
-                    if (repsCovered.count(rep) == 0) {
-                        repsCovered.emplace(rep);
-                    }
+                    repsCovered.emplace(other.sds.findNode(el));
                 }
             }
         }
 
+        // collect the cached members of the intersecting dj sets
+        std::vector<StatesBucket> buckets;
+        for (value_type rep : repsCovered) {
+            auto found = other.equivalencePartition.find({rep, nullptr});
+            assert(found != other.equivalencePartition.end() && "dj set of other is not cached");
+            buckets.push_back((*found).second);
+        }
+
         // add the intersecting dj sets into this one
-        {
-            value_type el;
-            value_type rep;
-            auto it = other.sds.sparseToDenseMap.begin();
-            auto end = other.sds.sparseToDenseMap.end();
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
-                rep = other.sds.findNode(el);
-                if (repsCovered.count(rep) != 0) {
-                    this->insert(el, rep);
+        this->statesMapStale.store(true, std::memory_order_relaxed);
+        forEachChunk(buckets.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const StatesList& members = *buckets[i];
+                const value_type rep = members.get(0);
+                const size_t numMembers = members.size();
+                for (size_t j = 0; j < numMembers; ++j) {
+                    this->sds.unionNodes(members.get(j), rep);
                 }
             }
-        }
+        });
     }
 
     /**
@@ -201,6 +217,7 @@ public:
         this->statesMapStale.store(true, std::memory_order_relaxed);
 
         equivalencePartition.clear();
+        numMergedSets = 0;
     }
 
     /**
@@ -221,17 +238,7 @@ public:
      */
     size_t size() const {
         genAllDisjointSetLists();
-
-        statesLock.lock_shared();
-
-        size_t retVal = 0;
-        for (auto& e : this->equivalencePartition) {
-            const size_t s = e.second->size();
-            retVal += s * s;
-        }
-
-        statesLock.unlock_shared();
-        return retVal;
+        return numPairs.load(std::memory_order_relaxed);
     }
 
     // an almighty iterator for several types of iteration.
@@ -247,6 +254,10 @@ public:
         explicit iterator(const EquivalenceRelation* br)
                 : br(br), ityp(IterType::ALL), djSetMapListIt(br->equivalencePartition.begin()),
                   djSetMapListEnd(br->equivalencePartition.end()) {
+            // skip the sets that have been merged into others
+            while (djSetMapListIt != djSetMapListEnd && (*djSetMapListIt).second->size() == 0) {
+                ++djSetMapListIt;
+            }
             // no need to fast forward if this iterator is empty
             if (djSetMapListIt == djSetMapListEnd) {
                 isEndVal = true;
@@ -254,7 +265,6 @@ public:
             }
             // grab the pointer to the list, and make it our current list
             djSetList = (*djSetMapListIt).second;
-            assert(djSetList->size() != 0);
 
             updateAnterior();
             updatePosterior();
@@ -354,18 +364,16 @@ public:
                         // move anterior along one
                         // see if we can't move the anterior along one
                         if (++cAnteriorIndex == djSetList->size()) {
-                            // move the djset it along one
+                            // move the djset it along one, skipping the sets merged into others
                             // see if we can't move it along one (we're at the end)
-                            if (++djSetMapListIt == djSetMapListEnd) {
-                                isEndVal = true;
-                                return *this;
-                            }
+                            do {
+                                if (++djSetMapListIt == djSetMapListEnd) {
+                                    isEndVal = true;
+                                    return *this;
+                                }
+                            } while ((*djSetMapListIt).second->size() == 0);
 
-                            // we can't iterate along this djset if it is empty
                             djSetList = (*djSetMapListIt).second;
-                            if (djSetList->size() == 0) {
-                                throw std::out_of_range("error: encountered a zero size djset");
-                            }
 
                             // update our cAnterior and cPosterior
                             cAnteriorIndex = 0;
@@ -643,7 +651,9 @@ public:
         std::vector<souffle::range<iterator>> ret;
         if (chunks <= equivalencePartition.size()) {
             for (auto& p : equivalencePartition) {
-                ret.push_back(souffle::make_range(closure(p.first), end()));
+                if (p.second->size() != 0) {
+                    ret.push_back(souffle::make_range(closure(p.first), end()));
+                }
             }
             return ret;
         }
@@ -654,7 +664,9 @@ public:
         const size_t perchunk = numPairs / chunks;
         for (const auto& itp : equivalencePartition) {
             const size_t s = itp.second->size();
-            if (s * s > perchunk) {
+            if (s == 0) {
+                continue;
+            } else if (s * s > perchunk) {
                 for (const auto& i : *itp.second) {
                     ret.push_back(souffle::make_range(anteriorIt(i), end()));
                 }
@@ -692,39 +704,144 @@ private:
     mutable StatesMap equivalencePartition;
     // whether the cache is stale
     mutable std::atomic<bool> statesMapStale;
+    // the number of pairs in the cached sets
+    mutable std::atomic<size_t> numPairs{0};
+    // the number of cached sets that have been emptied by merging them into others
+    mutable size_t numMergedSets = 0;
+
+    // the number of nodes (or sets) below which bulk operations run sequentially
+    static constexpr size_t parallelGenSize = 1 << 14;
+
+    /**
+     * Apply the given function to the index ranges of a partitioning of [0, n), in parallel
+     * if there are enough indices to make it worthwhile.
+     */
+    template <typename Func>
+    static void forEachChunk(const size_t n, const Func& func) {
+#ifdef IS_PARALLEL
+        const bool parallel = n >= parallelGenSize && !omp_in_parallel() && omp_get_max_threads() > 1;
+#else
+        const bool parallel = false;
+#endif
+        if (!parallel) {
+            func(size_t(0), n);
+            return;
+        }
+        const size_t numChunks = 4 * MAX_THREADS;
+        const size_t chunkSize = (n + numChunks - 1) / numChunks;
+        PARALLEL_START
+            pfor(size_t i = 0; i < numChunks; ++i) {
+                func(std::min(n, i * chunkSize), std::min(n, (i + 1) * chunkSize));
+            }
+        PARALLEL_END
+    }
+
+    /**
+     * Yield the cached set of the given representative, creating the set if it is new.
+     */
+    StatesBucket& getCachedSet(value_type rep) {
+        StorePair p = {rep, nullptr};
+        equivalencePartition.insert(p, [&](StorePair& sp) {
+            auto* r = new StatesList(1);
+            sp.second = r;
+            return r;
+        });
+        // only the representative is used for ordering, so the set may be exchanged in place
+        return const_cast<StorePair&>(*equivalencePartition.find(p)).second;
+    }
+
+    /**
+     * Union the two values, updating the valid cache accordingly rather than invalidating it.
+     * The smaller set is appended to the larger one, which leaves the former empty.
+     * Requires exclusive access to this relation.
+     */
+    void unionCached(value_type x, value_type y) {
+        for (value_type v : {x, y}) {
+            if (!sds.nodeExists(v)) {
+                sds.makeNode(v);
+                getCachedSet(v)->append(v);
+                numPairs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        const value_type rx = sds.findNode(x);
+        const value_type ry = sds.findNode(y);
+        if (rx == ry) return;
+        sds.unionNodes(rx, ry);
+        const value_type root = sds.findNode(rx);
+
+        StatesBucket& rootSet = getCachedSet(root);
+        StatesBucket& mergedSet = getCachedSet(root == rx ? ry : rx);
+        if (rootSet->size() < mergedSet->size()) {
+            std::swap(rootSet, mergedSet);
+        }
+        const size_t numMerged = mergedSet->size();
+        numPairs.fetch_add(2 * rootSet->size() * numMerged, std::memory_order_relaxed);
+        for (size_t i = 0; i < numMerged; ++i) {
+            rootSet->append(mergedSet->get(i));
+        }
+        mergedSet->clear();
+        ++numMergedSets;
+    }
 
     /**
      * Generate a cache of the sets such that they can be iterated over efficiently.
-     * Each set is partitioned into a PiggyList.
+     * Each set is partitioned into a PiggyList, filled in parallel over the nodes of the disjoint set
+     * and then sorted, so that the members are listed in the same order for any number of threads.
+     * Once generated, the cache is read without taking the lock until the next insertion.
      */
     void genAllDisjointSetLists() const {
-        statesLock.lock();
-
         // no need to generate again, already done.
-        if (!this->statesMapStale.load(std::memory_order_acquire)) {
-            statesLock.unlock();
-            return;
-        }
+        if (!this->statesMapStale.load(std::memory_order_acquire)) return;
+
+        std::lock_guard<std::shared_mutex> guard(statesLock);
+        if (!this->statesMapStale.load(std::memory_order_acquire)) return;
 
         // btree version
         emptyPartition();
 
-        size_t dSetSize = this->sds.ds.a_blocks.size();
-        for (size_t i = 0; i < dSetSize; ++i) {
-            typename TupleType::value_type sparseVal = this->sds.toSparse(i);
-            parent_t rep = this->sds.findNode(sparseVal);
-
-            StorePair p = {rep, nullptr};
-            StatesList* mapList = equivalencePartition.insert(p, [&](StorePair& sp) {
-                auto* r = new StatesList(1);
-                sp.second = r;
-                return r;
-            });
-            mapList->append(sparseVal);
+        forEachChunk(this->sds.ds.a_blocks.size(), [&](size_t begin, size_t end) {
+            typename StatesMap::operation_hints hints;
+            for (size_t i = begin; i < end; ++i) {
+                typename TupleType::value_type sparseVal = this->sds.toSparse(i);
+                parent_t rep = this->sds.findNode(sparseVal);
+
+                StorePair p = {rep, nullptr};
+                StatesList* mapList = equivalencePartition.insert(p, hints, [&](StorePair& sp) {
+                    auto* r = new StatesList(1);
+                    sp.second = r;
+                    return r;
+                });
+                mapList->append(sparseVal);
+            }
+        });
+
+        size_t pairs = 0;
+        std::vector<StatesBucket> buckets;
+        for (auto& e : this->equivalencePartition) {
+            const size_t s = e.second->size();
+            pairs += s * s;
+            buckets.push_back(e.second);
         }
+        numPairs.store(pairs, std::memory_order_relaxed);
+
+        // the parallel fill appends in any order; sort the members so that iteration is deterministic
+        forEachChunk(buckets.size(), [&](size_t begin, size_t end) {
+            std::vector<value_type> members;
+            for (size_t i = begin; i < end; ++i) {
+                StatesList& list = *buckets[i];
+                members.resize(list.size());
+                for (size_t j = 0; j < members.size(); ++j) {
+                    members[j] = list.get(j);
+                }
+                std::sort(members.begin(), members.end());
+                for (size_t j = 0; j < members.size(); ++j) {
+                    list.get(j) = members[j];
+                }
+            }
+        });
 
         statesMapStale.store(false, std::memory_order_release);
-        statesLock.unlock();
     }
 };
 }  // namespace souffle
@@ -285,6 +285,41 @@ public:
     }
 } recursiveRuleNumberProcessor;
 
+/**
+ * Recursive Rule Join Order Profile Event Processor
+ *
+ * Records the loop nest the interpreter chose for a version of a recursive
+ * rule in an iteration, with its estimated number of tuple visits and its
+ * runtime.
+ */
+const class RecursiveRuleAdaptiveProcessor : public EventProcessor {
+public:
+    RecursiveRuleAdaptiveProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@a-recursive-rule", this);
+    }
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& version = signature[2];
+        const std::string& rule = signature[4];
+        const std::string& alternative = signature[5];
+        microseconds start = va_arg(args, microseconds);
+        microseconds end = va_arg(args, microseconds);
+        va_arg(args, size_t);
+        va_arg(args, size_t);
+        size_t estimate = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                version, "join-order", "alternative"},
+                std::stoul(alternative));
+        db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                version, "join-order", "estimate"},
+                estimate);
+        db.addDurationEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                    version, "join-order", "runtime"},
+                start, end);
+    }
+} recursiveRuleAdaptiveProcessor;
+
 /**
  * Non-Recursive Relation Number Profile Event Processor
  */
@@ -536,6 +571,23 @@ public:
 
 } relationReadsProcessor;
 
+/**
+ * Relation Statistics Processor
+ */
+const class RelationStatisticsProcessor : public EventProcessor {
+public:
+    RelationStatisticsProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@s-relation-statistics", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& attribute = signature[2];
+        size_t distinct = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "statistics", "distinct", attribute}, distinct);
+    }
+} relationStatisticsProcessor;
+
 /**
  * Config entry processor
  */
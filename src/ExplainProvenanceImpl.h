@@ -771,54 +771,21 @@ private:
             return std::make_tuple(-1, -1, std::vector<RamDomain>());
         }
 
-        // find correct tuple
-        for (auto& tuple : *rel) {
-            bool match = true;
-            std::vector<RamDomain> currentTuple;
-
-            for (size_t i = 0; i < rel->getArity() - rel->getAuxiliaryArity(); i++) {
-                RamDomain n;
-                if (*rel->getAttrType(i) == 's') {
-                    std::string s;
-                    tuple >> s;
-                    n = symTable.lookupExisting(s);
-                } else if (*rel->getAttrType(i) == 'f') {
-                    RamFloat element;
-                    tuple >> element;
-                    n = ramBitCast(element);
-                } else if (*rel->getAttrType(i) == 'u') {
-                    RamUnsigned element;
-                    tuple >> element;
-                    n = ramBitCast(element);
-                } else {
-                    tuple >> n;
-                }
-
-                currentTuple.push_back(n);
-
-                if (n != tup[i]) {
-                    match = false;
-                    break;
-                }
-            }
-
-            if (match) {
-                RamDomain ruleNum;
-                tuple >> ruleNum;
-
-                RamDomain levelNum;
-                tuple >> levelNum;
-
-                std::vector<RamDomain> subtreeLevels;
-
-                for (size_t i = rel->getArity() - rel->getAuxiliaryArity() + 2; i < rel->getArity(); i++) {
-                    RamDomain subLevel;
-                    tuple >> subLevel;
-                    subtreeLevels.push_back(subLevel);
-                }
+        const size_t arity = rel->getArity();
+        const size_t auxArity = rel->getAuxiliaryArity();
+        if (tup.size() != arity - auxArity) {
+            return std::make_tuple(-1, -1, std::vector<RamDomain>());
+        }
 
-                return std::make_tuple(ruleNum, levelNum, subtreeLevels);
+        // find correct tuple through an index on its non-auxiliary elements
+        auto range = rel->prefixRange(tup);
+        if (range.first != range.second) {
+            const tuple& found = *range.first;
+            std::vector<RamDomain> subtreeLevels;
+            for (size_t i = arity - auxArity + 2; i < arity; i++) {
+                subtreeLevels.push_back(found[i]);
             }
+            return std::make_tuple(found[arity - auxArity], found[arity - auxArity + 1], subtreeLevels);
         }
 
         // if no tuple exists
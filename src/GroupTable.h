@@ -0,0 +1,179 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file GroupTable.h
+ *
+ * The groups of a group-by aggregate, shared by the interpreter and the
+ * synthesised code.
+ *
+ * A group-by aggregate, e.g. count : { e(x, _) } for each binding of x by
+ * an outer loop, is looked up by a range query per binding at first. Once
+ * these range queries have visited as many tuples as the aggregated relation
+ * holds, the aggregate is computed for all groups in a single pass over the
+ * relation, in parallel across partitions of the relation (by the idle threads
+ * of an enclosing parallel loop, see parallelFor), and the remaining
+ * lookups are answered by a binary search over the groups. Small or selective
+ * lookups hence never pay for the pass, and repeated lookups of large groups
+ * cost at most twice the pass.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "AggregateOp.h"
+#include "RamTypes.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * @class GroupTable
+ * @brief The aggregates of the groups of a relation, computed in one pass once lookups are expensive
+ */
+class GroupTable {
+public:
+    /**
+     * The groups collected from one part of the relation. Tuples of a group
+     * that are adjacent in the scanned order are folded right away.
+     */
+    class Partition {
+    public:
+        Partition(AggregateOp function, std::size_t keyArity) : function(function), keyArity(keyArity) {}
+
+        /** Add the value of a tuple to the group of the given key */
+        void add(const RamDomain* key, RamDomain value) {
+            if (groups.empty() || !std::equal(key, key + keyArity, keys.end() - keyArity)) {
+                keys.insert(keys.end(), key, key + keyArity);
+                groups.emplace_back(function);
+            }
+            groups.back().add(value);
+        }
+
+    private:
+        friend class GroupTable;
+
+        AggregateOp function;
+        std::size_t keyArity;
+        std::vector<RamDomain> keys;
+        std::vector<AggregateAccumulator> groups;
+    };
+
+    GroupTable(AggregateOp function, std::size_t keyArity) : function(function), keyArity(keyArity) {}
+
+    /** Drop all groups, e.g. before the aggregated relation is modified */
+    void reset() {
+        built.store(false, std::memory_order_relaxed);
+        cost.store(0, std::memory_order_relaxed);
+        limit.store(0, std::memory_order_relaxed);
+        keys.clear();
+        groups.clear();
+    }
+
+    /** Return true if all groups have been computed */
+    bool isBuilt() const {
+        return built.load(std::memory_order_acquire);
+    }
+
+    /** Return an empty partition for collecting groups */
+    Partition makePartition() const {
+        return Partition(function, keyArity);
+    }
+
+    /**
+     * Charge the number of tuples visited by a range query answering a lookup.
+     * Returns true for the single call that reaches the size of the relation,
+     * obtained from the given function; the caller is expected to build the
+     * groups, while concurrent lookups proceed by range queries.
+     */
+    template <typename Size>
+    bool charge(std::size_t visited, const Size& relationSize) {
+        std::size_t bound = limit.load(std::memory_order_relaxed);
+        if (bound == 0) {
+            bound = std::max<std::size_t>(1, relationSize());
+            limit.store(bound, std::memory_order_relaxed);
+        }
+        std::size_t before = cost.fetch_add(visited, std::memory_order_relaxed);
+        return before < bound && bound <= before + visited;
+    }
+
+    /** Compute all groups from the partitions of a pass over the relation */
+    void build(const std::vector<Partition>& partitions) {
+        // sort the groups of all partitions by their keys
+        std::vector<std::pair<const RamDomain*, const AggregateAccumulator*>> order;
+        for (const auto& partition : partitions) {
+            for (std::size_t i = 0; i < partition.groups.size(); ++i) {
+                order.emplace_back(&partition.keys[i * keyArity], &partition.groups[i]);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&](const auto& a, const auto& b) {
+            return std::lexicographical_compare(a.first, a.first + keyArity, b.first, b.first + keyArity);
+        });
+
+        // merge the parts of groups split across partitions
+        keys.clear();
+        groups.clear();
+        for (const auto& cur : order) {
+            if (groups.empty() || !std::equal(cur.first, cur.first + keyArity, keys.end() - keyArity)) {
+                keys.insert(keys.end(), cur.first, cur.first + keyArity);
+                groups.push_back(*cur.second);
+            } else {
+                groups.back().merge(*cur.second);
+            }
+        }
+        built.store(true, std::memory_order_release);
+    }
+
+    /** Return the group of the given key, or nullptr if the group is empty */
+    const AggregateAccumulator* lookup(const RamDomain* key) const {
+        std::size_t low = 0;
+        std::size_t high = groups.size();
+        while (low < high) {
+            std::size_t mid = low + (high - low) / 2;
+            const RamDomain* cur = &keys[mid * keyArity];
+            if (std::lexicographical_compare(cur, cur + keyArity, key, key + keyArity)) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low < groups.size() && std::equal(key, key + keyArity, &keys[low * keyArity])) {
+            return &groups[low];
+        }
+        return nullptr;
+    }
+
+private:
+    /** the aggregation function */
+    AggregateOp function;
+
+    /** the number of grouping attributes */
+    std::size_t keyArity;
+
+    /** the keys of the groups in ascending order, keyArity values each */
+    std::vector<RamDomain> keys;
+
+    /** the aggregate of each group */
+    std::vector<AggregateAccumulator> groups;
+
+    /** true once the groups have been computed */
+    std::atomic<bool> built{false};
+
+    /** the number of tuples visited by range queries */
+    std::atomic<std::size_t> cost{0};
+
+    /** the size of the relation, 0 until the first lookup */
+    std::atomic<std::size_t> limit{0};
+};
+
+}  // end of namespace souffle
@@ -16,9 +16,11 @@
 
 #include "RamTypes.h"
 #include "ReadStream.h"
+#include "ReadStreamBinary.h"
 #include "ReadStreamCSV.h"
 #include "SymbolTable.h"
 #include "WriteStream.h"
+#include "WriteStreamBinary.h"
 #include "WriteStreamCSV.h"
 
 #ifdef USE_SQLITE
@@ -80,6 +82,8 @@ private:
         registerWriteStreamFactory(std::make_shared<WriteFileCSVFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutCSVFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutPrintSizeFactory>());
+        registerReadStreamFactory(std::make_shared<ReadBinaryFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteBinaryFactory>());
 #ifdef USE_SQLITE
         registerReadStreamFactory(std::make_shared<ReadSQLiteFactory>());
         registerWriteStreamFactory(std::make_shared<WriteSQLiteFactory>());
@@ -43,13 +43,16 @@ class InterpreterContext {
     std::vector<std::unique_ptr<RamDomain[]>> allocatedDataContainer;
     /** @brief Views */
     std::vector<std::unique_ptr<IndexView>> views;
+    /** @brief Iteration number of the enclosing loop, local to the stratum being evaluated */
+    size_t iteration = 0;
 
 public:
     InterpreterContext(size_t size = 0) : data(size) {}
 
     /** This constructor is used when program enter a new scope.
-     * Only Subroutine value needs to be copied */
-    InterpreterContext(InterpreterContext& ctxt) : returnValues(ctxt.returnValues), args(ctxt.args) {}
+     * Only Subroutine value and the iteration number need to be copied */
+    InterpreterContext(InterpreterContext& ctxt)
+            : returnValues(ctxt.returnValues), args(ctxt.args), iteration(ctxt.iteration) {}
     virtual ~InterpreterContext() = default;
 
     const RamDomain*& operator[](size_t index) {
@@ -105,6 +108,21 @@ public:
         return (*args)[i];
     }
 
+    /** @brief Return current iteration number for loop operation */
+    size_t getIterationNumber() const {
+        return iteration;
+    }
+
+    /** @brief Increase iteration number by one */
+    void incIterationNumber() {
+        ++iteration;
+    }
+
+    /** @brief Reset iteration number */
+    void resetIterationNumber() {
+        iteration = 0;
+    }
+
     /** @brief Create a view in the environment */
     void createView(const InterpreterRelation& rel, size_t indexPos, size_t viewPos) {
         ViewPtr view;
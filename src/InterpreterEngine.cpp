@@ -16,13 +16,16 @@
 #include "InterpreterEngine.h"
 #include "AggregateOp.h"
 #include "BinaryConstraintOps.h"
+#include "Checkpoint.h"
 #include "FunctorOps.h"
+#include "GroupTable.h"
 #include "IOSystem.h"
 #include "InterpreterContext.h"
 #include "InterpreterGenerator.h"
 #include "InterpreterIndex.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
+#include "InterpreterProgInterface.h"
 #include "InterpreterRelation.h"
 #include "Logger.h"
 #include "ProfileEvent.h"
@@ -47,14 +50,18 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <csignal>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <regex>
 #include <sstream>
 #include <utility>
+#include <vector>
 #include <dlfcn.h>
 #include <ffi.h>
 
@@ -82,8 +89,26 @@ namespace souffle {
 
 namespace {
 constexpr RamDomain RAM_BIT_SHIFT_MASK = RAM_DOMAIN_SIZE - 1;
+
+// Number of partitions per thread of parallel scans, balanced by work stealing
+constexpr int PARTITIONS_PER_THREAD = 16;
 }
 
+/**
+ * @class InterpreterFunctor
+ * @brief A user-defined operator whose function has been resolved and whose
+ *        foreign function call interface has been prepared ahead of evaluation.
+ */
+class InterpreterFunctor {
+public:
+    /** resolved function; nullptr if no loaded library provides it */
+    void (*fn)() = nullptr;
+    /** prepared call interface */
+    ffi_cif cif;
+    /** argument types referenced by the call interface */
+    std::vector<ffi_type*> args;
+};
+
 InterpreterEngine::RelationHandle& InterpreterEngine::getRelationHandle(const size_t idx) {
     return generator.getRelationHandle(idx);
 }
@@ -121,6 +146,47 @@ void* InterpreterEngine::getMethodHandle(const std::string& method) {
     return nullptr;
 }
 
+std::shared_ptr<InterpreterFunctor> InterpreterEngine::prepareFunctor(const RamUserDefinedOperator& op) {
+    auto functor = std::make_shared<InterpreterFunctor>();
+    const std::string& name = op.getName();
+
+    // missing functors are only reported when they are evaluated
+    functor->fn = reinterpret_cast<void (*)()>(getMethodHandle(name));
+    if (functor->fn == nullptr) {
+        return functor;
+    }
+
+    auto ffiType = [](TypeAttribute type) -> ffi_type* {
+        switch (type) {
+            case TypeAttribute::Symbol: return &FFI_Symbol;
+            case TypeAttribute::Signed: return &FFI_RamSigned;
+            case TypeAttribute::Unsigned: return &FFI_RamUnsigned;
+            case TypeAttribute::Float: return &FFI_RamFloat;
+            case TypeAttribute::Record: return nullptr;
+        }
+        return nullptr;
+    };
+
+    // records are not supported; the evaluation reports them
+    for (TypeAttribute type : op.getArgsTypes()) {
+        functor->args.push_back(ffiType(type));
+        if (functor->args.back() == nullptr) {
+            return functor;
+        }
+    }
+    ffi_type* codomain = ffiType(op.getReturnType());
+    if (codomain == nullptr) {
+        return functor;
+    }
+
+    const auto prepStatus = ffi_prep_cif(
+            &functor->cif, FFI_DEFAULT_ABI, functor->args.size(), codomain, functor->args.data());
+    if (prepStatus != FFI_OK) {
+        fatal("Failed to prepare CIF for user-defined operator `%s`; error code = %d", name, prepStatus);
+    }
+    return functor;
+}
+
 std::vector<std::unique_ptr<InterpreterEngine::RelationHandle>>& InterpreterEngine::getRelationMap() {
     return generator.getRelations();
 }
@@ -170,16 +236,6 @@ const std::vector<void*>& InterpreterEngine::loadDLL() {
     return dll;
 }
 
-size_t InterpreterEngine::getIterationNumber() const {
-    return iteration;
-}
-void InterpreterEngine::incIterationNumber() {
-    ++iteration;
-}
-void InterpreterEngine::resetIterationNumber() {
-    iteration = 0;
-}
-
 void InterpreterEngine::executeMain() {
     SignalHandler::instance()->set();
     if (Global::config().has("verbose")) {
@@ -189,6 +245,26 @@ void InterpreterEngine::executeMain() {
     generateIR();
     assert(main != nullptr && "Executing an empty program");
 
+    // restore the newest checkpoint, whose strata are skipped, and checkpoint the following strata
+    std::unique_ptr<InterpreterProgInterface> interface;
+    std::unique_ptr<Checkpoint> strataCheckpoint;
+    if (Global::config().has("checkpoint-dir")) {
+        interface = std::make_unique<InterpreterProgInterface>(*this);
+        strataCheckpoint = std::make_unique<Checkpoint>(Global::config().get("checkpoint-dir"),
+                Checkpoint::getFingerprint(toString(tUnit.getProgram())), getSymbolTable(), getRecordTable(),
+                interface->getAllRelations());
+        // an incremental run continues from the snapshot of the preceding run, updating all strata
+        if (!Global::config().has("incremental")) {
+            visitDepthFirst(tUnit.getProgram(), [&](const RamIO& io) {
+                if (io.get("operation") == "input" && io.getDirectives().count("filename") != 0) {
+                    strataCheckpoint->addInput(io.get("filename"));
+                }
+            });
+            checkpoint = strataCheckpoint.get();
+        }
+        strataCheckpoint->restore();
+    }
+
     InterpreterContext ctxt;
 
     if (!profileEnabled) {
@@ -239,6 +315,12 @@ void InterpreterEngine::executeMain() {
                     "@relation-reads;" + cur.first, cur.second, 0);
         }
     }
+    if (strataCheckpoint != nullptr && Global::config().has("incremental")) {
+        strataCheckpoint->saveAll();
+    } else if (strataCheckpoint != nullptr) {
+        strataCheckpoint->finish();
+    }
+    checkpoint = nullptr;
     SignalHandler::instance()->reset();
 }
 
@@ -515,13 +597,12 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             const std::string& name = cur.getName();
             const std::vector<TypeAttribute>& type = cur.getArgsTypes();
 
-            auto fn = reinterpret_cast<void (*)()>(getMethodHandle(name));
-            if (fn == nullptr) fatal("cannot find user-defined operator `%s`", name);
+            // the function has been resolved and its call interface prepared by the generator
+            InterpreterFunctor& functor = *node->getFunctor();
+            if (functor.fn == nullptr) fatal("cannot find user-defined operator `%s`", name);
 
             // prepare dynamic call environment
             size_t arity = cur.getArguments().size();
-            ffi_cif cif;
-            ffi_type* args[arity];
             void* values[arity];
             RamDomain intVal[arity];
             RamUnsigned uintVal[arity];
@@ -534,22 +615,18 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 RamDomain arg = execute(node->getChild(i), ctxt);
                 switch (type[i]) {
                     case TypeAttribute::Symbol:
-                        args[i] = &FFI_Symbol;
                         strVal[i] = getSymbolTable().resolve(arg).c_str();
                         values[i] = &strVal[i];
                         break;
                     case TypeAttribute::Signed:
-                        args[i] = &FFI_RamSigned;
                         intVal[i] = arg;
                         values[i] = &intVal[i];
                         break;
                     case TypeAttribute::Unsigned:
-                        args[i] = &FFI_RamUnsigned;
                         uintVal[i] = ramBitCast<RamUnsigned>(arg);
                         values[i] = &uintVal[i];
                         break;
                     case TypeAttribute::Float:
-                        args[i] = &FFI_RamFloat;
                         floatVal[i] = ramBitCast<RamFloat>(arg);
                         values[i] = &floatVal[i];
                         break;
@@ -557,24 +634,9 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 }
             }
 
-            // Get codomain.
-            auto codomain = &FFI_RamSigned;
-            switch (cur.getReturnType()) {
-                // initialize for string value.
-                case TypeAttribute::Symbol: codomain = &FFI_Symbol; break;
-                case TypeAttribute::Signed: codomain = &FFI_RamSigned; break;
-                case TypeAttribute::Unsigned: codomain = &FFI_RamUnsigned; break;
-                case TypeAttribute::Float: codomain = &FFI_RamFloat; break;
-                case TypeAttribute::Record: fatal("Not implemented");
-            }
-
             // Call the external function.
-            const auto prepStatus = ffi_prep_cif(&cif, FFI_DEFAULT_ABI, arity, codomain, args);
-            if (prepStatus != FFI_OK) {
-                fatal("Failed to prepare CIF for user-defined operator `%s`; error code = %d", name,
-                        prepStatus);
-            }
-            ffi_call(&cif, fn, &rc, values);
+            if (cur.getReturnType() == TypeAttribute::Record) fatal("Not implemented");
+            ffi_call(&functor.cif, functor.fn, &rc, values);
 
             RamDomain result;
             switch (cur.getReturnType()) {
@@ -756,10 +818,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
             if (profileEnabled && !cur.getProfileText().empty()) {
                 auto& currentFrequencies = frequencies[cur.getProfileText()];
-                while (currentFrequencies.size() <= getIterationNumber()) {
+                while (currentFrequencies.size() <= ctxt.getIterationNumber()) {
                     currentFrequencies.emplace_back(0);
                 }
-                frequencies[cur.getProfileText()][getIterationNumber()]++;
+                frequencies[cur.getProfileText()][ctxt.getIterationNumber()]++;
             }
             return result;
         ESAC(TupleOperation)
@@ -782,8 +844,9 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             auto preamble = node->getPreamble();
             auto& rel = *node->getRelation();
 
-            auto pStream = rel.partitionScan(numOfThreads);
+            auto pStream = rel.partitionScan(MAX_THREADS * PARTITIONS_PER_THREAD);
 
+            WorkStealingLoop tasks(pStream.size());
             PARALLEL_START
                 ;
                 InterpreterContext newCtxt(ctxt);
@@ -791,8 +854,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                for (std::size_t part : tasks) {
+                    for (const TupleRef& val : pStream[part]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (!execute(node->getChild(0), newCtxt)) {
                             break;
@@ -849,9 +912,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t indexPos = node->getData(0);
-            auto pStream =
-                    rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
+            auto pStream = rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                    MAX_THREADS * PARTITIONS_PER_THREAD);
 
+            WorkStealingLoop tasks(pStream.size());
             PARALLEL_START
                 ;
                 InterpreterContext newCtxt(ctxt);
@@ -859,8 +923,8 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                for (std::size_t part : tasks) {
+                    for (const TupleRef& val : pStream[part]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (!execute(node->getChild(2 * arity), newCtxt)) {
                             break;
@@ -891,16 +955,17 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             auto preamble = node->getPreamble();
             auto& rel = *node->getRelation();
 
-            auto pStream = rel.partitionScan(numOfThreads);
+            auto pStream = rel.partitionScan(MAX_THREADS * PARTITIONS_PER_THREAD);
             auto viewInfo = preamble->getViewInfoForNested();
+            WorkStealingLoop tasks(pStream.size());
             PARALLEL_START
                 ;
                 InterpreterContext newCtxt(ctxt);
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                for (std::size_t part : tasks) {
+                    for (const TupleRef& val : pStream[part]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (execute(node->getChild(0), newCtxt)) {
                             execute(node->getChild(1), newCtxt);
@@ -962,17 +1027,18 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             }
 
             size_t indexPos = node->getData(0);
-            auto pStream =
-                    rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity), numOfThreads);
+            auto pStream = rel.partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                    MAX_THREADS * PARTITIONS_PER_THREAD);
 
+            WorkStealingLoop tasks(pStream.size());
             PARALLEL_START
                 ;
                 InterpreterContext newCtxt(ctxt);
                 for (const auto& info : viewInfo) {
                     newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
-                pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-                    for (const TupleRef& val : *it) {
+                for (std::size_t part : tasks) {
+                    for (const TupleRef& val : pStream[part]) {
                         newCtxt[cur.getTupleId()] = val.getBase();
                         if (execute(node->getChild(2 * arity), newCtxt)) {
                             execute(node->getChild(2 * arity + 1), newCtxt);
@@ -1009,6 +1075,12 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     node->getRelation()->scan());
         ESAC(Aggregate)
 
+        CASE(ParallelAggregate)
+            return executeParallelAggregate(ctxt, cur, *node->getChild(0), node->getChild(1),
+                    *node->getChild(2), *node->getPreamble(),
+                    node->getRelation()->partitionScan(MAX_THREADS * PARTITIONS_PER_THREAD));
+        ESAC(ParallelAggregate)
+
         CASE(IndexAggregate)
             // init temporary tuple for this level
             size_t arity = cur.getRelation().getArity();
@@ -1034,6 +1106,153 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                     *node->getChild(2 * arity + 2), view->range(TupleRef(low, arity), TupleRef(hig, arity)));
         ESAC(IndexAggregate)
 
+        CASE(ParallelIndexAggregate)
+            size_t arity = cur.getRelation().getArity();
+
+            // get lower and upper boundaries for iteration
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                if (node->getChild(i) != nullptr) {
+                    low[i] = execute(node->getChild(i), ctxt);
+                    hig[i] = execute(node->getChild(i + arity), ctxt);
+                } else {
+                    low[i] = MIN_RAM_SIGNED;
+                    hig[i] = MAX_RAM_SIGNED;
+                }
+            }
+
+            size_t indexPos = node->getData(0);
+            return executeParallelAggregate(ctxt, cur, *node->getChild(2 * arity),
+                    node->getChild(2 * arity + 1), *node->getChild(2 * arity + 2), *node->getPreamble(),
+                    node->getRelation()->partitionRange(indexPos, TupleRef(low, arity), TupleRef(hig, arity),
+                            MAX_THREADS * PARTITIONS_PER_THREAD));
+        ESAC(ParallelIndexAggregate)
+
+        CASE(RangeAggregate)
+            size_t arity = cur.getRelation().getArity();
+
+            // get lower and upper boundaries of the range
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            for (size_t i = 0; i < arity; i++) {
+                if (node->getChild(i) != nullptr) {
+                    low[i] = execute(node->getChild(i), ctxt);
+                    hig[i] = execute(node->getChild(i + arity), ctxt);
+                } else {
+                    low[i] = MIN_RAM_SIGNED;
+                    hig[i] = MAX_RAM_SIGNED;
+                }
+            }
+
+            size_t viewId = node->getData(0);
+            auto& view = ctxt.getView(viewId);
+
+            RamDomain res[1];
+            if (cur.getFunction() == AggregateOp::COUNT) {
+                res[0] = view->count(TupleRef(low, arity), TupleRef(hig, arity));
+            } else {
+                // the minimum or maximum is the target of the first or last tuple of the range
+                RamDomain tuple[arity];
+                bool found = cur.getFunction() == AggregateOp::MIN
+                                     ? view->first(TupleRef(low, arity), TupleRef(hig, arity), tuple)
+                                     : view->last(TupleRef(low, arity), TupleRef(hig, arity), tuple);
+                if (!found) {
+                    return true;
+                }
+                ctxt[cur.getTupleId()] = tuple;
+                res[0] = execute(node->getChild(2 * arity), ctxt);
+            }
+
+            // write result to environment
+            ctxt[cur.getTupleId()] = res;
+            return execute(node->getChild(2 * arity + 1), ctxt);
+        ESAC(RangeAggregate)
+
+        CASE(GroupAggregate)
+            auto& rel = *node->getRelation();
+            size_t arity = cur.getRelation().getArity();
+            const InterpreterNode& filter = *node->getChild(2 * arity);
+            const InterpreterNode* expression = node->getChild(2 * arity + 1);
+            const bool isCount = cur.getFunction() == AggregateOp::COUNT;
+            GroupTable& groups = *node->getGroupTable();
+
+            // the bounds of the search attributes are equal and form the key of the group
+            RamDomain low[arity];
+            RamDomain hig[arity];
+            RamDomain key[arity];
+            size_t keyArity = 0;
+            for (size_t i = 0; i < arity; i++) {
+                if (node->getChild(i) != nullptr) {
+                    low[i] = hig[i] = key[keyArity++] = execute(node->getChild(i), ctxt);
+                } else {
+                    low[i] = MIN_RAM_SIGNED;
+                    hig[i] = MAX_RAM_SIGNED;
+                }
+            }
+
+            AggregateAccumulator acc(cur.getFunction());
+            if (groups.isBuilt()) {
+                if (const AggregateAccumulator* group = groups.lookup(key)) {
+                    acc = *group;
+                }
+            } else {
+                // aggregate the group by a range query, charging the visited tuples
+                size_t visited = 1;
+                auto& view = ctxt.getView(node->getData(0));
+                for (auto data : view->range(TupleRef(low, arity), TupleRef(hig, arity))) {
+                    ++visited;
+                    ctxt[cur.getTupleId()] = &data[0];
+                    if (execute(&filter, ctxt)) {
+                        acc.add(isCount ? 0 : execute(expression, ctxt));
+                    }
+                }
+
+                if (groups.charge(visited, [&]() { return rel.size(); })) {
+                    // aggregate all groups in one pass over the index of the search
+                    for (size_t i = 0; i < arity; i++) {
+                        low[i] = MIN_RAM_SIGNED;
+                        hig[i] = MAX_RAM_SIGNED;
+                    }
+                    auto pStream = rel.partitionRange(node->getData(1), TupleRef(low, arity),
+                            TupleRef(hig, arity), MAX_THREADS * PARTITIONS_PER_THREAD);
+                    std::vector<GroupTable::Partition> partitions(pStream.size(), groups.makePartition());
+
+                    // the lookup usually runs within a parallel scan, whose idle threads join the pass
+                    auto preamble = node->getPreamble();
+                    parallelFor(pStream.size(), [&](std::size_t part) {
+                        InterpreterContext newCtxt(ctxt);
+                        auto viewInfo = preamble->getViewInfoForNested();
+                        for (const auto& info : viewInfo) {
+                            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+                        }
+                        RamDomain groupKey[arity];
+                        for (const TupleRef& val : pStream[part]) {
+                            newCtxt[cur.getTupleId()] = val.getBase();
+                            if (!execute(&filter, newCtxt)) {
+                                continue;
+                            }
+                            for (size_t i = 0; i < keyArity; i++) {
+                                groupKey[i] = val[node->getData(2 + i)];
+                            }
+                            partitions[part].add(groupKey, isCount ? 0 : execute(expression, newCtxt));
+                        }
+                    });
+                    groups.build(partitions);
+                }
+            }
+
+            // write result to environment
+            RamDomain tuple[1];
+            tuple[0] = acc.getResult();
+            ctxt[cur.getTupleId()] = tuple;
+
+            if (!acc.hasResult()) {
+                return true;
+            }
+            return execute(node->getChild(2 * arity + 2), ctxt);
+        ESAC(GroupAggregate)
+
         CASE_NO_CAST(Break)
             // check condition
             if (execute(node->getChild(0), ctxt)) {
@@ -1052,10 +1271,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
 
             if (profileEnabled && !cur.getProfileText().empty()) {
                 auto& currentFrequencies = frequencies[cur.getProfileText()];
-                while (currentFrequencies.size() <= getIterationNumber()) {
+                while (currentFrequencies.size() <= ctxt.getIterationNumber()) {
                     currentFrequencies.emplace_back(0);
                 }
-                frequencies[cur.getProfileText()][getIterationNumber()]++;
+                frequencies[cur.getProfileText()][ctxt.getIterationNumber()]++;
             }
             return result;
         ESAC(Filter)
@@ -1093,7 +1312,44 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return true;
         ESAC(Sequence)
 
+        CASE_NO_CAST(Schedule)
+            // decode the predecessors of the strata calls and run the calls as a task graph
+            const auto& children = node->getChildren();
+            std::vector<std::vector<size_t>> predecessors(children.size());
+            size_t pos = 1;
+            for (auto& preds : predecessors) {
+                const size_t count = node->getData(pos++);
+                for (size_t i = 0; i < count; ++i) {
+                    preds.push_back(node->getData(pos++));
+                }
+            }
+            runTaskGraph(predecessors, node->getData(0), [&](size_t stratum) {
+                // checkpointed strata are evaluated in sequence
+                if (checkpoint != nullptr && checkpoint->isFinished(stratum)) {
+                    return;
+                }
+                InterpreterContext newCtxt(ctxt);
+                execute(children[stratum].get(), newCtxt);
+                if (checkpoint != nullptr) {
+                    checkpoint->save(stratum);
+                }
+            });
+            return true;
+        ESAC(Schedule)
+
         CASE_NO_CAST(Parallel)
+            if (node->getData(0) != 0) {
+                // independent statements free of exits => run them concurrently
+                const auto& children = node->getChildren();
+                PARALLEL_START
+                    ;
+                    pfor(size_t i = 0; i < children.size(); i++) {
+                        InterpreterContext newCtxt(ctxt);
+                        execute(children[i].get(), newCtxt);
+                    }
+                PARALLEL_END;
+                return true;
+            }
             for (const auto& child : node->getChildren()) {
                 if (!execute(child.get(), ctxt)) {
                     return false;
@@ -1102,12 +1358,51 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return true;
         ESAC(Parallel)
 
+        CASE(AdaptiveQuery)
+            // Choose the loop nest with the fewest estimated tuple visits for the current relation
+            // sizes. A loop binding k of the n attributes of a relation R is expected to visit
+            // |R|^((n-k)/n) tuples per tuple of its outer loops.
+            size_t choice = 0;
+            double minCost = std::numeric_limits<double>::max();
+            size_t pos = 0;
+            for (size_t i = 0; i < node->getChildren().size(); ++i) {
+                const size_t numLoops = node->getData(pos++);
+                double cost = 0;
+                double visits = 1;
+                for (size_t j = 0; j < numLoops; ++j) {
+                    const InterpreterRelation& rel = *getRelationHandle(node->getData(pos++));
+                    const auto size = static_cast<double>(rel.size());
+                    const size_t arity = rel.getArity();
+                    const size_t bound = node->getData(pos++);
+                    double free = arity == 0 ? 0 : static_cast<double>(arity - bound) / arity;
+                    visits *= size == 0 ? 0 : std::pow(size, free);
+                    cost += visits;
+                }
+                if (cost < minCost) {
+                    choice = i;
+                    minCost = cost;
+                }
+            }
+            if (!profileEnabled) {
+                return execute(node->getChild(choice), ctxt);
+            }
+
+            // log the choice with its estimated and observed cost
+            auto& profile = ProfileEventSingleton::instance();
+            time_point start = now();
+            size_t startMaxRSS = profile.getMaxRSS();
+            RamDomain result = execute(node->getChild(choice), ctxt);
+            profile.makeTimingEvent(cur.getMessage() + std::to_string(choice), start, now(), startMaxRSS,
+                    profile.getMaxRSS(), static_cast<size_t>(minCost), ctxt.getIterationNumber());
+            return result;
+        ESAC(AdaptiveQuery)
+
         CASE_NO_CAST(Loop)
-            resetIterationNumber();
+            ctxt.resetIterationNumber();
             while (execute(node->getChild(0), ctxt)) {
-                incIterationNumber();
+                ctxt.incIterationNumber();
             }
-            resetIterationNumber();
+            ctxt.resetIterationNumber();
             return true;
         ESAC(Loop)
 
@@ -1116,13 +1411,13 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         ESAC(Exit)
 
         CASE(LogRelationTimer)
-            Logger logger(cur.getMessage(), getIterationNumber(),
+            Logger logger(cur.getMessage(), ctxt.getIterationNumber(),
                     std::bind(&InterpreterRelation::size, node->getRelation()));
             return execute(node->getChild(0), ctxt);
         ESAC(LogRelationTimer)
 
         CASE(LogTimer)
-            Logger logger(cur.getMessage(), getIterationNumber());
+            Logger logger(cur.getMessage(), ctxt.getIterationNumber());
             return execute(node->getChild(0), ctxt);
         ESAC(LogTimer)
 
@@ -1144,10 +1439,16 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
         CASE(LogSize)
             const InterpreterRelation& rel = *node->getRelation();
             ProfileEventSingleton::instance().makeQuantityEvent(
-                    cur.getMessage(), rel.size(), getIterationNumber());
+                    cur.getMessage(), rel.size(), ctxt.getIterationNumber());
             return true;
         ESAC(LogSize)
 
+        CASE(LogStatistics)
+            const InterpreterRelation& rel = *node->getRelation();
+            ProfileEventSingleton::instance().makeStatisticsEvents(cur.getMessage(), rel, rel.getArity());
+            return true;
+        ESAC(LogStatistics)
+
         CASE(IO)
 
             const auto& directive = cur.getDirectives();
@@ -1156,6 +1457,10 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             if (op == "input") {
                 try {
                     InterpreterRelation& relation = *node->getRelation();
+                    // replace the facts of a preceding run
+                    if (directive.count("clear") != 0) {
+                        relation.purge();
+                    }
                     IOSystem::getInstance()
                             .getReader(directive, getSymbolTable(), getRecordTable())
                             ->readAll(relation);
@@ -1214,6 +1519,11 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
                 }
             }
             execute(node->getChild(0), ctxt);
+
+            // Drop the groups of group aggregates; the relations may change until the next execution.
+            for (auto& groups : preamble->getGroupTables()) {
+                groups->reset();
+            }
             return true;
         ESAC(Query)
 
@@ -1225,6 +1535,11 @@ RamDomain InterpreterEngine::execute(const InterpreterNode* node, InterpreterCon
             return true;
         ESAC(Extend)
 
+        CASE_NO_CAST(Merge)
+            getRelationHandle(node->getData(1))->insert(*getRelationHandle(node->getData(0)));
+            return true;
+        ESAC(Merge)
+
         CASE_NO_CAST(Swap)
             swapRelation(node->getData(0), node->getData(1));
             return true;
@@ -1241,46 +1556,7 @@ template <typename Aggregate>
 RamDomain InterpreterEngine::executeAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
         const InterpreterNode& filter, const InterpreterNode* expression,
         const InterpreterNode& nestedOperation, Stream stream) {
-    bool shouldRunNested = false;
-
-    // initialize result
-    RamDomain res = 0;
-
-    // Use for calculating mean.
-    std::pair<RamFloat, RamFloat> accumulateMean;
-
-    switch (aggregate.getFunction()) {
-        case AggregateOp::MIN: res = ramBitCast(MAX_RAM_SIGNED); break;
-        case AggregateOp::UMIN: res = ramBitCast(MAX_RAM_UNSIGNED); break;
-        case AggregateOp::FMIN: res = ramBitCast(MAX_RAM_FLOAT); break;
-
-        case AggregateOp::MAX: res = ramBitCast(MIN_RAM_SIGNED); break;
-        case AggregateOp::UMAX: res = ramBitCast(MIN_RAM_UNSIGNED); break;
-        case AggregateOp::FMAX: res = ramBitCast(MIN_RAM_FLOAT); break;
-
-        case AggregateOp::SUM:
-            res = ramBitCast(static_cast<RamSigned>(0));
-            shouldRunNested = true;
-            break;
-        case AggregateOp::USUM:
-            res = ramBitCast(static_cast<RamUnsigned>(0));
-            shouldRunNested = true;
-            break;
-        case AggregateOp::FSUM:
-            res = ramBitCast(static_cast<RamFloat>(0));
-            shouldRunNested = true;
-            break;
-
-        case AggregateOp::MEAN:
-            res = 0;
-            accumulateMean = {0, 0};
-            break;
-
-        case AggregateOp::COUNT:
-            res = 0;
-            shouldRunNested = true;
-            break;
-    }
+    AggregateAccumulator acc(aggregate.getFunction());
 
     for (auto ip : stream) {
         const RamDomain* data = &ip[0];
@@ -1290,66 +1566,75 @@ RamDomain InterpreterEngine::executeAggregate(InterpreterContext& ctxt, const Ag
             continue;
         }
 
-        shouldRunNested = true;
-
         // count is a special case.
         if (aggregate.getFunction() == AggregateOp::COUNT) {
-            ++res;
+            acc.add(0);
             continue;
         }
 
         // eval target expression
         assert(expression);  // only case where this is null is `COUNT`
-        RamDomain val = execute(expression, ctxt);
-
-        switch (aggregate.getFunction()) {
-            case AggregateOp::MIN: res = std::min(res, val); break;
-            case AggregateOp::FMIN:
-                res = ramBitCast(std::min(ramBitCast<RamFloat>(res), ramBitCast<RamFloat>(val)));
-                break;
-            case AggregateOp::UMIN:
-                res = ramBitCast(std::min(ramBitCast<RamUnsigned>(res), ramBitCast<RamUnsigned>(val)));
-                break;
-
-            case AggregateOp::MAX: res = std::max(res, val); break;
-            case AggregateOp::FMAX:
-                res = ramBitCast(std::max(ramBitCast<RamFloat>(res), ramBitCast<RamFloat>(val)));
-                break;
-            case AggregateOp::UMAX:
-                res = ramBitCast(std::max(ramBitCast<RamUnsigned>(res), ramBitCast<RamUnsigned>(val)));
-                break;
+        acc.add(execute(expression, ctxt));
+    }
 
-            case AggregateOp::SUM: res += val; break;
-            case AggregateOp::FSUM:
-                res = ramBitCast(ramBitCast<RamFloat>(res) + ramBitCast<RamFloat>(val));
-                break;
-            case AggregateOp::USUM:
-                res = ramBitCast(ramBitCast<RamUnsigned>(res) + ramBitCast<RamUnsigned>(val));
-                break;
+    // write result to environment
+    RamDomain tuple[1];
+    tuple[0] = acc.getResult();
+    ctxt[aggregate.getTupleId()] = tuple;
 
-            case AggregateOp::MEAN:
-                accumulateMean.first += ramBitCast<RamFloat>(val);
-                accumulateMean.second++;
-                break;
+    if (!acc.hasResult()) {
+        return true;
+    } else {
+        return execute(&nestedOperation, ctxt);
+    }
+}
 
-            case AggregateOp::COUNT: fatal("This should never be executed");
+template <typename Aggregate>
+RamDomain InterpreterEngine::executeParallelAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
+        const InterpreterNode& filter, const InterpreterNode* expression,
+        const InterpreterNode& nestedOperation, InterpreterPreamble& preamble,
+        PartitionedStream partitions) {
+    // aggregate each partition separately
+    std::vector<AggregateAccumulator> partials(
+            partitions.size(), AggregateAccumulator(aggregate.getFunction()));
+    WorkStealingLoop tasks(partitions.size());
+    PARALLEL_START
+        ;
+        InterpreterContext newCtxt(ctxt);
+        for (const auto& info : preamble.getViewInfoForNested()) {
+            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
         }
-    }
+        for (std::size_t part : tasks) {
+            for (const TupleRef& val : partitions[part]) {
+                newCtxt[aggregate.getTupleId()] = val.getBase();
+                if (!execute(&filter, newCtxt)) {
+                    continue;
+                }
+                // count is a special case.
+                if (aggregate.getFunction() == AggregateOp::COUNT) {
+                    partials[part].add(0);
+                } else {
+                    partials[part].add(execute(expression, newCtxt));
+                }
+            }
+        }
+    PARALLEL_END;
 
-    if (aggregate.getFunction() == AggregateOp::MEAN && accumulateMean.second != 0) {
-        res = ramBitCast(accumulateMean.first / accumulateMean.second);
+    // combine the partial aggregates in the order of the partitions
+    AggregateAccumulator acc(aggregate.getFunction());
+    for (const auto& partial : partials) {
+        acc.merge(partial);
     }
 
     // write result to environment
     RamDomain tuple[1];
-    tuple[0] = res;
+    tuple[0] = acc.getResult();
     ctxt[aggregate.getTupleId()] = tuple;
 
-    if (!shouldRunNested) {
+    if (!acc.hasResult()) {
         return true;
-    } else {
-        return execute(&nestedOperation, ctxt);
     }
+    return execute(&nestedOperation, ctxt);
 }
 
 }  // namespace souffle
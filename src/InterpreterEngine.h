@@ -16,10 +16,12 @@
 
 #pragma once
 
+#include "Checkpoint.h"
 #include "Global.h"
 #include "InterpreterGenerator.h"
 #include "InterpreterIndex.h"
 #include "RamIndexAnalysis.h"
+#include "RamScheduleAnalysis.h"
 #include "RamTranslationUnit.h"
 #include "RamTypes.h"
 #include "RecordTable.h"
@@ -38,6 +40,7 @@ namespace souffle {
 
 class InterpreterProgInterface;
 class InterpreterContext;
+class InterpreterFunctor;
 class InterpreterNode;
 class InterpreterRelation;
 class SymbolTable;
@@ -54,7 +57,9 @@ public:
     InterpreterEngine(RamTranslationUnit& tUnit)
             : profileEnabled(Global::config().has("profile")),
               numOfThreads(std::stoi(Global::config().get("jobs"))), tUnit(tUnit),
-              isa(tUnit.getAnalysis<RamIndexAnalysis>()), generator(isa) {
+              isa(tUnit.getAnalysis<RamIndexAnalysis>()),
+              generator(isa, [this](const RamUserDefinedOperator& op) { return prepareFunctor(op); },
+                      tUnit.getAnalysis<RamScheduleAnalysis>()) {
 #ifdef _OPENMP
         if (numOfThreads > 0) {
             omp_set_num_threads(numOfThreads);
@@ -89,16 +94,18 @@ private:
     RamDomain executeAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
             const InterpreterNode& filter, const InterpreterNode* expression,
             const InterpreterNode& nestedOperation, Stream stream);
+    /** Execute helper. Common part of ParallelAggregate & ParallelIndexAggregate. */
+    template <typename Aggregate>
+    RamDomain executeParallelAggregate(InterpreterContext& ctxt, const Aggregate& aggregate,
+            const InterpreterNode& filter, const InterpreterNode* expression,
+            const InterpreterNode& nestedOperation, InterpreterPreamble& preamble,
+            PartitionedStream partitions);
     /** @brief Return method handler */
     void* getMethodHandle(const std::string& method);
+    /** @brief Resolve a user-defined operator and prepare its foreign function call */
+    std::shared_ptr<InterpreterFunctor> prepareFunctor(const RamUserDefinedOperator& op);
     /** @brief Load DLL */
     const std::vector<void*>& loadDLL();
-    /** @brief Return current iteration number for loop operation */
-    size_t getIterationNumber() const;
-    /** @brief Increase iteration number by one */
-    void incIterationNumber();
-    /** @brief Reset iteration number */
-    void resetIterationNumber();
     /** @brief Increment the counter */
     int incCounter();
     /** @brief Return the relation map. */
@@ -114,8 +121,6 @@ private:
     size_t numOfThreads;
     /** Profile counter */
     std::atomic<RamDomain> counter{0};
-    /** Loop iteration counter */
-    size_t iteration = 0;
     /** Profile for rule frequencies */
     std::map<std::string, std::deque<std::atomic<size_t>>> frequencies;
     /** Profile for relation reads */
@@ -130,6 +135,8 @@ private:
     NodeGenerator generator;
     /** Record Table*/
     RecordTable recordTable;
+    /** Checkpoint of the strata while executing main with --checkpoint-dir */
+    Checkpoint* checkpoint = nullptr;
 };
 
 }  // namespace souffle
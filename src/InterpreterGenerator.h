@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Global.h"
+#include "GroupTable.h"
 #include "InterpreterIndex.h"
 #include "InterpreterNode.h"
 #include "InterpreterPreamble.h"
@@ -28,6 +29,7 @@
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamRelation.h"
+#include "RamScheduleAnalysis.h"
 #include "RamStatement.h"
 #include "RamTypes.h"
 #include "RamUtils.h"
@@ -36,6 +38,7 @@
 #include "utility/MiscUtil.h"
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
@@ -55,9 +58,19 @@ class NodeGenerator : public RamVisitor<std::unique_ptr<InterpreterNode>> {
     using NodePtr = std::unique_ptr<InterpreterNode>;
     using NodePtrVec = std::vector<NodePtr>;
     using RelationHandle = std::unique_ptr<InterpreterRelation>;
+    using FunctorPreparer = std::function<std::shared_ptr<InterpreterFunctor>(const RamUserDefinedOperator&)>;
 
 public:
-    NodeGenerator(RamIndexAnalysis* isa) : isa(isa), isProvenance(Global::config().has("provenance")) {}
+    NodeGenerator(RamIndexAnalysis* isa, FunctorPreparer prepareFunctor = nullptr,
+            const RamScheduleAnalysis* schedule = nullptr)
+            : isa(isa), prepareFunctor(std::move(prepareFunctor)), schedule(schedule),
+              isProvenance(Global::config().has("provenance")),
+              strataWorkers(Global::config().has("parallel-strata") && !Global::config().has("profile") &&
+                                            !Global::config().has("live-profile") &&
+                                            !Global::config().has("checkpoint-dir")
+                                    ? std::stoi(Global::config().get("parallel-strata"))
+                                    : 1),
+              checkpointing(Global::config().has("checkpoint-dir") && !Global::config().has("incremental")) {}
 
     /**
      * @brief Generate the tree based on given entry.
@@ -110,7 +123,12 @@ public:
         for (const auto& arg : op.getArguments()) {
             children.push_back(visit(arg));
         }
-        return std::make_unique<InterpreterNode>(I_UserDefinedOperator, &op, std::move(children));
+        auto res = std::make_unique<InterpreterNode>(I_UserDefinedOperator, &op, std::move(children));
+        // Resolve the functor and prepare its call once, rather than on every evaluation
+        if (prepareFunctor) {
+            res->setFunctor(prepareFunctor(op));
+        }
+        return res;
     }
 
     NodePtr visitNestedIntrinsicOperator(const RamNestedIntrinsicOperator& op) override {
@@ -335,6 +353,19 @@ public:
         return std::make_unique<InterpreterNode>(I_Aggregate, &aggregate, std::move(children), rel);
     }
 
+    NodePtr visitParallelAggregate(const RamParallelAggregate& aggregate) override {
+        size_t relId = encodeRelation(aggregate.getRelation());
+        auto rel = relations[relId].get();
+        NodePtrVec children;
+        children.push_back(visit(aggregate.getCondition()));
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelAggregate, &aggregate, std::move(children), rel);
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
     NodePtr visitIndexAggregate(const RamIndexAggregate& aggregate) override {
         size_t relId = encodeRelation(aggregate.getRelation());
         auto rel = relations[relId].get();
@@ -354,6 +385,77 @@ public:
                 I_IndexAggregate, &aggregate, std::move(children), rel, std::move(data));
     }
 
+    NodePtr visitParallelIndexAggregate(const RamParallelIndexAggregate& aggregate) override {
+        size_t relId = encodeRelation(aggregate.getRelation());
+        auto rel = relations[relId].get();
+        NodePtrVec children;
+        for (const auto& value : aggregate.getRangePattern().first) {
+            children.push_back(visit(value));
+        }
+        for (const auto& value : aggregate.getRangePattern().second) {
+            children.push_back(visit(value));
+        }
+        children.push_back(visit(aggregate.getCondition()));
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        std::vector<size_t> data;
+        data.push_back((encodeIndexPos(aggregate)));
+        auto res = std::make_unique<InterpreterNode>(
+                I_ParallelIndexAggregate, &aggregate, std::move(children), rel, std::move(data));
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
+    NodePtr visitRangeAggregate(const RamRangeAggregate& aggregate) override {
+        size_t relId = encodeRelation(aggregate.getRelation());
+        auto rel = relations[relId].get();
+        NodePtrVec children;
+        for (const auto& value : aggregate.getRangePattern().first) {
+            children.push_back(visit(value));
+        }
+        for (const auto& value : aggregate.getRangePattern().second) {
+            children.push_back(visit(value));
+        }
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        std::vector<size_t> data;
+        data.push_back((encodeView(&aggregate)));
+        return std::make_unique<InterpreterNode>(
+                I_RangeAggregate, &aggregate, std::move(children), rel, std::move(data));
+    }
+
+    NodePtr visitGroupAggregate(const RamGroupAggregate& aggregate) override {
+        size_t relId = encodeRelation(aggregate.getRelation());
+        auto rel = relations[relId].get();
+        NodePtrVec children;
+        for (const auto& value : aggregate.getRangePattern().first) {
+            children.push_back(visit(value));
+        }
+        for (const auto& value : aggregate.getRangePattern().second) {
+            children.push_back(visit(value));
+        }
+        children.push_back(visit(aggregate.getCondition()));
+        children.push_back(visit(aggregate.getExpression()));
+        children.push_back(visitTupleOperation(aggregate));
+        std::vector<size_t> data;
+        data.push_back((encodeView(&aggregate)));
+        data.push_back((encodeIndexPos(aggregate)));
+        // the attributes grouping the relation
+        const auto& pattern = aggregate.getRangePattern().first;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (!isRamUndefValue(pattern[i])) {
+                data.push_back(i);
+            }
+        }
+        auto groups = std::make_shared<GroupTable>(aggregate.getFunction(), data.size() - 2);
+        parentQueryPreamble->addGroupTable(groups);
+        auto res = std::make_unique<InterpreterNode>(
+                I_GroupAggregate, &aggregate, std::move(children), rel, std::move(data));
+        res->setGroupTable(groups);
+        res->setPreamble(parentQueryPreamble);
+        return res;
+    }
+
     NodePtr visitBreak(const RamBreak& breakOp) override {
         NodePtrVec children;
         children.push_back(visit(breakOp.getCondition()));
@@ -392,16 +494,64 @@ public:
         for (const auto& value : seq.getStatements()) {
             children.push_back(visit(value));
         }
+        if ((strataWorkers > 1 || checkpointing) && schedule != nullptr && schedule->getStrata() == &seq) {
+            // The strata calls are scheduled on concurrent workers, or checkpointed one after the other.
+            // The data array holds the number of workers followed by the predecessor count and the
+            // predecessors of each call.
+            std::vector<size_t> data{strataWorkers};
+            for (const auto& preds : schedule->getPredecessors()) {
+                data.push_back(preds.size());
+                data.insert(data.end(), preds.begin(), preds.end());
+            }
+            return std::make_unique<InterpreterNode>(
+                    I_Schedule, &seq, std::move(children), nullptr, std::move(data));
+        }
         return std::make_unique<InterpreterNode>(I_Sequence, &seq, std::move(children));
     }
 
     NodePtr visitParallel(const RamParallel& parallel) override {
-        // Parallel statements are executed in sequence for now.
+        // Parallel statements are executed concurrently if they neither spawn parallel
+        // operations themselves nor exit a loop; otherwise they are executed in sequence.
         NodePtrVec children;
         for (const auto& value : parallel.getStatements()) {
             children.push_back(visit(value));
         }
-        return std::make_unique<InterpreterNode>(I_Parallel, &parallel, std::move(children));
+        bool concurrent = children.size() > 1;
+        visitDepthFirst(parallel, [&](const RamAbstractParallel&) { concurrent = false; });
+        visitDepthFirst(parallel, [&](const RamExit&) { concurrent = false; });
+        return std::make_unique<InterpreterNode>(I_Parallel, &parallel, std::move(children), nullptr,
+                std::vector<size_t>{concurrent ? 1u : 0u});
+    }
+
+    NodePtr visitAdaptiveQuery(const RamAdaptiveQuery& adaptive) override {
+        // The data array holds the loop count of each alternative followed by the scanned relation
+        // and the number of bound attributes of each loop, from the outermost loop inwards.
+        NodePtrVec children;
+        std::vector<size_t> data;
+        for (const auto& alternative : adaptive.getStatements()) {
+            children.push_back(visit(alternative));
+            std::vector<size_t> loops;
+            visitDepthFirst(*alternative, [&](const RamRelationOperation& loop) {
+                if (dynamic_cast<const RamAbstractAggregate*>(&loop) != nullptr) {
+                    return;
+                }
+                size_t bound = 0;
+                if (const auto* indexLoop = dynamic_cast<const RamIndexOperation*>(&loop)) {
+                    const auto pattern = indexLoop->getRangePattern();
+                    for (size_t i = 0; i < pattern.first.size(); ++i) {
+                        if (!isRamUndefValue(pattern.first[i]) && !isRamUndefValue(pattern.second[i])) {
+                            ++bound;
+                        }
+                    }
+                }
+                loops.push_back(encodeRelation(loop.getRelation()));
+                loops.push_back(bound);
+            });
+            data.push_back(loops.size() / 2);
+            data.insert(data.end(), loops.begin(), loops.end());
+        }
+        return std::make_unique<InterpreterNode>(
+                I_AdaptiveQuery, &adaptive, std::move(children), nullptr, std::move(data));
     }
 
     NodePtr visitLoop(const RamLoop& loop) override {
@@ -461,6 +611,12 @@ public:
         return std::make_unique<InterpreterNode>(I_LogSize, &size, NodePtrVec{}, rel);
     }
 
+    NodePtr visitLogStatistics(const RamLogStatistics& statistics) override {
+        size_t relId = encodeRelation(statistics.getRelation());
+        auto rel = relations[relId].get();
+        return std::make_unique<InterpreterNode>(I_LogStatistics, &statistics, NodePtrVec{}, rel);
+    }
+
     NodePtr visitIO(const RamIO& io) override {
         size_t relId = encodeRelation(io.getRelation());
         auto rel = relations[relId].get();
@@ -468,6 +624,16 @@ public:
     }
 
     NodePtr visitQuery(const RamQuery& query) override {
+        // queries copying a whole relation are merged in bulk; provenance
+        // relations are excluded as a merge does not apply the updater
+        const auto copied = getCopiedRelations(query);
+        if (copied.first != nullptr && !isProvenance) {
+            std::vector<size_t> data;
+            data.push_back(encodeRelation(*copied.first));
+            data.push_back(encodeRelation(*copied.second));
+            return std::make_unique<InterpreterNode>(I_Merge, &query, NodePtrVec{}, nullptr, std::move(data));
+        }
+
         std::shared_ptr<InterpreterPreamble> preamble = std::make_shared<InterpreterPreamble>();
         parentQueryPreamble = preamble;
         // split terms of conditions of outer-most filter operation
@@ -506,7 +672,13 @@ public:
             };
         });
 
-        visitDepthFirst(*next, [&](const RamAbstractParallel&) { preamble->isParallel = true; });
+        // parallel aggregates run their nested operation once on the thread of the query
+        visitDepthFirst(*next, [&](const RamNode& node) {
+            if (dynamic_cast<const RamAbstractParallel*>(&node) != nullptr &&
+                    dynamic_cast<const RamAbstractAggregate*>(&node) == nullptr) {
+                preamble->isParallel = true;
+            }
+        });
 
         NodePtrVec children;
         children.push_back(visit(*next));
@@ -554,6 +726,10 @@ private:
     std::unordered_map<const RamNode*, size_t> indexTable;
     /** Used by index encoding */
     RamIndexAnalysis* isa;
+    /** Resolves user-defined operators and prepares their calls */
+    FunctorPreparer prepareFunctor;
+    /** Dependencies among the strata of the main program */
+    const RamScheduleAnalysis* schedule;
     /** Points to the current preamble during the generation.  It is used to passing preamble between parent
      * query and its nested parallel operation. */
     std::shared_ptr<InterpreterPreamble> parentQueryPreamble = nullptr;
@@ -569,6 +745,10 @@ private:
     std::vector<std::unique_ptr<RelationHandle>> relations;
     /** If generating a provenance program */
     const bool isProvenance;
+    /** Maximal number of strata evaluated concurrently */
+    const size_t strataWorkers;
+    /** Whether checkpoints are written after the strata */
+    const bool checkpointing;
     /** RamProgram */
     RamProgram* program;
 
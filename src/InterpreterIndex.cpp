@@ -22,9 +22,11 @@
 #include "PiggyList.h"
 #include "utility/ContainerUtil.h"
 #include "utility/MiscUtil.h"
+#include "utility/ParallelUtil.h"
 #include "utility/StreamUtil.h"
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <ostream>
 
 namespace souffle {
@@ -87,6 +89,32 @@ std::ostream& operator<<(std::ostream& out, const Order& order) {
     return out << "[" << join(order.order) << "]";
 }
 
+std::size_t IndexView::count(const TupleRef& low, const TupleRef& high) const {
+    std::size_t res = 0;
+    for (const auto& cur : range(low, high)) {
+        static_cast<void>(cur);
+        ++res;
+    }
+    return res;
+}
+
+bool IndexView::first(const TupleRef& low, const TupleRef& high, RamDomain* out) const {
+    for (const auto& cur : range(low, high)) {
+        std::copy(cur.getBase(), cur.getBase() + cur.size(), out);
+        return true;
+    }
+    return false;
+}
+
+bool IndexView::last(const TupleRef& low, const TupleRef& high, RamDomain* out) const {
+    bool found = false;
+    for (const auto& cur : range(low, high)) {
+        std::copy(cur.getBase(), cur.getBase() + cur.size(), out);
+        found = true;
+    }
+    return found;
+}
+
 /**
  * An index wrapper for nullary indexes. For those, no complex
  * nested data structure is required.
@@ -567,6 +595,346 @@ private:
     size_t arity;
 };
 
+/**
+ * An append-only store for tuples of a construction-time arity. Tuples are
+ * kept inline in fixed-stride blocks of doubling size; hence, their addresses
+ * remain stable until the store is cleared.
+ */
+class DynTupleStore {
+    /** number of tuples in the first block (as a power of two) */
+    static constexpr size_t BLOCK_BITS = 10;
+
+    /** maximal number of blocks; block i holds 2^(BLOCK_BITS + i) tuples */
+    static constexpr size_t MAX_BLOCKS = 64 - BLOCK_BITS;
+
+    /** arity of the stored tuples */
+    const size_t arity;
+
+    /** blocks holding the tuples */
+    std::array<std::atomic<RamDomain*>, MAX_BLOCKS> blocks{};
+
+    /** serialises the allocation of blocks and the access to the recycled slots */
+    SpinLock blockLock;
+
+    /** next free slot */
+    std::atomic<size_t> next{0};
+
+    /** slots handed back to the store, to be filled again before new slots are taken */
+    std::vector<RamDomain*> recycled;
+
+    /** number of recycled slots */
+    std::atomic<size_t> numRecycled{0};
+
+public:
+    explicit DynTupleStore(size_t arity) : arity(arity) {}
+
+    DynTupleStore(const DynTupleStore&) = delete;
+    DynTupleStore& operator=(const DynTupleStore&) = delete;
+
+    ~DynTupleStore() {
+        clear();
+    }
+
+    /** copies the given tuple into the store and returns its stable address */
+    const RamDomain* add(const RamDomain* tuple) {
+        if (numRecycled.load(std::memory_order_acquire) > 0) {
+            RamDomain* res = nullptr;
+            blockLock.lock();
+            if (!recycled.empty()) {
+                res = recycled.back();
+                recycled.pop_back();
+                numRecycled.store(recycled.size(), std::memory_order_release);
+            }
+            blockLock.unlock();
+            if (res != nullptr) {
+                std::memcpy(res, tuple, arity * sizeof(RamDomain));
+                return res;
+            }
+        }
+
+        const size_t n = next.fetch_add(1, std::memory_order_relaxed) + (size_t(1) << BLOCK_BITS);
+        const size_t msb = 63 - __builtin_clzll(n);
+        std::atomic<RamDomain*>& block = blocks[msb - BLOCK_BITS];
+
+        // allocate the block if not present
+        if (block.load(std::memory_order_acquire) == nullptr) {
+            blockLock.lock();
+            if (block.load(std::memory_order_relaxed) == nullptr) {
+                block.store(new RamDomain[(size_t(1) << msb) * arity], std::memory_order_release);
+            }
+            blockLock.unlock();
+        }
+
+        RamDomain* res = block.load(std::memory_order_acquire) + (n & ((size_t(1) << msb) - 1)) * arity;
+        std::memcpy(res, tuple, arity * sizeof(RamDomain));
+        return res;
+    }
+
+    /** hands back the slot of a tuple that is not referenced, such that it is filled again */
+    void recycle(const RamDomain* tuple) {
+        blockLock.lock();
+        recycled.push_back(const_cast<RamDomain*>(tuple));
+        numRecycled.store(recycled.size(), std::memory_order_release);
+        blockLock.unlock();
+    }
+
+    /** releases all tuples; not thread safe */
+    void clear() {
+        for (auto& block : blocks) {
+            delete[] block.exchange(nullptr);
+        }
+        next = 0;
+        recycled.clear();
+        numRecycled = 0;
+    }
+};
+
+/**
+ * A B-tree index for arities not covered by the templated indexes. The tuples
+ * are stored inline in a DynTupleStore, encoded in the order of the index, such
+ * that the comparator of the B-tree is a plain lexicographical comparison
+ * rather than a per-component indirection through the order.
+ */
+class DynBTreeIndex : public InterpreterIndex {
+    /* lexicographical comparison of two encoded tuples */
+    struct comparator {
+        size_t arity;
+
+        comparator(size_t arity = 0) : arity(arity) {}
+
+        int operator()(const RamDomain* x, const RamDomain* y) const {
+            for (size_t i = 0; i < arity; ++i) {
+                if (x[i] < y[i]) {
+                    return -1;
+                }
+                if (x[i] > y[i]) {
+                    return 1;
+                }
+            }
+            return 0;
+        }
+
+        bool less(const RamDomain* x, const RamDomain* y) const {
+            return operator()(x, y) < 0;
+        }
+
+        bool equal(const RamDomain* x, const RamDomain* y) const {
+            return std::memcmp(x, y, arity * sizeof(RamDomain)) == 0;
+        }
+    };
+
+    // the B-tree keeps the sizes of its sub-trees for counting ranges
+    using index_set = btree_set<const RamDomain*, comparator, std::allocator<const RamDomain*>, 256,
+            typename detail::default_strategy<const RamDomain*>::type, comparator,
+            detail::updater<const RamDomain*>, true>;
+    using Hints = typename index_set::operation_hints;
+    using iter = typename index_set::iterator;
+
+    // the order to be simulated
+    Order order;
+
+    // the storage of the encoded tuples
+    DynTupleStore store;
+
+    // the B-tree referencing the tuples of the store
+    index_set set;
+
+    // a source adapter for streaming through data
+    class Source : public Stream::Source {
+        const Order& order;
+
+        // the begin and end of the stream
+        iter cur;
+        iter end;
+
+        // an internal buffer for decoded elements
+        std::vector<RamDomain> buffer;
+
+    public:
+        Source(const Order& order, iter begin, iter end)
+                : order(order), cur(std::move(begin)), end(std::move(end)),
+                  buffer(Stream::BUFFER_SIZE * order.size()) {}
+
+        int load(TupleRef* out, int max) override {
+            const size_t arity = order.size();
+            int c = 0;
+            while (cur != end && c < max) {
+                order.decode(*cur, &buffer[c * arity]);
+                out[c] = TupleRef(&buffer[c * arity], arity);
+                ++cur;
+                ++c;
+            }
+            return c;
+        }
+
+        int reload(TupleRef* out, int max) override {
+            const size_t arity = order.size();
+            int c = 0;
+            max = std::min(max, Stream::BUFFER_SIZE);
+            while (c < max) {
+                out[c] = TupleRef(&buffer[c * arity], arity);
+                ++c;
+            }
+            return c;
+        }
+
+        std::unique_ptr<Stream::Source> clone() override {
+            auto source = std::make_unique<Source>(order, cur, end);
+            source->buffer = this->buffer;
+            return source;
+        }
+    };
+
+    // The index view associated to this view type.
+    struct DynBTreeIndexView : public IndexView {
+        const DynBTreeIndex& index;
+        mutable Hints hints;
+
+        // buffers for encoding the probed tuples
+        mutable DynTuple a;
+        mutable DynTuple b;
+
+        DynBTreeIndexView(const DynBTreeIndex& index)
+                : index(index), a(index.getArity()), b(index.getArity()) {}
+
+        bool contains(const TupleRef& tuple) const override {
+            index.order.encode(tuple.getBase(), &a[0]);
+            return index.set.contains(&a[0], hints);
+        }
+
+        bool contains(const TupleRef& low, const TupleRef& high) const override {
+            return !bounds(low, high).empty();
+        }
+
+        Stream range(const TupleRef& low, const TupleRef& high) const override {
+            auto range = bounds(low, high);
+            return std::make_unique<Source>(index.order, range.begin(), range.end());
+        }
+
+        std::size_t count(const TupleRef& low, const TupleRef& high) const override {
+            index.order.encode(low.getBase(), &a[0]);
+            index.order.encode(high.getBase(), &b[0]);
+            return index.set.count(&a[0], &b[0]);
+        }
+
+        bool first(const TupleRef& low, const TupleRef& high, RamDomain* out) const override {
+            auto range = bounds(low, high);
+            if (range.empty()) {
+                return false;
+            }
+            index.order.decode(*range.begin(), out);
+            return true;
+        }
+
+        bool last(const TupleRef& low, const TupleRef& high, RamDomain* out) const override {
+            index.order.encode(low.getBase(), &a[0]);
+            index.order.encode(high.getBase(), &b[0]);
+            std::size_t n = index.set.count(&a[0], &b[0]);
+            if (n == 0) {
+                return false;
+            }
+            index.order.decode(*index.set.select(index.set.rank(&a[0]) + n - 1), out);
+            return true;
+        }
+
+        size_t getArity() const override {
+            return index.getArity();
+        }
+
+        souffle::range<iter> bounds(const TupleRef& low, const TupleRef& high) const {
+            index.order.encode(low.getBase(), &a[0]);
+            index.order.encode(high.getBase(), &b[0]);
+            return {index.set.lower_bound(&a[0], hints), index.set.upper_bound(&b[0], hints)};
+        }
+    };
+
+public:
+    DynBTreeIndex(Order order)
+            : order(std::move(order)), store(this->order.size()),
+              set(comparator(this->order.size()), comparator(this->order.size())) {}
+
+    IndexViewPtr createView() const override {
+        return std::make_unique<DynBTreeIndexView>(*this);
+    }
+
+    size_t getArity() const override {
+        return order.size();
+    }
+
+    bool empty() const override {
+        return set.empty();
+    }
+
+    std::size_t size() const override {
+        return set.size();
+    }
+
+    bool insert(const TupleRef& tuple) override {
+        // encode into a buffer of the thread; only new tuples are copied into the store
+        static thread_local std::vector<RamDomain> entry;
+        entry.resize(getArity());
+        order.encode(tuple.getBase(), entry.data());
+        if (set.contains(entry.data())) {
+            return false;
+        }
+        const RamDomain* stored = store.add(entry.data());
+        if (set.insert(stored)) {
+            return true;
+        }
+        // a concurrent insertion of the same tuple won => the copy is not referenced
+        store.recycle(stored);
+        return false;
+    }
+
+    void insert(const InterpreterIndex& src) override {
+        for (const auto& cur : src.scan()) {
+            insert(cur);
+        }
+    }
+
+    bool contains(const TupleRef& tuple) const override {
+        return DynBTreeIndexView(*this).contains(tuple);
+    }
+
+    bool contains(const TupleRef& low, const TupleRef& high) const override {
+        return DynBTreeIndexView(*this).contains(low, high);
+    }
+
+    Stream scan() const override {
+        return std::make_unique<Source>(order, set.begin(), set.end());
+    }
+
+    PartitionedStream partitionScan(int partitionCount) const override {
+        auto chunks = set.partition(partitionCount);
+        std::vector<Stream> res;
+        res.reserve(chunks.size());
+        for (const auto& cur : chunks) {
+            res.push_back(std::make_unique<Source>(order, cur.begin(), cur.end()));
+        }
+        return res;
+    }
+
+    Stream range(const TupleRef& low, const TupleRef& high) const override {
+        return DynBTreeIndexView(*this).range(low, high);
+    }
+
+    PartitionedStream partitionRange(
+            const TupleRef& low, const TupleRef& high, int partitionCount) const override {
+        auto range = DynBTreeIndexView(*this).bounds(low, high);
+        std::vector<Stream> res;
+        res.reserve(partitionCount);
+        for (const auto& cur : range.partition(partitionCount)) {
+            res.push_back(std::make_unique<Source>(order, cur.begin(), cur.end()));
+        }
+        return res;
+    }
+
+    void clear() override {
+        set.clear();
+        store.clear();
+    }
+};
+
 // The comparator to be used for B-tree nodes.
 template <std::size_t Arity>
 using comparator = typename index_utils::get_full_index<Arity>::type::comparator;
@@ -584,13 +952,98 @@ struct InterpreterProvenanceUpdater {
     }
 };
 
+// B-tree keeping the sizes of its sub-trees for counting ranges
+template <std::size_t Arity>
+using t_counted_btree = btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>, 256,
+        typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity>,
+        detail::updater<t_tuple<Arity>>, true>;
+
 /**
  * A index adapter for B-trees, using the generic index adapter.
  */
 template <std::size_t Arity>
-class BTreeIndex : public GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>> {
+class BTreeIndex : public GenericIndex<t_counted_btree<Arity>> {
+    using Base = GenericIndex<t_counted_btree<Arity>>;
+    using Entry = typename Base::Entry;
+
+    // The index view answering counts and boundaries of ranges without enumerating them.
+    struct BTreeIndexView : public Base::GenericIndexView {
+        const BTreeIndex& index;
+
+        BTreeIndexView(const BTreeIndex& index) : Base::GenericIndexView(index), index(index) {}
+
+        std::size_t count(const TupleRef& low, const TupleRef& high) const override {
+            return index.data.count(
+                    index.order.encode(low.asTuple<Arity>()), index.order.encode(high.asTuple<Arity>()));
+        }
+
+        bool first(const TupleRef& low, const TupleRef& high, RamDomain* out) const override {
+            auto range = index.bounds(low, high, this->hints);
+            if (range.empty()) {
+                return false;
+            }
+            index.order.decode(&(*range.begin())[0], out);
+            return true;
+        }
+
+        bool last(const TupleRef& low, const TupleRef& high, RamDomain* out) const override {
+            Entry a = index.order.encode(low.asTuple<Arity>());
+            Entry b = index.order.encode(high.asTuple<Arity>());
+            std::size_t n = index.data.count(a, b);
+            if (n == 0) {
+                return false;
+            }
+            index.order.decode(&(*index.data.select(index.data.rank(a) + n - 1))[0], out);
+            return true;
+        }
+    };
+
 public:
-    using GenericIndex<btree_set<t_tuple<Arity>, comparator<Arity>>>::GenericIndex;
+    using Base::Base;
+    using Base::insert;
+
+    IndexViewPtr createView() const override {
+        return std::make_unique<BTreeIndexView>(*this);
+    }
+
+    bool canMerge(const InterpreterIndex& src) const override {
+        auto other = dynamic_cast<const BTreeIndex*>(&src);
+        return other != nullptr && other->order == this->order;
+    }
+
+    void insert(const InterpreterIndex& src) override {
+        if (!canMerge(src)) {
+            Base::insert(src);
+            return;
+        }
+        // both trees are sorted alike => merge them instead of inserting tuple by tuple
+        this->data.insertAll(static_cast<const BTreeIndex&>(src).data);
+    }
+
+    void insertSorted(const RamDomain* tuples, std::size_t count) override {
+        const auto* begin = reinterpret_cast<const t_tuple<Arity>*>(tuples);
+        const auto* end = begin + count;
+
+        // for small insertions the hinted insertion of the sorted elements is cheaper
+        if (count * this->data.merge_ratio < this->data.size()) {
+            typename Base::Hints hints;
+            for (auto cur = begin; cur != end; ++cur) {
+                this->data.insert(this->order.encode(*cur), hints);
+            }
+            return;
+        }
+
+        // re-order the tuples for this index and build it bottom-up
+        std::vector<Entry> entries;
+        entries.reserve(count);
+        for (auto cur = begin; cur != end; ++cur) {
+            entries.push_back(this->order.encode(*cur));
+        }
+        if (this->order != Order::create(Arity)) {
+            std::sort(entries.begin(), entries.end());
+        }
+        this->data.insertSorted(entries.begin(), entries.end());
+    }
 };
 
 /**
@@ -622,6 +1075,16 @@ public:
 class EqrelIndex : public GenericIndex<EquivalenceRelation<t_tuple<2>>> {
 public:
     using GenericIndex<EquivalenceRelation<t_tuple<2>>>::GenericIndex;
+    using GenericIndex<EquivalenceRelation<t_tuple<2>>>::insert;
+
+    bool canMerge(const InterpreterIndex& src) const override {
+        return dynamic_cast<const EqrelIndex*>(&src) != nullptr;
+    }
+
+    void insert(const InterpreterIndex& src) override {
+        // unite the sets of both relations instead of inserting all pairs
+        this->data.insertAll(static_cast<const EqrelIndex&>(src).data);
+    }
 
     void extend(InterpreterIndex* other) override {
         auto otherIndex = dynamic_cast<EqrelIndex*>(other);
@@ -647,7 +1110,7 @@ std::unique_ptr<InterpreterIndex> createBTreeIndex(const Order& order) {
         case 12: return std::make_unique<BTreeIndex<12>>(order);
     }
 
-    fatal("Requested arity not yet supported. Feel free to add it.");
+    return std::make_unique<DynBTreeIndex>(order);
 }
 
 std::unique_ptr<InterpreterIndex> createBTreeProvenanceIndex(const Order& order) {
@@ -705,7 +1168,8 @@ std::unique_ptr<InterpreterIndex> createBrieIndex(const Order& order) {
         case 12: return std::make_unique<BrieIndex<12>>(order);
     }
 
-    fatal("Requested arity not yet supported. Feel free to add it.");
+    // wide relations are stored in a B-tree instead
+    return std::make_unique<DynBTreeIndex>(order);
 }
 
 std::unique_ptr<InterpreterIndex> createIndirectIndex(const Order& order) {
@@ -167,6 +167,24 @@ public:
         return res;
     }
 
+    /**
+     * Encodes a tuple of the arity of this order into the given target.
+     */
+    void encode(const RamDomain* entry, RamDomain* res) const {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            res[i] = entry[order[i]];
+        }
+    }
+
+    /**
+     * Decodes a tuple of the arity of this order into the given target.
+     */
+    void decode(const RamDomain* entry, RamDomain* res) const {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            res[order[i]] = entry[i];
+        }
+    }
+
     const AttributeOrder& getOrder() const {
         return this->order;
     }
@@ -263,7 +281,9 @@ public:
         if (source == nullptr) {
             return std::make_unique<Stream>();
         }
-        auto newStream = std::make_unique<Stream>(source->clone());
+        // the clone must not load the next chunk of the source, but take over the current one
+        auto newStream = std::make_unique<Stream>();
+        newStream->source = source->clone();
         newStream->source->reload(&newStream->buffer[0], limit);
         newStream->cur = cur;
         newStream->limit = limit;
@@ -352,6 +372,16 @@ public:
     iterator end() {
         return streams.end();
     }
+
+    // -- allow PartitionStreams to be processed by index, e.g. by a WorkStealingLoop --
+
+    std::size_t size() const {
+        return streams.size();
+    }
+
+    Stream& operator[](std::size_t i) {
+        return streams[i];
+    }
 };
 
 /**
@@ -376,6 +406,25 @@ public:
      */
     virtual Stream range(const TupleRef& low, const TupleRef& high) const = 0;
 
+    /**
+     * Counts the elements in the given range within this index.
+     * The default implementation enumerates the range.
+     */
+    virtual std::size_t count(const TupleRef& low, const TupleRef& high) const;
+
+    /**
+     * Copies the first element of the given range in the order of this index
+     * to the given target. Returns false if the range is empty.
+     */
+    virtual bool first(const TupleRef& low, const TupleRef& high, RamDomain* out) const;
+
+    /**
+     * Copies the last element of the given range in the order of this index
+     * to the given target. Returns false if the range is empty.
+     * The default implementation enumerates the range.
+     */
+    virtual bool last(const TupleRef& low, const TupleRef& high, RamDomain* out) const;
+
     /**
      * Return arity size of the index
      */
@@ -424,6 +473,25 @@ public:
      */
     virtual void insert(const InterpreterIndex& src) = 0;
 
+    /**
+     * Inserts the given number of consecutive tuples of the arity of this index,
+     * enumerated in lexicographical order; indexes may build themselves in bulk.
+     */
+    virtual void insertSorted(const RamDomain* tuples, std::size_t count) {
+        const std::size_t arity = getArity();
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(TupleRef(tuples + i * arity, arity));
+        }
+    }
+
+    /**
+     * Tests whether the given index stores its elements in the same data structure
+     * and order as this index, such that insert(src) can merge them in bulk.
+     */
+    virtual bool canMerge(const InterpreterIndex&) const {
+        return false;
+    }
+
     /**
      * Tests whether the given tuple is present in this index or not.
      */
@@ -30,6 +30,8 @@
 #include <vector>
 
 namespace souffle {
+class GroupTable;
+class InterpreterFunctor;
 class InterpreterPreamble;
 class InterpreterRelation;
 class RamNode;
@@ -62,13 +64,19 @@ enum InterpreterNodeType {
     I_ParallelIndexChoice,
     I_UnpackRecord,
     I_Aggregate,
+    I_ParallelAggregate,
     I_IndexAggregate,
+    I_ParallelIndexAggregate,
+    I_RangeAggregate,
+    I_GroupAggregate,
     I_Break,
     I_Filter,
     I_Project,
     I_SubroutineReturn,
     I_Sequence,
+    I_Schedule,
     I_Parallel,
+    I_AdaptiveQuery,
     I_Loop,
     I_Exit,
     I_LogRelationTimer,
@@ -76,9 +84,11 @@ enum InterpreterNodeType {
     I_DebugInfo,
     I_Clear,
     I_LogSize,
+    I_LogStatistics,
     I_IO,
     I_Query,
     I_Extend,
+    I_Merge,
     I_Swap,
     I_Call
 };
@@ -130,6 +140,26 @@ public:
         preamble = p;
     }
 
+    /** @brief get prepared call of a user-defined operator */
+    inline InterpreterFunctor* getFunctor() const {
+        return functor.get();
+    }
+
+    /** @brief set prepared call of a user-defined operator */
+    inline void setFunctor(const std::shared_ptr<InterpreterFunctor>& f) {
+        functor = f;
+    }
+
+    /** @brief get groups of a group aggregate */
+    inline GroupTable* getGroupTable() const {
+        return groups.get();
+    }
+
+    /** @brief set groups of a group aggregate */
+    inline void setGroupTable(const std::shared_ptr<GroupTable>& g) {
+        groups = g;
+    }
+
     /** @brief get list of all children */
     const std::vector<std::unique_ptr<InterpreterNode>>& getChildren() const {
         return children;
@@ -148,5 +178,7 @@ protected:
     RelationHandle* const relHandle;
     std::vector<size_t> data;
     std::shared_ptr<InterpreterPreamble> preamble = nullptr;
+    std::shared_ptr<InterpreterFunctor> functor = nullptr;
+    std::shared_ptr<GroupTable> groups = nullptr;
 };
 }  // namespace souffle
@@ -23,6 +23,7 @@
 
 namespace souffle {
 
+class GroupTable;
 class InterpreterNode;
 
 /**
@@ -81,6 +82,16 @@ public:
         viewInfoForNested.push_back({relId, indexPos, viewPos});
     }
 
+    /** @brief Add the groups of a group aggregate, which are dropped after each execution. */
+    void addGroupTable(std::shared_ptr<GroupTable> groups) {
+        groupTables.push_back(std::move(groups));
+    }
+
+    /** @brief Return the groups of group aggregates */
+    const std::vector<std::shared_ptr<GroupTable>>& getGroupTables() {
+        return groupTables;
+    }
+
     /** If this preamble contains parallel operation.  */
     bool isParallel = false;
 
@@ -95,6 +106,8 @@ private:
     std::vector<std::array<size_t, 3>> viewInfoForFilter;
     /** Vector of View information in nested operations */
     std::vector<std::array<size_t, 3>> viewInfoForNested;
+    /** Vector of groups of group aggregates */
+    std::vector<std::shared_ptr<GroupTable>> groupTables;
 };
 
 }  // namespace souffle
@@ -28,6 +28,7 @@
 #include "RamVisitor.h"
 #include "SouffleInterface.h"
 #include "SymbolTable.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -74,6 +75,45 @@ public:
                 new InterpreterRelInterface::iterator_base(id, this, relation.end()));
     }
 
+    /** Range of tuples whose bound elements lie between the given bounds */
+    std::pair<iterator, iterator> lowerUpperBound(const std::vector<RamDomain>& low,
+            const std::vector<RamDomain>& high, const std::vector<bool>& bound) const override {
+        assert(low.size() == getArity() && high.size() == getArity() && bound.size() == getArity() &&
+                "query does not match the arity of the relation");
+        InterpreterRelation::AttributeSet attributes;
+        for (size_t i = 0; i < getArity(); i++) {
+            if (bound[i]) {
+                attributes.insert(i);
+            }
+        }
+        size_t indexPos;
+        if (!relation.findIndex(attributes, indexPos)) {
+            return Relation::lowerUpperBound(low, high, bound);
+        }
+
+        // bound the unconstrained elements by the smallest and largest values
+        std::vector<RamDomain> lower(getArity(), MIN_RAM_SIGNED);
+        std::vector<RamDomain> upper(getArity(), MAX_RAM_SIGNED);
+        for (size_t i = 0; i < getArity(); i++) {
+            if (bound[i]) {
+                lower[i] = low[i];
+                upper[i] = high[i];
+            }
+        }
+        Stream stream = relation.range(
+                indexPos, TupleRef(lower.data(), getArity()), TupleRef(upper.data(), getArity()));
+        std::pair<iterator, iterator> res{
+                iterator(new InterpreterRelInterface::iterator_base(id, this, std::move(stream))), end()};
+
+        // the index range covers all tuples between the bounds in the order of the index, which
+        // coincides with the query if the bound elements are bound to single values
+        if (isEqualityQuery(low, high, bound)) {
+            return res;
+        }
+        return {iterator(new bound_filter(std::move(res.first), res.second, low, high, bound)),
+                iterator(new bound_filter(res.second, res.second, {}, {}, {}))};
+    }
+
     /** Get name */
     std::string getName() const override {
         return name;
@@ -133,35 +173,34 @@ protected:
 
         /** Get current tuple */
         tuple& operator*() override {
-            // set tuple stream to first element
-            tup.rewind();
-
-            // construct the tuple to return
+            // elements are stored in their internal representation, hence copied as they are
+            const RamDomain* elements = *it;
             for (size_t i = 0; i < ramRelationInterface->getArity(); i++) {
-                switch (*(ramRelationInterface->getAttrType(i))) {
-                    case 's': {
-                        std::string s = ramRelationInterface->getSymbolTable().resolve((*it)[i]);
-                        tup << s;
-                        break;
-                    }
-                    case 'f': {
-                        tup << ramBitCast<RamFloat>((*it)[i]);
-                        break;
-                    }
-                    case 'u': {
-                        tup << ramBitCast<RamUnsigned>((*it)[i]);
-                        break;
-                    }
-                    default: {
-                        tup << (*it)[i];
-                        break;
-                    }
-                }
+                tup[i] = elements[i];
             }
             tup.rewind();
             return tup;
         }
 
+        /** Get elements of current tuple */
+        const RamDomain* data() override {
+            return *it;
+        }
+
+        /** Copy the elements of consecutive tuples */
+        size_t read(RamDomain* buffer, size_t maxTuples, size_t arity,
+                const Relation::iterator_base& end) override {
+            const auto* last = dynamic_cast<const InterpreterRelInterface::iterator_base*>(&end);
+            if (last == nullptr) {
+                return Relation::iterator_base::read(buffer, maxTuples, arity, end);
+            }
+            size_t n = 0;
+            for (; n < maxTuples && it != last->it; ++n, ++it) {
+                std::copy_n(*it, arity, buffer + n * arity);
+            }
+            return n;
+        }
+
         /** Clone iterator */
         iterator_base* clone() const override {
             return new InterpreterRelInterface::iterator_base(getId(), ramRelationInterface, it);
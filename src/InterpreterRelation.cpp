@@ -36,7 +36,8 @@ InterpreterRelation::InterpreterRelation(std::size_t arity, std::size_t auxiliar
                 order.push_back(i);
             }
         }
-        indexes.push_back(factory(Order(order)));
+        orders.emplace_back(order);
+        indexes.push_back(factory(orders.back()));
     }
 
     // Use the first index as default main index
@@ -67,10 +68,47 @@ bool InterpreterRelation::insert(const TupleRef& tuple) {
     return true;
 }
 
+void InterpreterRelation::insertSorted(const RamDomain* tuples, std::size_t count) {
+    for (const auto& cur : indexes) {
+        if (cur != nullptr) {
+            cur->insertSorted(tuples, count);
+        }
+    }
+}
+
 void InterpreterRelation::insert(const InterpreterRelation& other) {
-    // TODO: cover this in a smarter way
-    for (const auto& cur : other.scan()) {
-        insert(cur);
+    // find for each index a counterpart in the other relation it can be merged with
+    std::vector<const InterpreterIndex*> sources;
+    const InterpreterIndex* mainSource = nullptr;
+    for (const auto& cur : indexes) {
+        const InterpreterIndex* src = nullptr;
+        if (cur != nullptr) {
+            for (const auto& candidate : other.indexes) {
+                if (candidate != nullptr && cur->canMerge(*candidate)) {
+                    src = candidate.get();
+                    break;
+                }
+            }
+        }
+        if (cur.get() == main) {
+            mainSource = src;
+        }
+        sources.push_back(src);
+    }
+
+    // fall back to inserting tuple by tuple if the main index can not be merged
+    if (mainSource == nullptr) {
+        for (const auto& cur : other.scan()) {
+            insert(cur);
+        }
+        return;
+    }
+
+    // merge index by index; indexes without counterpart are filled from the main index of other
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] != nullptr) {
+            indexes[i]->insert(sources[i] != nullptr ? *sources[i] : *other.main);
+        }
     }
 }
 
@@ -90,6 +128,22 @@ PartitionedStream InterpreterRelation::partitionScan(size_t partitionCount) cons
     return main->partitionScan(partitionCount);
 }
 
+bool InterpreterRelation::findIndex(const AttributeSet& attributes, size_t& indexPos) const {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i] == nullptr) {
+            continue;
+        }
+        const auto& order = orders[i].getOrder();
+        if (order.size() >= attributes.size() &&
+                std::all_of(order.begin(), order.begin() + attributes.size(),
+                        [&](Attribute attribute) { return attributes.count(attribute) > 0; })) {
+            indexPos = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 Stream InterpreterRelation::range(const size_t& indexPos, const TupleRef& low, const TupleRef& high) const {
     auto& pos = indexes[indexPos];
     return pos->range(low, high);
@@ -103,6 +157,7 @@ PartitionedStream InterpreterRelation::partitionRange(
 
 void InterpreterRelation::swap(InterpreterRelation& other) {
     indexes.swap(other.indexes);
+    orders.swap(other.orders);
 }
 
 size_t InterpreterRelation::getLevel() const {
@@ -191,6 +246,13 @@ bool InterpreterIndirectRelation::insert(const RamDomain* tuple) {
     return this->insert(TupleRef(tuple, arity));
 }
 
+void InterpreterIndirectRelation::insertSorted(const RamDomain* tuples, std::size_t count) {
+    // the indexes refer to the blocks of this relation => insert tuple by tuple
+    for (std::size_t i = 0; i < count; ++i) {
+        insert(TupleRef(tuples + i * arity, arity));
+    }
+}
+
 void InterpreterIndirectRelation::purge() {
     blockList.clear();
     for (auto& cur : indexes) {
@@ -59,6 +59,8 @@ public:
 
         Iterator(const InterpreterRelation& rel) : stream(std::make_unique<Stream>(rel.scan())) {}
 
+        Iterator(Stream stream) : stream(std::make_unique<Stream>(std::move(stream))) {}
+
         Iterator(const Iterator& iter) : stream(iter.stream->clone()) {}
 
         Iterator(Iterator&& iter) : stream(std::move(iter.stream)) {}
@@ -117,6 +119,12 @@ public:
      */
     void insert(const InterpreterRelation& other);
 
+    /**
+     * Add the given number of consecutive tuples, enumerated in lexicographical
+     * order, building the indexes in bulk where possible.
+     */
+    virtual void insertSorted(const RamDomain* tuples, std::size_t count);
+
     /**
      * Tests whether this relation contains the given tuple.
      */
@@ -137,6 +145,14 @@ public:
      */
     PartitionedStream partitionScan(size_t partitionCount) const;
 
+    /**
+     * Finds an index whose order starts with the given attributes, such that the
+     * index supports range queries binding exactly these attributes.
+     *
+     * @return true if such an index exists, its position is stored in indexPos
+     */
+    bool findIndex(const AttributeSet& attributes, size_t& indexPos) const;
+
     /**
      * Obtains a stream covering the interval between the two given entries.
      */
@@ -229,6 +245,9 @@ protected:
     // a map of managed indexes
     std::vector<std::unique_ptr<InterpreterIndex>> indexes;
 
+    // the orders of the managed indexes
+    std::vector<Order> orders;
+
     // a pointer to the main index within the managed index
     InterpreterIndex* main;
 
@@ -260,6 +279,8 @@ public:
 
     bool insert(const RamDomain* tuple) override;
 
+    void insertSorted(const RamDomain* tuples, std::size_t count) override;
+
     /** Clear all indexes */
     void purge() override;
 
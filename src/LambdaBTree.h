@@ -83,7 +83,8 @@ public:
             }
 
             // create new node
-            this->leftmost = new typename parenttype::leaf_node();
+            this->leftmost =
+                    static_cast<typename parenttype::leaf_node*>(parenttype::node::create(this->pool, false));
             this->leftmost->numElements = 1;
             // call the functor as we've successfully inserted
             typename Functor::result_type res = f(k);
@@ -313,8 +314,8 @@ public:
 
                 // split this node
                 auto old_root = this->root;
-                idx -= cur->rebalance_or_split(
-                        const_cast<typename parenttype::node**>(&this->root), this->root_lock, idx, parents);
+                idx -= cur->rebalance_or_split(const_cast<typename parenttype::node**>(&this->root),
+                        this->root_lock, this->pool, idx, parents);
 
                 // release parent lock
                 for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
@@ -367,7 +368,8 @@ public:
         // special handling for inserting first element
         if (this->empty()) {
             // create new node
-            this->leftmost = new typename parenttype::leaf_node();
+            this->leftmost =
+                    static_cast<typename parenttype::leaf_node*>(parenttype::node::create(this->pool, false));
             this->leftmost->numElements = 1;
             // call the functor as we've successfully inserted
             typename Functor::result_type res = f(k);
@@ -444,8 +446,8 @@ public:
 
             if (cur->numElements >= parenttype::node::maxKeys) {
                 // split this node
-                idx -= cur->rebalance_or_split(
-                        const_cast<typename parenttype::node**>(&this->root), this->root_lock, idx);
+                idx -= cur->rebalance_or_split(const_cast<typename parenttype::node**>(&this->root),
+                        this->root_lock, this->pool, idx);
 
                 // insert element in right fragment
                 if (((typename parenttype::size_type)idx) > cur->numElements) {
@@ -498,6 +500,7 @@ public:
         // swap the content
         std::swap(this->root, other.root);
         std::swap(this->leftmost, other.leftmost);
+        this->pool.swap(other.pool);
     }
 
     // Implementation of the assignment operation for trees.
@@ -507,6 +510,9 @@ public:
             return *this;
         }
 
+        // drop the old content
+        this->clear();
+
         // create a deep-copy of the content of the other tree
         // shortcut for empty sets
         if (other.empty()) {
@@ -514,7 +520,7 @@ public:
         }
 
         // clone content (deep copy)
-        this->root = other.root->clone();
+        this->root = other.root->clone(this->pool);
 
         // update leftmost reference
         auto tmp = this->root;
@@ -598,12 +604,6 @@ public:
     // A move constructor.
     LambdaBTreeSet(LambdaBTreeSet&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    LambdaBTreeSet(s size, n* root, l* leftmost) : super::parenttype(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     LambdaBTreeSet& operator=(const LambdaBTreeSet& other) {
         super::operator=(other);
@@ -87,6 +87,15 @@ public:
         return line.str();
     }
 
+    static const std::string aRecursiveRule(const std::string& relationName, const int version,
+            const SrcLocation& srcLocation, const std::string& datalogText) {
+        const char* messageType = "@a-recursive-rule";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << version << ";" << srcLocation << ";"
+             << datalogText << ";";
+        return line.str();
+    }
+
     static const std::string tRecursiveRelation(
             const std::string& relationName, const SrcLocation& srcLocation) {
         const char* messageType = "@t-recursive-relation";
@@ -103,6 +112,13 @@ public:
         return line.str();
     }
 
+    static const std::string sRelationStatistics(const std::string& relationName) {
+        const char* messageType = "@s-relation-statistics";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";";
+        return line.str();
+    }
+
     static const std::string cRecursiveRelation(
             const std::string& relationName, const SrcLocation& srcLocation) {
         const char* messageType = "@c-recursive-relation";
@@ -20,13 +20,18 @@
 #include "ProfileEvent.h"
 #include "utility/MiscUtil.h"
 #include <cstddef>
-#include <functional>
 #include <string>
 #include <utility>
-#include <sys/resource.h>
 
 namespace souffle {
 
+/** Size function of a logger that does not log a size */
+struct NoSize {
+    size_t operator()() const {
+        return 0;
+    }
+};
+
 /**
  * The class utilized to times for the souffle profiling tool. This class
  * is utilized by both -- the interpreted and compiled version -- to conduct
@@ -34,24 +39,26 @@ namespace souffle {
  *
  * To far, only execution times are logged. More events, e.g. the number of
  * processed tuples may be added in the future.
+ *
+ * The maximum resident set size is taken from the last utilisation event
+ * rather than read on every construction and destruction, as loggers are
+ * created for every rule evaluation.
  */
+template <typename SizeFn = NoSize>
 class Logger {
 public:
-    Logger(std::string label, size_t iteration) : Logger(label, iteration, []() { return 0; }) {}
+    Logger(std::string label, size_t iteration) : Logger(std::move(label), iteration, SizeFn()) {}
 
-    Logger(std::string label, size_t iteration, std::function<size_t()> size)
-            : label(std::move(label)), start(now()), iteration(iteration), size(size), preSize(size()) {
-        struct rusage ru {};
-        getrusage(RUSAGE_SELF, &ru);
-        startMaxRSS = ru.ru_maxrss;
+    Logger(std::string label, size_t iteration, SizeFn size)
+            : label(std::move(label)), start(now()), iteration(iteration), size(std::move(size)),
+              preSize(this->size()) {
+        startMaxRSS = ProfileEventSingleton::instance().getMaxRSS();
         // Assume that if we are logging the progress of an event then we care about usage during that time.
         ProfileEventSingleton::instance().resetTimerInterval();
     }
 
     ~Logger() {
-        struct rusage ru {};
-        getrusage(RUSAGE_SELF, &ru);
-        size_t endMaxRSS = ru.ru_maxrss;
+        size_t endMaxRSS = ProfileEventSingleton::instance().getMaxRSS();
         ProfileEventSingleton::instance().makeTimingEvent(
                 label, start, now(), startMaxRSS, endMaxRSS, size() - preSize, iteration);
     }
@@ -61,7 +68,7 @@ private:
     time_point start;
     size_t startMaxRSS;
     size_t iteration;
-    std::function<size_t()> size;
+    SizeFn size;
     size_t preSize;
 };
 }  // end of namespace souffle
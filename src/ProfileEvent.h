@@ -16,31 +16,81 @@
 
 #pragma once
 
-#include "EventProcessor.h"
 #include "ProfileDatabase.h"
+#include "ProfileLog.h"
+#include "RamTypes.h"
 #include "utility/MiscUtil.h"
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
 #include <ctime>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 #include <sys/resource.h>
 #include <sys/time.h>
 
 namespace souffle {
 
+/**
+ * Estimates the number of distinct values of a stream from the k smallest
+ * hashes of its values (k minimum values); the count is exact up to k
+ * distinct values.
+ */
+class DistinctCounter {
+public:
+    void insert(RamDomain value) {
+        uint64_t hash = mix(static_cast<uint64_t>(value));
+        if (hashes.size() == k && hash >= *hashes.rbegin()) {
+            return;
+        }
+        if (hashes.insert(hash).second && hashes.size() > k) {
+            hashes.erase(std::prev(hashes.end()));
+        }
+    }
+
+    size_t count() const {
+        if (hashes.size() < k) {
+            return hashes.size();
+        }
+        // the k-th smallest of n uniform hashes is about k/n of the hash range
+        return static_cast<size_t>((k - 1) * (std::ldexp(1.0, 64) / static_cast<double>(*hashes.rbegin())));
+    }
+
+private:
+    static constexpr size_t k = 1024;
+
+    /** the finaliser of splitmix64 */
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::set<uint64_t> hashes;
+};
+
 /**
  * Profile Event Singleton
+ *
+ * Events are streamed to a binary profile log; the profile database holds
+ * the events of a log read by the profiler, or of a live profile.
  */
 class ProfileEventSingleton {
     /** profile database */
     profile::ProfileDatabase database;
-    std::string filename{""};
+    /** profile log */
+    profile::ProfileLog log;
+    /** maximum resident set size (kb) of the last utilisation event */
+    std::atomic<size_t> maxRSS{0};
 
     ProfileEventSingleton() = default;
 
@@ -58,33 +108,44 @@ public:
 
     /** create config record */
     void makeConfigRecord(const std::string& key, const std::string& value) {
-        profile::EventProcessorSingleton::instance().process(database, "@config", key.c_str(), value.c_str());
+        log.append(profile::LogRecordKind::Config, key, {log.intern(value)});
     }
 
     /** create time event */
     void makeTimeEvent(const std::string& txt) {
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), std::chrono::duration_cast<microseconds>(now().time_since_epoch()));
+        log.append(profile::LogRecordKind::Time, txt, {toMicroseconds(now())});
     }
 
     /** create an event for recording start and end times */
     void makeTimingEvent(const std::string& txt, time_point start, time_point end, size_t startMaxRSS,
             size_t endMaxRSS, size_t size, size_t iteration) {
-        microseconds start_ms = std::chrono::duration_cast<microseconds>(start.time_since_epoch());
-        microseconds end_ms = std::chrono::duration_cast<microseconds>(end.time_since_epoch());
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), start_ms, end_ms, startMaxRSS, endMaxRSS, size, iteration);
+        log.append(profile::LogRecordKind::Timing, txt,
+                {toMicroseconds(start), toMicroseconds(end), startMaxRSS, endMaxRSS, size, iteration});
     }
 
     /** create quantity event */
     void makeQuantityEvent(const std::string& txt, size_t number, int iteration) {
-        profile::EventProcessorSingleton::instance().process(database, txt.c_str(), number, iteration);
+        log.append(profile::LogRecordKind::Quantity, txt, {number, static_cast<uint64_t>(iteration)});
+    }
+
+    /** create an event for the number of distinct values of each attribute of a relation */
+    template <typename Relation>
+    void makeStatisticsEvents(const std::string& txt, const Relation& relation, size_t arity) {
+        std::vector<DistinctCounter> counters(arity);
+        for (const auto& tuple : relation) {
+            for (size_t i = 0; i < arity; ++i) {
+                counters[i].insert(tuple[i]);
+            }
+        }
+        for (size_t i = 0; i < arity; ++i) {
+            makeQuantityEvent(txt + std::to_string(i), counters[i].count(), 0);
+        }
     }
 
     /** create utilisation event */
     void makeUtilisationEvent(const std::string& txt) {
         /* current time */
-        microseconds time = std::chrono::duration_cast<microseconds>(now().time_since_epoch());
+        uint64_t time = toMicroseconds(now());
         /* system CPU time used */
         struct rusage ru {};
         getrusage(RUSAGE_SELF, &ru);
@@ -93,25 +154,25 @@ public:
         /* user CPU time used */
         uint64_t userTime = ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec;
         /* Maximum resident set size (kb) */
-        size_t maxRSS = ru.ru_maxrss;
+        size_t rss = ru.ru_maxrss;
+        maxRSS.store(rss, std::memory_order_relaxed);
 
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), time, systemTime, userTime, maxRSS);
+        log.append(profile::LogRecordKind::Utilisation, txt, {time, systemTime, userTime, rss});
+    }
+
+    /** Get the maximum resident set size (kb) of the last utilisation event */
+    size_t getMaxRSS() const {
+        return maxRSS.load(std::memory_order_relaxed);
     }
 
     void setOutputFile(std::string filename) {
-        this->filename = filename;
+        if (!log.open(filename)) {
+            std::cerr << "Cannot open profile log file <" + filename + ">";
+        }
     }
-    /** Dump all events */
+    /** Write all events to the log file */
     void dump() {
-        if (!filename.empty()) {
-            std::ofstream os(filename);
-            if (!os.is_open()) {
-                std::cerr << "Cannot open profile log file <" + filename + ">";
-            } else {
-                database.print(os);
-            }
-        }
+        log.close();
     }
 
     /** Start timer */
@@ -131,11 +192,27 @@ public:
         return database;
     }
 
+    /** Replay the events into the profile database for a live profile */
+    void setLiveDB() {
+        log.replayInto(database);
+    }
+
+    /** Read the profile database from a binary profile log, or from a JSON profile database */
     void setDBFromFile(const std::string& filename) {
-        database = profile::ProfileDatabase(filename);
+        std::ifstream in(filename, std::ios::binary);
+        profile::ProfileDatabase db;
+        if (profile::ProfileLog::replay(in, db)) {
+            database = std::move(db);
+        } else {
+            database = profile::ProfileDatabase(filename);
+        }
     }
 
 private:
+    static uint64_t toMicroseconds(time_point time) {
+        return std::chrono::duration_cast<microseconds>(time.time_since_epoch()).count();
+    }
+
     /**  Profile Timer */
     class ProfileTimer {
     private:
@@ -214,9 +291,13 @@ private:
          *  @param interval the size of the timing interval in milliseconds
          */
         void resetTimerInterval(uint32_t interval = 10) {
+            // only wake the timer if the interval gets shorter, as loggers reset it constantly
+            bool shorter = interval < t;
             t = interval;
             runCount = 0;
-            conditionVariable.notify_all();
+            if (shorter) {
+                conditionVariable.notify_all();
+            }
         }
     };
 
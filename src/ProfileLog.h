@@ -0,0 +1,377 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProfileLog.h
+ *
+ * Defines the binary profile log: a stream of fixed-size event records
+ * that is written to disk while the program runs, and replayed into a
+ * profile database by the profiler.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "EventProcessor.h"
+#include "ProfileDatabase.h"
+#include "utility/MiscUtil.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/** Kinds of records of a binary profile log */
+enum class LogRecordKind : uint32_t {
+    /** definition of a label, followed by the label's characters */
+    Label,
+    /** configuration entry: key label, value label */
+    Config,
+    /** time event: time */
+    Time,
+    /** timing event: start, end, start max RSS, end max RSS, size, iteration */
+    Timing,
+    /** quantity event: number, iteration */
+    Quantity,
+    /** utilisation event: time, system time, user time, max RSS */
+    Utilisation
+};
+
+/**
+ * A fixed-size record of a binary profile log.
+ *
+ * Events refer to their text by a label id; the definition of a label
+ * precedes the first event using it.
+ */
+struct LogRecord {
+    LogRecordKind kind;
+    uint32_t label;
+    std::array<uint64_t, 7> values;
+};
+static_assert(sizeof(LogRecord) == 64, "log records fill a cache line");
+
+/**
+ * Binary profile log
+ *
+ * Events are appended to a lock-free ring buffer of the logging thread and
+ * streamed to the log file by a background writer, which flushes the file
+ * periodically so that a crash loses little of the log. The log holds the
+ * events in memory until it is given a file.
+ */
+class ProfileLog {
+public:
+    /** the magic bytes of a binary profile log */
+    static constexpr char magic[8] = {'S', 'O', 'U', 'F', 'P', 'L', 'O', 'G'};
+
+    /** the version of the log format */
+    static constexpr uint64_t version = 1;
+
+    /** the number of records of a ring buffer */
+    static constexpr size_t bufferSize = 4096;
+
+    ProfileLog() : id(nextId()) {
+        pending.append(magic, sizeof(magic));
+        pending.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+
+    ~ProfileLog() {
+        close();
+    }
+
+    /** Append an event of the given kind */
+    void append(LogRecordKind kind, const std::string& text, std::array<uint64_t, 7> values) {
+        LogRecord record{kind, intern(text), values};
+        Buffer& buffer = getBuffer();
+        while (!buffer.push(record)) {
+            // a full buffer is drained by its producer
+            std::lock_guard<std::mutex> guard(writerMutex);
+            drain();
+        }
+    }
+
+    /** Return the id of the given label */
+    uint32_t intern(const std::string& text) {
+        thread_local LabelCache cache;
+        if (cache.owner != id) {
+            cache.owner = id;
+            cache.ids.clear();
+        }
+        auto pos = cache.ids.find(text);
+        if (pos != cache.ids.end()) {
+            return pos->second;
+        }
+        std::lock_guard<std::mutex> guard(labelMutex);
+        auto res = labelIds.emplace(text, labels.size());
+        if (res.second) {
+            labels.push_back(text);
+        }
+        cache.ids.emplace(text, res.first->second);
+        return res.first->second;
+    }
+
+    /** Stream the log to the given file; return false if the file cannot be opened */
+    bool open(const std::string& filename) {
+        std::lock_guard<std::mutex> guard(writerMutex);
+        file.open(filename, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        this->filename = filename;
+        file.write(pending.data(), pending.size());
+        pending.clear();
+        file.flush();
+        return true;
+    }
+
+    /** Stop the writer and write all events */
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(writerMutex);
+            running = false;
+        }
+        wakeup.notify_all();
+        if (writer.joinable()) {
+            writer.join();
+        }
+        std::lock_guard<std::mutex> guard(writerMutex);
+        drain();
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+
+    /**
+     * Replay the log into the given database: all events so far at once, and
+     * later events as they are written.
+     */
+    void replayInto(ProfileDatabase& db) {
+        std::lock_guard<std::mutex> guard(writerMutex);
+        drain();
+        if (file.is_open()) {
+            std::ifstream in(filename, std::ios::binary);
+            replay(in, db);
+        } else {
+            std::istringstream in(pending);
+            replay(in, db);
+        }
+        replayDB = &db;
+    }
+
+    /**
+     * Replay a binary profile log into the given database; return false if
+     * the stream does not hold a binary profile log. The replay stops at a
+     * record truncated by a crash.
+     */
+    static bool replay(std::istream& in, ProfileDatabase& db) {
+        char header[sizeof(magic)];
+        uint64_t logVersion = 0;
+        in.read(header, sizeof(header));
+        in.read(reinterpret_cast<char*>(&logVersion), sizeof(logVersion));
+        if (!in || std::memcmp(header, magic, sizeof(magic)) != 0) {
+            return false;
+        }
+        if (logVersion != version) {
+            throw std::runtime_error("Unsupported version of the binary profile log.");
+        }
+        std::vector<std::string> logLabels;
+        LogRecord record{};
+        while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+            if (record.kind == LogRecordKind::Label) {
+                std::string text(record.values[0], '\0');
+                if (!in.read(&text[0], text.size())) {
+                    break;
+                }
+                logLabels.resize(std::max<size_t>(logLabels.size(), record.label + 1));
+                logLabels[record.label] = std::move(text);
+            } else {
+                replay(record, logLabels, db);
+            }
+        }
+        return true;
+    }
+
+private:
+    /** Single-producer single-consumer ring buffer of the records of a thread */
+    class Buffer {
+    public:
+        /** Push a record; return false if the buffer is full */
+        bool push(const LogRecord& record) {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) == bufferSize) {
+                return false;
+            }
+            records[h % bufferSize] = record;
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** Pop all records */
+        template <typename Consumer>
+        void pop(Consumer consume) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            size_t h = head.load(std::memory_order_acquire);
+            for (; t != h; ++t) {
+                consume(records[t % bufferSize]);
+            }
+            tail.store(h, std::memory_order_release);
+        }
+
+    private:
+        std::array<LogRecord, bufferSize> records;
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+    };
+
+    /** Labels known to a thread */
+    struct LabelCache {
+        uint64_t owner = 0;
+        std::unordered_map<std::string, uint32_t> ids;
+    };
+
+    /** Buffer of a thread */
+    struct BufferCache {
+        uint64_t owner = 0;
+        Buffer* buffer = nullptr;
+    };
+
+    /** Return a new log id; ids distinguish logs in the thread-local caches */
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    /** Return the buffer of the calling thread, and start the writer on first use */
+    Buffer& getBuffer() {
+        thread_local BufferCache cache;
+        if (cache.owner != id) {
+            std::lock_guard<std::mutex> guard(writerMutex);
+            buffers.push_back(std::make_unique<Buffer>());
+            cache.owner = id;
+            cache.buffer = buffers.back().get();
+            if (!writer.joinable() && running) {
+                writer = std::thread([this]() { write(); });
+            }
+        }
+        return *cache.buffer;
+    }
+
+    /** Write the log periodically until the log is closed */
+    void write() {
+        std::unique_lock<std::mutex> lock(writerMutex);
+        while (running) {
+            wakeup.wait_for(lock, flushInterval);
+            drain();
+        }
+    }
+
+    /** Write the records of all buffers and the labels they refer to; requires the writer mutex */
+    void drain() {
+        batch.clear();
+        for (auto& buffer : buffers) {
+            buffer->pop([&](const LogRecord& record) { batch.push_back(record); });
+        }
+        if (batch.empty()) {
+            return;
+        }
+        // labels are interned before their events are pushed
+        size_t firstLabel = writtenLabels.size();
+        {
+            std::lock_guard<std::mutex> guard(labelMutex);
+            writtenLabels.insert(writtenLabels.end(), labels.begin() + firstLabel, labels.end());
+        }
+        for (size_t i = firstLabel; i < writtenLabels.size(); ++i) {
+            const std::string& text = writtenLabels[i];
+            LogRecord record{LogRecordKind::Label, static_cast<uint32_t>(i), {text.size()}};
+            output(reinterpret_cast<const char*>(&record), sizeof(record));
+            output(text.data(), text.size());
+        }
+        output(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(LogRecord));
+        if (file.is_open()) {
+            file.flush();
+        }
+        if (replayDB != nullptr) {
+            for (const LogRecord& record : batch) {
+                replay(record, writtenLabels, *replayDB);
+            }
+        }
+    }
+
+    /** Write bytes to the log file, or hold them until there is one */
+    void output(const char* data, size_t size) {
+        if (file.is_open()) {
+            file.write(data, size);
+        } else {
+            pending.append(data, size);
+        }
+    }
+
+    /** Replay an event into the database */
+    static void replay(const LogRecord& record, const std::vector<std::string>& labels, ProfileDatabase& db) {
+        auto& processor = EventProcessorSingleton::instance();
+        const char* text = labels.at(record.label).c_str();
+        const auto& v = record.values;
+        switch (record.kind) {
+            case LogRecordKind::Config:
+                processor.process(db, "@config", text, labels.at(v[0]).c_str());
+                break;
+            case LogRecordKind::Time: processor.process(db, text, microseconds(v[0])); break;
+            case LogRecordKind::Timing:
+                processor.process(db, text, microseconds(v[0]), microseconds(v[1]), size_t(v[2]),
+                        size_t(v[3]), size_t(v[4]), size_t(v[5]));
+                break;
+            case LogRecordKind::Quantity: processor.process(db, text, size_t(v[0]), int(v[1])); break;
+            case LogRecordKind::Utilisation:
+                processor.process(db, text, microseconds(v[0]), uint64_t(v[1]), uint64_t(v[2]), size_t(v[3]));
+                break;
+            case LogRecordKind::Label: break;
+        }
+    }
+
+    /** the interval between writes of the log */
+    static constexpr std::chrono::milliseconds flushInterval{100};
+
+    const uint64_t id;
+
+    /** interned labels */
+    std::mutex labelMutex;
+    std::vector<std::string> labels;
+    std::unordered_map<std::string, uint32_t> labelIds;
+
+    /** writer state, guarded by the writer mutex */
+    std::mutex writerMutex;
+    std::condition_variable wakeup;
+    bool running = true;
+    std::thread writer;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<LogRecord> batch;
+    std::vector<std::string> writtenLabels;
+    std::string filename;
+    std::ofstream file;
+    std::string pending;
+    ProfileDatabase* replayDB = nullptr;
+};
+
+}  // namespace profile
+}  // namespace souffle
@@ -865,6 +865,46 @@ protected:
     }
 };
 
+/**
+ * @class RamParallelAggregate
+ * @brief Aggregation function applied on some relation, evaluated in parallel
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * t0.0 = COUNT PARALLEL FOR ALL t0 IN A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Each thread aggregates the tuples of some partitions of A; the partial
+ * aggregates are combined before the nested operation is executed once.
+ */
+class RamParallelAggregate : public RamAggregate, public RamAbstractParallel {
+public:
+    RamParallelAggregate(std::unique_ptr<RamOperation> nested, AggregateOp fun,
+            std::unique_ptr<RamRelationReference> relRef, std::unique_ptr<RamExpression> expression,
+            std::unique_ptr<RamCondition> condition, int ident)
+            : RamAggregate(std::move(nested), fun, std::move(relRef), std::move(expression),
+                      std::move(condition), ident) {}
+
+    RamParallelAggregate* clone() const override {
+        return new RamParallelAggregate(std::unique_ptr<RamOperation>(getOperation().clone()), function,
+                std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                std::unique_ptr<RamExpression>(expression->clone()),
+                std::unique_ptr<RamCondition>(condition->clone()), getTupleId());
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "t" << getTupleId() << ".0=";
+        RamAbstractAggregate::print(os, tabpos);
+        os << "PARALLEL FOR ALL t" << getTupleId() << " ∈ " << getRelation().getName();
+        if (!isRamTrue(condition.get())) {
+            os << " WHERE " << getCondition();
+        }
+        os << std::endl;
+        RamRelationOperation::print(os, tabpos + 1);
+    }
+};
+
 /**
  * @class RamIndexAggregate
  * @brief Indexed aggregation on a relation
@@ -924,6 +964,147 @@ protected:
     }
 };
 
+/**
+ * @class RamParallelIndexAggregate
+ * @brief Indexed aggregation on a relation, evaluated in parallel
+ */
+class RamParallelIndexAggregate : public RamIndexAggregate, public RamAbstractParallel {
+public:
+    RamParallelIndexAggregate(std::unique_ptr<RamOperation> nested, AggregateOp fun,
+            std::unique_ptr<RamRelationReference> relRef, std::unique_ptr<RamExpression> expression,
+            std::unique_ptr<RamCondition> condition, RamPattern queryPattern, int ident)
+            : RamIndexAggregate(std::move(nested), fun, std::move(relRef), std::move(expression),
+                      std::move(condition), std::move(queryPattern), ident) {}
+
+    RamParallelIndexAggregate* clone() const override {
+        RamPattern pattern;
+        for (const auto& i : queryPattern.first) {
+            pattern.first.emplace_back(i->clone());
+        }
+        for (const auto& i : queryPattern.second) {
+            pattern.second.emplace_back(i->clone());
+        }
+        return new RamParallelIndexAggregate(std::unique_ptr<RamOperation>(getOperation().clone()),
+                function, std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                std::unique_ptr<RamExpression>(expression->clone()),
+                std::unique_ptr<RamCondition>(condition->clone()), std::move(pattern), getTupleId());
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "t" << getTupleId() << ".0=";
+        RamAbstractAggregate::print(os, tabpos);
+        os << "PARALLEL SEARCH t" << getTupleId() << " ∈ " << getRelation().getName();
+        printIndex(os);
+        if (!isRamTrue(condition.get())) {
+            os << " WHERE " << getCondition();
+        }
+        os << std::endl;
+        RamIndexOperation::print(os, tabpos + 1);
+    }
+};
+
+/**
+ * @class RamRangeAggregate
+ * @brief Indexed aggregation on a relation, answered from the boundaries of the range
+ *
+ * The aggregate has no condition and either counts the tuples of the range,
+ * or takes the minimum or maximum of the attribute following the bound
+ * attributes in the order of the index, i.e., the target expression is
+ * the value of the first or the last tuple of the range. For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * t1.0=count RANGE SEARCH t1 ∈ e ON INDEX t1.0 = t0.0
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Indexes keeping the sizes of their sub-trees compute the aggregate
+ * without enumerating the range.
+ */
+class RamRangeAggregate : public RamIndexAggregate {
+public:
+    RamRangeAggregate(std::unique_ptr<RamOperation> nested, AggregateOp fun,
+            std::unique_ptr<RamRelationReference> relRef, std::unique_ptr<RamExpression> expression,
+            std::unique_ptr<RamCondition> condition, RamPattern queryPattern, int ident)
+            : RamIndexAggregate(std::move(nested), fun, std::move(relRef), std::move(expression),
+                      std::move(condition), std::move(queryPattern), ident) {}
+
+    RamRangeAggregate* clone() const override {
+        RamPattern pattern;
+        for (const auto& i : queryPattern.first) {
+            pattern.first.emplace_back(i->clone());
+        }
+        for (const auto& i : queryPattern.second) {
+            pattern.second.emplace_back(i->clone());
+        }
+        return new RamRangeAggregate(std::unique_ptr<RamOperation>(getOperation().clone()), function,
+                std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                std::unique_ptr<RamExpression>(expression->clone()),
+                std::unique_ptr<RamCondition>(condition->clone()), std::move(pattern), getTupleId());
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "t" << getTupleId() << ".0=";
+        RamAbstractAggregate::print(os, tabpos);
+        os << "RANGE SEARCH t" << getTupleId() << " ∈ " << getRelation().getName();
+        printIndex(os);
+        os << std::endl;
+        RamIndexOperation::print(os, tabpos + 1);
+    }
+};
+
+/**
+ * @class RamGroupAggregate
+ * @brief Indexed aggregation on a relation, evaluated for all groups at once
+ *
+ * The search attributes group the relation; their values are given by
+ * outer tuples, and the condition and target expression only refer to
+ * the aggregated tuple. For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * FOR t0 IN k
+ *  t1.0=count GROUP SEARCH t1 ∈ e ON INDEX t1.0 = t0.0
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * counts the tuples of e for each tuple of k. Instead of a range query per
+ * outer tuple, the aggregate may be computed for all values of the search
+ * attributes in one pass over the relation.
+ */
+class RamGroupAggregate : public RamIndexAggregate {
+public:
+    RamGroupAggregate(std::unique_ptr<RamOperation> nested, AggregateOp fun,
+            std::unique_ptr<RamRelationReference> relRef, std::unique_ptr<RamExpression> expression,
+            std::unique_ptr<RamCondition> condition, RamPattern queryPattern, int ident)
+            : RamIndexAggregate(std::move(nested), fun, std::move(relRef), std::move(expression),
+                      std::move(condition), std::move(queryPattern), ident) {}
+
+    RamGroupAggregate* clone() const override {
+        RamPattern pattern;
+        for (const auto& i : queryPattern.first) {
+            pattern.first.emplace_back(i->clone());
+        }
+        for (const auto& i : queryPattern.second) {
+            pattern.second.emplace_back(i->clone());
+        }
+        return new RamGroupAggregate(std::unique_ptr<RamOperation>(getOperation().clone()), function,
+                std::unique_ptr<RamRelationReference>(relationRef->clone()),
+                std::unique_ptr<RamExpression>(expression->clone()),
+                std::unique_ptr<RamCondition>(condition->clone()), std::move(pattern), getTupleId());
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "t" << getTupleId() << ".0=";
+        RamAbstractAggregate::print(os, tabpos);
+        os << "GROUP SEARCH t" << getTupleId() << " ∈ " << getRelation().getName();
+        printIndex(os);
+        if (!isRamTrue(condition.get())) {
+            os << " WHERE " << getCondition();
+        }
+        os << std::endl;
+        RamIndexOperation::print(os, tabpos + 1);
+    }
+};
+
 enum class RamNestedIntrinsicOp {
     RANGE,
     URANGE,
@@ -0,0 +1,123 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamScheduleAnalysis.cpp
+ *
+ * Implementation of RAM Schedule Analysis
+ *
+ ***********************************************************************/
+
+#include "RamScheduleAnalysis.h"
+#include "RamNode.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamRelation.h"
+#include "RamStatement.h"
+#include "RamTranslationUnit.h"
+#include "RamVisitor.h"
+#include "utility/StreamUtil.h"
+#include <algorithm>
+#include <map>
+#include <set>
+
+namespace souffle {
+
+void RamScheduleAnalysis::run(const RamTranslationUnit& translationUnit) {
+    const RamProgram& program = translationUnit.getProgram();
+
+    // locate the sequence of stratum calls
+    visitDepthFirst(program.getMain(), [&](const RamSequence& seq) {
+        const auto& stmts = seq.getStatements();
+        if (strata == nullptr && stmts.size() > 1 &&
+                std::all_of(stmts.begin(), stmts.end(),
+                        [](const RamStatement* stmt) { return dynamic_cast<const RamCall*>(stmt) != nullptr; })) {
+            strata = &seq;
+        }
+    });
+    if (strata == nullptr) {
+        return;
+    }
+
+    // the last stratum modifying a relation, and the strata reading it since then
+    std::map<const RamRelation*, size_t> lastWriter;
+    std::map<const RamRelation*, std::vector<size_t>> readers;
+    // the last stratum writing output
+    size_t lastOutput = 0;
+    bool hasOutput = false;
+
+    for (const RamStatement* stmt : strata->getStatements()) {
+        const size_t cur = predecessors.size();
+        const RamStatement& body = program.getSubroutine(static_cast<const RamCall*>(stmt)->getName());
+
+        // collect the relations accessed and modified by the stratum
+        std::set<const RamRelation*> accessed;
+        std::set<const RamRelation*> modified;
+        bool output = false;
+        visitDepthFirst(body, [&](const RamRelationReference& ref) { accessed.insert(ref.get()); });
+        visitDepthFirst(body, [&](const RamProject& project) { modified.insert(&project.getRelation()); });
+        visitDepthFirst(body, [&](const RamClear& clear) { modified.insert(&clear.getRelation()); });
+        visitDepthFirst(body, [&](const RamBinRelationStatement& binary) {
+            modified.insert(&binary.getFirstRelation());
+            modified.insert(&binary.getSecondRelation());
+        });
+        visitDepthFirst(body, [&](const RamIO& io) {
+            if (io.get("operation") == "input") {
+                modified.insert(&io.getRelation());
+            } else {
+                output = true;
+            }
+        });
+
+        accessed.insert(modified.begin(), modified.end());
+
+        // order the stratum after conflicting strata
+        std::set<size_t> preds;
+        for (const RamRelation* rel : accessed) {
+            auto writer = lastWriter.find(rel);
+            if (writer != lastWriter.end()) {
+                preds.insert(writer->second);
+            }
+            if (modified.count(rel) > 0) {
+                for (size_t reader : readers[rel]) {
+                    preds.insert(reader);
+                }
+                readers[rel].clear();
+                lastWriter[rel] = cur;
+            } else {
+                readers[rel].push_back(cur);
+            }
+        }
+        if (output) {
+            if (hasOutput) {
+                preds.insert(lastOutput);
+            }
+            lastOutput = cur;
+            hasOutput = true;
+        }
+        preds.erase(cur);
+        predecessors.emplace_back(preds.begin(), preds.end());
+    }
+}
+
+void RamScheduleAnalysis::print(std::ostream& os) const {
+    if (strata == nullptr) {
+        return;
+    }
+    const auto& stmts = strata->getStatements();
+    for (size_t i = 0; i < stmts.size(); ++i) {
+        os << static_cast<const RamCall*>(stmts[i])->getName() << " waits for: ";
+        os << join(predecessors[i], ", ", [&](std::ostream& out, size_t pred) {
+            out << static_cast<const RamCall*>(stmts[pred])->getName();
+        });
+        os << "\n";
+    }
+}
+
+}  // end of namespace souffle
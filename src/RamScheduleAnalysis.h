@@ -0,0 +1,73 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamScheduleAnalysis.h
+ *
+ * Determine the dependencies among the strata of the main program, such
+ * that independent strata can be evaluated concurrently.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace souffle {
+
+class RamSequence;
+class RamTranslationUnit;
+
+/**
+ * @class RamScheduleAnalysis
+ * @brief A Ram Analysis determining the order constraints among strata
+ *
+ * The main program invokes the strata by a sequence of calls. Stratum j has
+ * to wait for an earlier stratum i if one of them modifies (computes, loads,
+ * swaps or clears) a relation the other one accesses, or if both write
+ * output. All other pairs of strata may be evaluated in any order.
+ */
+class RamScheduleAnalysis : public RamAnalysis {
+public:
+    RamScheduleAnalysis(const char* id) : RamAnalysis(id) {}
+
+    static constexpr const char* name = "schedule-analysis";
+
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    void print(std::ostream& os) const override;
+
+    /**
+     * @brief Get the sequence of stratum calls in the main program
+     * @return the sequence, or nullptr if the main program has no such sequence
+     */
+    const RamSequence* getStrata() const {
+        return strata;
+    }
+
+    /**
+     * @brief Get the strata an element of the sequence of stratum calls has to wait for
+     * @return the positions of these strata in the sequence, each smaller than the position itself
+     */
+    const std::vector<std::vector<size_t>>& getPredecessors() const {
+        return predecessors;
+    }
+
+private:
+    /** sequence of stratum calls */
+    const RamSequence* strata = nullptr;
+
+    /** predecessors of each stratum call */
+    std::vector<std::vector<size_t>> predecessors;
+};
+
+}  // end of namespace souffle
@@ -341,6 +341,42 @@ protected:
     std::unique_ptr<RamOperation> operation;
 };
 
+/**
+ * @brief Match a query that copies all tuples of one relation into another
+ *
+ * Such queries are issued by the semi-naive evaluation for merging relations:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * QUERY
+ *   FOR t0 IN A
+ *     PROJECT (t0.0, ..., t0.n) INTO B
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * @return the source and target relation, or a pair of null pointers if the query is no such copy
+ */
+inline std::pair<const RamRelation*, const RamRelation*> getCopiedRelations(const RamQuery& query) {
+    const auto* scan = dynamic_cast<const RamScan*>(&query.getOperation());
+    if (scan == nullptr) {
+        return {nullptr, nullptr};
+    }
+    const auto* project = dynamic_cast<const RamProject*>(&scan->getOperation());
+    if (project == nullptr) {
+        return {nullptr, nullptr};
+    }
+    const RamRelation& src = scan->getRelation();
+    const RamRelation& dest = project->getRelation();
+    if (src.getArity() == 0 || src.getArity() != dest.getArity() ||
+            src.getAuxiliaryArity() != dest.getAuxiliaryArity()) {
+        return {nullptr, nullptr};
+    }
+    const auto values = project->getValues();
+    for (size_t i = 0; i < values.size(); ++i) {
+        const auto* element = dynamic_cast<const RamTupleElement*>(values[i]);
+        if (element == nullptr || element->getTupleId() != scan->getTupleId() || element->getElement() != i) {
+            return {nullptr, nullptr};
+        }
+    }
+    return {&src, &dest};
+}
+
 /**
  * @class RamListStatement
  * @brief Abstract class for a list of RAM statements
@@ -427,7 +463,9 @@ protected:
  *
  * Execute statements in parallel and wait until all statements have
  * completed their execution before completing the execution of the
- * parallel block.
+ * parallel block. The statements must be independent of each other;
+ * statements containing parallel operations are run in sequence, as
+ * parallelism is kept flat.
  *
  * For example:
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -465,6 +503,63 @@ protected:
     }
 };
 
+/**
+ * @class RamAdaptiveQuery
+ * @brief Alternative loop nests of a rule
+ *
+ * Each statement evaluates the rule in a different join order. The
+ * interpreter executes one of them, chosen by the current sizes of the
+ * relations the loops scan; the synthesiser executes the first one.
+ * The choice is logged with the given message, suffixed by the index
+ * of the chosen statement.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * ADAPTIVE TEXT "..."
+ *   QUERY
+ *     ...
+ *   QUERY
+ *     ...
+ * END ADAPTIVE
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamAdaptiveQuery : public RamListStatement {
+public:
+    RamAdaptiveQuery(std::vector<std::unique_ptr<RamStatement>> statements, std::string message)
+            : RamListStatement(std::move(statements)), message(std::move(message)) {}
+
+    /** @brief Get logging message */
+    const std::string& getMessage() const {
+        return message;
+    }
+
+    RamAdaptiveQuery* clone() const override {
+        std::vector<std::unique_ptr<RamStatement>> res;
+        for (auto& cur : statements) {
+            res.push_back(std::unique_ptr<RamStatement>(cur->clone()));
+        }
+        return new RamAdaptiveQuery(std::move(res), message);
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "ADAPTIVE TEXT "
+           << "\"" << stringify(message) << "\"" << std::endl;
+        for (auto const& stmt : statements) {
+            RamStatement::print(stmt.get(), os, tabpos + 1);
+        }
+        os << times(" ", tabpos) << "END ADAPTIVE" << std::endl;
+    }
+
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamAdaptiveQuery&>(node);
+        return RamListStatement::equal(other) && message == other.message;
+    }
+
+    /** logging message */
+    std::string message;
+};
+
 /**
  * @class RamLoop
  * @brief Execute statement until statement terminates loop via an exit statement
@@ -774,6 +869,43 @@ protected:
     std::string message;
 };
 
+/**
+ * @class RamLogStatistics
+ * @brief Log the number of distinct values of each attribute of a relation.
+ *
+ * The logging message is suffixed by the index of the attribute.
+ */
+class RamLogStatistics : public RamRelationStatement {
+public:
+    RamLogStatistics(std::unique_ptr<RamRelationReference> relRef, std::string message)
+            : RamRelationStatement(std::move(relRef)), message(std::move(message)) {}
+
+    /** @brief Get logging message */
+    const std::string& getMessage() const {
+        return message;
+    }
+
+    RamLogStatistics* clone() const override {
+        return new RamLogStatistics(std::unique_ptr<RamRelationReference>(relationRef->clone()), message);
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LOGSTATISTICS " << getRelation().getName();
+        os << " TEXT "
+           << "\"" << stringify(message) << "\"";
+        os << std::endl;
+    }
+
+    bool equal(const RamNode& node) const override {
+        const auto& other = static_cast<const RamLogStatistics&>(node);
+        return RamRelationStatement::equal(other) && message == other.message;
+    }
+
+    /** logging message */
+    std::string message;
+};
+
 /**
  * @class RamCall
  * @brief Call a subroutine
@@ -1090,6 +1090,148 @@ bool HoistAggregateTransformer::hoistAggregate(RamProgram& program) {
     return changed;
 }  // namespace souffle
 
+bool RangeAggregateTransformer::convertAggregates(RamProgram& program) {
+    bool changed = false;
+
+    // check whether an indexed aggregate is determined by the boundaries of its range
+    auto isRangeAggregate = [&](const RamIndexAggregate& aggregate) {
+        const RamRelation& rel = aggregate.getRelation();
+        if (!isRamTrue(&aggregate.getCondition()) || rel.getAuxiliaryArity() > 0) {
+            return false;
+        }
+
+        // the bound attributes must be bound by equalities
+        const auto& pattern = aggregate.getRangePattern();
+        size_t numBound = 0;
+        for (size_t i = 0; i < pattern.first.size(); ++i) {
+            const RamExpression* low = pattern.first[i];
+            const RamExpression* high = pattern.second[i];
+            if (isRamUndefValue(low) && isRamUndefValue(high)) {
+                continue;
+            }
+            if (isRamUndefValue(low) || isRamUndefValue(high) || !(*low == *high)) {
+                return false;
+            }
+            ++numBound;
+        }
+        if (numBound == 0) {
+            return false;
+        }
+        if (aggregate.getFunction() == AggregateOp::COUNT) {
+            return true;
+        }
+        if (aggregate.getFunction() != AggregateOp::MIN && aggregate.getFunction() != AggregateOp::MAX) {
+            return false;
+        }
+
+        // only B-trees store the range in the order of the index
+        if (rel.getRepresentation() != RelationRepresentation::DEFAULT &&
+                rel.getRepresentation() != RelationRepresentation::BTREE) {
+            return false;
+        }
+
+        // the target must be the attribute following the bound attributes in the order of the
+        // index, which is completed by the remaining attributes in ascending order
+        const auto* element = dynamic_cast<const RamTupleElement*>(&aggregate.getExpression());
+        if (element == nullptr || element->getTupleId() != aggregate.getTupleId() ||
+                numBound >= rel.getArity()) {
+            return false;
+        }
+        auto order = idxAnalysis->getIndexes(rel).getLexOrder(idxAnalysis->getSearchSignature(&aggregate));
+        for (size_t i = 0; i < rel.getArity() && order.size() <= numBound; ++i) {
+            if (!contains(order, i)) {
+                order.push_back(i);
+            }
+        }
+        return order[numBound] == element->getElement();
+    };
+
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> aggRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const RamIndexAggregate* iagg = dynamic_cast<RamIndexAggregate*>(node.get())) {
+                if (dynamic_cast<RamGroupAggregate*>(node.get()) == nullptr &&
+                        dynamic_cast<RamParallelIndexAggregate*>(node.get()) == nullptr &&
+                        dynamic_cast<RamRangeAggregate*>(node.get()) == nullptr && isRangeAggregate(*iagg)) {
+                    changed = true;
+                    node = std::make_unique<RamRangeAggregate>(
+                            std::unique_ptr<RamOperation>(iagg->getOperation().clone()),
+                            iagg->getFunction(), std::make_unique<RamRelationReference>(&iagg->getRelation()),
+                            std::unique_ptr<RamExpression>(iagg->getExpression().clone()),
+                            std::unique_ptr<RamCondition>(iagg->getCondition().clone()),
+                            clone(iagg->getRangePattern()), iagg->getTupleId());
+                }
+            }
+            node->apply(makeLambdaRamMapper(aggRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(aggRewriter));
+    });
+    return changed;
+}
+
+bool GroupAggregateTransformer::convertAggregates(RamProgram& program) {
+    bool changed = false;
+
+    // check whether an indexed aggregate computes a function of the group
+    // selected by outer tuples only
+    auto isGroupAggregate = [](const RamIndexAggregate& aggregate) {
+        const int identifier = aggregate.getTupleId();
+        const auto& pattern = aggregate.getRangePattern();
+        bool bound = false;
+        bool grouped = false;
+        for (size_t i = 0; i < pattern.first.size(); ++i) {
+            const RamExpression* low = pattern.first[i];
+            const RamExpression* high = pattern.second[i];
+            if (isRamUndefValue(low) && isRamUndefValue(high)) {
+                continue;
+            }
+            // ranges do not partition the relation
+            if (isRamUndefValue(low) || isRamUndefValue(high) || !(*low == *high)) {
+                return false;
+            }
+            bound = true;
+            visitDepthFirst(*low, [&](const RamTupleElement& element) {
+                grouped = grouped || element.getTupleId() != identifier;
+            });
+        }
+
+        // the groups must not depend on the outer tuples or on evaluation order
+        bool local = true;
+        auto checkLocal = [&](const RamNode& node) {
+            visitDepthFirst(node, [&](const RamTupleElement& element) {
+                local = local && element.getTupleId() == identifier;
+            });
+            visitDepthFirst(node, [&](const RamAutoIncrement&) { local = false; });
+        };
+        checkLocal(aggregate.getCondition());
+        checkLocal(aggregate.getExpression());
+        return bound && grouped && local;
+    };
+
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        std::function<std::unique_ptr<RamNode>(std::unique_ptr<RamNode>)> aggRewriter =
+                [&](std::unique_ptr<RamNode> node) -> std::unique_ptr<RamNode> {
+            if (const RamIndexAggregate* iagg = dynamic_cast<RamIndexAggregate*>(node.get())) {
+                if (dynamic_cast<RamGroupAggregate*>(node.get()) == nullptr &&
+                        dynamic_cast<RamRangeAggregate*>(node.get()) == nullptr && isGroupAggregate(*iagg)) {
+                    changed = true;
+                    node = std::make_unique<RamGroupAggregate>(
+                            std::unique_ptr<RamOperation>(iagg->getOperation().clone()),
+                            iagg->getFunction(), std::make_unique<RamRelationReference>(&iagg->getRelation()),
+                            std::unique_ptr<RamExpression>(iagg->getExpression().clone()),
+                            std::unique_ptr<RamCondition>(iagg->getCondition().clone()),
+                            clone(iagg->getRangePattern()), iagg->getTupleId());
+                }
+            }
+            node->apply(makeLambdaRamMapper(aggRewriter));
+            return node;
+        };
+        const_cast<RamQuery*>(&query)->apply(makeLambdaRamMapper(aggRewriter));
+    });
+    return changed;
+}
+
 bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
     bool changed = false;
 
@@ -1142,6 +1284,35 @@ bool ParallelTransformer::parallelizeOperations(RamProgram& program) {
                             std::unique_ptr<RamOperation>(indexChoice->getOperation().clone()),
                             indexChoice->getProfileText());
                 }
+            } else if (const RamAggregate* aggregate = dynamic_cast<RamAggregate*>(node.get())) {
+                const RamRelation& rel = aggregate->getRelation();
+                if (aggregate->getTupleId() == 0 && rel.getArity() > 0 &&
+                        nullptr == dynamic_cast<RamParallelAggregate*>(node.get())) {
+                    changed = true;
+                    return std::make_unique<RamParallelAggregate>(
+                            std::unique_ptr<RamOperation>(aggregate->getOperation().clone()),
+                            aggregate->getFunction(), std::make_unique<RamRelationReference>(&rel),
+                            std::unique_ptr<RamExpression>(aggregate->getExpression().clone()),
+                            std::unique_ptr<RamCondition>(aggregate->getCondition().clone()),
+                            aggregate->getTupleId());
+                }
+            } else if (const auto* indexAggregate = dynamic_cast<RamIndexAggregate*>(node.get())) {
+                // the groups of group aggregates are already computed in parallel, and
+            // range aggregates do not enumerate their range
+                const RamRelation& rel = indexAggregate->getRelation();
+                if (indexAggregate->getTupleId() == 0 && rel.getArity() > 0 &&
+                        nullptr == dynamic_cast<RamParallelIndexAggregate*>(node.get()) &&
+                        nullptr == dynamic_cast<RamGroupAggregate*>(node.get()) &&
+                        nullptr == dynamic_cast<RamRangeAggregate*>(node.get())) {
+                    changed = true;
+                    RamPattern queryPattern = clone(indexAggregate->getRangePattern());
+                    return std::make_unique<RamParallelIndexAggregate>(
+                            std::unique_ptr<RamOperation>(indexAggregate->getOperation().clone()),
+                            indexAggregate->getFunction(), std::make_unique<RamRelationReference>(&rel),
+                            std::unique_ptr<RamExpression>(indexAggregate->getExpression().clone()),
+                            std::unique_ptr<RamCondition>(indexAggregate->getCondition().clone()),
+                            std::move(queryPattern), indexAggregate->getTupleId());
+                }
             }
             node->apply(makeLambdaRamMapper(parallelRewriter));
             return node;
@@ -696,9 +696,105 @@ protected:
     }
 };
 
+/**
+ * @class RangeAggregateTransformer
+ * @brief Turns indexed aggregates determined by the boundaries of their range into range aggregates
+ *
+ * An indexed aggregate without condition that counts its range, or takes the
+ * minimum or maximum of the attribute following the equality-bound attributes
+ * in the order of the index, is computed without enumerating the range. For
+ * example:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN k
+ *    t1.0=count SEARCH t1 ∈ e ON INDEX t1.0 = t0.0
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN k
+ *    t1.0=count RANGE SEARCH t1 ∈ e ON INDEX t1.0 = t0.0
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * so that B-tree indexes may count the range in logarithmic time, and look
+ * up the minimum or maximum at the boundary of the range.
+ */
+class RangeAggregateTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "RangeAggregateTransformer";
+    }
+
+    /**
+     * @brief Convert indexed aggregates to range aggregates
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool convertAggregates(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        idxAnalysis = translationUnit.getAnalysis<RamIndexAnalysis>();
+        return convertAggregates(translationUnit.getProgram());
+    }
+
+    RamIndexAnalysis* idxAnalysis{nullptr};
+};
+
+/**
+ * @class GroupAggregateTransformer
+ * @brief Turns indexed aggregates grouped by outer tuples into group aggregates
+ *
+ * An indexed aggregate whose search attributes are all bound by equalities
+ * to values of outer tuples, and whose condition and target expression only
+ * refer to the aggregated tuple, computes the same function of a group of
+ * the relation for every outer tuple. For example:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN k
+ *    t1.0=count SEARCH t1 ∈ e ON INDEX t1.0 = t0.0
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * will be rewritten to
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *  QUERY
+ *   FOR t0 IN k
+ *    t1.0=count GROUP SEARCH t1 ∈ e ON INDEX t1.0 = t0.0
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * so that the engines may compute the aggregates of all groups in one pass.
+ */
+class GroupAggregateTransformer : public RamTransformer {
+public:
+    std::string getName() const override {
+        return "GroupAggregateTransformer";
+    }
+
+    /**
+     * @brief Convert indexed aggregates to group aggregates
+     * @param program Program that is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool convertAggregates(RamProgram& program);
+
+protected:
+    bool transform(RamTranslationUnit& translationUnit) override {
+        return convertAggregates(translationUnit.getProgram());
+    }
+};
+
 /**
  * @class ParallelTransformer
- * @brief Transforms Choice/IndexChoice/IndexScan/Scan into parallel versions.
+ * @brief Transforms Choice/IndexChoice/IndexScan/Scan/Aggregate/IndexAggregate into parallel versions.
  *
  * For example ..
  *
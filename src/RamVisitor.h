@@ -120,7 +120,11 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Choice);
         FORWARD(ParallelIndexChoice);
         FORWARD(IndexChoice);
+        FORWARD(ParallelAggregate);
         FORWARD(Aggregate);
+        FORWARD(GroupAggregate);
+        FORWARD(ParallelIndexAggregate);
+        FORWARD(RangeAggregate);
         FORWARD(IndexAggregate);
 
         // Statements
@@ -128,6 +132,7 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Query);
         FORWARD(Clear);
         FORWARD(LogSize);
+        FORWARD(LogStatistics);
 
         FORWARD(Swap);
         FORWARD(Extend);
@@ -137,6 +142,7 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Sequence);
         FORWARD(Loop);
         FORWARD(Parallel);
+        FORWARD(AdaptiveQuery);
         FORWARD(Exit);
         FORWARD(LogTimer);
         FORWARD(LogRelationTimer);
@@ -164,6 +170,7 @@ protected:
     LINK(Query, Statement);
     LINK(Clear, RelationStatement);
     LINK(LogSize, RelationStatement);
+    LINK(LogStatistics, RelationStatement);
 
     LINK(RelationStatement, Statement);
 
@@ -174,6 +181,7 @@ protected:
     LINK(Sequence, ListStatement);
     LINK(Loop, Statement);
     LINK(Parallel, ListStatement);
+    LINK(AdaptiveQuery, ListStatement);
     LINK(ListStatement, Statement);
     LINK(Exit, Statement);
     LINK(LogTimer, Statement);
@@ -198,6 +206,10 @@ protected:
     LINK(ParallelIndexChoice, IndexChoice);
     LINK(RelationOperation, TupleOperation);
     LINK(Aggregate, RelationOperation);
+    LINK(ParallelAggregate, Aggregate);
+    LINK(GroupAggregate, IndexAggregate);
+    LINK(ParallelIndexAggregate, IndexAggregate);
+    LINK(RangeAggregate, IndexAggregate);
     LINK(IndexAggregate, IndexOperation);
     LINK(IndexOperation, RelationOperation);
     LINK(TupleOperation, NestedOperation);
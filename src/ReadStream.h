@@ -21,17 +21,34 @@
 #include "json11.h"
 #include "utility/MiscUtil.h"
 #include "utility/StringUtil.h"
+#include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <exception>
 #include <map>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace souffle {
 
+namespace detail {
+
+/** Detects relations which build their indexes in bulk from sorted tuples by insertSorted */
+template <typename T, typename = void>
+struct HasInsertSorted : std::false_type {};
+
+template <typename T>
+struct HasInsertSorted<T, std::void_t<decltype(std::declval<T&>().insertSorted(
+                                  std::declval<const RamDomain*>(), std::declval<std::size_t>()))>>
+        : std::true_type {};
+
+}  // namespace detail
+
 class ReadStream : public SerialisationStream<false> {
 protected:
     ReadStream(
@@ -41,15 +58,102 @@ protected:
 public:
     template <typename T>
     void readAll(T& relation) {
-        auto lease = symbolTable.acquireLock();
-        (void)lease;
-        while (const auto next = readNextTuple()) {
-            const RamDomain* ramDomain = next.get();
-            relation.insert(ramDomain);
+        const size_t width = typeAttributes.size();
+        if constexpr (detail::HasInsertSorted<T>::value) {
+            if (width > 0 && isSorted()) {
+                readAllSorted(relation);
+                return;
+            }
+        }
+        std::vector<RamDomain> batch;
+        while (const size_t count = readNextTuples(batch)) {
+            const RamDomain* ramDomain = batch.data();
+            for (size_t i = 0; i < count; ++i, ramDomain += width) {
+                relation.insert(ramDomain);
+            }
         }
     }
 
 protected:
+    /** Maximal number of tuples handed over to the relation at once */
+    static constexpr size_t BATCH_SIZE = 4096;
+
+    /** Whether the tuples are read in lexicographical order, such that they can be loaded in bulk */
+    virtual bool isSorted() const {
+        return false;
+    }
+
+    /** Read all tuples and hand them over to the relation at once, to build its indexes in bulk */
+    template <typename T>
+    void readAllSorted(T& relation) {
+        const size_t width = typeAttributes.size();
+        std::vector<RamDomain> tuples;
+        std::vector<RamDomain> batch;
+        try {
+            while (const size_t count = readNextTuples(batch)) {
+                tuples.insert(tuples.end(), batch.begin(), batch.begin() + count * width);
+            }
+        } catch (...) {
+            relation.insertSorted(tuples.data(), tuples.size() / width);
+            throw;
+        }
+        relation.insertSorted(tuples.data(), tuples.size() / width);
+    }
+
+    /**
+     * Read the next batch of tuples into the given buffer, each tuple occupying
+     * typeAttributes.size() consecutive values.
+     *
+     * If reading fails after some tuples have been read, these tuples are
+     * returned first and the error is raised by the following call; hence
+     * all tuples preceding a malformed one end up in the relation.
+     *
+     * @return the number of tuples read; 0 if the input is exhausted
+     */
+    virtual size_t readNextTuples(std::vector<RamDomain>& batch) {
+        rethrowPendingError();
+        const size_t width = typeAttributes.size();
+        batch.resize(BATCH_SIZE * width);
+        size_t count = 0;
+        try {
+            while (count < BATCH_SIZE && readNextTupleInto(batch.data() + count * width)) {
+                ++count;
+            }
+        } catch (...) {
+            if (count == 0) {
+                throw;
+            }
+            pendingError = std::current_exception();
+        }
+        return count;
+    }
+
+    /**
+     * Read the next tuple into the given buffer of typeAttributes.size() values.
+     *
+     * @return false if no tuple was readable
+     */
+    virtual bool readNextTupleInto(RamDomain* tuple) {
+        const auto next = readNextTuple();
+        if (!next) {
+            return false;
+        }
+        std::copy(next.get(), next.get() + typeAttributes.size(), tuple);
+        return true;
+    }
+
+    /** Raise an error deferred by readNextTuples, if any */
+    void rethrowPendingError() {
+        if (pendingError) {
+            std::exception_ptr error = pendingError;
+            pendingError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    /** An error deferred until the tuples read before it have been inserted */
+    std::exception_ptr pendingError;
+
     /**
      * Read a record from a string.
      *
@@ -0,0 +1,237 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamBinary.h
+ *
+ * Reads relations from binary, column-oriented files (IO=binary).
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BinaryRelationFormat.h"
+#include "RamTypes.h"
+#include "ReadStream.h"
+#include "SymbolTable.h"
+#include "utility/ContainerUtil.h"
+#include "utility/FileUtil.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace souffle {
+
+class RecordTable;
+
+/**
+ * Reads a relation from a binary file written by WriteStreamBinary.
+ *
+ * The file is mapped into memory if possible and the tuples are assembled
+ * directly from its columns; only the symbols of its dictionary are entered
+ * into the symbol table, once each. The tuples are handed over in the order they
+ * were written, i.e., the order of the main index of the written relation, such
+ * that insertions into B-tree indexes of the same order are guided by their hints.
+ * Sorted files whose symbols keep their order in the symbol table are handed over
+ * at once, to be loaded into the indexes in bulk.
+ */
+class ReadStreamBinary : public ReadStream {
+public:
+    ReadStreamBinary(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable)
+            : ReadStream(rwOperation, symbolTable, recordTable), fileName(getFileName(rwOperation)),
+              mapping(fileName) {
+        if (mapping.isMapped()) {
+            contents = mapping.contents();
+        } else {
+            std::ifstream file(fileName, std::ios::in | std::ios::binary);
+            if (!file) {
+                throw std::invalid_argument("Cannot open binary file " + fileName);
+            }
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            contents = buffer;
+        }
+        readHeader();
+        readSymbols();
+    }
+
+protected:
+    bool isSorted() const override {
+        // the tuples stay sorted if the symbols of the dictionary obtain ascending ids
+        if ((header.flags & BinaryRelationHeader::SORTED) == 0) {
+            return false;
+        }
+        return std::adjacent_find(symbols.begin(), symbols.end(), std::greater_equal<RamDomain>()) ==
+               symbols.end();
+    }
+
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(typeAttributes.size());
+        if (!readNextTupleInto(tuple.get())) {
+            return nullptr;
+        }
+        return tuple;
+    }
+
+    bool readNextTupleInto(RamDomain* tuple) override {
+        if (next == header.numTuples) {
+            return false;
+        }
+        for (size_t i = 0; i < columns.size(); ++i) {
+            tuple[i] = getValue(i, next);
+        }
+        ++next;
+        return true;
+    }
+
+    size_t readNextTuples(std::vector<RamDomain>& batch) override {
+        const size_t width = columns.size();
+        const size_t count = std::min<uint64_t>(BATCH_SIZE, header.numTuples - next);
+        batch.resize(count * width);
+
+        // transpose the columns into the batch
+        for (size_t i = 0; i < width; ++i) {
+            const RamDomain* column = columns[i] + next;
+            RamDomain* target = batch.data() + i;
+            if (typeAttributes[i][0] == 's') {
+                for (size_t j = 0; j < count; ++j, target += width) {
+                    *target = symbols[column[j]];
+                }
+            } else {
+                for (size_t j = 0; j < count; ++j, target += width) {
+                    *target = column[j];
+                }
+            }
+        }
+        next += count;
+        return count;
+    }
+
+private:
+    /** Obtain the value of an attribute of a tuple */
+    RamDomain getValue(size_t attribute, uint64_t tuple) const {
+        const RamDomain value = columns[attribute][tuple];
+        return typeAttributes[attribute][0] == 's' ? symbols[value] : value;
+    }
+
+    /** Read and validate the header and locate the columns */
+    void readHeader() {
+        if (contents.size() < sizeof(header)) {
+            throwFormatError("truncated header");
+        }
+        std::memcpy(&header, contents.data(), sizeof(header));
+        if (!header.isCompatible()) {
+            throwFormatError("unsupported format or version");
+        }
+        if (header.width != typeAttributes.size()) {
+            throwFormatError("mismatching arity");
+        }
+        if (header.symbolOffsetsOffset() > contents.size() ||
+                header.numSymbols > (contents.size() - header.symbolOffsetsOffset()) / sizeof(uint64_t) ||
+                header.symbolBytes > contents.size() ||
+                header.numTuples > contents.size() / sizeof(RamDomain) ||
+                header.fileSize() > contents.size()) {
+            throwFormatError("truncated file");
+        }
+        const char* types = contents.data() + BinaryRelationHeader::typesOffset();
+        for (size_t i = 0; i < header.width; ++i) {
+            if (types[i] != typeAttributes[i][0]) {
+                throwFormatError("mismatching attribute types");
+            }
+        }
+        for (size_t i = 0; i < header.width; ++i) {
+            columns.push_back(reinterpret_cast<const RamDomain*>(contents.data() + header.columnOffset(i)));
+        }
+    }
+
+    /** Enter the symbols of the dictionary into the symbol table */
+    void readSymbols() {
+        const auto* offsets =
+                reinterpret_cast<const uint64_t*>(contents.data() + header.symbolOffsetsOffset());
+        const char* data = contents.data() + header.symbolDataOffset();
+        symbols.reserve(header.numSymbols);
+        for (uint64_t i = 0; i < header.numSymbols; ++i) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.symbolBytes) {
+                throwFormatError("corrupt symbol dictionary");
+            }
+            symbols.push_back(
+                    symbolTable.lookup(std::string_view(data + offsets[i], offsets[i + 1] - offsets[i])));
+        }
+
+        // symbol columns may only refer to the dictionary
+        for (size_t i = 0; i < header.width; ++i) {
+            if (typeAttributes[i][0] != 's') {
+                continue;
+            }
+            const RamDomain* column = columns[i];
+            if (std::any_of(column, column + header.numTuples, [&](RamDomain value) {
+                    return value < 0 || static_cast<uint64_t>(value) >= header.numSymbols;
+                })) {
+                throwFormatError("corrupt symbol column");
+            }
+        }
+    }
+
+    [[noreturn]] void throwFormatError(const std::string& reason) const {
+        throw std::invalid_argument("Cannot read binary file " + fileName + ": " + reason);
+    }
+
+    static std::string getFileName(const std::map<std::string, std::string>& rwOperation) {
+        return getOr(rwOperation, "filename", rwOperation.at("name") + ".bin");
+    }
+
+    const std::string fileName;
+
+    /** the mapped file, if it can be mapped */
+    MemoryMappedFile mapping;
+
+    /** the contents of the file, if it cannot be mapped */
+    std::string buffer;
+
+    /** the contents of the file */
+    std::string_view contents;
+
+    BinaryRelationHeader header;
+
+    /** the first value of each column */
+    std::vector<const RamDomain*> columns;
+
+    /** the symbol table entries of the symbols of the dictionary */
+    std::vector<RamDomain> symbols;
+
+    /** the position of the next tuple */
+    uint64_t next = 0;
+};
+
+class ReadBinaryFactory : public ReadStreamFactory {
+public:
+    std::unique_ptr<ReadStream> getReader(const std::map<std::string, std::string>& rwOperation,
+            SymbolTable& symbolTable, RecordTable& recordTable) override {
+        return std::make_unique<ReadStreamBinary>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~ReadBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -19,6 +19,7 @@
 #include "SymbolTable.h"
 #include "utility/ContainerUtil.h"
 #include "utility/FileUtil.h"
+#include "utility/ParallelUtil.h"
 #include "utility/StringUtil.h"
 
 #ifdef USE_LIBZ
@@ -32,11 +33,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace souffle {
@@ -48,12 +52,7 @@ public:
             SymbolTable& symbolTable, RecordTable& recordTable)
             : ReadStream(rwOperation, symbolTable, recordTable),
               delimiter(getOr(rwOperation, "delimiter", "\t")), file(file), lineNumber(0),
-              inputMap(getInputColumnMap(rwOperation, arity)) {
-        while (inputMap.size() < arity) {
-            int size = static_cast<int>(inputMap.size());
-            inputMap[size] = size;
-        }
-    }
+              columnMap(getColumnMap(getInputColumnMap(rwOperation, arity))) {}
 
 protected:
     /**
@@ -63,79 +62,166 @@ protected:
      * @return
      */
     std::unique_ptr<RamDomain[]> readNextTuple() override {
-        if (file.eof()) {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(typeAttributes.size());
+        if (!readNextTupleInto(tuple.get())) {
             return nullptr;
         }
-        std::string line;
-        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(typeAttributes.size());
+        return tuple;
+    }
 
+    bool readNextTupleInto(RamDomain* tuple) override {
+        if (file.eof()) {
+            return false;
+        }
         if (!getline(file, line)) {
-            return nullptr;
+            return false;
         }
+        ++lineNumber;
+
+        std::fill(tuple, tuple + typeAttributes.size(), 0);
+        parseLine(line, lineNumber, tuple, [&](std::string_view element, size_t attribute, size_t) {
+            return readElement(element, typeAttributes.at(attribute));
+        });
+        return true;
+    }
+
+    /**
+     * Split a line into its elements and store them in the given tuple.
+     *
+     * The conversion of each element is delegated to convert(element, attribute, column),
+     * so that callers may postpone the conversion of symbols and records.
+     */
+    template <typename Convert>
+    void parseLine(std::string_view line, size_t lineNumber, RamDomain* tuple, Convert&& convert) const {
         // Handle Windows line endings on non-Windows systems
         if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
+            line.remove_suffix(1);
         }
-        ++lineNumber;
 
         size_t start = 0;
         size_t end = 0;
         size_t columnsFilled = 0;
-        for (uint32_t column = 0; columnsFilled < arity; column++) {
-            size_t charactersRead = 0;
-            std::string element = nextElement(line, start, end);
-            if (inputMap.count(column) == 0) {
+        for (size_t column = 0; columnsFilled < arity; column++) {
+            std::string_view element = nextElement(line, start, end, lineNumber);
+            if (column >= columnMap.size() || columnMap[column] < 0) {
                 continue;
             }
             ++columnsFilled;
 
+            const auto attribute = static_cast<size_t>(columnMap[column]);
             try {
-                auto&& ty = typeAttributes.at(inputMap[column]);
-                switch (ty[0]) {
-                    case 's': {
-                        tuple[inputMap[column]] = symbolTable.unsafeLookup(element);
-                        charactersRead = element.size();
-                        break;
-                    }
-                    case 'r': {
-                        tuple[inputMap[column]] = readRecord(element, ty, 0, &charactersRead);
-                        break;
-                    }
-                    case 'i': {
-                        tuple[inputMap[column]] = RamSignedFromString(element, &charactersRead);
-                        break;
-                    }
-                    case 'u': {
-                        tuple[inputMap[column]] = ramBitCast(readRamUnsigned(element, charactersRead));
-                        break;
-                    }
-                    case 'f': {
-                        tuple[inputMap[column]] = ramBitCast(RamFloatFromString(element, &charactersRead));
-                        break;
-                    }
-                    default: fatal("invalid type attribute: `%c`", ty[0]);
+                tuple[attribute] = convert(element, attribute, column);
+            } catch (...) {
+                throwConversionError(element, column, lineNumber);
+            }
+        }
+    }
+
+    /**
+     * Convert an element of the given type; the whole element must be consumed.
+     */
+    RamDomain readElement(std::string_view element, const std::string& type) {
+        switch (type[0]) {
+            case 's': {
+                return symbolTable.lookup(element);
+            }
+            case 'r': {
+                size_t charactersRead = 0;
+                RamDomain value = readRecord(std::string(element), type, 0, &charactersRead);
+                checkConsumed(element, charactersRead);
+                return value;
+            }
+            default: return readNumber(element, type);
+        }
+    }
+
+    /**
+     * Convert a numeric element of the given type; the whole element must be consumed.
+     * Numbers do not touch the symbol and record tables, hence may be converted concurrently.
+     */
+    RamDomain readNumber(std::string_view element, const std::string& type) const {
+        size_t charactersRead = 0;
+        RamDomain value = 0;
+        switch (type[0]) {
+            case 'i': {
+                RamSigned number;
+                if (readDecimal(element, number)) {
+                    return number;
                 }
-                // Check if everything was read.
-                if (charactersRead != element.size()) {
-                    throw std::invalid_argument(
-                            "Expected: " + delimiter + " or \\n. Got: " + element[charactersRead]);
+                value = RamSignedFromString(std::string(element), &charactersRead);
+                break;
+            }
+            case 'u': {
+                RamUnsigned number;
+                if (readDecimal(element, number)) {
+                    return ramBitCast(number);
                 }
-            } catch (...) {
-                std::stringstream errorMessage;
-                errorMessage << "Error converting <" + element + "> in column " << column + 1 << " in line "
-                             << lineNumber << "; ";
-                throw std::invalid_argument(errorMessage.str());
+                value = ramBitCast(readRamUnsigned(std::string(element), charactersRead));
+                break;
+            }
+            case 'f': {
+                value = ramBitCast(RamFloatFromString(std::string(element), &charactersRead));
+                break;
             }
+            default: fatal("invalid type attribute: `%c`", type[0]);
         }
+        checkConsumed(element, charactersRead);
+        return value;
+    }
 
-        return tuple;
+    /** Check if everything was read. */
+    void checkConsumed(std::string_view element, size_t charactersRead) const {
+        if (charactersRead != element.size()) {
+            throw std::invalid_argument(
+                    "Expected: " + delimiter + " or \\n. Got: " + element[charactersRead]);
+        }
+    }
+
+    /**
+     * Read a plain decimal number (digits with an optional leading minus for
+     * signed types) without allocating.
+     *
+     * @return false if the element is not of this form or out of range; the
+     *         general conversion then decides on the value or the error
+     */
+    template <typename T>
+    static bool readDecimal(std::string_view element, T& value) {
+        bool negative = false;
+        if constexpr (std::is_signed<T>::value) {
+            if (!element.empty() && element[0] == '-') {
+                negative = true;
+                element.remove_prefix(1);
+            }
+        }
+        if (element.empty() || element.size() > std::numeric_limits<T>::digits10) {
+            return false;
+        }
+        T result = 0;
+        for (char c : element) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            result = result * 10 + (c - '0');
+        }
+        if constexpr (std::is_signed<T>::value) {
+            result = negative ? -result : result;
+        }
+        value = result;
+        return true;
+    }
+
+    [[noreturn]] static void throwConversionError(std::string_view element, size_t column, size_t lineNumber) {
+        std::stringstream errorMessage;
+        errorMessage << "Error converting <" << element << "> in column " << column + 1 << " in line "
+                     << lineNumber << "; ";
+        throw std::invalid_argument(errorMessage.str());
     }
 
     /**
      * Read an unsigned element. Possible bases are 2, 10, 16
      * Base is indicated by the first two chars.
      */
-    RamUnsigned readRamUnsigned(const std::string& element, size_t& charactersRead) {
+    RamUnsigned readRamUnsigned(const std::string& element, size_t& charactersRead) const {
         // Sanity check
         assert(element.size() > 0);
 
@@ -152,16 +238,14 @@ protected:
         return value;
     }
 
-    std::string nextElement(const std::string& line, size_t& start, size_t& end) {
-        std::string element;
-
+    std::string_view nextElement(std::string_view line, size_t& start, size_t& end, size_t lineNumber) const {
         // Handle record/tuple delimiter coincidence.
         if (delimiter.find(',') != std::string::npos) {
             int record_parens = 0;
             size_t next_delimiter = line.find(delimiter, start);
 
             // Find first delimiter after the record.
-            while (end < std::min(next_delimiter, line.length()) || record_parens != 0) {
+            while (end < line.length() && (end < next_delimiter || record_parens != 0)) {
                 // Track the number of parenthesis.
                 if (line[end] == '[') {
                     ++record_parens;
@@ -200,7 +284,7 @@ protected:
             throw std::invalid_argument(errorMessage.str());
         }
 
-        element = line.substr(start, end - start);
+        std::string_view element = line.substr(start, end - start);
         start = end + delimiter.size();
 
         return element;
@@ -230,26 +314,69 @@ protected:
         return inputColumnMap;
     }
 
+    /** Flatten a column map into a vector indexed by column; unmapped columns are -1 */
+    static std::vector<int> getColumnMap(const std::map<int, int>& inputColumnMap) {
+        std::vector<int> columns;
+        for (const auto& [column, attribute] : inputColumnMap) {
+            if (column < 0) {
+                continue;
+            }
+            if (columns.size() <= static_cast<size_t>(column)) {
+                columns.resize(column + 1, -1);
+            }
+            columns[column] = attribute;
+        }
+        return columns;
+    }
+
     const std::string delimiter;
     std::istream& file;
     size_t lineNumber;
-    std::map<int, int> inputMap;
+    /** attribute of each column of the input; -1 for columns which are skipped */
+    const std::vector<int> columnMap;
+    /** buffer of the line being parsed */
+    std::string line;
 };
 
+/**
+ * Reads a CSV fact file.
+ *
+ * Uncompressed files are memory-mapped and split into line-aligned chunks
+ * that are parsed in parallel. Numbers are converted by the parallel phase;
+ * symbols and records are resolved afterwards chunk by chunk in file order,
+ * so that symbol and record numbering and the reported errors are the same
+ * as for sequential reading. Other files are read as a stream.
+ */
 class ReadFileCSV : public ReadStreamCSV {
 public:
     ReadFileCSV(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
             RecordTable& recordTable)
             : ReadStreamCSV(fileHandle, rwOperation, symbolTable, recordTable),
               baseName(souffle::baseName(getFileName(rwOperation))),
-              fileHandle(getFileName(rwOperation), std::ios::in | std::ios::binary) {
+              fileHandle(getFileName(rwOperation), std::ios::in | std::ios::binary),
+              mapping(getFileName(rwOperation)) {
         if (!fileHandle.is_open()) {
             throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
         }
+        if (mapping.isMapped()) {
+            remaining = mapping.contents();
+            // compressed files are left to the stream
+            if (remaining.size() >= 2 && remaining[0] == '\x1f' && remaining[1] == '\x8b') {
+                remaining = std::string_view();
+                mapped = false;
+            } else {
+                mapped = true;
+            }
+        }
         // Strip headers if we're using them
         if (getOr(rwOperation, "headers", "false") == "true") {
-            std::string line;
-            getline(file, line);
+            if (mapped) {
+                size_t next = remaining.find('\n');
+                remaining.remove_prefix(next == std::string_view::npos ? remaining.size() : next + 1);
+            } else {
+                std::string line;
+                getline(file, line);
+            }
         }
     }
 
@@ -263,16 +390,185 @@ public:
         try {
             return ReadStreamCSV::readNextTuple();
         } catch (std::exception& e) {
-            std::stringstream errorMessage;
-            errorMessage << e.what();
-            errorMessage << "cannot parse fact file " << baseName << "!\n";
-            throw std::invalid_argument(errorMessage.str());
+            throwFileError(e);
         }
     }
 
     ~ReadFileCSV() override = default;
 
 protected:
+    /** Target size of a chunk of the mapped file in bytes */
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    /** A symbol or record element whose conversion is postponed */
+    struct DeferredElement {
+        std::string_view element;
+        uint32_t attribute;
+        uint32_t column;
+    };
+
+    /** A line-aligned chunk of the mapped file */
+    struct Chunk {
+        std::string_view text;
+        /** the parsed tuples; symbol and record attributes are still to be resolved */
+        std::vector<RamDomain> tuples;
+        /** the postponed elements of all tuples in order */
+        std::vector<DeferredElement> deferred;
+        /** number of tuples parsed */
+        size_t count = 0;
+        /** the first line which failed to parse, if any */
+        bool failed = false;
+        std::string_view failedLine;
+    };
+
+    size_t readNextTuples(std::vector<RamDomain>& batch) override {
+        try {
+            if (!mapped) {
+                return ReadStreamCSV::readNextTuples(batch);
+            }
+            rethrowPendingError();
+            while (nextChunk == chunks.size()) {
+                if (remaining.empty()) {
+                    return 0;
+                }
+                parseChunks();
+            }
+            return resolveChunk(chunks[nextChunk++], batch);
+        } catch (std::exception& e) {
+            throwFileError(e);
+        }
+    }
+
+    bool readNextTupleInto(RamDomain* tuple) override {
+        if (!mapped) {
+            return ReadStreamCSV::readNextTupleInto(tuple);
+        }
+        // unbuffered reading of the next line of the mapped file
+        assert(nextChunk == chunks.size() && "mixing tuple-wise and batched reads");
+        if (remaining.empty()) {
+            return false;
+        }
+        size_t next = remaining.find('\n');
+        std::string_view line = remaining.substr(0, next);
+        remaining.remove_prefix(next == std::string_view::npos ? remaining.size() : next + 1);
+        ++lineNumber;
+
+        std::fill(tuple, tuple + typeAttributes.size(), 0);
+        parseLine(line, lineNumber, tuple, [&](std::string_view element, size_t attribute, size_t) {
+            return readElement(element, typeAttributes.at(attribute));
+        });
+        return true;
+    }
+
+    /**
+     * Split off the next chunks of the mapped file and parse them in parallel.
+     */
+    void parseChunks() {
+        chunks.clear();
+        nextChunk = 0;
+        const size_t numChunks = 4 * MAX_THREADS;
+        while (!remaining.empty() && chunks.size() < numChunks) {
+            size_t next = remaining.size() <= CHUNK_SIZE ? std::string_view::npos
+                                                         : remaining.find('\n', CHUNK_SIZE - 1);
+            size_t length = next == std::string_view::npos ? remaining.size() : next + 1;
+            chunks.emplace_back();
+            chunks.back().text = remaining.substr(0, length);
+            remaining.remove_prefix(length);
+        }
+
+        PARALLEL_START
+            pfor(size_t i = 0; i < chunks.size(); ++i) {
+                parseChunk(chunks[i]);
+            }
+        PARALLEL_END
+    }
+
+    /**
+     * Parse the lines of a chunk, converting all numbers. The parsing stops at
+     * the first malformed line, which is reported when the chunk is resolved.
+     */
+    void parseChunk(Chunk& chunk) const {
+        const size_t width = typeAttributes.size();
+        std::string_view text = chunk.text;
+        while (!text.empty()) {
+            size_t next = text.find('\n');
+            std::string_view line = text.substr(0, next);
+            text.remove_prefix(next == std::string_view::npos ? text.size() : next + 1);
+
+            chunk.tuples.resize((chunk.count + 1) * width, 0);
+            const size_t deferred = chunk.deferred.size();
+            try {
+                // the line number is irrelevant since failed lines are parsed again
+                parseLine(line, 0, chunk.tuples.data() + chunk.count * width,
+                        [&](std::string_view element, size_t attribute, size_t column) -> RamDomain {
+                            const std::string& type = typeAttributes.at(attribute);
+                            if (type[0] == 's' || type[0] == 'r') {
+                                chunk.deferred.push_back({element, static_cast<uint32_t>(attribute),
+                                        static_cast<uint32_t>(column)});
+                                return 0;
+                            }
+                            return readNumber(element, type);
+                        });
+            } catch (...) {
+                chunk.tuples.resize(chunk.count * width);
+                chunk.deferred.resize(deferred);
+                chunk.failed = true;
+                chunk.failedLine = line;
+                return;
+            }
+            ++chunk.count;
+        }
+    }
+
+    /**
+     * Resolve the symbols and records of a parsed chunk and hand over its tuples.
+     */
+    size_t resolveChunk(Chunk& chunk, std::vector<RamDomain>& batch) {
+        const size_t width = typeAttributes.size();
+        const size_t perTuple = chunk.count == 0 ? 0 : chunk.deferred.size() / chunk.count;
+        const size_t firstLine = lineNumber;
+
+        size_t count = 0;
+        try {
+            for (auto cur = chunk.deferred.begin(); count < chunk.count; ++count) {
+                RamDomain* tuple = chunk.tuples.data() + count * width;
+                for (size_t i = 0; i < perTuple; ++i, ++cur) {
+                    try {
+                        tuple[cur->attribute] = readElement(cur->element, typeAttributes[cur->attribute]);
+                    } catch (...) {
+                        throwConversionError(cur->element, cur->column, firstLine + count + 1);
+                    }
+                }
+            }
+            if (chunk.failed) {
+                // parse the failed line again to raise its error
+                std::vector<RamDomain> tuple(width);
+                parseLine(chunk.failedLine, firstLine + count + 1, tuple.data(),
+                        [&](std::string_view element, size_t attribute, size_t) {
+                            return readElement(element, typeAttributes.at(attribute));
+                        });
+            }
+        } catch (...) {
+            if (count == 0) {
+                throw;
+            }
+            pendingError = std::current_exception();
+        }
+        lineNumber += count;
+
+        batch.swap(chunk.tuples);
+        chunk.tuples.clear();
+        chunk.deferred.clear();
+        return count;
+    }
+
+    [[noreturn]] void throwFileError(const std::exception& e) const {
+        std::stringstream errorMessage;
+        errorMessage << e.what();
+        errorMessage << "cannot parse fact file " << baseName << "!\n";
+        throw std::invalid_argument(errorMessage.str());
+    }
+
     static std::string getFileName(const std::map<std::string, std::string>& rwOperation) {
         return getOr(rwOperation, "filename", rwOperation.at("name") + ".facts");
     }
@@ -283,6 +579,16 @@ protected:
 #else
     std::ifstream fileHandle;
 #endif
+    /** the mapped file, if it can be mapped */
+    MemoryMappedFile mapping;
+    /** whether the tuples are read from the mapping */
+    bool mapped = false;
+    /** the part of the mapped file which has not been split into chunks yet */
+    std::string_view remaining;
+    /** the chunks of the current round of parallel parsing */
+    std::vector<Chunk> chunks;
+    /** the next chunk to be resolved */
+    size_t nextChunk = 0;
 };
 
 class ReadCinCSVFactory : public ReadStreamFactory {
@@ -19,6 +19,7 @@
 #include "SymbolTable.h"
 #include "utility/MiscUtil.h"
 #include "utility/StringUtil.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <fstream>
@@ -26,12 +27,21 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sqlite3.h>
 
 namespace souffle {
 class RecordTable;
 
+/**
+ * Reads a relation from an SQLite database.
+ *
+ * If the database was written by Souffle, the tuples are read from the
+ * underlying table of the relation's view rather than the view itself, and
+ * symbols are resolved by their ids; the ids are cached so that each symbol
+ * is looked up once.
+ */
 class ReadStreamSQLite : public ReadStream {
 public:
     ReadStreamSQLite(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
@@ -40,11 +50,13 @@ public:
               relationName(rwOperation.at("name")) {
         openDB();
         checkTableExists();
+        readRawTable = isWrittenBySouffle();
         prepareSelectStatement();
     }
 
     ~ReadStreamSQLite() override {
         sqlite3_finalize(selectStatement);
+        sqlite3_finalize(symbolSelectStatement);
         sqlite3_close(db);
     }
 
@@ -56,28 +68,41 @@ protected:
      * @return
      */
     std::unique_ptr<RamDomain[]> readNextTuple() override {
-        if (sqlite3_step(selectStatement) != SQLITE_ROW) {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(arity + auxiliaryArity);
+        if (!readNextTupleInto(tuple.get())) {
             return nullptr;
         }
+        return tuple;
+    }
 
-        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(arity + auxiliaryArity);
+    bool readNextTupleInto(RamDomain* tuple) override {
+        // note: stepping a finished statement would restart it
+        if (exhausted || sqlite3_step(selectStatement) != SQLITE_ROW) {
+            exhausted = true;
+            return false;
+        }
 
         uint32_t column;
         for (column = 0; column < arity; column++) {
-            std::string element(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, column)));
-
-            if (element.empty()) {
-                element = "n/a";
-            }
-
             try {
                 auto&& ty = typeAttributes.at(column);
                 switch (ty[0]) {
-                    case 's': tuple[column] = symbolTable.unsafeLookup(element); break;
+                    case 's':
+                        tuple[column] = readRawTable
+                                                ? lookupSymbol(sqlite3_column_int64(selectStatement, column))
+                                                : symbolTable.unsafeLookup(getText(selectStatement, column));
+                        break;
                     case 'i':
                     case 'u':
                     case 'f':
-                    case 'r': tuple[column] = RamSignedFromString(element); break;
+                    case 'r':
+                        if (sqlite3_column_type(selectStatement, column) == SQLITE_INTEGER) {
+                            tuple[column] =
+                                    static_cast<RamDomain>(sqlite3_column_int64(selectStatement, column));
+                        } else {
+                            tuple[column] = RamSignedFromString(getText(selectStatement, column));
+                        }
+                        break;
                     default: fatal("invalid type attribute: `%c`", ty[0]);
                 }
             } catch (...) {
@@ -86,8 +111,36 @@ protected:
                 throw std::invalid_argument(errorMessage.str());
             }
         }
+        std::fill(tuple + arity, tuple + arity + auxiliaryArity, 0);
 
-        return tuple;
+        return true;
+    }
+
+    /** Get the text of a column; empty and null values read as "n/a" */
+    static std::string getText(sqlite3_stmt* statement, int column) {
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+        if (text == nullptr || *text == 0) {
+            return "n/a";
+        }
+        return text;
+    }
+
+    /** Get the symbol of a symbol id of the database */
+    RamDomain lookupSymbol(sqlite3_int64 id) {
+        auto pos = symbolCache.find(id);
+        if (pos != symbolCache.end()) {
+            return pos->second;
+        }
+        if (sqlite3_bind_int64(symbolSelectStatement, 1, id) != SQLITE_OK) {
+            throwError("SQLite error in sqlite3_bind_int64: ");
+        }
+        if (sqlite3_step(symbolSelectStatement) != SQLITE_ROW) {
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        const RamDomain symbol = symbolTable.unsafeLookup(getText(symbolSelectStatement, 0));
+        sqlite3_reset(symbolSelectStatement);
+        symbolCache.emplace(id, symbol);
+        return symbol;
     }
 
     void executeSQL(const std::string& sql) {
@@ -114,11 +167,17 @@ protected:
 
     void prepareSelectStatement() {
         std::stringstream selectSQL;
-        selectSQL << "SELECT * FROM '" << relationName << "'";
+        selectSQL << "SELECT * FROM '" << (readRawTable ? "_" : "") << relationName << "'";
         const char* tail = nullptr;
         if (sqlite3_prepare_v2(db, selectSQL.str().c_str(), -1, &selectStatement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
         }
+        if (readRawTable) {
+            const std::string symbolSQL = "SELECT symbol FROM '" + symbolTableName + "' WHERE id = ?;";
+            if (sqlite3_prepare_v2(db, symbolSQL.c_str(), -1, &symbolSelectStatement, &tail) != SQLITE_OK) {
+                throwError("SQLite error in sqlite3_prepare_v2: ");
+            }
+        }
     }
 
     void openDB() {
@@ -131,30 +190,60 @@ protected:
     }
 
     void checkTableExists() {
+        if (!exists("table", relationName) && !exists("view", relationName)) {
+            throw std::invalid_argument("Required table or view does not exist in " + dbFilename +
+                                        " for relation " + relationName);
+        }
+    }
+
+    /** Check whether the database holds a table or view of the given name */
+    bool exists(const std::string& type, const std::string& name) {
         sqlite3_stmt* tableStatement;
-        std::stringstream selectSQL;
-        selectSQL << "SELECT count(*) FROM sqlite_master WHERE type IN ('table', 'view') AND ";
-        selectSQL << " name = '" << relationName << "';";
+        const char* selectSQL = "SELECT count(*) FROM sqlite_master WHERE type = ? AND name = ?;";
         const char* tail = nullptr;
 
-        if (sqlite3_prepare_v2(db, selectSQL.str().c_str(), -1, &tableStatement, &tail) != SQLITE_OK) {
+        if (sqlite3_prepare_v2(db, selectSQL, -1, &tableStatement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
         }
+        sqlite3_bind_text(tableStatement, 1, type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(tableStatement, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+
+        bool found = sqlite3_step(tableStatement) == SQLITE_ROW && sqlite3_column_int(tableStatement, 0) > 0;
+        sqlite3_finalize(tableStatement);
+        return found;
+    }
 
-        if (sqlite3_step(tableStatement) == SQLITE_ROW) {
-            int count = sqlite3_column_int(tableStatement, 0);
-            if (count > 0) {
-                sqlite3_finalize(tableStatement);
-                return;
+    /**
+     * Check whether the relation is the view over a table of symbol ids created by
+     * WriteStreamSQLite, such that the table can be read directly.
+     */
+    bool isWrittenBySouffle() {
+        if (!exists("view", relationName) || !exists("table", "_" + relationName)) {
+            return false;
+        }
+        for (size_t column = 0; column < arity; column++) {
+            if (typeAttributes.at(column)[0] == 's') {
+                return exists("table", symbolTableName);
             }
         }
-        sqlite3_finalize(tableStatement);
-        throw std::invalid_argument(
-                "Required table or view does not exist in " + dbFilename + " for relation " + relationName);
+        return true;
     }
+
     const std::string& dbFilename;
     const std::string& relationName;
+    const std::string symbolTableName = "__SymbolTable";
+
+    /** whether tuples are read from the table underlying the relation's view */
+    bool readRawTable = false;
+
+    /** whether all rows have been read */
+    bool exhausted = false;
+
+    /** symbols of the symbol ids of the database read so far */
+    std::unordered_map<sqlite3_int64, RamDomain> symbolCache;
+
     sqlite3_stmt* selectStatement = nullptr;
+    sqlite3_stmt* symbolSelectStatement = nullptr;
     sqlite3* db = nullptr;
 };
 
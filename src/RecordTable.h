@@ -13,17 +13,28 @@
  * Data container implementing a map between records and their references.
  * Records are separated by arity, i.e., stored in different RecordMaps.
  *
+ * Records of one arity are kept in a flat arena of fixed-stride blocks,
+ * so that record pointers stay stable for the life time of the table.
+ * References are found through a sharded open-addressing hash index that
+ * is probed directly with the record data. Successful lookups and unpack
+ * operations are lock-free; only the insertion of a new record locks the
+ * shard it hashes to.
+ *
  ***********************************************************************/
 
 #pragma once
 
 #include "CompiledTuple.h"
 #include "RamTypes.h"
+#include "utility/ParallelUtil.h"
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -34,108 +45,317 @@ class RecordMap {
     /** arity of record */
     const size_t arity;
 
-    /** hash function for unordered record map */
-    struct RecordHash {
-        std::size_t operator()(std::vector<RamDomain> record) const {
-            std::size_t seed = 0;
-            std::hash<RamDomain> domainHash;
-            for (RamDomain value : record) {
-                seed ^= domainHash(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    /** number of records in the first arena block (as a power of two) */
+    static constexpr size_t BLOCK_BITS = 10;
+
+    /** maximal number of arena blocks; block i holds 2^(BLOCK_BITS + i) records */
+    static constexpr size_t MAX_BLOCKS = 64 - BLOCK_BITS;
+
+    /** number of independently locked shards of the hash index (power of two) */
+    static constexpr size_t NUM_SHARDS = 64;
+
+    /** initial number of slots of the hash table of a shard (power of two) */
+    static constexpr size_t INITIAL_SLOTS = 16;
+
+    /**
+     * A slot of the hash index: the upper 32 bits hold a fragment of the hash
+     * of the record (to skip most mismatches without touching the arena), the
+     * lower 32 bits hold the record reference. A slot value of 0 is empty since
+     * reference 0 is never handed out.
+     */
+    using slot_t = uint64_t;
+
+    /** open-addressing hash table of a shard */
+    struct HashTable {
+        explicit HashTable(size_t capacity)
+                : mask(capacity - 1), slots(std::make_unique<std::atomic<slot_t>[]>(capacity)) {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(0, std::memory_order_relaxed);
             }
-            return seed;
         }
+
+        /** capacity - 1 of the table */
+        const size_t mask;
+
+        /** slots of the table */
+        std::unique_ptr<std::atomic<slot_t>[]> slots;
     };
 
-    /** map from records to references */
-    // TODO (b-scholz): replace vector<RamDomain> with something more memory-frugal
-    std::unordered_map<std::vector<RamDomain>, RamDomain, RecordHash> recordToIndex;
+    /** shard of the hash index */
+    struct Shard {
+        /** the currently active table; readers probe it without locking */
+        std::atomic<HashTable*> table{nullptr};
 
-    /** array of records; index represents record reference */
-    // TODO (b-scholz): replace vector<RamDomain> with something more memory-frugal
-    std::vector<std::vector<RamDomain>> indexToRecord;
+        /** all tables ever installed; outgrown tables are retained for concurrent readers */
+        std::vector<std::unique_ptr<HashTable>> tables;
 
-public:
-    explicit RecordMap(size_t arity) : arity(arity), indexToRecord(1) {}  // note: index 0 element left free
+        /** number of records referenced by this shard */
+        size_t size = 0;
 
-    /** @brief converts record to a record reference */
-    // TODO (b-scholz): replace vector<RamDomain> with something more memory-frugal
-    RamDomain pack(const std::vector<RamDomain>& vector) {
-        RamDomain index;
-#pragma omp critical(record_pack)
-        {
-            auto pos = recordToIndex.find(vector);
-            if (pos != recordToIndex.end()) {
-                index = pos->second;
-            } else {
-#pragma omp critical(record_unpack)
-                {
-                    indexToRecord.push_back(vector);
-                    index = indexToRecord.size() - 1;
-                    recordToIndex[vector] = index;
-
-                    // assert that new index is smaller than the range
-                    assert(index != std::numeric_limits<RamDomain>::max());
-                }
+        /** serialises insertions into this shard */
+        SpinLock lock;
+    };
+
+    /** arena blocks holding the records */
+    std::array<std::atomic<RamDomain*>, MAX_BLOCKS> blocks{};
+
+    /** serialises the allocation of arena blocks */
+    SpinLock blockLock;
+
+    /** next free record reference; note: reference 0 is left free */
+    std::atomic<size_t> next{1};
+
+    /** shards of the hash index */
+    std::array<Shard, NUM_SHARDS> shards;
+
+    /** hash of a record (boost hash-combine followed by a 64-bit finaliser) */
+    uint64_t hash(const RamDomain* record) const {
+        uint64_t seed = arity;
+        for (size_t i = 0; i < arity; ++i) {
+            seed ^= static_cast<uint64_t>(record[i]) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+        }
+        seed ^= seed >> 33;
+        seed *= 0xff51afd7ed558ccdull;
+        seed ^= seed >> 33;
+        seed *= 0xc4ceb9fe1a85ec53ull;
+        seed ^= seed >> 33;
+        return seed;
+    }
+
+    /** obtain the arena location of a record reference */
+    RamDomain* locate(size_t index) const {
+        const size_t n = index + (size_t(1) << BLOCK_BITS);
+        const size_t msb = 63 - __builtin_clzll(n);
+        RamDomain* block = blocks[msb - BLOCK_BITS].load(std::memory_order_acquire);
+        assert(block != nullptr && "Attempting to access non-existing record");
+        return block + (n & ((size_t(1) << msb) - 1)) * arity;
+    }
+
+    /** reserve a fresh record reference and copy the record into the arena */
+    size_t allocate(const RamDomain* record) {
+        const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+
+        // assert that new index is smaller than the range
+        assert(index < static_cast<size_t>(std::numeric_limits<RamDomain>::max()) &&
+                index <= std::numeric_limits<uint32_t>::max());
+
+        // allocate the arena block if not present
+        const size_t blockNum = (63 - __builtin_clzll(index + (size_t(1) << BLOCK_BITS))) - BLOCK_BITS;
+        if (blocks[blockNum].load(std::memory_order_acquire) == nullptr) {
+            blockLock.lock();
+            if (blocks[blockNum].load(std::memory_order_relaxed) == nullptr) {
+                blocks[blockNum].store(
+                        new RamDomain[(size_t(1) << (BLOCK_BITS + blockNum)) * arity],
+                        std::memory_order_release);
             }
+            blockLock.unlock();
+        }
+
+        if (arity > 0) {
+            std::memcpy(locate(index), record, arity * sizeof(RamDomain));
         }
         return index;
     }
 
+    /**
+     * Probe a table for a record; returns the reference or 0 if the record is not
+     * present. On a miss, the position of the empty slot ending the probe sequence
+     * is stored in pos.
+     */
+    RamDomain probe(const HashTable& table, const RamDomain* record, uint64_t h, size_t& pos) const {
+        const slot_t tag = h & 0xffffffff00000000ull;
+        for (pos = (h >> 6) & table.mask;; pos = (pos + 1) & table.mask) {
+            const slot_t slot = table.slots[pos].load(std::memory_order_acquire);
+            if (slot == 0) {
+                return 0;
+            }
+            if ((slot & 0xffffffff00000000ull) == tag) {
+                const auto index = static_cast<size_t>(slot & 0xffffffffull);
+                if (arity == 0 || std::memcmp(locate(index), record, arity * sizeof(RamDomain)) == 0) {
+                    return static_cast<RamDomain>(index);
+                }
+            }
+        }
+    }
+
+    /** double the capacity of the table of a shard; requires the shard lock */
+    void grow(Shard& shard) {
+        const HashTable& old = *shard.table.load(std::memory_order_relaxed);
+        auto table = std::make_unique<HashTable>(2 * (old.mask + 1));
+        for (size_t i = 0; i <= old.mask; ++i) {
+            const slot_t slot = old.slots[i].load(std::memory_order_relaxed);
+            if (slot == 0) {
+                continue;
+            }
+            const uint64_t h = hash(locate(slot & 0xffffffffull));
+            size_t pos = (h >> 6) & table->mask;
+            while (table->slots[pos].load(std::memory_order_relaxed) != 0) {
+                pos = (pos + 1) & table->mask;
+            }
+            table->slots[pos].store(slot, std::memory_order_relaxed);
+        }
+        shard.table.store(table.get(), std::memory_order_release);
+        shard.tables.push_back(std::move(table));
+    }
+
+public:
+    explicit RecordMap(size_t arity) : arity(arity) {
+        for (auto& shard : shards) {
+            shard.tables.push_back(std::make_unique<HashTable>(INITIAL_SLOTS));
+            shard.table.store(shard.tables.back().get(), std::memory_order_relaxed);
+        }
+    }
+
+    RecordMap(const RecordMap&) = delete;
+    RecordMap& operator=(const RecordMap&) = delete;
+
+    ~RecordMap() {
+        for (auto& block : blocks) {
+            delete[] block.load();
+        }
+    }
+
+    /** @brief converts record to a record reference */
+    RamDomain pack(const std::vector<RamDomain>& vector) {
+        assert(vector.size() == arity && "Record of wrong arity");
+        return pack(vector.data());
+    }
+
     /** @brief convert record pointer to a record reference */
     RamDomain pack(const RamDomain* tuple) {
-        // TODO (b-scholz): data is unnecessarily copied
-        // for a successful lookup. To avoid this, we should
-        // compute a hash of the pointer-array and traverse through
-        // the bucket list of the unordered map finding the record.
-        // Note that in case of non-existence, the record still needs to be
-        // copied for the newly created entry but this will be the less
-        // frequent case.
-        std::vector<RamDomain> tmp(arity);
-        for (size_t i = 0; i < arity; i++) {
-            tmp[i] = tuple[i];
+        const uint64_t h = hash(tuple);
+        Shard& shard = shards[h & (NUM_SHARDS - 1)];
+        size_t pos;
+
+        // lock-free lookup; a concurrently outgrown table only yields false negatives
+        if (RamDomain index = probe(*shard.table.load(std::memory_order_acquire), tuple, h, pos)) {
+            return index;
+        }
+
+        // the record is likely to be new => re-probe and insert under the shard lock
+        shard.lock.lock();
+        HashTable* table = shard.table.load(std::memory_order_relaxed);
+        RamDomain index = probe(*table, tuple, h, pos);
+        if (index == 0) {
+            if (2 * (shard.size + 1) > table->mask + 1) {
+                grow(shard);
+                table = shard.table.load(std::memory_order_relaxed);
+                probe(*table, tuple, h, pos);
+            }
+            index = static_cast<RamDomain>(allocate(tuple));
+            table->slots[pos].store(
+                    (h & 0xffffffff00000000ull) | static_cast<slot_t>(index), std::memory_order_release);
+            ++shard.size;
         }
-        return pack(tmp);
+        shard.lock.unlock();
+        return index;
     }
 
     /** @brief convert record reference to a record pointer */
     const RamDomain* unpack(RamDomain index) const {
-        const RamDomain* res;
-#pragma omp critical(record_unpack)
-        res = indexToRecord[index].data();
-        return res;
+        assert(index > 0 && static_cast<size_t>(index) < next.load(std::memory_order_relaxed) &&
+                "Attempting to unpack non-existing record");
+        return locate(index);
+    }
+
+    /** @brief get arity of records in this map */
+    size_t getArity() const {
+        return arity;
+    }
+
+    /** @brief get number of records in this map */
+    size_t size() const {
+        return next.load(std::memory_order_relaxed) - 1;
     }
 };
 
 class RecordTable {
 public:
     RecordTable() = default;
-    virtual ~RecordTable() = default;
+    RecordTable(const RecordTable&) = delete;
+    RecordTable& operator=(const RecordTable&) = delete;
+
+    virtual ~RecordTable() {
+        RecordNode* node = head.load();
+        while (node != nullptr) {
+            RecordNode* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
 
     /** @brief convert record to record reference */
-    RamDomain pack(RamDomain* tuple, size_t arity) {
+    RamDomain pack(const RamDomain* tuple, size_t arity) {
         return lookupArity(arity).pack(tuple);
     }
     /** @brief convert record reference to a record */
     const RamDomain* unpack(RamDomain ref, size_t arity) const {
-        auto iter = maps.find(arity);
-        assert(iter != maps.end() && "Attempting to unpack non-existing record");
-        return (iter->second).unpack(ref);
+        const RecordMap* map = findArity(arity);
+        assert(map != nullptr && "Attempting to unpack non-existing record");
+        return map->unpack(ref);
+    }
+
+    /** @brief get the arities of the records in the table */
+    std::vector<size_t> getArities() const {
+        std::vector<size_t> arities;
+        for (RecordNode* node = head.load(std::memory_order_acquire); node != nullptr; node = node->next) {
+            arities.push_back(node->map.getArity());
+        }
+        return arities;
+    }
+
+    /** @brief get number of records of a given arity; their references are 1 to this number */
+    size_t size(size_t arity) const {
+        const RecordMap* map = findArity(arity);
+        return map == nullptr ? 0 : map->size();
     }
 
 private:
+    /** list node associating an arity with its RecordMap */
+    struct RecordNode {
+        explicit RecordNode(size_t arity) : map(arity) {}
+        RecordMap map;
+        RecordNode* next = nullptr;
+    };
+
+    /** @brief find the RecordMap for a given arity; returns nullptr if it does not exist */
+    const RecordMap* findArity(size_t arity) const {
+        for (RecordNode* node = head.load(std::memory_order_acquire); node != nullptr; node = node->next) {
+            if (node->map.getArity() == arity) {
+                return &node->map;
+            }
+        }
+        return nullptr;
+    }
+
     /** @brief lookup RecordMap for a given arity; if it does not exist, create new RecordMap */
     RecordMap& lookupArity(size_t arity) {
-        std::unordered_map<size_t, RecordMap>::iterator mapsIterator;
-#pragma omp critical(RecordTableGetForArity)
-        {
-            // This will create a new map if it doesn't exist yet.
-            mapsIterator = maps.emplace(arity, arity).first;
+        if (const RecordMap* map = findArity(arity)) {
+            return const_cast<RecordMap&>(*map);
+        }
+
+        // publish a new map unless another thread has added one for this arity in the mean-time
+        auto* node = new RecordNode(arity);
+        node->next = head.load(std::memory_order_acquire);
+        while (true) {
+            for (RecordNode* cur = node->next; cur != nullptr; cur = cur->next) {
+                if (cur->map.getArity() == arity) {
+                    delete node;
+                    return cur->map;
+                }
+            }
+            if (head.compare_exchange_weak(
+                        node->next, node, std::memory_order_release, std::memory_order_acquire)) {
+                return node->map;
+            }
         }
-        return mapsIterator->second;
     }
 
-    /** Arity/RecordMap association */
-    std::unordered_map<size_t, RecordMap> maps;
+    /**
+     * Arity/RecordMap association; programs use only a handful of arities, hence
+     * a lock-free list that is only ever prepended to is sufficient.
+     */
+    std::atomic<RecordNode*> head{nullptr};
 };
 
 /** @brief helper to convert tuple to record reference for the synthesiser */
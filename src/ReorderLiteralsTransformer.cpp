@@ -26,10 +26,13 @@
 #include "AstUtils.h"
 #include "AstVisitor.h"
 #include "Global.h"
+#include "PrecedenceGraph.h"
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <set>
 #include <string>
 #include <utility>
@@ -47,6 +50,23 @@ inline bool isProposition(const AstAtom* atom) {
     return atom->getArguments().empty();
 }
 
+/**
+ * Checks whether all variables of an argument are bound.
+ */
+bool isBoundArgument(const AstArgument* arg, const std::set<std::string>& boundVariables) {
+    // argument is bound iff all contained variables are bound
+    bool isBound = true;
+
+    visitDepthFirst(*arg, [&](const AstVariable& var) {
+        if (boundVariables.find(var.getName()) == boundVariables.end()) {
+            // found an unbound variable, so argument is unbound
+            isBound = false;
+        }
+    });
+
+    return isBound;
+}
+
 /**
  * Counts the number of bound arguments in a given atom.
  */
@@ -54,17 +74,7 @@ unsigned int numBoundArguments(const AstAtom* atom, const std::set<std::string>&
     int count = 0;
 
     for (const AstArgument* arg : atom->getArguments()) {
-        // argument is bound iff all contained variables are bound
-        bool isBound = true;
-
-        visitDepthFirst(*arg, [&](const AstVariable& var) {
-            if (boundVariables.find(var.getName()) == boundVariables.end()) {
-                // found an unbound variable, so argument is unbound
-                isBound = false;
-            }
-        });
-
-        if (isBound) {
+        if (isBoundArgument(arg, boundVariables)) {
             count++;
         }
     }
@@ -356,6 +366,143 @@ AstClause* reorderClauseWithSips(sips_t sipsFunction, AstClause* clause) {
     return changeNeeded ? reorderAtoms(clause, newOrdering) : nullptr;
 }
 
+/**
+ * Checks whether an ordering keeps all atoms in place.
+ */
+bool isIdentity(const std::vector<unsigned int>& ordering) {
+    for (unsigned int i = 0; i < ordering.size(); i++) {
+        if (ordering[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Estimates the number of tuples of an atom that match a binding of the given variables.
+ *
+ * The estimate is the size of the relation in the profile divided by the number of distinct
+ * values of each bound attribute, assuming that the attributes are independent. As the index
+ * selection provides an index for every search signature, each bound attribute narrows down
+ * the lookup. A delta atom ranges over the new tuples of an average iteration.
+ */
+double estimateMatches(const AstAtom* atom, bool delta, const std::set<std::string>& boundVariables,
+        AstProfileUse& profileUse) {
+    const AstQualifiedName& name = atom->getQualifiedName();
+    double size = profileUse.getRelationSize(name);
+    if (delta) {
+        size /= std::max<size_t>(1, profileUse.getIterations(name));
+    }
+    if (isProposition(atom)) {
+        return std::min(size, 1.0);
+    }
+
+    double matches = size;
+    std::vector<AstArgument*> args = atom->getArguments();
+    for (size_t i = 0; i < args.size(); i++) {
+        if (dynamic_cast<AstUnnamedVariable*>(args[i]) != nullptr ||
+                !isBoundArgument(args[i], boundVariables)) {
+            continue;
+        }
+        double distinct = profileUse.getDistinctValues(name, i);
+        if (distinct == 0) {
+            // without statistics, assume that the attributes together form a key
+            distinct = std::pow(size, 1.0 / args.size());
+        }
+        matches /= std::max(1.0, std::min(distinct, size));
+    }
+    return matches;
+}
+
+/**
+ * Finds the ordering of a vector of atoms with the least estimated cost: the number of
+ * lookups and intermediate tuples of the join. The atom at the delta position, if any,
+ * ranges over the new tuples of an iteration.
+ *
+ * Small bodies are ordered exhaustively by dynamic programming over the subsets of atoms,
+ * larger ones greedily by the least number of matching tuples.
+ */
+std::vector<unsigned int> getCostBasedOrder(
+        const std::vector<AstAtom*>& atoms, int delta, AstProfileUse& profileUse) {
+    const size_t maxExhaustive = 10;
+    size_t n = atoms.size();
+
+    if (n > maxExhaustive) {
+        auto costSips = [&](std::vector<AstAtom*> remaining, const std::set<std::string>& boundVariables) {
+            double currLeast = -1;
+            unsigned int currLeastIdx = 0U;
+            for (unsigned int i = 0; i < remaining.size(); i++) {
+                if (remaining[i] == nullptr) {
+                    // already processed - move on
+                    continue;
+                }
+                bool isDelta = static_cast<int>(i) == delta;
+                double matches = estimateMatches(remaining[i], isDelta, boundVariables, profileUse);
+                if (currLeast < 0 || matches < currLeast) {
+                    currLeast = matches;
+                    currLeastIdx = i;
+                }
+            }
+            return currLeastIdx;
+        };
+        return applySips(costSips, atoms);
+    }
+
+    // the variables bound by each atom
+    std::vector<std::set<std::string>> atomVariables(n);
+    for (size_t i = 0; i < n; i++) {
+        visitDepthFirst(*atoms[i], [&](const AstVariable& var) { atomVariables[i].insert(var.getName()); });
+    }
+
+    // the cheapest ordering of each subset of atoms
+    struct Plan {
+        double cost;
+        double tuples;
+        std::vector<unsigned int> ordering;
+    };
+    std::vector<Plan> best(1U << n, {std::numeric_limits<double>::infinity(), 0, {}});
+    best[0] = {0, 1, {}};
+    for (size_t subset = 0; subset < best.size(); subset++) {
+        const Plan& plan = best[subset];
+        std::set<std::string> boundVariables;
+        for (unsigned int i : plan.ordering) {
+            boundVariables.insert(atomVariables[i].begin(), atomVariables[i].end());
+        }
+        for (unsigned int i = 0; i < n; i++) {
+            if ((subset & (1U << i)) != 0) {
+                continue;
+            }
+            bool isDelta = static_cast<int>(i) == delta;
+            double tuples = plan.tuples * estimateMatches(atoms[i], isDelta, boundVariables, profileUse);
+            double cost = plan.cost + plan.tuples + tuples;
+            Plan& next = best[subset | (1U << i)];
+            if (cost < next.cost) {
+                next = {cost, tuples, plan.ordering};
+                next.ordering.push_back(i);
+            }
+        }
+    }
+
+    // keep the current ordering unless the cost model finds a cheaper one
+    const Plan& cheapest = best.back();
+    double currentCost = 0;
+    double currentTuples = 1;
+    std::set<std::string> boundVariables;
+    for (unsigned int i = 0; i < n; i++) {
+        bool isDelta = static_cast<int>(i) == delta;
+        double tuples = currentTuples * estimateMatches(atoms[i], isDelta, boundVariables, profileUse);
+        currentCost += currentTuples + tuples;
+        currentTuples = tuples;
+        boundVariables.insert(atomVariables[i].begin(), atomVariables[i].end());
+    }
+    if (cheapest.cost < currentCost) {
+        return cheapest.ordering;
+    }
+    std::vector<unsigned int> ordering(n);
+    std::iota(ordering.begin(), ordering.end(), 0U);
+    return ordering;
+}
+
 bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit) {
     bool changed = false;
     AstProgram& program = *translationUnit.getProgram();
@@ -390,59 +537,57 @@ bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit)
     }
 
     // --- profile-guided reordering ---
+    // ordering is based on the cost model of the relation statistics of the given profile
     if (Global::config().has("profile-use")) {
-        // parse supplied profile information
         auto* profileUse = translationUnit.getAnalysis<AstProfileUse>();
+        auto* sccGraph = translationUnit.getAnalysis<SCCGraph>();
+        auto* recursiveClauses = translationUnit.getAnalysis<RecursiveClauses>();
 
-        auto profilerSips = [&](std::vector<AstAtom*> atoms, const std::set<std::string>& boundVariables) {
-            // Goal: reorder based on the given profiling information
-            // Metric: cost(atom_R) = log(|atom_R|) * #free/#args
-            //         - exception: propositions are prioritised
-
-            double currOptimalVal = -1;
-            unsigned int currOptimalIdx = 0U;
-            bool set = false;
-
-            for (unsigned int i = 0; i < atoms.size(); i++) {
-                const AstAtom* currAtom = atoms[i];
+        // change the ordering of literals within clauses
+        std::vector<AstClause*> clausesToRemove;
 
-                if (currAtom == nullptr) {
-                    // already processed - move on
+        for (const AstRelation* rel : program.getRelations()) {
+            for (AstClause* clause : getClauses(program, *rel)) {
+                // ignore clauses with fixed execution plans
+                if (clause->getExecutionPlan() != nullptr) {
                     continue;
                 }
-
-                if (isProposition(currAtom)) {
-                    // prioritise propositions
-                    return i;
+                std::vector<AstAtom*> atoms = getBodyLiterals<AstAtom>(*clause);
+
+                if (!recursiveClauses->recursive(clause)) {
+                    std::vector<unsigned int> newOrdering = getCostBasedOrder(atoms, -1, *profileUse);
+                    if (!isIdentity(newOrdering)) {
+                        // reordering needed - swap around
+                        clausesToRemove.push_back(clause);
+                        program.addClause(std::unique_ptr<AstClause>(reorderAtoms(clause, newOrdering)));
+                    }
+                    continue;
                 }
 
-                // calculate log(|R|) * #free/#args
-                int numBound = numBoundArguments(currAtom, boundVariables);
-                int numArgs = currAtom->getArity();
-                int numFree = numArgs - numBound;
-                double value = log(profileUse->getRelationSize(currAtom->getQualifiedName()));
-                value *= (numFree * 1.0) / numArgs;
-
-                if (!set || value < currOptimalVal) {
-                    set = true;
-                    currOptimalVal = value;
-                    currOptimalIdx = i;
+                // each version of a recursive clause ranges over the new tuples of another atom of the SCC,
+                // and is ordered separately by an execution plan
+                auto plan = std::make_unique<AstExecutionPlan>();
+                bool planned = false;
+                int version = 0;
+                for (size_t i = 0; i < atoms.size(); i++) {
+                    if (sccGraph->getSCC(getAtomRelation(atoms[i], &program)) != sccGraph->getSCC(rel)) {
+                        continue;
+                    }
+                    std::vector<unsigned int> newOrdering = getCostBasedOrder(atoms, i, *profileUse);
+                    if (!isIdentity(newOrdering)) {
+                        // execution plans number atoms from 1
+                        for (unsigned int& pos : newOrdering) {
+                            pos++;
+                        }
+                        plan->setOrderFor(version,
+                                std::make_unique<AstExecutionOrder>(newOrdering, clause->getSrcLoc()));
+                        planned = true;
+                    }
+                    version++;
                 }
-            }
-
-            return currOptimalIdx;
-        };
-
-        // change the ordering of literals within clauses
-        std::vector<AstClause*> clausesToRemove;
-
-        for (const AstRelation* rel : program.getRelations()) {
-            for (AstClause* clause : getClauses(program, *rel)) {
-                AstClause* newClause = reorderClauseWithSips(profilerSips, clause);
-                if (newClause != nullptr) {
-                    // reordering needed - swap around
-                    clausesToRemove.push_back(clause);
-                    program.addClause(std::unique_ptr<AstClause>(newClause));
+                if (planned) {
+                    clause->setExecutionPlan(std::move(plan));
+                    changed = true;
                 }
             }
         }
@@ -34,6 +34,7 @@
 namespace souffle {
 
 class tuple;
+class tuple_view;
 
 /**
  * Object-oriented wrapper class for Souffle's templatized relations.
@@ -102,6 +103,27 @@ protected:
          */
         virtual tuple& operator*() = 0;
 
+        /**
+         * Return the elements of the tuple that is pointed to by the iterator_base.
+         * The elements remain valid until the iterator_base is advanced. The default
+         * implementation materialises the tuple; child classes may return the stored elements.
+         *
+         * @return Pointer to the elements of the tuple
+         */
+        virtual const RamDomain* data();
+
+        /**
+         * Copy the elements of consecutive tuples into a buffer, advancing the iterator_base
+         * until it equals end or maxTuples tuples are copied.
+         *
+         * @param buffer Row-major buffer of at least maxTuples * arity elements
+         * @param maxTuples Maximal number of tuples to copy
+         * @param arity Number of elements of a tuple
+         * @param end Reference to the iterator_base at which to stop
+         * @return Number of copied tuples
+         */
+        virtual size_t read(RamDomain* buffer, size_t maxTuples, size_t arity, const iterator_base& end);
+
         /**
          * Overload the "==" operator.
          *
@@ -234,6 +256,16 @@ public:
             return *(*iter);
         }
 
+        /**
+         * Return the elements of the tuple that the iterator is pointing to without copying them.
+         * The elements remain valid until the iterator is advanced.
+         *
+         * @return Pointer to the elements of the tuple
+         */
+        const RamDomain* data() const {
+            return iter->data();
+        }
+
         /**
          * Overload the "==" operator.
          *
@@ -258,8 +290,17 @@ public:
         bool operator!=(const iterator& o) const {
             return !(*this == o);
         }
+
+        friend class Relation;
     };
 
+    class view_iterator;
+
+    /**
+     * Range of tuple views over all tuples of a relation.
+     */
+    class view_range;
+
     /**
      * Insert a new tuple into the relation.
      * The definition of insert function has to be defined by the child class of relation class.
@@ -336,6 +377,83 @@ public:
      */
     virtual size_t getArity() const = 0;
 
+    /**
+     * Return the range of tuples whose bound elements lie between the given bounds.
+     *
+     * Elements and bounds are given in their internal representation, i.e., symbols by their number
+     * in the symbol table, and are compared as signed numbers. Relations look the bound elements up
+     * in one of their indexes if they have an index starting with the bound columns, such that the
+     * lookup takes logarithmic time. Otherwise, the default implementation filters a scan of the
+     * relation.
+     *
+     * @param low Reference to the lower bounds of the elements
+     * @param high Reference to the upper bounds of the elements
+     * @param bound Reference to the flags stating which elements are bound
+     * @return Pair of iterators delimiting the range
+     */
+    virtual std::pair<iterator, iterator> lowerUpperBound(const std::vector<RamDomain>& low,
+            const std::vector<RamDomain>& high, const std::vector<bool>& bound) const;
+
+    /**
+     * Return the range of tuples whose bound elements equal those of the given pattern.
+     * For example, for a binary relation, equalRange({x, 0}, {true, false}) yields all tuples
+     * whose first element is x.
+     *
+     * @param pattern Reference to the values of the elements; values of unbound elements are ignored
+     * @param bound Reference to the flags stating which elements are bound
+     * @return Pair of iterators delimiting the range
+     */
+    std::pair<iterator, iterator> equalRange(
+            const std::vector<RamDomain>& pattern, const std::vector<bool>& bound) const {
+        return lowerUpperBound(pattern, pattern, bound);
+    }
+
+    /**
+     * Return the range of tuples whose leading elements equal the given prefix.
+     *
+     * @param prefix Reference to the values of the leading elements
+     * @return Pair of iterators delimiting the range
+     */
+    std::pair<iterator, iterator> prefixRange(const std::vector<RamDomain>& prefix) const {
+        assert(prefix.size() <= getArity() && "prefix exceeds the arity of the relation");
+        std::vector<RamDomain> pattern(prefix);
+        pattern.resize(getArity());
+        std::vector<bool> bound(getArity(), false);
+        std::fill_n(bound.begin(), prefix.size(), true);
+        return equalRange(pattern, bound);
+    }
+
+    /**
+     * Return a range of views over the tuples of the relation.
+     * In contrast to the iterator, a view refers to the stored elements of a tuple rather than a copy.
+     * For example, "for (tuple_view t : relation.views()) { ... t.getSigned(0) ... }".
+     *
+     * @return Range of tuple views
+     */
+    view_range views() const;
+
+    /**
+     * Copy the elements of the tuples from the position of an iterator into a caller-provided buffer.
+     * The iterator is advanced past the copied tuples, such that a relation is read in batches by
+     * calling read until it returns 0.
+     *
+     * @param it Reference to the iterator to read from
+     * @param end Reference to the iterator at which to stop
+     * @param buffer Row-major buffer of at least maxTuples * getArity() elements
+     * @param maxTuples Maximal number of tuples to copy
+     * @return Number of copied tuples
+     */
+    size_t read(iterator& it, const iterator& end, RamDomain* buffer, size_t maxTuples) const {
+        return it.iter->read(buffer, maxTuples, getArity(), *end.iter);
+    }
+
+    /**
+     * Export the tuples of the relation column by column.
+     *
+     * @return A vector per attribute holding the elements of all tuples in iteration order
+     */
+    std::vector<std::vector<RamDomain>> exportColumns() const;
+
     /**
      * Return the number of auxiliary attributes. Auxiliary attributes
      * are used for provenance and and other alternative evaluation
@@ -388,6 +506,25 @@ public:
      * in the table, set the next element pointer points to the current element itself.
      */
     virtual void purge() = 0;
+
+protected:
+    /**
+     * Iterator filtering the tuples of a scan by lower and upper bounds of their elements.
+     */
+    class bound_filter;
+
+    /**
+     * Check whether the bound elements of a query are bound to single values.
+     */
+    static bool isEqualityQuery(const std::vector<RamDomain>& low, const std::vector<RamDomain>& high,
+            const std::vector<bool>& bound) {
+        for (size_t i = 0; i < bound.size(); i++) {
+            if (bound[i] && low[i] != high[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
 };
 
 /**
@@ -648,6 +785,280 @@ public:
     }
 };
 
+/**
+ * A view of a tuple stored in a relation.
+ *
+ * In contrast to a tuple, a view does not own the elements of the tuple but refers to the
+ * elements stored by the relation. Hence, it is cheap to create but only remains valid until
+ * the iterator it was obtained from is advanced. Elements are accessed by their position and
+ * type, rather than through the stream operators of a tuple.
+ */
+class tuple_view {
+    /**
+     * The relation to which the tuple belongs.
+     */
+    const Relation* relation;
+
+    /**
+     * The elements of the tuple.
+     */
+    const RamDomain* base;
+
+    /**
+     * The number of elements of the tuple.
+     */
+    size_t arity;
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param relation Reference to the relation to which the tuple belongs
+     * @param base Pointer to the elements of the tuple
+     */
+    tuple_view(const Relation& relation, const RamDomain* base)
+            : relation(&relation), base(base), arity(relation.getArity()) {}
+
+    /**
+     * Get the reference to the relation to which the tuple belongs.
+     *
+     * @return Reference to a relation.
+     */
+    const Relation& getRelation() const {
+        return *relation;
+    }
+
+    /**
+     * Return the number of elements in the tuple.
+     *
+     * @return the number of elements in the tuple (size_t).
+     */
+    size_t size() const {
+        return arity;
+    }
+
+    /**
+     * Return the elements of the tuple in their internal representation.
+     */
+    const RamDomain* data() const {
+        return base;
+    }
+
+    const RamDomain* begin() const {
+        return base;
+    }
+
+    const RamDomain* end() const {
+        return base + arity;
+    }
+
+    /**
+     * Return the element in idx position of a tuple in its internal representation.
+     *
+     * @param idx This is the idx of element in a tuple (size_t).
+     */
+    RamDomain operator[](size_t idx) const {
+        assert(idx < arity && "exceeded tuple's size");
+        return base[idx];
+    }
+
+    /**
+     * Return the signed number in idx position of the tuple.
+     */
+    RamSigned getSigned(size_t idx) const {
+        assert(idx < arity && "exceeded tuple's size");
+        assert((*relation->getAttrType(idx) == 'i' || *relation->getAttrType(idx) == 'r') &&
+                "wrong element type");
+        return base[idx];
+    }
+
+    /**
+     * Return the unsigned number in idx position of the tuple.
+     */
+    RamUnsigned getUnsigned(size_t idx) const {
+        assert(idx < arity && "exceeded tuple's size");
+        assert((*relation->getAttrType(idx) == 'u') && "wrong element type");
+        return ramBitCast<RamUnsigned>(base[idx]);
+    }
+
+    /**
+     * Return the float in idx position of the tuple.
+     */
+    RamFloat getFloat(size_t idx) const {
+        assert(idx < arity && "exceeded tuple's size");
+        assert((*relation->getAttrType(idx) == 'f') && "wrong element type");
+        return ramBitCast<RamFloat>(base[idx]);
+    }
+
+    /**
+     * Return the symbol in idx position of the tuple.
+     */
+    const std::string& getSymbol(size_t idx) const {
+        assert(idx < arity && "exceeded tuple's size");
+        assert((*relation->getAttrType(idx) == 's') && "wrong element type");
+        return relation->getSymbolTable().resolve(base[idx]);
+    }
+};
+
+/**
+ * Iterator yielding a view of each tuple of a relation.
+ */
+class Relation::view_iterator {
+    iterator it;
+    const Relation* relation;
+
+public:
+    view_iterator(iterator it, const Relation& relation) : it(std::move(it)), relation(&relation) {}
+
+    tuple_view operator*() const {
+        return tuple_view(*relation, it.data());
+    }
+
+    view_iterator& operator++() {
+        ++it;
+        return *this;
+    }
+
+    bool operator==(const view_iterator& o) const {
+        return it == o.it;
+    }
+
+    bool operator!=(const view_iterator& o) const {
+        return it != o.it;
+    }
+};
+
+class Relation::view_range {
+    view_iterator first;
+    view_iterator last;
+
+public:
+    view_range(view_iterator first, view_iterator last) : first(std::move(first)), last(std::move(last)) {}
+
+    const view_iterator& begin() const {
+        return first;
+    }
+
+    const view_iterator& end() const {
+        return last;
+    }
+};
+
+inline const RamDomain* Relation::iterator_base::data() {
+    return (**this).data;
+}
+
+inline size_t Relation::iterator_base::read(
+        RamDomain* buffer, size_t maxTuples, size_t arity, const iterator_base& end) {
+    size_t n = 0;
+    for (; n < maxTuples && !(*this == end); ++n, ++(*this)) {
+        std::copy_n(data(), arity, buffer + n * arity);
+    }
+    return n;
+}
+
+inline Relation::view_range Relation::views() const {
+    return view_range(view_iterator(begin(), *this), view_iterator(end(), *this));
+}
+
+inline std::vector<std::vector<RamDomain>> Relation::exportColumns() const {
+    const size_t arity = getArity();
+    std::vector<std::vector<RamDomain>> columns(arity, std::vector<RamDomain>(size()));
+    if (arity == 0) {
+        return columns;
+    }
+
+    // transpose batches of tuples into the columns
+    const size_t batchSize = 1024;
+    std::vector<RamDomain> buffer(batchSize * arity);
+    iterator it = begin();
+    const iterator last = end();
+    size_t count = 0;
+    while (size_t n = read(it, last, buffer.data(), batchSize)) {
+        for (size_t i = 0; i < arity; i++) {
+            RamDomain* column = columns[i].data() + count;
+            for (size_t j = 0; j < n; j++) {
+                column[j] = buffer[j * arity + i];
+            }
+        }
+        count += n;
+    }
+    return columns;
+}
+
+class Relation::bound_filter : public Relation::iterator_base {
+    /** Current position of the scan */
+    iterator cur;
+
+    /** End of the scan */
+    iterator end;
+
+    /** Lower bounds of the elements */
+    std::vector<RamDomain> low;
+
+    /** Upper bounds of the elements */
+    std::vector<RamDomain> high;
+
+    /** Flags stating which elements are bound */
+    std::vector<bool> bound;
+
+    /** Skip tuples not within the bounds */
+    void skip() {
+        while (cur != end && !matches(cur.data())) {
+            ++cur;
+        }
+    }
+
+    bool matches(const RamDomain* t) const {
+        for (size_t i = 0; i < bound.size(); i++) {
+            if (bound[i] && (t[i] < low[i] || high[i] < t[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    bound_filter(iterator begin, iterator end, std::vector<RamDomain> low, std::vector<RamDomain> high,
+            std::vector<bool> bound)
+            : iterator_base(0), cur(std::move(begin)), end(std::move(end)), low(std::move(low)),
+              high(std::move(high)), bound(std::move(bound)) {
+        skip();
+    }
+
+    void operator++() override {
+        ++cur;
+        skip();
+    }
+
+    tuple& operator*() override {
+        return *cur;
+    }
+
+    const RamDomain* data() override {
+        return cur.data();
+    }
+
+    iterator_base* clone() const override {
+        return new bound_filter(*this);
+    }
+
+protected:
+    bool equal(const iterator_base& o) const override {
+        const auto* other = dynamic_cast<const bound_filter*>(&o);
+        return other != nullptr && cur == other->cur;
+    }
+};
+
+inline std::pair<Relation::iterator, Relation::iterator> Relation::lowerUpperBound(
+        const std::vector<RamDomain>& low, const std::vector<RamDomain>& high,
+        const std::vector<bool>& bound) const {
+    assert(low.size() == getArity() && high.size() == getArity() && bound.size() == getArity() &&
+            "query does not match the arity of the relation");
+    return {iterator(new bound_filter(begin(), end(), low, high, bound)),
+            iterator(new bound_filter(end(), end(), {}, {}, {}))};
+}
+
 /**
  * Abstract base class for generated Datalog programs.
  */
@@ -12,6 +12,13 @@
  *
  * Data container to store symbols of the Datalog program.
  *
+ * Symbols are interned exactly once in an append-only arena of strings
+ * whose addresses never change; the dense index of a symbol is its
+ * position in this arena. Symbols are found through a sharded
+ * open-addressing hash index probed with string views. Resolving an index
+ * and looking up an existing symbol do not lock; only inserting a new
+ * symbol locks the shard the symbol hashes to.
+ *
  ***********************************************************************/
 
 #pragma once
@@ -20,13 +27,18 @@
 #include "utility/MiscUtil.h"
 #include "utility/ParallelUtil.h"
 #include "utility/StreamUtil.h"
-#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <cstdlib>
-#include <deque>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -41,143 +53,370 @@ namespace souffle {
  */
 class SymbolTable {
 private:
-    /** A lock to synchronize parallel accesses */
+    /** number of symbols in the first arena block (as a power of two) */
+    static constexpr size_t BLOCK_BITS = 10;
+
+    /** maximal number of arena blocks; block i holds 2^(BLOCK_BITS + i) symbols */
+    static constexpr size_t MAX_BLOCKS = 64 - BLOCK_BITS;
+
+    /** number of independently locked shards of the hash index (power of two) */
+    static constexpr size_t NUM_SHARDS = 64;
+
+    /** initial number of slots of the hash table of a shard (power of two) */
+    static constexpr size_t INITIAL_SLOTS = 16;
+
+    /**
+     * A slot of the hash index: the upper 32 bits hold a fragment of the hash
+     * of the symbol, the lower 32 bits hold the index of the symbol plus one.
+     * A slot value of 0 is empty.
+     */
+    using slot_t = uint64_t;
+
+    /** open-addressing hash table of a shard */
+    struct HashTable {
+        explicit HashTable(size_t capacity)
+                : mask(capacity - 1), slots(std::make_unique<std::atomic<slot_t>[]>(capacity)) {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /** capacity - 1 of the table */
+        const size_t mask;
+
+        /** slots of the table */
+        std::unique_ptr<std::atomic<slot_t>[]> slots;
+    };
+
+    /** shard of the hash index */
+    struct Shard {
+        /** the currently active table; readers probe it without locking */
+        std::atomic<HashTable*> table{nullptr};
+
+        /** all tables ever installed; outgrown tables are retained for concurrent readers */
+        std::vector<std::unique_ptr<HashTable>> tables;
+
+        /** number of symbols referenced by this shard */
+        size_t size = 0;
+
+        /** serialises insertions into this shard */
+        SpinLock lock;
+    };
+
+    /** A lock to synchronize accesses of clients that require exclusive access */
     mutable Lock access;
 
-    /** Map indices to strings. */
-    std::deque<std::string> numToStr;
+    /** arena blocks holding the symbols; a symbol's index is its position in the arena */
+    std::array<std::atomic<std::string*>, MAX_BLOCKS> blocks{};
+
+    /** serialises the allocation of arena blocks */
+    SpinLock blockLock;
+
+    /** number of indices handed out to symbols, some of which may still be under construction */
+    std::atomic<size_t> reserved{0};
+
+    /** number of symbols in the table; all symbols below it are constructed */
+    std::atomic<size_t> numSymbols{0};
+
+    /** shards of the hash index */
+    std::array<Shard, NUM_SHARDS> shards;
+
+    /** Hash of a symbol. */
+    static uint64_t hash(std::string_view symbol) {
+        uint64_t h = std::hash<std::string_view>()(symbol);
+        // mix so that shard and probe position are taken from independent bits
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /** Obtain the arena location of a symbol index. */
+    std::string& locate(size_t index) const {
+        const size_t n = index + (size_t(1) << BLOCK_BITS);
+        const size_t msb = 63 - __builtin_clzll(n);
+        std::string* block = blocks[msb - BLOCK_BITS].load(std::memory_order_acquire);
+        return block[n & ((size_t(1) << msb) - 1)];
+    }
+
+    /** Reserve a fresh index, intern the symbol in the arena and publish it. */
+    size_t allocate(std::string_view symbol) {
+        const size_t index = reserved.fetch_add(1, std::memory_order_relaxed);
+        assert(index < static_cast<size_t>(std::numeric_limits<RamDomain>::max()) &&
+                index < std::numeric_limits<uint32_t>::max());
+
+        // allocate the arena block if not present
+        const size_t blockNum = (63 - __builtin_clzll(index + (size_t(1) << BLOCK_BITS))) - BLOCK_BITS;
+        if (blocks[blockNum].load(std::memory_order_acquire) == nullptr) {
+            blockLock.lock();
+            if (blocks[blockNum].load(std::memory_order_relaxed) == nullptr) {
+                blocks[blockNum].store(
+                        new std::string[size_t(1) << (BLOCK_BITS + blockNum)], std::memory_order_release);
+            }
+            blockLock.unlock();
+        }
+
+        locate(index).assign(symbol.data(), symbol.size());
+
+        // publish the indices in order, so that all symbols below size() are constructed
+#ifdef IS_PARALLEL
+        detail::Waiter wait;
+        while (numSymbols.load(std::memory_order_acquire) != index) {
+            wait();
+        }
+#endif
+        numSymbols.store(index + 1, std::memory_order_release);
+        return index;
+    }
+
+    /**
+     * Probe a table for a symbol; returns the slot of the symbol or 0 if it is not
+     * present. On a miss, the position of the empty slot ending the probe sequence
+     * is stored in pos.
+     */
+    slot_t probe(const HashTable& table, std::string_view symbol, uint64_t h, size_t& pos) const {
+        const slot_t tag = h & 0xffffffff00000000ull;
+        for (pos = (h >> 6) & table.mask;; pos = (pos + 1) & table.mask) {
+            const slot_t slot = table.slots[pos].load(std::memory_order_acquire);
+            if (slot == 0) {
+                return 0;
+            }
+            if ((slot & 0xffffffff00000000ull) == tag && locate((slot & 0xffffffffull) - 1) == symbol) {
+                return slot;
+            }
+        }
+    }
+
+    /** Double the capacity of the table of a shard; requires the shard lock. */
+    void grow(Shard& shard) {
+        const HashTable& old = *shard.table.load(std::memory_order_relaxed);
+        auto table = std::make_unique<HashTable>(2 * (old.mask + 1));
+        for (size_t i = 0; i <= old.mask; ++i) {
+            const slot_t slot = old.slots[i].load(std::memory_order_relaxed);
+            if (slot == 0) {
+                continue;
+            }
+            size_t pos = (hash(locate((slot & 0xffffffffull) - 1)) >> 6) & table->mask;
+            while (table->slots[pos].load(std::memory_order_relaxed) != 0) {
+                pos = (pos + 1) & table->mask;
+            }
+            table->slots[pos].store(slot, std::memory_order_relaxed);
+        }
+        shard.table.store(table.get(), std::memory_order_release);
+        shard.tables.push_back(std::move(table));
+    }
 
-    /** Map strings to indices. */
-    std::unordered_map<std::string, size_t> strToNum;
+    /** Find the index of a symbol without inserting it; returns false if it does not exist. */
+    bool find(std::string_view symbol, size_t& index) const {
+        const uint64_t h = hash(symbol);
+        const Shard& shard = shards[h & (NUM_SHARDS - 1)];
+        size_t pos;
+        if (slot_t slot = probe(*shard.table.load(std::memory_order_acquire), symbol, h, pos)) {
+            index = (slot & 0xffffffffull) - 1;
+            return true;
+        }
+        // an outgrown table may have been probed => check again under the lock
+        auto& lock = const_cast<SpinLock&>(shard.lock);
+        lock.lock();
+        slot_t slot = probe(*shard.table.load(std::memory_order_relaxed), symbol, h, pos);
+        lock.unlock();
+        index = (slot & 0xffffffffull) - 1;
+        return slot != 0;
+    }
 
     /** Convenience method to place a new symbol in the table, if it does not exist, and return the index of
      * it. */
-    inline size_t newSymbolOfIndex(const std::string& symbol) {
+    inline size_t newSymbolOfIndex(std::string_view symbol) {
+        const uint64_t h = hash(symbol);
+        Shard& shard = shards[h & (NUM_SHARDS - 1)];
+        size_t pos;
+
+        // lock-free lookup of existing symbols
+        if (slot_t slot = probe(*shard.table.load(std::memory_order_acquire), symbol, h, pos)) {
+            return (slot & 0xffffffffull) - 1;
+        }
+
+        // the symbol is likely to be new => re-probe and insert under the shard lock
+        shard.lock.lock();
+        HashTable* table = shard.table.load(std::memory_order_relaxed);
+        slot_t slot = probe(*table, symbol, h, pos);
         size_t index;
-        auto it = strToNum.find(symbol);
-        if (it == strToNum.end()) {
-            index = numToStr.size();
-            strToNum[symbol] = index;
-            numToStr.push_back(symbol);
+        if (slot == 0) {
+            if (2 * (shard.size + 1) > table->mask + 1) {
+                grow(shard);
+                table = shard.table.load(std::memory_order_relaxed);
+                probe(*table, symbol, h, pos);
+            }
+            index = allocate(symbol);
+            table->slots[pos].store(
+                    (h & 0xffffffff00000000ull) | static_cast<slot_t>(index + 1), std::memory_order_release);
+            ++shard.size;
         } else {
-            index = it->second;
+            index = (slot & 0xffffffffull) - 1;
         }
+        shard.lock.unlock();
         return index;
     }
 
     /** Convenience method to place a new symbol in the table, if it does not exist. */
-    inline void newSymbol(const std::string& symbol) {
-        if (strToNum.find(symbol) == strToNum.end()) {
-            strToNum[symbol] = numToStr.size();
-            numToStr.push_back(symbol);
+    inline void newSymbol(std::string_view symbol) {
+        newSymbolOfIndex(symbol);
+    }
+
+    /** Initialise the empty hash index. */
+    void init() {
+        for (auto& shard : shards) {
+            shard.tables.push_back(std::make_unique<HashTable>(INITIAL_SLOTS));
+            shard.table.store(shard.tables.back().get(), std::memory_order_relaxed);
+        }
+    }
+
+    /** Release the arena and the hash index. */
+    void release() {
+        for (auto& block : blocks) {
+            delete[] block.exchange(nullptr);
+        }
+        for (auto& shard : shards) {
+            shard.table.store(nullptr);
+            shard.tables.clear();
+            shard.size = 0;
+        }
+        reserved.store(0);
+        numSymbols.store(0);
+    }
+
+    /** Exchange the contents of two tables; not thread-safe. */
+    void swap(SymbolTable& other) {
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) {
+            blocks[i].store(other.blocks[i].exchange(blocks[i].load()));
+        }
+        for (size_t i = 0; i < NUM_SHARDS; ++i) {
+            shards[i].table.store(other.shards[i].table.exchange(shards[i].table.load()));
+            shards[i].tables.swap(other.shards[i].tables);
+            std::swap(shards[i].size, other.shards[i].size);
+        }
+        reserved.store(other.reserved.exchange(reserved.load()));
+        numSymbols.store(other.numSymbols.exchange(numSymbols.load()));
+    }
+
+    /** Copy all symbols of another table, preserving their indices; requires an empty table. */
+    void copy(const SymbolTable& other) {
+        const size_t n = other.size();
+        for (size_t i = 0; i < n; ++i) {
+            newSymbol(other.locate(i));
         }
     }
 
 public:
     /** Empty constructor. */
-    SymbolTable() = default;
+    SymbolTable() {
+        init();
+    }
 
     /** Copy constructor, performs a deep copy. */
-    SymbolTable(const SymbolTable& other) : numToStr(other.numToStr), strToNum(other.strToNum) {}
+    SymbolTable(const SymbolTable& other) : SymbolTable() {
+        copy(other);
+    }
 
     /** Copy constructor for r-value reference. */
-    SymbolTable(SymbolTable&& other) noexcept {
-        numToStr.swap(other.numToStr);
-        strToNum.swap(other.strToNum);
+    SymbolTable(SymbolTable&& other) noexcept : SymbolTable() {
+        swap(other);
     }
 
-    SymbolTable(std::initializer_list<std::string> symbols) {
-        strToNum.reserve(symbols.size());
+    SymbolTable(std::initializer_list<std::string> symbols) : SymbolTable() {
         for (const auto& symbol : symbols) {
             newSymbol(symbol);
         }
     }
 
     /** Destructor, frees memory allocated for all strings. */
-    virtual ~SymbolTable() = default;
+    virtual ~SymbolTable() {
+        release();
+    }
 
     /** Assignment operator, performs a deep copy and frees memory allocated for all strings. */
     SymbolTable& operator=(const SymbolTable& other) {
         if (this == &other) {
             return *this;
         }
-        numToStr = other.numToStr;
-        strToNum = other.strToNum;
+        release();
+        init();
+        copy(other);
         return *this;
     }
 
     /** Assignment operator for r-value references. */
     SymbolTable& operator=(SymbolTable&& other) noexcept {
-        numToStr.swap(other.numToStr);
-        strToNum.swap(other.strToNum);
+        swap(other);
         return *this;
     }
 
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
      * already. */
+    RamDomain lookup(std::string_view symbol) {
+        return static_cast<RamDomain>(newSymbolOfIndex(symbol));
+    }
     RamDomain lookup(const std::string& symbol) {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            return static_cast<RamDomain>(newSymbolOfIndex(symbol));
-        }
+        return lookup(std::string_view(symbol));
+    }
+    RamDomain lookup(const char* symbol) {
+        return lookup(std::string_view(symbol));
     }
 
     /** Finds the index of a symbol in the table, giving an error if it's not found */
-    RamDomain lookupExisting(const std::string& symbol) const {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            auto result = strToNum.find(symbol);
-            if (result == strToNum.end()) {
-                fatal("Error string not found in call to `SymbolTable::lookupExisting`: `%s`", symbol);
-            }
-            return static_cast<RamDomain>(result->second);
+    RamDomain lookupExisting(std::string_view symbol) const {
+        size_t index;
+        if (!find(symbol, index)) {
+            fatal("Error string not found in call to `SymbolTable::lookupExisting`: `%s`", symbol);
         }
+        return static_cast<RamDomain>(index);
+    }
+    RamDomain lookupExisting(const std::string& symbol) const {
+        return lookupExisting(std::string_view(symbol));
+    }
+    RamDomain lookupExisting(const char* symbol) const {
+        return lookupExisting(std::string_view(symbol));
     }
 
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
      * already. */
+    RamDomain unsafeLookup(std::string_view symbol) {
+        return lookup(symbol);
+    }
     RamDomain unsafeLookup(const std::string& symbol) {
-        return newSymbolOfIndex(symbol);
+        return lookup(std::string_view(symbol));
+    }
+    RamDomain unsafeLookup(const char* symbol) {
+        return lookup(std::string_view(symbol));
     }
 
     /** Find a symbol in the table by its index, note that this gives an error if the index is out of
      * bounds.
      */
     const std::string& resolve(const RamDomain index) const {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            auto pos = static_cast<size_t>(index);
-            if (pos >= size()) {
-                // TODO: use different error reporting here!!
-                fatal("Error index out of bounds in call to `SymbolTable::resolve`. index = `%d`", index);
-            }
-            return numToStr[pos];
+        auto pos = static_cast<size_t>(index);
+        if (pos >= size()) {
+            // TODO: use different error reporting here!!
+            fatal("Error index out of bounds in call to `SymbolTable::resolve`. index = `%d`", index);
         }
+        return locate(pos);
     }
 
     const std::string& unsafeResolve(const RamDomain index) const {
-        return numToStr[static_cast<size_t>(index)];
+        return locate(static_cast<size_t>(index));
     }
 
     /* Return the size of the symbol table, being the number of symbols it currently holds. */
     size_t size() const {
-        return numToStr.size();
+        return numSymbols.load(std::memory_order_acquire);
     }
 
     /** Bulk insert symbols into the table, note that this operation is more efficient than repeated
      * inserts
      * of single symbols. */
     void insert(const std::vector<std::string>& symbols) {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            strToNum.reserve(size() + symbols.size());
-            for (auto& symbol : symbols) {
-                newSymbol(symbol);
-            }
+        for (auto& symbol : symbols) {
+            newSymbol(symbol);
         }
     }
 
@@ -185,42 +424,33 @@ public:
      * symbols
      * in bulk. */
     void insert(const std::string& symbol) {
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            newSymbol(symbol);
-        }
+        newSymbol(symbol);
     }
 
     /** Print the symbol table to the given stream. */
     void print(std::ostream& out) const {
         {
             out << "SymbolTable: {\n\t";
-            out << join(strToNum, "\n\t",
-                           [](std::ostream& out, const std::pair<std::string, std::size_t>& entry) {
-                               out << entry.first << "\t => " << entry.second;
-                           })
-                << "\n";
+            const size_t n = size();
+            for (size_t i = 0; i < n; ++i) {
+                if (i > 0) {
+                    out << "\n\t";
+                }
+                out << locate(i) << "\t => " << i;
+            }
+            out << "\n";
             out << "}\n";
         }
     }
 
     /** Check if the symbol table contains a string */
     bool contains(const std::string& symbol) const {
-        auto lease = access.acquire();
-        (void)lease;  // avoid warning;
-        auto result = strToNum.find(symbol);
-        if (result == strToNum.end()) {
-            return false;
-        } else {
-            return true;
-        }
+        size_t index;
+        return find(symbol, index);
     }
 
     /** Check if the symbol table contains an index */
     bool contains(const RamDomain index) const {
-        auto lease = access.acquire();
-        (void)lease;  // avoid warning;
         auto pos = static_cast<size_t>(index);
         if (pos >= size()) {
             return false;
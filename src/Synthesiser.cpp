@@ -17,6 +17,7 @@
 #include "Synthesiser.h"
 #include "AggregateOp.h"
 #include "BinaryConstraintOps.h"
+#include "Checkpoint.h"
 #include "FunctorOps.h"
 #include "Global.h"
 #include "RamCondition.h"
@@ -26,6 +27,7 @@
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamRelation.h"
+#include "RamScheduleAnalysis.h"
 #include "RamStatement.h"
 #include "RamTranslationUnit.h"
 #include "RamTypes.h"
@@ -43,9 +45,16 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <map>
+#include <set>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
@@ -122,6 +131,16 @@ const std::string Synthesiser::getOpContextName(const RamRelation& rel) {
     return getRelationName(rel) + "_op_ctxt";
 }
 
+/** Check whether the indexes of a relation count their ranges */
+bool Synthesiser::isCountedRelation(const RamRelation& rel) {
+    if (countedRelations.count(&rel) == 0) {
+        return false;
+    }
+    auto type = SynthesiserRelation::getSynthesiserRelation(
+            rel, translationUnit.getAnalysis<RamIndexAnalysis>()->getIndexes(rel), false, true);
+    return dynamic_cast<SynthesiserDirectRelation*>(type.get()) != nullptr;
+}
+
 /** Get relation type struct */
 void Synthesiser::generateRelationTypeStruct(
         std::ostream& out, std::unique_ptr<SynthesiserRelation> relationType) {
@@ -180,6 +199,87 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         std::ostringstream preamble;
         bool preambleIssued = false;
 
+        /** Return the C++ name of an aggregation function */
+        static std::string getAggregateOpName(AggregateOp op) {
+            switch (op) {
+                case AggregateOp::MAX: return "AggregateOp::MAX";
+                case AggregateOp::MIN: return "AggregateOp::MIN";
+                case AggregateOp::SUM: return "AggregateOp::SUM";
+                case AggregateOp::FMAX: return "AggregateOp::FMAX";
+                case AggregateOp::FMIN: return "AggregateOp::FMIN";
+                case AggregateOp::FSUM: return "AggregateOp::FSUM";
+                case AggregateOp::MEAN: return "AggregateOp::MEAN";
+                case AggregateOp::UMAX: return "AggregateOp::UMAX";
+                case AggregateOp::UMIN: return "AggregateOp::UMIN";
+                case AggregateOp::USUM: return "AggregateOp::USUM";
+                case AggregateOp::COUNT: return "AggregateOp::COUNT";
+            }
+
+            UNREACHABLE_BAD_CASE_ANALYSIS
+        }
+
+        /** Emit the value a tuple contributes to an aggregate */
+        void emitAggregateValue(const RamAbstractAggregate& aggregate, std::ostream& out) {
+            if (aggregate.getFunction() == AggregateOp::COUNT) {
+                out << "0";
+            } else {
+                rec(out, &aggregate.getExpression());
+            }
+        }
+
+        /**
+         * Emit a parallel aggregate over the partitions in variable part: each task
+         * aggregates a partition, and the partial aggregates are combined in the
+         * order of the partitions before the nested operation runs once.
+         */
+        void emitParallelAggregate(const RamAbstractAggregate& aggregate, const RamTupleOperation& operation,
+                std::ostream& out) {
+            auto identifier = operation.getTupleId();
+            std::string acc = "acc" + toString(identifier);
+
+            out << "AggregateAccumulator " << acc << "(" << getAggregateOpName(aggregate.getFunction())
+                << ");\n";
+            out << "std::vector<AggregateAccumulator> partials(part.size(), " << acc << ");\n";
+            out << "WorkStealingLoop tasks(part.size());\n";
+            out << "PARALLEL_START;\n";
+            for (const RamRelation* cur : synthesiser.getReferencedRelations(operation)) {
+                out << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*cur);
+                out << "," << synthesiser.getRelationName(*cur);
+                out << "->createContext());\n";
+            }
+            out << "for(std::size_t task : tasks) {\n";
+            out << "try{\n";
+            out << "for(const auto& env" << identifier << " : part[task]) {\n";
+            out << "if( ";
+            visit(aggregate.getCondition(), out);
+            out << ") {\n";
+            out << "partials[task].add(";
+            emitAggregateValue(aggregate, out);
+            out << ");\n";
+            out << "}\n";
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+            out << "PARALLEL_END;\n";
+            out << "for(const auto& partial : partials) {\n";
+            out << acc << ".merge(partial);\n";
+            out << "}\n";
+
+            emitAggregateResult(operation, acc, out);
+        }
+
+        /**
+         * Emit the write of the result of the given accumulator into the environment tuple,
+         * followed by the nested operation if the aggregate has a value.
+         */
+        void emitAggregateResult(
+                const RamTupleOperation& operation, const std::string& acc, std::ostream& out) {
+            out << "env" << operation.getTupleId() << "[0] = " << acc << ".getResult();\n";
+            out << "if (" << acc << ".hasResult()) {\n";
+            visitTupleOperation(operation, out);
+            out << "}\n";
+        }
+
     public:
         CodeEmitter(Synthesiser& syn) : synthesiser(syn) {
             rec = [&](auto& out, const auto* value) {
@@ -221,6 +321,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
             // get some table details
             if (op == "input") {
+                // replace the facts of a preceding run
+                if (directives.count("clear") != 0) {
+                    out << synthesiser.getRelationName(io.getRelation()) << "->purge();\n";
+                }
                 out << "try {";
                 out << "std::map<std::string, std::string> directiveMap(";
                 printDirectives(directives);
@@ -257,6 +361,27 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         void visitQuery(const RamQuery& query, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
+            // merge relations in bulk if a query merely copies one direct (or equivalence) relation
+            // into another; provenance relations are excluded as a merge does not apply the updater
+            const auto copied = getCopiedRelations(query);
+            if (copied.first != nullptr && !Global::config().has("provenance")) {
+                auto isDirect = [&](const RamRelation& rel) {
+                    auto type = SynthesiserRelation::getSynthesiserRelation(rel, isa->getIndexes(rel), false);
+                    return dynamic_cast<SynthesiserDirectRelation*>(type.get()) != nullptr;
+                };
+                auto isEqrel = [&](const RamRelation& rel) {
+                    auto type = SynthesiserRelation::getSynthesiserRelation(rel, isa->getIndexes(rel), false);
+                    return dynamic_cast<SynthesiserEqrelRelation*>(type.get()) != nullptr;
+                };
+                if ((isDirect(*copied.first) && isDirect(*copied.second)) ||
+                        (isEqrel(*copied.first) && isEqrel(*copied.second))) {
+                    out << synthesiser.getRelationName(*copied.second) << "->insertAll(*"
+                        << synthesiser.getRelationName(*copied.first) << ");\n";
+                    PRINT_END_COMMENT(out);
+                    return;
+                }
+            }
+
             // split terms of conditions of outer filter operation
             // into terms that require a context and terms that
             // do not require a context
@@ -290,9 +415,24 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             // enclose operation in its own scope
             out << "{\n";
 
-            // check whether loop nest can be parallelized
+            // declare the groups of group aggregates, shared by all threads of the query
+            visitDepthFirst(*next, [&](const RamGroupAggregate& aggregate) {
+                const auto& pattern = aggregate.getRangePattern().first;
+                auto keyArity = std::count_if(pattern.begin(), pattern.end(),
+                        [](const RamExpression* value) { return !isRamUndefValue(value); });
+                out << "GroupTable groups" << aggregate.getTupleId() << "("
+                    << getAggregateOpName(aggregate.getFunction()) << "," << keyArity << ");\n";
+            });
+
+            // check whether loop nest can be parallelized; parallel aggregates
+            // run their nested operation once on the thread of the query
             bool isParallel = false;
-            visitDepthFirst(*next, [&](const RamAbstractParallel&) { isParallel = true; });
+            visitDepthFirst(*next, [&](const RamNode& node) {
+                if (dynamic_cast<const RamAbstractParallel*>(&node) != nullptr &&
+                        dynamic_cast<const RamAbstractAggregate*>(&node) == nullptr) {
+                    isParallel = true;
+                }
+            });
 
             // reset preamble
             preamble.str("");
@@ -347,7 +487,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         void visitClear(const RamClear& clear, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
 
-            if (!clear.getRelation().isTemp()) {
+            // relations are kept for the program interface, unless rebuilt by an incremental update
+            if (!clear.getRelation().isTemp() && !Global::config().has("incremental")) {
                 out << "if (performIO) ";
             }
             out << synthesiser.getRelationName(clear.getRelation()) << "->"
@@ -364,10 +505,86 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitLogStatistics(const RamLogStatistics& statistics, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto& rel = statistics.getRelation();
+            out << "ProfileEventSingleton::instance().makeStatisticsEvents(R\"_(";
+            out << statistics.getMessage() << ")_\",";
+            out << "*" << synthesiser.getRelationName(rel) << "," << rel.getArity() << ");";
+            PRINT_END_COMMENT(out);
+        }
+
         // -- control flow statements --
 
         void visitSequence(const RamSequence& seq, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+
+            // strata calls of the main program => run independent strata concurrently
+            const auto* schedule = synthesiser.getTranslationUnit().getAnalysis<RamScheduleAnalysis>();
+            const int strataWorkers = Global::config().has("parallel-strata")
+                                              ? std::stoi(Global::config().get("parallel-strata"))
+                                              : 1;
+            if (Global::config().has("checkpoint-dir") && !Global::config().has("incremental") &&
+                    schedule->getStrata() == &seq) {
+                // evaluate the strata in sequence, starting after the restored checkpoint
+                const RamProgram& prog = synthesiser.getTranslationUnit().getProgram();
+                const auto& subs = prog.getSubroutines();
+                const auto& stmts = seq.getStatements();
+                out << "{\n";
+                out << "Checkpoint checkpoint(checkpointDirectory, \""
+                    << Checkpoint::getFingerprint(toString(prog))
+                    << "\", symTable, recordTable, getAllRelations());\n";
+                visitDepthFirst(prog, [&](const RamIO& io) {
+                    if (io.get("operation") != "input" || io.getDirectives().count("filename") == 0) {
+                        return;
+                    }
+                    const std::string filename = "\"" + escape(io.get("filename")) + "\"";
+                    if (io.get("filename").front() == '/') {
+                        out << "checkpoint.addInput(" << filename << ");\n";
+                    } else {
+                        out << "checkpoint.addInput(inputDirectory.empty() ? std::string(" << filename
+                            << ") : inputDirectory + \"/\" + " << filename << ");\n";
+                    }
+                });
+                out << "for (std::size_t stratum = checkpoint.restore(); stratum < " << stmts.size()
+                    << "; ++stratum) {\n";
+                out << "std::vector<RamDomain> args, ret;\n";
+                out << "switch (stratum) {\n";
+                for (size_t i = 0; i < stmts.size(); ++i) {
+                    const auto& name = static_cast<const RamCall*>(stmts[i])->getName();
+                    out << "case " << i << ": subroutine_" << distance(subs.begin(), subs.find(name))
+                        << "(args, ret); break;\n";
+                }
+                out << "}\n";
+                out << "checkpoint.save(stratum);\n";
+                out << "}\n";
+                out << "checkpoint.finish();\n";
+                out << "}\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+            if (strataWorkers > 1 && schedule->getStrata() == &seq && !Global::config().has("profile")) {
+                const RamProgram& prog = synthesiser.getTranslationUnit().getProgram();
+                const auto& subs = prog.getSubroutines();
+                const auto& stmts = seq.getStatements();
+                out << "runTaskGraph({";
+                out << join(schedule->getPredecessors(), ", ", [](std::ostream& os, const auto& preds) {
+                    os << "{" << join(preds, ", ") << "}";
+                });
+                out << "}, " << strataWorkers << ", [&](std::size_t stratum) {\n";
+                out << "std::vector<RamDomain> args, ret;\n";
+                out << "switch (stratum) {\n";
+                for (size_t i = 0; i < stmts.size(); ++i) {
+                    const auto& name = static_cast<const RamCall*>(stmts[i])->getName();
+                    out << "case " << i << ": subroutine_" << distance(subs.begin(), subs.find(name))
+                        << "(args, ret); break;\n";
+                }
+                out << "}\n";
+                out << "});\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             for (const auto& cur : seq.getStatements()) {
                 visit(cur, out);
             }
@@ -391,6 +608,27 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 return;
             }
 
+            // independent statements free of parallel operations and exits => run them concurrently
+            bool concurrent = true;
+            visitDepthFirst(parallel, [&](const RamAbstractParallel&) { concurrent = false; });
+            visitDepthFirst(parallel, [&](const RamExit&) { concurrent = false; });
+            if (concurrent) {
+                out << "PARALLEL_START;\n";
+                out << "pfor(int stmt = 0; stmt < " << stmts.size() << "; ++stmt) {\n";
+                out << "switch (stmt) {\n";
+                for (size_t i = 0; i < stmts.size(); ++i) {
+                    out << "case " << i << ": {\n";
+                    visit(stmts[i], out);
+                    out << "break;\n";
+                    out << "}\n";
+                }
+                out << "}\n";
+                out << "}\n";
+                out << "PARALLEL_END;\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             // more than one => parallel sections
 
             // start parallel section
@@ -408,6 +646,13 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitAdaptiveQuery(const RamAdaptiveQuery& adaptive, std::ostream& out) override {
+            // the join order is fixed in the compiled program
+            PRINT_BEGIN_COMMENT(out);
+            visit(adaptive.getStatements().front(), out);
+            PRINT_END_COMMENT(out);
+        }
+
         void visitLoop(const RamLoop& loop, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << "iter = 0;\n";
@@ -532,9 +777,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
+            out << "WorkStealingLoop tasks(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "for(std::size_t task : tasks) {\n";
+            out << "auto it = part.begin() + task;\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -606,9 +853,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
+            out << "WorkStealingLoop tasks(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "for(std::size_t task : tasks) {\n";
+            out << "auto it = part.begin() + task;\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -693,9 +942,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 // TODO (b-scholz): context may be missing here?
                 << "lowerUpperRange_" << keys << "(lower,upper);\n";
             out << "auto part = range.partition();\n";
+            out << "WorkStealingLoop tasks(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "for(std::size_t task : tasks) {\n";
+            out << "auto it = part.begin() + task;\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -780,9 +1031,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 // TODO (b-scholz): context may be missing here?
                 << "lowerUpperRange_" << keys << "(lower, upper);\n";
             out << "auto part = range.partition();\n";
+            out << "WorkStealingLoop tasks(part.size());\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "for(std::size_t task : tasks) {\n";
+            out << "auto it = part.begin() + task;\n";
             out << "try{";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -858,46 +1111,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 return;
             }
 
-            out << "bool shouldRunNested = false;\n";
-
-            // init result
-            std::string init;
-            switch (aggregate.getFunction()) {
-                case AggregateOp::MIN: init = "MAX_RAM_SIGNED"; break;
-                case AggregateOp::FMIN: init = "MAX_RAM_FLOAT"; break;
-                case AggregateOp::UMIN: init = "MAX_RAM_UNSIGNED"; break;
-                case AggregateOp::MAX: init = "MIN_RAM_SIGNED"; break;
-                case AggregateOp::FMAX: init = "MIN_RAM_FLOAT"; break;
-                case AggregateOp::UMAX: init = "MIN_RAM_UNSIGNED"; break;
-                case AggregateOp::COUNT:
-                    init = "0";
-                    out << "shouldRunNested = true;\n";
-                    break;
-                case AggregateOp::MEAN: init = "0"; break;
-                case AggregateOp::FSUM:
-                case AggregateOp::USUM:
-                case AggregateOp::SUM:
-                    init = "0";
-                    out << "shouldRunNested = true;\n";
-                    break;
-            }
-
-            std::string type;
-            switch (getTypeAttributeAggregate(aggregate.getFunction())) {
-                case TypeAttribute::Signed: type = "RamSigned"; break;
-                case TypeAttribute::Unsigned: type = "RamUnsigned"; break;
-                case TypeAttribute::Float: type = "RamFloat"; break;
-
-                case TypeAttribute::Symbol:
-                case TypeAttribute::Record: type = "RamDomain"; break;
-            }
-            out << type << " res" << identifier << " = " << init << ";\n";
-
-            if (aggregate.getFunction() == AggregateOp::MEAN) {
-                out << "if (accumulateMean.second != 0) {\n";
-                out << "res" << identifier << " = accumulateMean.first / accumulateMean.second;\n";
-                out << "}\n";
-            }
+            // aggregate the values, floats summed exactly
+            std::string acc = "acc" + toString(identifier);
+            out << "AggregateAccumulator " << acc << "(" << getAggregateOpName(aggregate.getFunction())
+                << ");\n";
 
             // check whether there is an index to use
             if (keys.empty()) {
@@ -926,81 +1143,39 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "if( ";
             visit(aggregate.getCondition(), out);
             out << ") {\n";
-
-            out << "shouldRunNested = true;\n";
-
-            // pick function
-            switch (aggregate.getFunction()) {
-                case AggregateOp::FMIN:
-                case AggregateOp::UMIN:
-                case AggregateOp::MIN:
-                    out << "res" << identifier << " = std::min(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::FMAX:
-                case AggregateOp::UMAX:
-                case AggregateOp::MAX:
-                    out << "res" << identifier << " = std::max(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::COUNT: out << "++res" << identifier << "\n;"; break;
-                case AggregateOp::FSUM:
-                case AggregateOp::USUM:
-                case AggregateOp::SUM:
-                    out << "res" << identifier << " += "
-                        << "ramBitCast<" << type << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    break;
-
-                case AggregateOp::MEAN:
-                    out << "accumulateMean.first += "
-                        << "ramBitCast<RamFloat>(";
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    out << "++accumulateMean.second;\n";
-                    break;
-            }
-
+            out << acc << ".add(";
+            emitAggregateValue(aggregate, out);
+            out << ");\n";
             out << "}\n";
 
             // end aggregator loop
             out << "}\n";
 
-            if (aggregate.getFunction() == AggregateOp::MEAN) {
-                out << "if (accumulateMean.second != 0) {\n";
-                out << "res" << identifier << " = accumulateMean.first / accumulateMean.second;\n";
-                out << "}\n";
-            }
-
-            // write result into environment tuple
-            out << "env" << identifier << "[0] = ramBitCast(res" << identifier << ");\n";
-
-            // check whether there exists a min/max first before next loop
-            out << "if (shouldRunNested) {\n";
-            visitTupleOperation(aggregate, out);
-            out << "}\n";
+            emitAggregateResult(aggregate, acc, out);
 
             PRINT_END_COMMENT(out);
         }
 
-        void visitAggregate(const RamAggregate& aggregate, std::ostream& out) override {
+        void visitParallelIndexAggregate(
+                const RamParallelIndexAggregate& aggregate, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             // get some properties
             const auto& rel = aggregate.getRelation();
+            auto arity = rel.getArity();
             auto relName = synthesiser.getRelationName(rel);
             auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
             auto identifier = aggregate.getTupleId();
+            auto keys = isa->getSearchSignature(&aggregate);
+
+            assert(identifier == 0 && "not outer-most loop");
+            assert(arity > 0 && "AstTranslator failed/no parallel aggregates for nullaries");
 
             // declare environment variable
             out << "Tuple<RamDomain,1> env" << identifier << ";\n";
 
             // special case: counting number elements over an unrestricted predicate
-            if (aggregate.getFunction() == AggregateOp::COUNT && isRamTrue(&aggregate.getCondition())) {
+            if (aggregate.getFunction() == AggregateOp::COUNT && keys.empty() &&
+                    isRamTrue(&aggregate.getCondition())) {
                 // shortcut: use relation size
                 out << "env" << identifier << "[0] = " << relName << "->"
                     << "size();\n";
@@ -1009,115 +1184,282 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 return;
             }
 
-            out << "bool shouldRunNested = false;\n";
-
-            // init result
-            std::string init;
-            switch (aggregate.getFunction()) {
-                case AggregateOp::MIN: init = "MAX_RAM_SIGNED"; break;
-                case AggregateOp::FMIN: init = "MAX_RAM_FLOAT"; break;
-                case AggregateOp::UMIN: init = "MAX_RAM_UNSIGNED"; break;
-                case AggregateOp::MAX: init = "MIN_RAM_SIGNED"; break;
-                case AggregateOp::FMAX: init = "MIN_RAM_FLOAT"; break;
-                case AggregateOp::UMAX: init = "MIN_RAM_UNSIGNED"; break;
-                case AggregateOp::COUNT:
-                    init = "0";
-                    out << "shouldRunNested = true;\n";
-                    break;
+            // partition the range to aggregate
+            if (keys.empty()) {
+                out << "auto part = " << relName << "->partition();\n";
+            } else {
+                const auto& patternsLower = aggregate.getRangePattern().first;
+                const auto& patternsUpper = aggregate.getRangePattern().second;
+                std::string tuple_type = "Tuple<RamDomain," + toString(arity) + ">";
 
-                case AggregateOp::MEAN: init = "0"; break;
+                out << "const " << tuple_type << " lower{{";
+                out << join(patternsLower.begin(), patternsLower.begin() + arity, ",", recWithDefault);
+                out << "}};\n";
 
-                case AggregateOp::FSUM:
-                case AggregateOp::USUM:
-                case AggregateOp::SUM:
-                    init = "0";
-                    out << "shouldRunNested = true;\n";
-                    break;
+                out << "const " << tuple_type << " upper{{";
+                out << join(patternsUpper.begin(), patternsUpper.begin() + arity, ",", recWithDefault);
+                out << "}};\n";
+
+                out << "auto range = " << relName << "->"
+                    << "lowerUpperRange_" << keys << "(lower,upper," << ctxName << ");\n";
+                out << "auto part = range.partition();\n";
             }
 
-            char const* type;
-            switch (getTypeAttributeAggregate(aggregate.getFunction())) {
-                case TypeAttribute::Signed: type = "RamSigned"; break;
-                case TypeAttribute::Unsigned: type = "RamUnsigned"; break;
-                case TypeAttribute::Float: type = "RamFloat"; break;
+            emitParallelAggregate(aggregate, aggregate, out);
 
-                case TypeAttribute::Symbol:
-                case TypeAttribute::Record: type = "RamDomain"; break;
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitRangeAggregate(const RamRangeAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // get some properties
+            const auto& rel = aggregate.getRelation();
+            auto arity = rel.getArity();
+            auto relName = synthesiser.getRelationName(rel);
+            auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+            auto identifier = aggregate.getTupleId();
+            auto keys = isa->getSearchSignature(&aggregate);
+            const bool counted = synthesiser.isCountedRelation(rel);
+
+            // get range to aggregate
+            const auto& patternsLower = aggregate.getRangePattern().first;
+            const auto& patternsUpper = aggregate.getRangePattern().second;
+            std::string tuple_type = "Tuple<RamDomain," + toString(arity) + ">";
+
+            out << "const " << tuple_type << " lower{{";
+            out << join(patternsLower.begin(), patternsLower.begin() + arity, ",", recWithDefault);
+            out << "}};\n";
+
+            out << "const " << tuple_type << " upper{{";
+            out << join(patternsUpper.begin(), patternsUpper.begin() + arity, ",", recWithDefault);
+            out << "}};\n";
+
+            // declare environment variable
+            out << "Tuple<RamDomain,1> env" << identifier << ";\n";
+
+            // counted indexes count the range without enumerating it
+            if (aggregate.getFunction() == AggregateOp::COUNT) {
+                if (counted) {
+                    out << "env" << identifier << "[0] = " << relName << "->countRange_" << keys
+                        << "(lower,upper," << ctxName << ");\n";
+                } else {
+                    out << "env" << identifier << "[0] = 0;\n";
+                    out << "for(const auto& t : " << relName << "->lowerUpperRange_" << keys
+                        << "(lower,upper," << ctxName << ")) {\n";
+                    out << "static_cast<void>(t);\n";
+                    out << "++env" << identifier << "[0];\n";
+                    out << "}\n";
+                }
+                visitTupleOperation(aggregate, out);
+                PRINT_END_COMMENT(out);
+                return;
             }
-            out << type << " res" << identifier << " = " << init << ";\n";
 
-            if (aggregate.getFunction() == AggregateOp::MEAN) {
-                out << "std::pair<RamFloat, RamFloat> accumulateMean = {0, 0};\n";
+            // the minimum or maximum is the target of the first or last tuple of the range
+            const bool last = aggregate.getFunction() == AggregateOp::MAX;
+            out << "auto range = " << relName << "->"
+                << (last && counted ? "lastInRange_" : "lowerUpperRange_") << keys << "(lower,upper,"
+                << ctxName << ");\n";
+            out << "if (!range.empty()) {\n";
+            out << "auto pos = range.begin();\n";
+            if (last && !counted) {
+                out << "for (auto it = range.begin(); it != range.end(); ++it) {\n";
+                out << "pos = it;\n";
+                out << "}\n";
             }
+            out << "RamDomain res" << identifier << ";\n";
+            out << "{\n";
+            out << "const auto& env" << identifier << " = *pos;\n";
+            out << "res" << identifier << " = ";
+            visit(aggregate.getExpression(), out);
+            out << ";\n";
+            out << "}\n";
+            out << "env" << identifier << "[0] = res" << identifier << ";\n";
+            visitTupleOperation(aggregate, out);
+            out << "}\n";
 
-            // check whether there is an index to use
-            out << "for(const auto& env" << identifier << " : "
-                << "*" << relName << ") {\n";
+            PRINT_END_COMMENT(out);
+        }
 
-            // produce condition inside the loop
-            out << "if( ";
-            visit(aggregate.getCondition(), out);
-            out << ") {\n";
+        void visitGroupAggregate(const RamGroupAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // get some properties
+            const auto& rel = aggregate.getRelation();
+            auto arity = rel.getArity();
+            auto relName = synthesiser.getRelationName(rel);
+            auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+            auto identifier = aggregate.getTupleId();
+            auto keys = isa->getSearchSignature(&aggregate);
+            const auto& patternsLower = aggregate.getRangePattern().first;
+            const auto& patternsUpper = aggregate.getRangePattern().second;
+            std::string tuple_type = "Tuple<RamDomain," + toString(arity) + ">";
+            std::string groups = "groups" + toString(identifier);
+            std::string acc = "acc" + toString(identifier);
+
+            // the key of the group are the values of the search attributes
+            std::vector<const RamExpression*> keyValues;
+            std::vector<size_t> keyAttributes;
+            for (size_t i = 0; i < arity; ++i) {
+                if (!isRamUndefValue(patternsLower[i])) {
+                    keyValues.push_back(patternsLower[i]);
+                    keyAttributes.push_back(i);
+                }
+            }
+            std::string key_type = "Tuple<RamDomain," + toString(keyValues.size()) + ">";
 
-            out << "shouldRunNested = true;\n";
-            // pick function
-            switch (aggregate.getFunction()) {
-                case AggregateOp::FMIN:
-                case AggregateOp::UMIN:
-                case AggregateOp::MIN:
-                    out << "res" << identifier << " = std::min(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::FMAX:
-                case AggregateOp::UMAX:
-                case AggregateOp::MAX:
-                    out << "res" << identifier << " = std::max(res" << identifier << ",ramBitCast<" << type
-                        << ">(";
-                    visit(aggregate.getExpression(), out);
-                    out << "));\n";
-                    break;
-                case AggregateOp::COUNT: out << "++res" << identifier << "\n;"; break;
-                case AggregateOp::FSUM:
-                case AggregateOp::USUM:
-                case AggregateOp::SUM:
-                    out << "res" << identifier << " += "
-                        << "ramBitCast<" << type << ">(";
-                    ;
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    break;
+            // the aggregated value of a tuple of the group
+            auto emitAdd = [&](const std::string& call) {
+                out << call;
+                emitAggregateValue(aggregate, out);
+                out << ");\n";
+            };
 
-                case AggregateOp::MEAN:
-                    out << "accumulateMean.first += "
-                        << "ramBitCast<RamFloat>(";
-                    visit(aggregate.getExpression(), out);
-                    out << ");\n";
-                    out << "++accumulateMean.second;\n";
-                    break;
-            }
+            // declare environment variable
+            out << "Tuple<RamDomain,1> env" << identifier << ";\n";
+            out << "AggregateAccumulator " << acc << "(" << getAggregateOpName(aggregate.getFunction())
+                << ");\n";
+            out << "const " << key_type << " key" << identifier << "{{";
+            out << join(keyValues, ",", rec);
+            out << "}};\n";
 
+            // look up the group once all groups are known
+            out << "if (" << groups << ".isBuilt()) {\n";
+            out << "if (const AggregateAccumulator* group = " << groups << ".lookup(key" << identifier
+                << ".data)) {\n";
+            out << acc << " = *group;\n";
             out << "}\n";
+            out << "} else {\n";
 
-            // end aggregator loop
+            // otherwise aggregate the group by a range query, charging the visited tuples
+            out << "const " << tuple_type << " lower{{";
+            out << join(patternsLower.begin(), patternsLower.begin() + arity, ",", recWithDefault);
+            out << "}};\n";
+            out << "const " << tuple_type << " upper{{";
+            out << join(patternsUpper.begin(), patternsUpper.begin() + arity, ",", recWithDefault);
+            out << "}};\n";
+            out << "auto range = " << relName << "->"
+                << "lowerUpperRange_" << keys << "(lower,upper," << ctxName << ");\n";
+            out << "std::size_t visited = 1;\n";
+            out << "for(const auto& env" << identifier << " : range) {\n";
+            out << "++visited;\n";
+            out << "if( ";
+            visit(aggregate.getCondition(), out);
+            out << ") {\n";
+            emitAdd(acc + ".add(");
+            out << "}\n";
             out << "}\n";
 
-            if (aggregate.getFunction() == AggregateOp::MEAN) {
-                out << "res" << identifier << " = accumulateMean.first / accumulateMean.second;\n";
+            // aggregate all groups in one pass over the relation, joined by the idle threads of an
+            // enclosing parallel scan
+            out << "if (" << groups << ".charge(visited, [&]() { return " << relName << "->size(); })) {\n";
+            out << "auto part = " << relName << "->partition();\n";
+            out << "std::vector<GroupTable::Partition> partitions(part.size(), " << groups
+                << ".makePartition());\n";
+            out << "parallelFor(part.size(), [&](std::size_t task) {\n";
+            for (const RamRelation* cur : synthesiser.getReferencedRelations(aggregate)) {
+                out << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*cur);
+                out << "," << synthesiser.getRelationName(*cur);
+                out << "->createContext());\n";
             }
+            out << "try{\n";
+            out << "for(const auto& env" << identifier << " : part[task]) {\n";
+            out << "if( ";
+            visit(aggregate.getCondition(), out);
+            out << ") {\n";
+            out << "const " << key_type << " group{{";
+            out << join(keyAttributes, ",",
+                    [&](auto& os, size_t i) { os << "env" << identifier << "[" << i << "]"; });
+            out << "}};\n";
+            emitAdd("partitions[task].add(group.data,");
+            out << "}\n";
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "});\n";
+            out << groups << ".build(partitions);\n";
+            out << "}\n";
+            out << "}\n";
 
             // write result into environment tuple
-            out << "env" << identifier << "[0] = ramBitCast(res" << identifier << ");\n";
+            out << "env" << identifier << "[0] = " << acc << ".getResult();\n";
 
-            // check whether there exists a min/max first before next loop
-            out << "if (shouldRunNested) {\n";
+            // check whether the group has a value before next loop
+            out << "if (" << acc << ".hasResult()) {\n";
             visitTupleOperation(aggregate, out);
             out << "}\n";
 
             PRINT_END_COMMENT(out);
         }
 
+        void visitAggregate(const RamAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // get some properties
+            const auto& rel = aggregate.getRelation();
+            auto relName = synthesiser.getRelationName(rel);
+            auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+            auto identifier = aggregate.getTupleId();
+
+            // declare environment variable
+            out << "Tuple<RamDomain,1> env" << identifier << ";\n";
+
+            // special case: counting number elements over an unrestricted predicate
+            if (aggregate.getFunction() == AggregateOp::COUNT && isRamTrue(&aggregate.getCondition())) {
+                // shortcut: use relation size
+                out << "env" << identifier << "[0] = " << relName << "->"
+                    << "size();\n";
+                visitTupleOperation(aggregate, out);
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
+            // aggregate the values, floats summed exactly
+            std::string acc = "acc" + toString(identifier);
+            out << "AggregateAccumulator " << acc << "(" << getAggregateOpName(aggregate.getFunction())
+                << ");\n";
+            out << "for(const auto& env" << identifier << " : "
+                << "*" << relName << ") {\n";
+            out << "if( ";
+            visit(aggregate.getCondition(), out);
+            out << ") {\n";
+            out << acc << ".add(";
+            emitAggregateValue(aggregate, out);
+            out << ");\n";
+            out << "}\n";
+            out << "}\n";
+
+            emitAggregateResult(aggregate, acc, out);
+
+            PRINT_END_COMMENT(out);
+        }
+
+        void visitParallelAggregate(const RamParallelAggregate& aggregate, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // get some properties
+            const auto& rel = aggregate.getRelation();
+            auto relName = synthesiser.getRelationName(rel);
+            auto identifier = aggregate.getTupleId();
+
+            assert(identifier == 0 && "not outer-most loop");
+            assert(rel.getArity() > 0 && "AstTranslator failed/no parallel aggregates for nullaries");
+
+            // declare environment variable
+            out << "Tuple<RamDomain,1> env" << identifier << ";\n";
+
+            // special case: counting number elements over an unrestricted predicate
+            if (aggregate.getFunction() == AggregateOp::COUNT && isRamTrue(&aggregate.getCondition())) {
+                // shortcut: use relation size
+                out << "env" << identifier << "[0] = " << relName << "->"
+                    << "size();\n";
+                visitTupleOperation(aggregate, out);
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
+            out << "auto part = " << relName << "->partition();\n";
+            emitParallelAggregate(aggregate, aggregate, out);
+
+            PRINT_END_COMMENT(out);
+        }
+
         void visitFilter(const RamFilter& filter, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << "if( ";
@@ -1758,7 +2100,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
     CodeEmitter(*this).visit(stmt, out);
 }
 
-void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary) {
+Synthesiser::GeneratedCode Synthesiser::generateParts(const std::string& id, bool& withSharedLibrary) {
     // ---------------------------------------------------------------
     //                      Auto-Index Generation
     // ---------------------------------------------------------------
@@ -1766,6 +2108,11 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     const RamProgram& prog = translationUnit.getProgram();
     auto* idxAnalysis = translationUnit.getAnalysis<RamIndexAnalysis>();
 
+    // the indexes of relations aggregated by range aggregates count their ranges
+    visitDepthFirst(prog, [&](const RamRangeAggregate& aggregate) {
+        countedRelations.insert(&aggregate.getRelation());
+    });
+
     // ---------------------------------------------------------------
     //                      Code Generation
     // ---------------------------------------------------------------
@@ -1774,22 +2121,31 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     std::string classname = "Sf_" + id;
 
-    // generate C++ program
+    // generate C++ program: the relation types, the program class, the out-of-line
+    // definitions of its members and the stand-alone main
+    GeneratedCode code;
+    std::stringstream typeDefs;
+    std::stringstream os;
+    std::stringstream defs;
+    defs << "namespace souffle {\n";
 
     if (Global::config().has("verbose")) {
-        os << "#define _SOUFFLE_STATS\n";
+        typeDefs << "#define _SOUFFLE_STATS\n";
     }
-    os << "\n#include \"souffle/CompiledSouffle.h\"\n";
+    typeDefs << "\n#include \"souffle/CompiledSouffle.h\"\n";
     if (Global::config().has("provenance")) {
-        os << "#include <mutex>\n";
-        os << "#include \"souffle/Explain.h\"\n";
+        typeDefs << "#include <mutex>\n";
+        typeDefs << "#include \"souffle/Explain.h\"\n";
     }
 
     if (Global::config().has("live-profile")) {
-        os << "#include <thread>\n";
-        os << "#include \"souffle/profile/Tui.h\"\n";
+        typeDefs << "#include <thread>\n";
+        typeDefs << "#include \"souffle/profile/Tui.h\"\n";
+    }
+    if (Global::config().has("checkpoint-dir")) {
+        typeDefs << "#include \"souffle/Checkpoint.h\"\n";
     }
-    os << "\n";
+    typeDefs << "\n";
     // produce external definitions for user-defined functors
     std::map<std::string, std::pair<TypeAttribute, std::vector<TypeAttribute>>> functors;
     visitDepthFirst(prog, [&](const RamUserDefinedOperator& op) {
@@ -1798,7 +2154,7 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         }
         withSharedLibrary = true;
     });
-    os << "extern \"C\" {\n";
+    typeDefs << "extern \"C\" {\n";
     for (const auto& f : functors) {
         //        size_t arity = f.second.length() - 1;
         const std::string& name = f.first;
@@ -1819,24 +2175,25 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             UNREACHABLE_BAD_CASE_ANALYSIS
         };
 
-        tfm::format(
-                os, "%s %s(%s);\n", cppTypeDecl(returnType), name, join(map(argsTypes, cppTypeDecl), ","));
+        tfm::format(typeDefs, "%s %s(%s);\n", cppTypeDecl(returnType), name,
+                join(map(argsTypes, cppTypeDecl), ","));
     }
-    os << "}\n";
-    os << "\n";
-    os << "namespace souffle {\n";
-    os << "static const RamDomain RAM_BIT_SHIFT_MASK = RAM_DOMAIN_SIZE - 1;\n";
+    typeDefs << "}\n";
+    typeDefs << "\n";
+    typeDefs << "namespace souffle {\n";
+    typeDefs << "static const RamDomain RAM_BIT_SHIFT_MASK = RAM_DOMAIN_SIZE - 1;\n";
 
     // synthesise data-structures for relations
     for (auto rel : prog.getRelations()) {
         bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                *rel, idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(*rel, idxAnalysis->getIndexes(*rel),
+                Global::config().has("provenance") && !isProvInfo, countedRelations.count(rel) > 0);
 
-        generateRelationTypeStruct(os, std::move(relationType));
+        generateRelationTypeStruct(typeDefs, std::move(relationType));
     }
-    os << '\n';
+    typeDefs << "}\n";
 
+    os << "namespace souffle {\n";
     os << "class " << classname << " : public SouffleProgram {\n";
 
     // regex wrapper
@@ -1866,18 +2223,10 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     os << "public:\n";
 
-    // declare symbol table
+    // declare symbol table, which is initialized by the constructor
     os << "// -- initialize symbol table --\n";
 
-    os << "SymbolTable symTable";
-    if (symTable.size() > 0) {
-        os << "{\n";
-        for (size_t i = 0; i < symTable.size(); i++) {
-            os << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
-        }
-        os << "}";
-    }
-    os << ";";
+    os << "SymbolTable symTable;";
 
     // declare record table
     os << "// -- initialize record table --\n";
@@ -1930,17 +2279,18 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         const std::string& cppName = getRelationName(*rel);
 
         bool isProvInfo = rel->getRepresentation() == RelationRepresentation::INFO;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                *rel, idxAnalysis->getIndexes(*rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(*rel, idxAnalysis->getIndexes(*rel),
+                Global::config().has("provenance") && !isProvInfo, countedRelations.count(rel) > 0);
         const std::string& type = relationType->getTypeName();
 
         // defining table
         os << "// -- Table: " << datalogName << "\n";
 
         os << "std::unique_ptr<" << type << "> " << cppName << " = std::make_unique<" << type << ">();\n";
-        if (!rel->isTemp()) {
+        // the preceding facts of an input relation belong to the state of an incremental evaluation
+        if (!rel->isTemp() ||
+                (Global::config().has("incremental") && datalogName.rfind("@previous_", 0) == 0)) {
             os << "souffle::RelationWrapper<";
-            os << relCtr++ << ",";
             os << type << ",";
             os << "Tuple<RamDomain," << arity << ">,";
             os << arity << ",";
@@ -1970,8 +2320,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             if (!initCons.empty()) {
                 initCons += ",\n";
             }
-            initCons += "\nwrapper_" + cppName + "(" + "*" + cppName + ",symTable,\"" + datalogName + "\"," +
-                        tupleType + "," + tupleName + ")";
+            initCons += "\nwrapper_" + cppName + "(" + std::to_string(relCtr++) + ",*" + cppName +
+                        ",symTable,\"" + datalogName + "\"," + tupleType + "," + tupleName + ")";
             registerRel += "addRelation(\"" + datalogName + "\",&wrapper_" + cppName + ",";
             registerRel += (loadRelations.count(rel->getName()) > 0) ? "true" : "false";
             registerRel += ",";
@@ -1983,24 +2333,36 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     // -- constructor --
 
-    os << classname;
+    std::vector<std::string> memberInits;
     if (Global::config().has("profile")) {
-        os << "(std::string pf=\"profile.log\") : profiling_fname(pf)";
-        if (!initCons.empty()) {
-            os << ",\n" << initCons;
-        }
+        os << classname << "(std::string pf=\"profile.log\");\n";
+        defs << classname << "::" << classname << "(std::string pf)";
+        memberInits.push_back("profiling_fname(pf)");
     } else {
-        os << "()";
-        if (!initCons.empty()) {
-            os << " : " << initCons;
+        os << classname << "();\n";
+        defs << classname << "::" << classname << "()";
+    }
+    if (symTable.size() > 0) {
+        std::stringstream symbols;
+        symbols << "symTable{\n";
+        for (size_t i = 0; i < symTable.size(); i++) {
+            symbols << "\tR\"_(" << symTable.resolve(i) << ")_\",\n";
         }
+        symbols << "}";
+        memberInits.push_back(symbols.str());
+    }
+    if (!initCons.empty()) {
+        memberInits.push_back(initCons);
     }
-    os << "{\n";
+    if (!memberInits.empty()) {
+        defs << " : " << join(memberInits, ",\n");
+    }
+    defs << "{\n";
     if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
+        defs << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
     }
-    os << registerRel;
-    os << "}\n";
+    defs << registerRel;
+    defs << "}\n";
     // -- destructor --
 
     os << "~" << classname << "() {\n";
@@ -2013,33 +2375,43 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "bool performIO;\n";
     os << "std::atomic<RamDomain> ctr{};\n\n";
     os << "std::atomic<size_t> iter{};\n";
+    if (Global::config().has("checkpoint-dir")) {
+        os << "std::string checkpointDirectory = R\"(" << Global::config().get("checkpoint-dir") << ")\";\n";
+        os << "public:\n";
+        os << "void setCheckpointDirectory(const std::string& dir) { checkpointDirectory = dir; }\n";
+        os << "private:\n";
+        if (Global::config().has("incremental")) {
+            os << "bool restored = false;\n";
+        }
+    }
 
     os << "void runFunction(std::string inputDirectory = \".\", "
-          "std::string outputDirectory = \".\", bool performIO = false) "
-          "{\n";
+          "std::string outputDirectory = \".\", bool performIO = false);\n";
+    defs << "void " << classname << "::runFunction(std::string inputDirectory, "
+         << "std::string outputDirectory, bool performIO) {\n";
 
-    os << "this->inputDirectory = inputDirectory;\n";
-    os << "this->outputDirectory = outputDirectory;\n";
-    os << "this->performIO = performIO;\n";
+    defs << "this->inputDirectory = inputDirectory;\n";
+    defs << "this->outputDirectory = outputDirectory;\n";
+    defs << "this->performIO = performIO;\n";
 
-    os << "SignalHandler::instance()->set();\n";
+    defs << "SignalHandler::instance()->set();\n";
     if (Global::config().has("verbose")) {
-        os << "SignalHandler::instance()->enableLogging();\n";
+        defs << "SignalHandler::instance()->enableLogging();\n";
     }
 
     // set default threads (in embedded mode)
     // if this is not set, and omp is used, the default omp setting of number of cores is used.
-    os << "#if defined(_OPENMP)\n";
-    os << "if (getNumThreads() > 0) {omp_set_num_threads(getNumThreads());}\n";
-    os << "#endif\n\n";
+    defs << "#if defined(_OPENMP)\n";
+    defs << "if (getNumThreads() > 0) {omp_set_num_threads(getNumThreads());}\n";
+    defs << "#endif\n\n";
 
     // add actual program body
-    os << "// -- query evaluation --\n";
+    defs << "// -- query evaluation --\n";
     if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().startTimer();\n";
-        os << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
-        os << "{\n"
-           << R"_(Logger logger("@runtime;", 0);)_" << '\n';
+        defs << "ProfileEventSingleton::instance().startTimer();\n";
+        defs << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
+        defs << "{\n"
+             << R"_(Logger logger("@runtime;", 0);)_" << '\n';
         // Store count of relations
         size_t relationCount = 0;
         for (auto rel : prog.getRelations()) {
@@ -2048,34 +2420,49 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             }
         }
         // Store configuration
-        os << R"_(ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string()_"
-           << relationCount << "));";
+        defs << R"_(ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string()_"
+             << relationCount << "));";
+    }
+
+    // an incremental evaluation continues from the snapshot of the preceding run
+    const bool snapshot = Global::config().has("incremental") && Global::config().has("checkpoint-dir");
+    if (snapshot) {
+        defs << "Checkpoint checkpoint(checkpointDirectory, \"" << Checkpoint::getFingerprint(toString(prog))
+             << "\", symTable, recordTable, getAllRelations());\n";
+        defs << "if (!restored) {\n";
+        defs << "checkpoint.restore();\n";
+        defs << "restored = true;\n";
+        defs << "}\n";
     }
 
     // emit code
-    emitCode(os, prog.getMain());
+    emitCode(defs, prog.getMain());
+
+    if (snapshot) {
+        defs << "checkpoint.saveAll();\n";
+    }
 
     if (Global::config().has("profile")) {
-        os << "}\n";
-        os << "ProfileEventSingleton::instance().stopTimer();\n";
-        os << "dumpFreqs();\n";
+        defs << "}\n";
+        defs << "ProfileEventSingleton::instance().stopTimer();\n";
+        defs << "dumpFreqs();\n";
     }
 
     // add code printing hint statistics
-    os << "\n// -- relation hint statistics --\n";
+    defs << "\n// -- relation hint statistics --\n";
 
     if (Global::config().has("verbose")) {
         for (auto rel : prog.getRelations()) {
             auto name = getRelationName(*rel);
-            os << "std::cout << \"Statistics for Relation " << name << ":\\n\";\n";
-            os << name << "->printStatistics(std::cout);\n";
-            os << "std::cout << \"\\n\";\n";
+            defs << "std::cout << \"Statistics for Relation " << name << ":\\n\";\n";
+            defs << name << "->printStatistics(std::cout);\n";
+            defs << "std::cout << \"\\n\";\n";
         }
     }
 
-    os << "SignalHandler::instance()->reset();\n";
+    defs << "SignalHandler::instance()->reset();\n";
 
-    os << "}\n";  // end of runFunction() method
+    defs << "}\n";  // end of runFunction() method
 
     // add methods to run with and without performing IO (mainly for the interface)
     os << "public:\nvoid run() override { runFunction(\".\", \".\", "
@@ -2092,7 +2479,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "}\n";
     // issue printAll method
     os << "public:\n";
-    os << "void printAll(std::string outputDirectory = \".\") override {\n";
+    os << "void printAll(std::string outputDirectory = \".\") override;\n";
+    defs << "void " << classname << "::printAll(std::string outputDirectory) {\n";
 
     // print directives as C++ initializers
     auto printDirectives = [&](const std::map<std::string, std::string>& registry) {
@@ -2100,54 +2488,56 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         if (cur == registry.end()) {
             return;
         }
-        os << "{{\"" << cur->first << "\",\"" << escape(cur->second) << "\"}";
+        defs << "{{\"" << cur->first << "\",\"" << escape(cur->second) << "\"}";
         ++cur;
         for (; cur != registry.end(); ++cur) {
-            os << ",{\"" << cur->first << "\",\"" << escape(cur->second) << "\"}";
+            defs << ",{\"" << cur->first << "\",\"" << escape(cur->second) << "\"}";
         }
-        os << '}';
+        defs << '}';
     };
 
     for (auto store : storeIOs) {
         auto const& directive = store->getDirectives();
-        os << "try {";
-        os << "std::map<std::string, std::string> directiveMap(";
+        defs << "try {";
+        defs << "std::map<std::string, std::string> directiveMap(";
         printDirectives(directive);
-        os << ");\n";
-        os << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
-        os << "directiveMap[\"filename\"].front() != '/') {";
-        os << R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
-        os << "}\n";
-        os << "IOSystem::getInstance().getWriter(";
-        os << "directiveMap, symTable, recordTable";
-        os << ")->writeAll(*" << getRelationName(store->getRelation()) << ");\n";
-
-        os << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+        defs << ");\n";
+        defs << R"_(if (!outputDirectory.empty() && (directiveMap["IO"] == "file" || )_";
+        defs << R"_(directiveMap["IO"] == "binary") && )_";
+        defs << "directiveMap[\"filename\"].front() != '/') {";
+        defs << R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
+        defs << "}\n";
+        defs << "IOSystem::getInstance().getWriter(";
+        defs << "directiveMap, symTable, recordTable";
+        defs << ")->writeAll(*" << getRelationName(store->getRelation()) << ");\n";
+
+        defs << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
     }
-    os << "}\n";  // end of printAll() method
+    defs << "}\n";  // end of printAll() method
 
     // issue loadAll method
-    os << "public:\n";
-    os << "void loadAll(std::string inputDirectory = \".\") override {\n";
+    os << "void loadAll(std::string inputDirectory = \".\") override;\n";
+    defs << "void " << classname << "::loadAll(std::string inputDirectory) {\n";
 
     for (auto load : loadIOs) {
-        os << "try {";
-        os << "std::map<std::string, std::string> directiveMap(";
+        defs << "try {";
+        defs << "std::map<std::string, std::string> directiveMap(";
         printDirectives(load->getDirectives());
-        os << ");\n";
-        os << R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
-        os << "directiveMap[\"filename\"].front() != '/') {";
-        os << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
-        os << "}\n";
-        os << "IOSystem::getInstance().getReader(";
-        os << "directiveMap, symTable, recordTable";
-        os << ")->readAll(*" << getRelationName(load->getRelation());
-        os << ");\n";
-        os << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
-              "'\\n';}\n";
+        defs << ");\n";
+        defs << R"_(if (!inputDirectory.empty() && (directiveMap["IO"] == "file" || )_";
+        defs << R"_(directiveMap["IO"] == "binary") && )_";
+        defs << "directiveMap[\"filename\"].front() != '/') {";
+        defs << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
+        defs << "}\n";
+        defs << "IOSystem::getInstance().getReader(";
+        defs << "directiveMap, symTable, recordTable";
+        defs << ")->readAll(*" << getRelationName(load->getRelation());
+        defs << ");\n";
+        defs << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
+                "'\\n';}\n";
     }
 
-    os << "}\n";  // end of loadAll() method
+    defs << "}\n";  // end of loadAll() method
     // issue dump methods
     auto dumpRelation = [&](const RamRelation& ramRelation) {
         const auto& relName = getRelationName(ramRelation);
@@ -2160,34 +2550,34 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
         Json types = Json::object{{name, relJson}};
 
-        os << "try {";
-        os << "std::map<std::string, std::string> rwOperation;\n";
-        os << "rwOperation[\"IO\"] = \"stdout\";\n";
-        os << R"(rwOperation["name"] = ")" << name << "\";\n";
-        os << "rwOperation[\"types\"] = ";
-        os << "\"" << escapeJSONstring(types.dump()) << "\"";
-        os << ";\n";
-        os << "IOSystem::getInstance().getWriter(";
-        os << "rwOperation, symTable, recordTable";
-        os << ")->writeAll(*" << relName << ");\n";
-        os << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+        defs << "try {";
+        defs << "std::map<std::string, std::string> rwOperation;\n";
+        defs << "rwOperation[\"IO\"] = \"stdout\";\n";
+        defs << R"(rwOperation["name"] = ")" << name << "\";\n";
+        defs << "rwOperation[\"types\"] = ";
+        defs << "\"" << escapeJSONstring(types.dump()) << "\"";
+        defs << ";\n";
+        defs << "IOSystem::getInstance().getWriter(";
+        defs << "rwOperation, symTable, recordTable";
+        defs << ")->writeAll(*" << relName << ");\n";
+        defs << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
     };
 
     // dump inputs
-    os << "public:\n";
-    os << "void dumpInputs(std::ostream& out = std::cout) override {\n";
+    os << "void dumpInputs(std::ostream& out = std::cout) override;\n";
+    defs << "void " << classname << "::dumpInputs(std::ostream& out) {\n";
     for (auto load : loadIOs) {
         dumpRelation(load->getRelation());
     }
-    os << "}\n";  // end of dumpInputs() method
+    defs << "}\n";  // end of dumpInputs() method
 
     // dump outputs
-    os << "public:\n";
-    os << "void dumpOutputs(std::ostream& out = std::cout) override {\n";
+    os << "void dumpOutputs(std::ostream& out = std::cout) override;\n";
+    defs << "void " << classname << "::dumpOutputs(std::ostream& out) {\n";
     for (auto store : storeIOs) {
         dumpRelation(store->getRelation());
     }
-    os << "}\n";  // end of dumpOutputs() method
+    defs << "}\n";  // end of dumpOutputs() method
 
     os << "public:\n";
     os << "SymbolTable& getSymbolTable() override {\n";
@@ -2239,20 +2629,25 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             os << "void "
                << "subroutine_" << subroutineNum
                << "(const std::vector<RamDomain>& args, "
-                  "std::vector<RamDomain>& ret) {\n";
+                  "std::vector<RamDomain>& ret);\n";
+            std::stringstream method;
+            method << "void " << classname << "::subroutine_" << subroutineNum
+                   << "(const std::vector<RamDomain>& args, "
+                      "std::vector<RamDomain>& ret) {\n";
 
             // issue lock variable for return statements
             bool needLock = false;
             visitDepthFirst(*sub.second, [&](const RamSubroutineReturn&) { needLock = true; });
             if (needLock) {
-                os << "std::mutex lock;\n";
+                method << "std::mutex lock;\n";
             }
 
             // emit code for subroutine
-            emitCode(os, *sub.second);
+            emitCode(method, *sub.second);
 
             // issue end of subroutine
-            os << "}\n";
+            method << "}\n";
+            code.subroutines.push_back(method.str());
             subroutineNum++;
         }
     }
@@ -2261,95 +2656,214 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     //  are not populated.
     if (Global::config().has("profile")) {
         os << "private:\n";
-        os << "void dumpFreqs() {\n";
+        os << "void dumpFreqs();\n";
+        defs << "void " << classname << "::dumpFreqs() {\n";
         for (auto const& cur : idxMap) {
-            os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(" << cur.first << ")_\", freqs["
-               << cur.second << "],0);\n";
+            defs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(" << cur.first
+                 << ")_\", freqs[" << cur.second << "],0);\n";
         }
         for (auto const& cur : neIdxMap) {
-            os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;" << cur.first
-               << ")_\", reads[" << cur.second << "],0);\n";
+            defs << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;"
+                 << cur.first << ")_\", reads[" << cur.second << "],0);\n";
         }
-        os << "}\n";  // end of dumpFreqs() method
+        defs << "}\n";  // end of dumpFreqs() method
     }
     os << "};\n";  // end of class declaration
+    os << "}\n";
 
     // hidden hooks
-    os << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
-    os << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
-       << "*>(p)->symTable;}\n";
-
-    os << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
-    os << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
-    os << "SouffleProgram *newInstance() {\n";
-    os << "return new " << classname << "();\n";
-    os << "};\n";
-    os << "public:\n";
-    os << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
-    os << "};\n";
-    os << "extern \"C\" {\n";
-    os << "factory_" << classname << " __factory_" << classname << "_instance;\n";
-    os << "}\n";
-    os << "}\n";
-    os << "#else\n";
-    os << "}\n";
-    os << "int main(int argc, char** argv)\n{\n";
-    os << "try{\n";
+    defs << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
+    defs << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
+         << "*>(p)->symTable;}\n";
+
+    defs << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
+    defs << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
+    defs << "SouffleProgram *newInstance() {\n";
+    defs << "return new " << classname << "();\n";
+    defs << "};\n";
+    defs << "public:\n";
+    defs << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
+    defs << "};\n";
+    defs << "extern \"C\" {\n";
+    defs << "factory_" << classname << " __factory_" << classname << "_instance;\n";
+    defs << "}\n";
+    defs << "}\n";
+    defs << "#else\n";
+    defs << "}\n";
+    defs << "int main(int argc, char** argv)\n{\n";
+    defs << "try{\n";
 
     // parse arguments
-    os << "souffle::CmdOptions opt(";
-    os << "R\"(" << Global::config().get("") << ")\",\n";
-    os << "R\"(.)\",\n";
-    os << "R\"(.)\",\n";
+    defs << "souffle::CmdOptions opt(";
+    defs << "R\"(" << Global::config().get("") << ")\",\n";
+    defs << "R\"(.)\",\n";
+    defs << "R\"(.)\",\n";
     if (Global::config().has("profile")) {
-        os << "true,\n";
-        os << "R\"(" << Global::config().get("profile") << ")\",\n";
+        defs << "true,\n";
+        defs << "R\"(" << Global::config().get("profile") << ")\",\n";
     } else {
-        os << "false,\n";
-        os << "R\"()\",\n";
+        defs << "false,\n";
+        defs << "R\"()\",\n";
     }
-    os << std::stoi(Global::config().get("jobs"));
-    os << ");\n";
+    defs << std::stoi(Global::config().get("jobs"));
+    if (Global::config().has("checkpoint-dir")) {
+        defs << ",\ntrue,\n";
+        defs << "R\"(" << Global::config().get("checkpoint-dir") << ")\"";
+    }
+    defs << ");\n";
 
-    os << "if (!opt.parse(argc,argv)) return 1;\n";
+    defs << "if (!opt.parse(argc,argv)) return 1;\n";
 
-    os << "souffle::";
+    defs << "souffle::";
     if (Global::config().has("profile")) {
-        os << classname + " obj(opt.getProfileName());\n";
+        defs << classname + " obj(opt.getProfileName());\n";
     } else {
-        os << classname + " obj;\n";
+        defs << classname + " obj;\n";
     }
 
-    os << "#if defined(_OPENMP) \n";
-    os << "obj.setNumThreads(opt.getNumJobs());\n";
-    os << "\n#endif\n";
+    defs << "#if defined(_OPENMP) \n";
+    defs << "obj.setNumThreads(opt.getNumJobs());\n";
+    defs << "\n#endif\n";
+    if (Global::config().has("checkpoint-dir")) {
+        defs << "obj.setCheckpointDirectory(opt.getCheckpointDir());\n";
+    }
 
     if (Global::config().has("profile")) {
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
-           << Global::config().get("version") << R"_(");)_" << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
+             << '\n';
+        defs << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
+             << Global::config().get("version") << R"_(");)_" << '\n';
     }
-    os << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+    defs << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
 
     if (Global::config().get("provenance") == "explain") {
-        os << "explain(obj, false, false);\n";
+        defs << "explain(obj, false, false);\n";
     } else if (Global::config().get("provenance") == "subtreeHeights") {
-        os << "obj.copyIndex();\n";
-        os << "explain(obj, false, true);\n";
+        defs << "obj.copyIndex();\n";
+        defs << "explain(obj, false, true);\n";
     } else if (Global::config().get("provenance") == "explore") {
-        os << "explain(obj, true, false);\n";
+        defs << "explain(obj, true, false);\n";
+    }
+    defs << "return 0;\n";
+    defs << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
+    defs << "}\n";
+    defs << "\n#endif\n";
+
+    code.types = typeDefs.str();
+    code.program = os.str();
+    code.main = defs.str();
+    return code;
+}
+
+void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary) {
+    GeneratedCode code = generateParts(id, withSharedLibrary);
+    os << code.types << code.program;
+    os << "namespace souffle {\n";
+    for (const auto& subroutine : code.subroutines) {
+        os << subroutine;
     }
-    os << "return 0;\n";
-    os << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
     os << "}\n";
-    os << "\n#endif\n";
+    os << code.main;
+}
+
+namespace {
+
+/** Write a file unless it already has the given content, so that its timestamp is kept */
+void writeIfChanged(const std::string& filename, const std::string& content) {
+    std::ifstream in(filename, std::ios::binary);
+    if (in) {
+        std::stringstream current;
+        current << in.rdbuf();
+        if (current.str() == content) {
+            return;
+        }
+    }
+    std::ofstream out(filename, std::ios::binary);
+    out << content;
+    if (!out) {
+        throw std::runtime_error("cannot write file " + filename);
+    }
+}
+
+}  // namespace
+
+std::vector<std::string> Synthesiser::generateUnits(
+        const std::string& baseFilename, const std::string& id, bool& withSharedLibrary) {
+    GeneratedCode code = generateParts(id, withSharedLibrary);
+    const std::string name = baseName(baseFilename);
+    std::string guard = "SOUFFLE_" + id + "_";
+    for (char& c : guard) {
+        c = std::isalnum(static_cast<unsigned char>(c)) ? std::toupper(static_cast<unsigned char>(c)) : '_';
+    }
+
+    // relation types, shared by all units and precompiled by souffle-compile
+    writeIfChanged(baseFilename + "_types.h",
+            "#ifndef " + guard + "TYPES_H\n#define " + guard + "TYPES_H\n" + code.types + "#endif\n");
+
+    // the program class
+    writeIfChanged(baseFilename + ".h", "#ifndef " + guard + "PROGRAM_H\n#define " + guard + "PROGRAM_H\n" +
+                                                "#include \"" + name + "_types.h\"\n" + code.program +
+                                                "#endif\n");
+
+    // the relation types are included first by the units, which lets the compiler use their
+    // precompiled header; it is not used when included from within another header
+    const std::string includes = "#include \"" + name + "_types.h\"\n#include \"" + name + ".h\"\n";
+
+    // members of the program class and the stand-alone main
+    writeIfChanged(baseFilename + ".cpp", includes + code.main);
+
+    // The subroutines are grouped into units of roughly unitSize bytes. A unit ends at a
+    // subroutine whose hash selects it, so that editing one stratum changes the boundaries of
+    // its own unit only. Units are named by the hash of their content, so that a unit keeps its
+    // file, and its object file, when units before it are added or removed.
+    const std::size_t unitSize = 64 * 1024;
+    const std::string directory = baseFilename.substr(0, baseFilename.size() - name.size());
+    const std::string unitPrefix = name + "_unit_";
+    std::vector<std::string> units;
+    std::set<std::string> unitNames;
+    std::string unit;
+    auto flush = [&]() {
+        std::string content = includes + "namespace souffle {\n" + unit + "}\n";
+        std::stringstream unitName;
+        unitName << unitPrefix << std::hex << std::setw(16) << std::setfill('0')
+                 << static_cast<uint64_t>(std::hash<std::string>()(content));
+        assert(unitNames.count(unitName.str()) == 0 && "units with the same content");
+        unitNames.insert(unitName.str());
+        std::string filename = directory + unitName.str() + ".cpp";
+        writeIfChanged(filename, content);
+        units.push_back(filename);
+        unit.clear();
+    };
+    for (const auto& subroutine : code.subroutines) {
+        unit += subroutine;
+        if ((unit.size() >= unitSize && std::hash<std::string>()(subroutine) % 4 == 0) ||
+                unit.size() >= 4 * unitSize) {
+            flush();
+        }
+    }
+    if (!unit.empty()) {
+        flush();
+    }
+
+    // remove the units, and their object files, left over from a previous version of the program
+    for (const std::string& entry : listDir(directory.empty() ? "." : directory)) {
+        const std::string stem = entry.substr(0, entry.rfind('.'));
+        if (stem.size() != unitPrefix.size() + 16 || stem.compare(0, unitPrefix.size(), unitPrefix) != 0 ||
+                unitNames.count(stem) > 0) {
+            continue;
+        }
+        const std::string extension = entry.substr(stem.size());
+        if (extension == ".cpp" || extension == ".o") {
+            std::remove((directory + entry).c_str());
+        }
+    }
+    return units;
 }
 
 }  // end of namespace souffle
@@ -23,6 +23,7 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -55,6 +56,9 @@ private:
     /** Cache for generated types for relations */
     std::set<std::string> typeCache;
 
+    /** Relations whose ranges are counted by range aggregates */
+    std::set<const RamRelation*> countedRelations;
+
 protected:
     /** Get record table */
     const RecordTable& getRecordTable();
@@ -71,6 +75,9 @@ protected:
     /** Get relation struct definition */
     void generateRelationTypeStruct(std::ostream& out, std::unique_ptr<SynthesiserRelation> relationType);
 
+    /** Check whether the indexes of a relation count their ranges */
+    bool isCountedRelation(const RamRelation& rel);
+
     /** Get referenced relations */
     std::set<const RamRelation*> getReferencedRelations(const RamOperation& op);
 
@@ -83,6 +90,24 @@ protected:
     /** Lookup read counter */
     size_t lookupReadIdx(const std::string& txt);
 
+    /** Parts of the generated program */
+    struct GeneratedCode {
+        /** Includes and relation types */
+        std::string types;
+
+        /** Declaration of the program class */
+        std::string program;
+
+        /** Definitions of the subroutines of the program class */
+        std::vector<std::string> subroutines;
+
+        /** Definitions of the remaining members and the stand-alone main */
+        std::string main;
+    };
+
+    /** Generate the parts of the program */
+    GeneratedCode generateParts(const std::string& id, bool& withSharedLibrary);
+
 public:
     explicit Synthesiser(RamTranslationUnit& tUnit) : translationUnit(tUnit) {}
     virtual ~Synthesiser() = default;
@@ -94,5 +119,14 @@ public:
 
     /** Generate code */
     void generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary);
+
+    /**
+     * Generate code split into translation units: <base>_types.h, <base>.h, <base>.cpp and the
+     * units <base>_unit_<hash>.cpp holding the subroutines, named by the hash of their content;
+     * files whose content is unchanged are not rewritten and stale units are removed. Returns the
+     * filenames of the units.
+     */
+    std::vector<std::string> generateUnits(
+            const std::string& baseFilename, const std::string& id, bool& withSharedLibrary);
 };
 }  // end of namespace souffle
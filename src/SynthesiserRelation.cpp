@@ -22,8 +22,8 @@
 
 namespace souffle {
 
-std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(
-        const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance) {
+std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(const RamRelation& ramRel,
+        const MinIndexSelection& indexSet, bool isProvenance, bool isCounted) {
     SynthesiserRelation* rel;
 
     // Handle the qualifier in souffle code
@@ -32,7 +32,7 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
-        rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
+        rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance, isCounted);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
         rel = new SynthesiserBrieRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::EQREL) {
@@ -44,7 +44,7 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         if (ramRel.getArity() > 6) {
             rel = new SynthesiserIndirectRelation(ramRel, indexSet, isProvenance);
         } else {
-            rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
+            rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance, isCounted);
         }
     }
 
@@ -204,7 +204,7 @@ void SynthesiserDirectRelation::computeIndices() {
 /** Generate type name of a direct indexed relation */
 std::string SynthesiserDirectRelation::getTypeName() {
     std::stringstream res;
-    res << "t_btree_" << getArity();
+    res << (isCounted ? "t_btree_counted_" : "t_btree_") << getArity();
 
     for (auto& ind : getIndices()) {
         res << "__" << join(ind, "_");
@@ -269,6 +269,12 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
                 out << join(ind.begin(), ind.end()) << ">, updater_" << getTypeName() << ">;\n";
             }
             // without provenance, some indices may be not full, so we use btree_multiset for those
+        } else if (isCounted) {
+            // the sizes of sub-trees are kept for counting ranges
+            out << "using t_ind_" << i << " = " << (ind.size() == arity ? "btree_set" : "btree_multiset")
+                << "<t_tuple, index_utils::comparator<" << join(ind) << ">, std::allocator<t_tuple>, 256, "
+                << "typename souffle::detail::default_strategy<t_tuple>::type, index_utils::comparator<"
+                << join(ind) << ">, souffle::detail::updater<t_tuple>, true>;\n";
         } else {
             if (ind.size() == arity) {
                 out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind)
@@ -328,6 +334,58 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
 
+    // insertAll methods; relations of the same type with full indexes only are merged index by index
+    if (!isProvenance) {
+        bool allFull = true;
+        for (auto& ind : inds) {
+            allFull = allFull && ind.size() == arity;
+        }
+        if (allFull) {
+            out << "void insertAll(" << getTypeName() << "& other) {\n";
+            for (size_t i = 0; i < numIndexes; i++) {
+                out << "ind_" << i << ".insertAll(other.ind_" << i << ");\n";
+            }
+            out << "}\n";  // end of insertAll(Type& other)
+
+            // sorted input, e.g. of binary files, is loaded into the indexes bottom-up
+            out << "void insertSorted(const RamDomain* ramDomain, std::size_t count) {\n";
+            out << "const t_tuple* tuples = reinterpret_cast<const t_tuple*>(ramDomain);\n";
+            out << "if (count * t_ind_" << masterIndex << "::merge_ratio < ind_" << masterIndex
+                << ".size()) {\n";
+            out << "context h;\n";
+            out << "for (std::size_t i = 0; i < count; ++i) {\n";
+            out << "insert(tuples[i], h);\n";
+            out << "}\n";
+            out << "return;\n";
+            out << "}\n";
+            for (size_t i = 0; i < numIndexes; i++) {
+                bool natural = true;
+                for (size_t j = 0; j < arity; j++) {
+                    natural = natural && inds[i][j] == j;
+                }
+                if (natural) {
+                    out << "ind_" << i << ".insertSorted(tuples, tuples + count);\n";
+                    continue;
+                }
+                out << "{\n";
+                out << "std::vector<t_tuple> sorted(tuples, tuples + count);\n";
+                out << "std::sort(sorted.begin(), sorted.end(), [](const t_tuple& a, const t_tuple& b) {\n";
+                out << "return index_utils::comparator<" << join(inds[i]) << ">().less(a, b);\n";
+                out << "});\n";
+                out << "ind_" << i << ".insertSorted(sorted.begin(), sorted.end());\n";
+                out << "}\n";
+            }
+            out << "}\n";  // end of insertSorted(RamDomain*, size_t)
+        }
+        out << "template <typename T>\n";
+        out << "void insertAll(T& other) {\n";
+        out << "context h;\n";
+        out << "for (const auto& t : other) {\n";
+        out << "insert(t, h);\n";
+        out << "}\n";
+        out << "}\n";  // end of insertAll(T& other)
+    }
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".contains(t, h.hints_" << masterIndex << ");\n";
@@ -411,7 +469,52 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         out << "context h;\n";
         out << "return lowerUpperRange_" << search << "(lower,upper,h);\n";
         out << "}\n";
+
+        // counted indexes determine the size and the last element of the range without enumerating it
+        if (isCounted) {
+            auto padBounds = [&]() {
+                out << "t_tuple low(lower); t_tuple high(lower);\n";
+                for (size_t column = 0; column < arity; column++) {
+                    if (search[column] == AttributeConstraint::None) {
+                        out << "low[" << column << "] = MIN_RAM_SIGNED;\n";
+                        out << "high[" << column << "] = MAX_RAM_SIGNED;\n";
+                    }
+                }
+            };
+
+            out << "std::size_t countRange_" << search;
+            out << "(const t_tuple& lower, const t_tuple& upper, context& h) const {\n";
+            padBounds();
+            out << "return ind_" << indNum << ".count(low, high);\n";
+            out << "}\n";
+
+            out << "range<t_ind_" << indNum << "::iterator> lastInRange_" << search;
+            out << "(const t_tuple& lower, const t_tuple& upper, context& h) const {\n";
+            padBounds();
+            out << "auto fin = ind_" << indNum << ".end();\n";
+            out << "std::size_t n = ind_" << indNum << ".count(low, high);\n";
+            out << "if (n == 0) return make_range(fin, fin);\n";
+            out << "auto pos = ind_" << indNum << ".select(ind_" << indNum << ".rank(low) + n - 1);\n";
+            out << "fin = pos; ++fin;\n";
+            out << "return make_range(pos, fin);\n";
+            out << "}\n";
+        }
+    }
+
+    // lookup method for the relation interface, passing the range of an index led by the bound columns
+    out << "template <typename Callback>\n";
+    out << "bool lookup(const std::vector<bool>& bound, const t_tuple& low, const t_tuple& high, "
+           "Callback&& callback) const {\n";
+    out << "context h;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "if (index_utils::isBoundPrefix({" << join(inds[i]) << "}, bound)) {\n";
+        out << "callback(make_range(ind_" << i << ".lower_bound(low, h.hints_" << i << "), ind_" << i
+            << ".upper_bound(high, h.hints_" << i << ")));\n";
+        out << "return true;\n";
+        out << "}\n";
     }
+    out << "return false;\n";
+    out << "}\n";
 
     // empty method
     out << "bool empty() const {\n";
@@ -1133,6 +1236,11 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     out << "return insert(data);\n";
     out << "}\n";
 
+    // insertAll method for eqrel, which unites the sets of both relations
+    out << "void insertAll(" << getTypeName() << "& other) {\n";
+    out << "ind_" << masterIndex << ".insertAll(other.ind_" << masterIndex << ");\n";
+    out << "}\n";
+
     // extends method for eqrel
     // performs a delta extension, where we union the sets that share elements between this and other.
     //      i.e. if a in this, and a in other, union(set(this->a), set(other->a))
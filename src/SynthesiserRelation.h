@@ -66,9 +66,9 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(std::ostream& out) = 0;
 
-    /** Factory method to generate a SynthesiserRelation */
-    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(
-            const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance);
+    /** Factory method to generate a SynthesiserRelation; counted relations count ranges of their indexes */
+    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(const RamRelation& ramRel,
+            const MinIndexSelection& indexSet, bool isProvenance, bool isCounted = false);
 
 protected:
     /** Ram relation referred to by this */
@@ -116,12 +116,17 @@ public:
 
 class SynthesiserDirectRelation : public SynthesiserRelation {
 public:
-    SynthesiserDirectRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
-            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+    SynthesiserDirectRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance,
+            bool isCounted = false)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance), isCounted(isCounted && !isProvenance) {}
 
     void computeIndices() override;
     std::string getTypeName() override;
     void generateTypeStruct(std::ostream& out) override;
+
+private:
+    /** Do the indexes keep the sizes of their sub-trees for counting ranges */
+    const bool isCounted;
 };
 
 class SynthesiserIndirectRelation : public SynthesiserRelation {
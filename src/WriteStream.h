@@ -49,11 +49,12 @@ public:
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
-            return;
-        }
-        for (const auto& current : relation) {
-            writeNext(current);
+        } else {
+            for (const auto& current : relation) {
+                writeNext(current);
+            }
         }
+        finish();
     }
 
     template <typename T>
@@ -66,6 +67,8 @@ protected:
 
     virtual void writeNullary() = 0;
     virtual void writeNextTuple(const RamDomain* tuple) = 0;
+    /** Completes the output once all tuples are written; failures are reported by exceptions */
+    virtual void finish() {}
     virtual void writeSize(std::size_t) {
         fatal("attempting to print size of a write operation");
     }
@@ -0,0 +1,184 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamBinary.h
+ *
+ * Writes relations into binary, column-oriented files (IO=binary).
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BinaryRelationFormat.h"
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include "WriteStream.h"
+#include "utility/ContainerUtil.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+class RecordTable;
+
+/**
+ * Writes a relation into a binary file.
+ *
+ * The columns are collected while the tuples are written and stored once all
+ * tuples are written, in the layout described in BinaryRelationFormat.h, along
+ * with the dictionary of the symbols occurring in the relation. The file is
+ * flagged as sorted if the tuples arrive in lexicographical order, as they do
+ * from relations whose main index orders the attributes naturally. Besides the
+ * attributes of the relation, its auxiliary attributes are stored as well; those
+ * of a nullary relation are not passed to the writer and stored as 0, as they
+ * are filled by the readers of the other formats.
+ */
+class WriteStreamBinary : public WriteStream {
+public:
+    WriteStreamBinary(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
+            const RecordTable& recordTable)
+            : WriteStream(rwOperation, symbolTable, recordTable),
+              fileName(getOr(rwOperation, "filename", rwOperation.at("name") + ".bin")),
+              file(fileName, std::ios::out | std::ios::binary | std::ios::trunc),
+              columns(typeAttributes.size()) {
+        if (!file) {
+            throw std::invalid_argument("Cannot open binary file " + fileName);
+        }
+        for (const auto& type : typeAttributes) {
+            if (type[0] == 'r') {
+                throw std::invalid_argument("Records are not supported by binary files: " + fileName);
+            }
+        }
+        header.width = typeAttributes.size();
+        header.flags = BinaryRelationHeader::SORTED;
+    }
+
+protected:
+    void writeNullary() override {
+        for (auto& column : columns) {
+            column.push_back(0);
+        }
+        header.numTuples = 1;
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        // keep track of whether the tuples arrive in lexicographical order
+        if (header.numTuples > 0 && std::lexicographical_compare(tuple, tuple + columns.size(),
+                                            previous.begin(), previous.end())) {
+            header.flags &= ~BinaryRelationHeader::SORTED;
+        }
+        previous.assign(tuple, tuple + columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            columns[i].push_back(tuple[i]);
+        }
+        ++header.numTuples;
+    }
+
+    void finish() override {
+        writeSymbols();
+        header.numSymbols = symbolOffsets.size() - 1;
+        header.symbolBytes = symbolData.size();
+        writeSection(&header, sizeof(header), BinaryRelationHeader::typesOffset());
+        std::string types;
+        for (const auto& type : typeAttributes) {
+            types += type[0];
+        }
+        writeSection(types.data(), types.size(), header.symbolOffsetsOffset());
+        writeSection(
+                symbolOffsets.data(), symbolOffsets.size() * sizeof(uint64_t), header.symbolDataOffset());
+        writeSection(symbolData.data(), symbolData.size(), header.columnOffset(0));
+        for (size_t i = 0; i < columns.size(); ++i) {
+            writeSection(
+                    columns[i].data(), columns[i].size() * sizeof(RamDomain), header.columnOffset(i + 1));
+        }
+        file.close();
+        if (!file) {
+            throw std::invalid_argument("Cannot write binary file " + fileName);
+        }
+    }
+
+private:
+    /**
+     * Build the dictionary of the symbols in the order of their ids and replace the
+     * symbols of the columns by their positions in the dictionary, which preserves
+     * the order of the tuples.
+     */
+    void writeSymbols() {
+        std::vector<RamDomain> symbols;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (typeAttributes[i][0] == 's') {
+                symbols.insert(symbols.end(), columns[i].begin(), columns[i].end());
+            }
+        }
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+        symbolOffsets.push_back(0);
+        for (RamDomain symbol : symbols) {
+            const std::string& text = symbolTable.unsafeResolve(symbol);
+            symbolData.insert(symbolData.end(), text.begin(), text.end());
+            symbolOffsets.push_back(symbolData.size());
+        }
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (typeAttributes[i][0] != 's') {
+                continue;
+            }
+            for (RamDomain& value : columns[i]) {
+                value = static_cast<RamDomain>(
+                        std::lower_bound(symbols.begin(), symbols.end(), value) - symbols.begin());
+            }
+        }
+    }
+
+    /** Write a section followed by the padding up to the given offset of the next section */
+    void writeSection(const void* data, size_t size, uint64_t next) {
+        file.write(static_cast<const char*>(data), size);
+        static const char padding[8] = {};
+        file.write(padding, static_cast<std::streamsize>(next - static_cast<uint64_t>(file.tellp())));
+    }
+
+    const std::string fileName;
+    std::ofstream file;
+    BinaryRelationHeader header;
+
+    /** the values of each attribute */
+    std::vector<std::vector<RamDomain>> columns;
+
+    /** the values of the preceding tuple */
+    std::vector<RamDomain> previous;
+
+    /** the dictionary, delimited by the offsets of its symbols */
+    std::vector<uint64_t> symbolOffsets;
+    std::vector<char> symbolData;
+};
+
+class WriteBinaryFactory : public WriteStreamFactory {
+public:
+    std::unique_ptr<WriteStream> getWriter(const std::map<std::string, std::string>& rwOperation,
+            const SymbolTable& symbolTable, const RecordTable& recordTable) override {
+        return std::make_unique<WriteStreamBinary>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~WriteBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -17,6 +17,7 @@
 #include "RamTypes.h"
 #include "SymbolTable.h"
 #include "WriteStream.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -33,6 +34,16 @@ namespace souffle {
 
 class RecordTable;
 
+/**
+ * Writes a relation into an SQLite database.
+ *
+ * The tuples are inserted in a single transaction by a prepared statement
+ * inserting many rows at once, which is committed once all tuples are written.
+ * The symbols of the symbol table are imported in bulk before the first tuple
+ * with a symbol is written, and the index on the database's symbol table is
+ * only created once all symbols are loaded. The ids are determined afresh by each
+ * write, since the database may have been changed since a preceding write.
+ */
 class WriteStreamSQLite : public WriteStream {
 public:
     WriteStreamSQLite(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
@@ -42,13 +53,17 @@ public:
         openDB();
         createTables();
         prepareStatements();
-        //        executeSQL("BEGIN TRANSACTION", db);
+        executeSQL("BEGIN TRANSACTION", db);
     }
 
     ~WriteStreamSQLite() override {
+        // discard the tuples written so far if writing failed
+        if (!committed) {
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
         sqlite3_finalize(insertStatement);
+        sqlite3_finalize(batchInsertStatement);
         sqlite3_finalize(symbolInsertStatement);
-        sqlite3_finalize(symbolSelectStatement);
         sqlite3_close(db);
     }
 
@@ -57,29 +72,32 @@ protected:
 
     void writeNextTuple(const RamDomain* tuple) override {
         for (size_t i = 0; i < arity; i++) {
-            RamDomain value = 0;  // Silence warning
-
             switch (typeAttributes.at(i)[0]) {
-                case 's': value = getSymbolTableID(tuple[i]); break;
-                default: value = tuple[i]; break;
-            }
-
-#if RAM_DOMAIN_SIZE == 64
-            if (sqlite3_bind_int64(insertStatement, i + 1, value) != SQLITE_OK) {
-#else
-            if (sqlite3_bind_int(insertStatement, i + 1, value) != SQLITE_OK) {
-#endif
-                throwError("SQLite error in sqlite3_bind_text: ");
+                case 's': buffer.push_back(getSymbolTableID(tuple[i])); break;
+                default: buffer.push_back(tuple[i]); break;
             }
         }
-        if (sqlite3_step(insertStatement) != SQLITE_DONE) {
-            throwError("SQLite error in sqlite3_step: ");
+        if (buffer.size() == batchRows * arity) {
+            insertRows(batchInsertStatement, buffer.data(), batchRows);
+            buffer.clear();
         }
-        sqlite3_clear_bindings(insertStatement);
-        sqlite3_reset(insertStatement);
+    }
+
+    void finish() override {
+        // insert the rows of an incomplete batch and commit the transaction
+        for (size_t row = 0; row * arity < buffer.size(); ++row) {
+            insertRows(insertStatement, buffer.data() + row * arity, 1);
+        }
+        buffer.clear();
+        executeSQL("COMMIT", db);
+        committed = true;
+        createIndices();
     }
 
 private:
+    /** Maximal number of rows inserted by a single statement */
+    static constexpr size_t MAX_BATCH_ROWS = 256;
+
     void executeSQL(const std::string& sql, sqlite3* db) {
         assert(db && "Database connection is closed");
 
@@ -102,41 +120,70 @@ private:
         throw std::invalid_argument(error.str());
     }
 
-    uint64_t getSymbolTableIDFromDB(int index) {
-        if (sqlite3_bind_text(symbolSelectStatement, 1, symbolTable.unsafeResolve(index).c_str(), -1,
-                    SQLITE_TRANSIENT) != SQLITE_OK) {
-            throwError("SQLite error in sqlite3_bind_text: ");
+    /** Bind the values of the given rows to an insert statement and execute it */
+    void insertRows(sqlite3_stmt* statement, const sqlite3_int64* values, size_t rows) {
+        for (size_t i = 0; i < rows * arity; i++) {
+            if (sqlite3_bind_int64(statement, i + 1, values[i]) != SQLITE_OK) {
+                throwError("SQLite error in sqlite3_bind_int64: ");
+            }
         }
-        if (sqlite3_step(symbolSelectStatement) != SQLITE_ROW) {
+        if (sqlite3_step(statement) != SQLITE_DONE) {
             throwError("SQLite error in sqlite3_step: ");
         }
-        uint64_t rowid = sqlite3_column_int64(symbolSelectStatement, 0);
-        sqlite3_clear_bindings(symbolSelectStatement);
-        sqlite3_reset(symbolSelectStatement);
-        return rowid;
+        sqlite3_reset(statement);
+    }
+
+    sqlite3_int64 getSymbolTableID(RamDomain index) {
+        if (!symbolsImported) {
+            importSymbols();
+        }
+        return dbSymbolTable[index];
     }
-    uint64_t getSymbolTableID(int index) {
-        if (dbSymbolTable.count(index) != 0) {
-            return dbSymbolTable[index];
+
+    /**
+     * Determine the ids of all symbols of the symbol table in the database. Symbols
+     * already stored in the database keep their ids, the others are inserted.
+     */
+    void importSymbols() {
+        std::unordered_map<std::string, sqlite3_int64> existing;
+        sqlite3_stmt* selectStatement = prepareStatement("SELECT id, symbol FROM '" + symbolTableName + "';");
+        while (sqlite3_step(selectStatement) == SQLITE_ROW) {
+            const auto* symbol = reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 1));
+            existing.emplace(symbol != nullptr ? symbol : "", sqlite3_column_int64(selectStatement, 0));
         }
+        sqlite3_finalize(selectStatement);
 
-        if (sqlite3_bind_text(symbolInsertStatement, 1, symbolTable.unsafeResolve(index).c_str(), -1,
-                    SQLITE_TRANSIENT) != SQLITE_OK) {
+        dbSymbolTable.resize(symbolTable.size());
+        for (size_t i = 0; i < dbSymbolTable.size(); i++) {
+            const std::string& symbol = symbolTable.unsafeResolve(i);
+            auto pos = existing.find(symbol);
+            dbSymbolTable[i] = (pos != existing.end()) ? pos->second : insertSymbol(symbol);
+        }
+        symbolsImported = true;
+    }
+
+    void bindSymbol(sqlite3_stmt* statement, const std::string& symbol) {
+        if (sqlite3_bind_text(statement, 1, symbol.c_str(), symbol.size(), SQLITE_STATIC) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
-        // Either the insert succeeds and we have a new row id or it already exists and a select is needed.
-        uint64_t rowid;
+    }
+
+    /** Insert a symbol into the database and return its id */
+    sqlite3_int64 insertSymbol(const std::string& symbol) {
+        bindSymbol(symbolInsertStatement, symbol);
         if (sqlite3_step(symbolInsertStatement) != SQLITE_DONE) {
-            // The symbol already exists so select it.
-            rowid = getSymbolTableIDFromDB(index);
-        } else {
-            rowid = sqlite3_last_insert_rowid(db);
+            throwError("SQLite error in sqlite3_step: ");
         }
-        sqlite3_clear_bindings(symbolInsertStatement);
         sqlite3_reset(symbolInsertStatement);
+        return sqlite3_last_insert_rowid(db);
+    }
 
-        dbSymbolTable[index] = rowid;
-        return rowid;
+    sqlite3_stmt* prepareStatement(const std::string& sql) {
+        sqlite3_stmt* statement = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+            throwError("SQLite error in sqlite3_prepare_v2: ");
+        }
+        return statement;
     }
 
     void openDB() {
@@ -146,45 +193,47 @@ private:
         sqlite3_extended_result_codes(db, 1);
         executeSQL("PRAGMA synchronous = OFF", db);
         executeSQL("PRAGMA journal_mode = MEMORY", db);
+        executeSQL("PRAGMA temp_store = MEMORY", db);
+        executeSQL("PRAGMA cache_size = -65536", db);
     }
 
     void prepareStatements() {
-        prepareInsertStatement();
+        insertStatement = prepareInsertStatement(1);
+        if (arity > 0) {
+            const auto maxVariables =
+                    static_cast<size_t>(sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+            batchRows = std::max<size_t>(1, std::min(MAX_BATCH_ROWS, maxVariables / arity));
+            batchInsertStatement = prepareInsertStatement(batchRows);
+        }
         prepareSymbolInsertStatement();
-        prepareSymbolSelectStatement();
     }
     void prepareSymbolInsertStatement() {
         std::stringstream insertSQL;
-        insertSQL << "INSERT INTO " << symbolTableName;
-        insertSQL << " VALUES(null,@V0);";
+        insertSQL << "INSERT INTO '" << symbolTableName << "'";
+        insertSQL << " VALUES(null,?);";
         const char* tail = nullptr;
         if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &symbolInsertStatement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
         }
     }
 
-    void prepareSymbolSelectStatement() {
-        std::stringstream selectSQL;
-        selectSQL << "SELECT id FROM " << symbolTableName;
-        selectSQL << " WHERE symbol = @V0;";
-        const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, selectSQL.str().c_str(), -1, &symbolSelectStatement, &tail) != SQLITE_OK) {
-            throwError("SQLite error in sqlite3_prepare_v2: ");
-        }
-    }
-
-    void prepareInsertStatement() {
+    sqlite3_stmt* prepareInsertStatement(size_t rows) {
         std::stringstream insertSQL;
         insertSQL << "INSERT INTO '_" << relationName << "' VALUES ";
-        insertSQL << "(@V0";
-        for (unsigned int i = 1; i < arity; i++) {
-            insertSQL << ",@V" << i;
+        for (size_t row = 0; row < rows; row++) {
+            insertSQL << (row == 0 ? "(?" : ",(?");
+            for (unsigned int i = 1; i < arity; i++) {
+                insertSQL << ",?";
+            }
+            insertSQL << ")";
         }
-        insertSQL << ");";
+        insertSQL << ";";
+        sqlite3_stmt* statement = nullptr;
         const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &insertStatement, &tail) != SQLITE_OK) {
+        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &statement, &tail) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_prepare_v2: ");
         }
+        return statement;
     }
 
     void createTables() {
@@ -246,18 +295,37 @@ private:
     void createSymbolTable() {
         std::stringstream createTableText;
         createTableText << "CREATE TABLE IF NOT EXISTS '" << symbolTableName << "' ";
-        createTableText << "(id INTEGER PRIMARY KEY, symbol TEXT UNIQUE);";
+        createTableText << "(id INTEGER PRIMARY KEY, symbol TEXT);";
         executeSQL(createTableText.str(), db);
     }
 
+    /** Create the index on the symbols once they are loaded */
+    void createIndices() {
+        if (symbolsImported) {
+            executeSQL("CREATE UNIQUE INDEX IF NOT EXISTS '" + symbolTableName + "_symbol' ON '" +
+                               symbolTableName + "'(symbol);",
+                    db);
+        }
+    }
+
     const std::string& dbFilename;
     const std::string& relationName;
     const std::string symbolTableName = "__SymbolTable";
 
-    std::unordered_map<uint64_t, uint64_t> dbSymbolTable;
+    /** ids of the symbols of the symbol table in the database */
+    std::vector<sqlite3_int64> dbSymbolTable;
+    bool symbolsImported = false;
+
+    /** whether the transaction has been committed */
+    bool committed = false;
+
+    /** values of the rows not inserted yet */
+    std::vector<sqlite3_int64> buffer;
+    size_t batchRows = 1;
+
     sqlite3_stmt* insertStatement = nullptr;
+    sqlite3_stmt* batchInsertStatement = nullptr;
     sqlite3_stmt* symbolInsertStatement = nullptr;
-    sqlite3_stmt* symbolSelectStatement = nullptr;
     sqlite3* db = nullptr;
 };
 
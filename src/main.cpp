@@ -61,9 +61,9 @@
 
 namespace souffle {
 /**
- * Executes a binary file.
+ * Executes a binary file, compiled from the given translation units if the generated code was split.
  */
-void executeBinary(const std::string& binaryFilename) {
+void executeBinary(const std::string& binaryFilename, const std::vector<std::string>& units = {}) {
     assert(!binaryFilename.empty() && "binary filename cannot be blank");
 
     // check whether the executable exists
@@ -87,6 +87,15 @@ void executeBinary(const std::string& binaryFilename) {
     if (Global::config().get("dl-program").empty()) {
         remove(binaryFilename.c_str());
         remove((binaryFilename + ".cpp").c_str());
+        if (!units.empty()) {
+            for (const char* suffix : {".o", ".h", ".flags", "_types.h", "_types.h.gch"}) {
+                remove((binaryFilename + suffix).c_str());
+            }
+            for (const std::string& unit : units) {
+                remove(unit.c_str());
+                remove((unit.substr(0, unit.size() - 4) + ".o").c_str());
+            }
+        }
     }
 
     // exit with same code as executable
@@ -96,9 +105,10 @@ void executeBinary(const std::string& binaryFilename) {
 }
 
 /**
- * Compiles the given source file to a binary file.
+ * Compiles the given source file, and the translation units split off from it, to a binary file.
  */
-void compileToBinary(std::string compileCmd, const std::string& sourceFilename) {
+void compileToBinary(std::string compileCmd, const std::string& sourceFilename,
+        const std::vector<std::string>& units = {}) {
     // add source code
     compileCmd += ' ';
     for (const std::string& path : splitString(Global::config().get("library-dir"), ' ')) {
@@ -117,6 +127,9 @@ void compileToBinary(std::string compileCmd, const std::string& sourceFilename)
     }
 
     compileCmd += sourceFilename;
+    for (const std::string& unit : units) {
+        compileCmd += ' ' + unit;
+    }
 
     // run executable
     if (system(compileCmd.c_str()) != 0) {
@@ -158,12 +171,26 @@ int main(int argc, char** argv) {
                 {"jobs", 'j', "N", "1", false,
                         "Run interpreter/compiler in parallel using N threads, N=auto for system "
                         "default."},
+                {"parallel-strata", '\7', "N", "1", false,
+                        "Evaluate up to N independent strata concurrently."},
+                {"checkpoint-dir", '\10', "DIR", "", false,
+                        "Checkpoint the program state after each stratum in <DIR> and resume from the "
+                        "newest checkpoint found there. Strata are evaluated in sequence."},
+                {"incremental", '\11', "", "", false,
+                        "Keep the relations of a run and update them by the changes of the input "
+                        "relations in the following run."},
+                {"adaptive-join-order", '\13', "", "", false,
+                        "Choose the join order of each recursive rule in every iteration by the sizes "
+                        "of the relations. Only supported by the interpreter."},
                 {"compile", 'c', "", "", false,
                         "Generate C++ source code, compile to a binary executable, then run this "
                         "executable."},
                 {"generate", 'g', "FILE", "", false,
                         "Generate C++ source code for the given Datalog program and write it to "
                         "<FILE>. If <FILE> is `-` then stdout is used."},
+                {"generate-units", '\12', "", "", false,
+                        "Split the generated C++ source code into a header and several translation "
+                        "units, which are compiled in parallel and only when they change."},
                 {"swig", 's', "LANG", "", false,
                         "Generate SWIG interface for given language. The values <LANG> accepts is java and "
                         "python. "},
@@ -258,6 +285,21 @@ int main(int argc, char** argv) {
         }
 #endif
 
+        /* for the parallel-strata option, to determine the number of concurrently evaluated strata */
+        if (!isNumber(Global::config().get("parallel-strata").c_str()) ||
+                std::stoi(Global::config().get("parallel-strata")) < 1) {
+            throw std::runtime_error("--parallel-strata may only be set to an integer greater than 0.");
+        }
+
+        /* the adaptive join order is chosen by the interpreter */
+        if (Global::config().has("adaptive-join-order") &&
+                (Global::config().has("compile") || Global::config().has("dl-program") ||
+                        Global::config().has("generate") || Global::config().has("swig") ||
+                        Global::config().has("provenance"))) {
+            throw std::runtime_error(
+                    "--adaptive-join-order is only supported by the interpreter without provenance.");
+        }
+
         /* if an output directory is given, check it exists */
         if (Global::config().has("output-dir") && !Global::config().has("output-dir", "-") &&
                 !existDir(Global::config().get("output-dir")) &&
@@ -542,6 +584,7 @@ int main(int argc, char** argv) {
             std::make_unique<EliminateDuplicatesTransformer>(),
             std::make_unique<ReorderConditionsTransformer>(),
             std::make_unique<RamLoopTransformer>(std::make_unique<ReorderFilterBreak>()),
+            std::make_unique<RangeAggregateTransformer>(), std::make_unique<GroupAggregateTransformer>(),
             std::make_unique<RamConditionalTransformer>(
                     // job count of 0 means all cores are used.
                     []() -> bool { return std::stoi(Global::config().get("jobs")) != 1; },
@@ -619,10 +662,13 @@ int main(int argc, char** argv) {
             std::string sourceFilename = baseFilename + ".cpp";
 
             bool withSharedLibrary;
+            std::vector<std::string> units;
             const bool emitToStdOut = Global::config().has("generate", "-");
             if (emitToStdOut)
                 synthesiser->generateCode(std::cout, baseIdentifier, withSharedLibrary);
-            else {
+            else if (Global::config().has("generate-units") && !Global::config().has("swig")) {
+                units = synthesiser->generateUnits(baseFilename, baseIdentifier, withSharedLibrary);
+            } else {
                 std::ofstream os{sourceFilename};
                 synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
             }
@@ -650,7 +696,7 @@ int main(int argc, char** argv) {
                 compileToBinary(compileCmd, sourceFilename);
             } else if (Global::config().has("compile")) {
                 auto start = std::chrono::high_resolution_clock::now();
-                compileToBinary(findCompileCmd(), sourceFilename);
+                compileToBinary(findCompileCmd(), sourceFilename, units);
                 /* Report overall run-time in verbose mode */
                 if (Global::config().has("verbose")) {
                     auto end = std::chrono::high_resolution_clock::now();
@@ -659,7 +705,7 @@ int main(int argc, char** argv) {
                 }
                 // run compiled C++ program if requested.
                 if (!Global::config().has("dl-program") && !Global::config().has("swig")) {
-                    executeBinary(baseFilename);
+                    executeBinary(baseFilename, units);
                 }
             }
         }
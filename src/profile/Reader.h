@@ -253,6 +253,14 @@ public:
             auto* postMaxRSS = dynamic_cast<SizeEntry*>(directory.readEntry("post"));
             base.setPreMaxRSS(preMaxRSS->getSize());
             base.setPostMaxRSS(postMaxRSS->getSize());
+        } else if (directory.getKey() == "statistics") {
+            if (auto* distinct = directory.readDirectoryEntry("distinct")) {
+                for (const auto& key : distinct->getKeys()) {
+                    if (auto* entry = dynamic_cast<SizeEntry*>(distinct->readEntry(key))) {
+                        base.setDistinctValues(std::stoul(key), entry->getSize());
+                    }
+                }
+            }
         }
     }
     void visit(SizeEntry& size) override {
@@ -39,6 +39,7 @@ private:
     int ruleId = 0;
     int recursiveId = 0;
     size_t tuplesRead = 0;
+    std::vector<size_t> distinctValues;
 
     std::vector<std::shared_ptr<Iteration>> iterations;
 
@@ -246,6 +247,18 @@ public:
     void addReads(size_t tuplesRead) {
         this->tuplesRead += tuplesRead;
     }
+
+    /** Get the number of distinct values of an attribute, or 0 if it is unknown */
+    size_t getDistinctValues(size_t attribute) const {
+        return attribute < distinctValues.size() ? distinctValues[attribute] : 0;
+    }
+
+    void setDistinctValues(size_t attribute, size_t distinct) {
+        if (attribute >= distinctValues.size()) {
+            distinctValues.resize(attribute + 1);
+        }
+        distinctValues[attribute] = distinct;
+    }
 };
 
 }  // namespace profile
@@ -80,6 +80,7 @@ public:
     }
 
     Tui() {
+        ProfileEventSingleton::instance().setLiveDB();
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
         this->reader = std::make_shared<Reader>(run);
         this->loaded = true;
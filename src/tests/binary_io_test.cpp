@@ -0,0 +1,266 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file binary_io_test.cpp
+ *
+ * Tests writing relations to and reading relations from binary files.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "BinaryRelationFormat.h"
+#include "CompiledTuple.h"
+#include "RamTypes.h"
+#include "ReadStreamBinary.h"
+#include "ReadStreamCSV.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "WriteStreamBinary.h"
+#include "WriteStreamCSV.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+using Tuple4 = Tuple<RamDomain, 4>;
+
+const std::string binFile = "binary_io_test.bin";
+const std::string csvFile = "binary_io_test.csv";
+
+/** The IO directive of a relation of a number, an unsigned, a float and a symbol column */
+std::map<std::string, std::string> getDirective(const std::string& io, const std::string& fileName) {
+    return {{"IO", io}, {"filename", fileName}, {"name", "test"},
+            {"types", "{\"test\": {\"arity\": 4, \"auxArity\": 0, \"types\": [\"i:number\", "
+                      "\"u:unsigned\", \"f:float\", \"s:symbol\"]}, \"records\": {}}"}};
+}
+
+/** Collects the tuples read from a file */
+struct Collector {
+    void insert(const RamDomain* tuple) {
+        tuples.push_back({{tuple[0], tuple[1], tuple[2], tuple[3]}});
+    }
+    std::vector<Tuple4> tuples;
+};
+
+std::vector<Tuple4> read(const std::string& fileName, SymbolTable& symbolTable) {
+    RecordTable recordTable;
+    Collector collector;
+    ReadStreamBinary(getDirective("binary", fileName), symbolTable, recordTable).readAll(collector);
+    return collector.tuples;
+}
+
+std::vector<Tuple4> generate(RamDomain n, SymbolTable& symbolTable) {
+    std::vector<Tuple4> tuples;
+    for (RamDomain i = 0; i < n; ++i) {
+        tuples.push_back({{-i, ramBitCast(RamUnsigned(i) * 3), ramBitCast(RamFloat(i) / 2),
+                symbolTable.lookup("symbol" + std::to_string(i % 1000))}});
+    }
+    return tuples;
+}
+
+}  // namespace
+
+TEST(Binary, WriteRead) {
+    std::remove(binFile.c_str());
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    std::vector<Tuple4> tuples = generate(5000, symbolTable);
+    WriteStreamBinary(getDirective("binary", binFile), symbolTable, recordTable).writeAll(tuples);
+
+    // read into a symbol table holding other symbols already
+    SymbolTable readSymbols;
+    readSymbols.lookup("other");
+    std::vector<Tuple4> readTuples = read(binFile, readSymbols);
+    EXPECT_EQ(tuples.size(), readTuples.size());
+
+    bool same = true;
+    for (size_t i = 0; i < tuples.size() && i < readTuples.size(); ++i) {
+        same = same && tuples[i][0] == readTuples[i][0] && tuples[i][1] == readTuples[i][1] &&
+               tuples[i][2] == readTuples[i][2] &&
+               symbolTable.resolve(tuples[i][3]) == readSymbols.resolve(readTuples[i][3]);
+    }
+    EXPECT_TRUE(same);
+    EXPECT_EQ(1001, readSymbols.size());
+
+    // a truncated file is rejected
+    std::ifstream in(binFile, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream(binFile, std::ios::binary | std::ios::trunc).write(contents.data(), contents.size() / 2);
+    bool rejected = false;
+    try {
+        read(binFile, readSymbols);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    EXPECT_TRUE(rejected);
+
+    std::remove(binFile.c_str());
+}
+
+TEST(Binary, NullaryAuxiliary) {
+    std::remove(binFile.c_str());
+
+    // a nullary relation with two auxiliary attributes, as recorded for provenance
+    const std::map<std::string, std::string> directive = {{"IO", "binary"}, {"filename", binFile},
+            {"name", "test"},
+            {"types", "{\"test\": {\"arity\": 0, \"auxArity\": 2, \"types\": [\"i:number\", "
+                      "\"i:number\"]}, \"records\": {}}"}};
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    for (size_t size : {0, 1}) {
+        std::vector<Tuple<RamDomain, 2>> tuples(size, {{3, 4}});
+        WriteStreamBinary(directive, symbolTable, recordTable).writeAll(tuples);
+
+        struct {
+            void insert(const RamDomain* tuple) {
+                aux.push_back(tuple[0]);
+                aux.push_back(tuple[1]);
+            }
+            std::vector<RamDomain> aux;
+        } collector;
+        ReadStreamBinary(directive, symbolTable, recordTable).readAll(collector);
+
+        // the auxiliary attributes of the nullary tuple are read as 0
+        EXPECT_EQ(2 * size, collector.aux.size());
+        for (RamDomain value : collector.aux) {
+            EXPECT_EQ(0, value);
+        }
+    }
+
+    std::remove(binFile.c_str());
+}
+
+TEST(Binary, SortedBulkLoad) {
+    std::remove(binFile.c_str());
+
+    // the symbols are entered in reverse, such that their ids do not follow their texts
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    std::vector<Tuple4> tuples;
+    for (RamDomain i = 99; i >= 0; --i) {
+        tuples.push_back({{i / 10, 0, 0, symbolTable.lookup("symbol" + std::to_string(i))}});
+    }
+    std::sort(tuples.begin(), tuples.end());
+
+    /** Collects the tuples and whether they were handed over in bulk */
+    struct {
+        void insert(const RamDomain* tuple) {
+            tuples.push_back({{tuple[0], tuple[1], tuple[2], tuple[3]}});
+        }
+        void insertSorted(const RamDomain* data, std::size_t count) {
+            bulk = true;
+            for (std::size_t i = 0; i < count; ++i) {
+                insert(data + 4 * i);
+            }
+        }
+        std::vector<Tuple4> tuples;
+        bool bulk = false;
+    } collector;
+
+    auto flags = [&]() {
+        BinaryRelationHeader header;
+        std::ifstream(binFile, std::ios::binary).read(reinterpret_cast<char*>(&header), sizeof(header));
+        return header.flags;
+    };
+    auto resolve = [](const std::vector<Tuple4>& tuples, const SymbolTable& symbols) {
+        std::vector<std::string> res;
+        for (const auto& cur : tuples) {
+            res.push_back(std::to_string(cur[0]) + symbols.resolve(cur[3]));
+        }
+        return res;
+    };
+
+    // sorted tuples are flagged as such and handed over at once
+    WriteStreamBinary(getDirective("binary", binFile), symbolTable, recordTable).writeAll(tuples);
+    EXPECT_EQ(BinaryRelationHeader::SORTED, flags());
+    SymbolTable freshSymbols;
+    ReadStreamBinary(getDirective("binary", binFile), freshSymbols, recordTable).readAll(collector);
+    EXPECT_TRUE(collector.bulk);
+    EXPECT_TRUE(std::is_sorted(collector.tuples.begin(), collector.tuples.end()));
+    EXPECT_TRUE(resolve(tuples, symbolTable) == resolve(collector.tuples, freshSymbols));
+
+    // symbols known in a different order break the order of the tuples
+    collector = {};
+    SymbolTable knownSymbols;
+    for (RamDomain i = 0; i < 100; ++i) {
+        knownSymbols.lookup("symbol" + std::to_string(i));
+    }
+    ReadStreamBinary(getDirective("binary", binFile), knownSymbols, recordTable).readAll(collector);
+    EXPECT_FALSE(collector.bulk);
+    EXPECT_TRUE(resolve(tuples, symbolTable) == resolve(collector.tuples, knownSymbols));
+
+    // unsorted tuples are not flagged
+    std::swap(tuples.front(), tuples.back());
+    WriteStreamBinary(getDirective("binary", binFile), symbolTable, recordTable).writeAll(tuples);
+    EXPECT_EQ(0, flags());
+    collector = {};
+    ReadStreamBinary(getDirective("binary", binFile), freshSymbols, recordTable).readAll(collector);
+    EXPECT_FALSE(collector.bulk);
+    EXPECT_EQ(tuples.size(), collector.tuples.size());
+
+    std::remove(binFile.c_str());
+}
+
+TEST(Performance, BinaryThroughput) {
+    // (use N = 10000000 for actual measurements)
+    const RamDomain N = 100000;
+    std::remove(binFile.c_str());
+    std::remove(csvFile.c_str());
+
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    std::vector<Tuple4> tuples = generate(N, symbolTable);
+
+    auto time = [](auto&& action) {
+        auto start = std::chrono::steady_clock::now();
+        action();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    };
+
+    auto csvWrite = time([&]() {
+        WriteFileCSV(getDirective("file", csvFile), symbolTable, recordTable).writeAll(tuples);
+    });
+    auto csvRead = time([&]() {
+        SymbolTable readSymbols;
+        Collector collector;
+        ReadFileCSV(getDirective("file", csvFile), readSymbols, recordTable).readAll(collector);
+        EXPECT_EQ(N, collector.tuples.size());
+    });
+    auto binWrite = time([&]() {
+        WriteStreamBinary(getDirective("binary", binFile), symbolTable, recordTable).writeAll(tuples);
+    });
+    auto binRead = time([&]() {
+        SymbolTable readSymbols;
+        EXPECT_EQ(N, read(binFile, readSymbols).size());
+    });
+
+    std::cout << N << " tuples - csv write: " << csvWrite << "ms, read: " << csvRead
+              << "ms; binary write: " << binWrite << "ms, read: " << binRead << "ms\n";
+
+    std::remove(binFile.c_str());
+    std::remove(csvFile.c_str());
+}
+
+}  // namespace souffle::test
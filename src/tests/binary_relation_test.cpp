@@ -20,6 +20,7 @@
 #include "utility/ContainerUtil.h"
 #include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <string>
 #include <utility>
@@ -525,6 +526,46 @@ TEST(EqRelTest, IterPartition) {
     EXPECT_EQ(br.size(), values.size());
 }
 
+TEST(EqRelTest, IncrementalCache) {
+    // br is {{0,1}, {2,3}, ..., {98,99}}, with its sets cached
+    EqRel br;
+    for (RamDomain i = 0; i < 100; i += 2) {
+        br.insert(i, i + 1);
+    }
+    EXPECT_EQ((size_t)4 * 50, br.size());
+
+    // br2 joins the first ten sets and adds the new set {200,201}
+    EqRel br2;
+    for (RamDomain i = 2; i < 20; i += 2) {
+        br2.insert(0, i);
+    }
+    br2.insert(200, 201);
+    br.insertAll(br2);
+
+    EXPECT_TRUE(br.contains(1, 19));
+    EXPECT_TRUE(br.contains(201, 200));
+    EXPECT_FALSE(br.contains(19, 20));
+    EXPECT_EQ((size_t)20 * 20 + 4 * 40 + 4, br.size());
+
+    // the sets merged into others are skipped by iteration
+    size_t count = 0;
+    for (auto x : br) {
+        EXPECT_TRUE(br.contains(x[0], x[1]));
+        ++count;
+    }
+    EXPECT_EQ(count, br.size());
+
+    std::vector<std::pair<RamDomain, RamDomain>> values;
+    for (auto chunk : br.partition(400)) {
+        for (auto x : chunk) {
+            values.push_back(std::make_pair(x[0], x[1]));
+        }
+    }
+    EXPECT_EQ(br.size(), values.size());
+    std::sort(values.begin(), values.end());
+    EXPECT_TRUE(std::unique(values.begin(), values.end()) == values.end());
+}
+
 TEST(EqRelTest, Scaling) {
     const int N = 100;
 
@@ -570,6 +611,83 @@ TEST(EqRelTest, ParallelScaling) {
         throw std::runtime_error("here's a gdb trap");
     }
 }
+
+TEST(EqRelTest, ParallelCache) {
+    // enough nodes for the cache to be generated in parallel
+    const int N = 20000;
+    const int K = 100;
+
+    // br is {{i | i mod K == k} | k < K}
+    EqRel br;
+#pragma omp parallel for
+    for (int i = 0; i < N; i++) {
+        br.insert(i, i % K);
+    }
+    EXPECT_EQ((size_t)K * (N / K) * (N / K), br.size());
+
+    size_t count = 0;
+    bool sameClass = true;
+    for (const auto& chunk : br.partition(400)) {
+        for (auto x : chunk) {
+            sameClass = sameClass && x[0] % K == x[1] % K;
+            ++count;
+        }
+    }
+    EXPECT_TRUE(sameClass);
+    EXPECT_EQ(count, br.size());
+
+    // the copy joins all classes below K/2
+    EqRel br2;
+    br2.insertAll(br);
+    for (int k = 1; k < K / 2; k++) {
+        br2.insert(0, k);
+    }
+    const size_t joined = (size_t)(K / 2) * (N / K);
+    EXPECT_EQ(joined * joined + (size_t)(K / 2) * (N / K) * (N / K), br2.size());
+
+    // extending a relation touching the first and last class adds both classes
+    EqRel br3;
+    br3.insert(N, 0);
+    br3.insert(K - 1, K - 1);
+    br3.extend(br2);
+    EXPECT_TRUE(br3.contains(N, K / 2 - 1));
+    EXPECT_TRUE(br3.contains(N - 1, K - 1));
+    EXPECT_FALSE(br3.contains(N, K - 1));
+    EXPECT_FALSE(br3.contains(K / 2, K / 2));
+    EXPECT_EQ((joined + 1) * (joined + 1) + (size_t)(N / K) * (N / K), br3.size());
+}
+
+TEST(EqRelTest, DeterministicCache) {
+    // enough nodes for the cache to be generated in parallel
+    const int N = 20000;
+    const int K = 10;
+
+    std::vector<int> data(N);
+    std::iota(data.begin(), data.end(), 0);
+    std::shuffle(data.begin(), data.end(), std::mt19937(42));
+
+    // the same relation, cached with a single thread and with several threads
+    const int maxThreads = omp_get_max_threads();
+    std::vector<std::vector<RamDomain>> iterated;
+    for (int threads : {1, 4}) {
+        EqRel br;
+        for (int i : data) {
+            br.insert(i, i % K);
+        }
+        omp_set_num_threads(threads);
+        EXPECT_EQ((size_t)K * (N / K) * (N / K), br.size());
+        omp_set_num_threads(maxThreads);
+
+        std::vector<RamDomain> tuples;
+        for (auto x : br) {
+            tuples.push_back(x[0]);
+            tuples.push_back(x[1]);
+        }
+        iterated.push_back(std::move(tuples));
+    }
+    EXPECT_EQ(iterated[0].size(), iterated[1].size());
+    EXPECT_TRUE(iterated[0] == iterated[1]);
+}
 #endif
 
 }  // namespace test
@@ -19,6 +19,7 @@
 #include "BTree.h"
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
 #include <iomanip>
@@ -365,6 +366,54 @@ TEST(BTreeMultiSet, Load) {
     }
 }
 
+TEST(BTreeMultiSet, InsertAll) {
+    using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 100; N += 3) {
+        test_set a;
+        test_set b;
+        std::multiset<int> all;
+        for (int i = 0; i < N; i++) {
+            a.insert(i / 2);
+            b.insert(i % 10);
+            all.insert(i / 2);
+            all.insert(i % 10);
+        }
+
+        // duplicates are retained
+        a.insertAll(b);
+        EXPECT_EQ(all.size(), a.size());
+        EXPECT_TRUE(a.check());
+        EXPECT_TRUE(std::equal(all.begin(), all.end(), a.begin()));
+    }
+}
+
+TEST(BTreeMultiSet, Counted) {
+    using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16,
+            detail::default_strategy<int>::type, detail::comparator<int>, detail::updater<int>, true>;
+
+    // each value i is inserted i times
+    test_set t;
+    for (int i = 20; i > 0; i--) {
+        for (int j = 0; j < i; j++) {
+            t.insert(i);
+        }
+    }
+    EXPECT_EQ(210, t.size());
+    EXPECT_TRUE(t.check());
+
+    for (std::size_t i = 1; i <= 20; i++) {
+        const int key = static_cast<int>(i);
+        EXPECT_EQ(i * (i - 1) / 2, t.rank(key));
+        EXPECT_EQ(i, t.count(key, key));
+        EXPECT_EQ(key, *t.select(i * (i - 1) / 2));
+        EXPECT_EQ(key, *t.select(i * (i + 1) / 2 - 1));
+    }
+    EXPECT_EQ(210, t.count(0, 100));
+    EXPECT_EQ(0, t.count(5, 4));
+    EXPECT_TRUE(t.select(210) == t.end());
+}
+
 TEST(BTreeMultiSet, Clear) {
     using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -21,6 +21,8 @@
 #include "utility/StreamUtil.h"
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <iomanip>
@@ -501,6 +503,214 @@ TEST(BTreeSet, Clear) {
     EXPECT_TRUE(t.empty());
 }
 
+TEST(BTreeSet, NodePool) {
+    detail::node_pool pool;
+    EXPECT_EQ(0, pool.getReservedSize());
+
+    // blocks are aligned and do not overlap
+    std::vector<char*> blocks;
+    for (int i = 0; i < 1000; i++) {
+        auto* block = static_cast<char*>(pool.allocate(100));
+        EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t));
+        std::fill(block, block + 100, static_cast<char>(i));
+        blocks.push_back(block);
+    }
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(std::all_of(
+                blocks[i], blocks[i] + 100, [&](char c) { return c == static_cast<char>(i); }));
+    }
+    EXPECT_LT(100000, pool.getReservedSize());
+
+    // blocks follow their pool on a swap
+    detail::node_pool other;
+    other.swap(pool);
+    EXPECT_EQ(0, pool.getReservedSize());
+    EXPECT_LT(100000, other.getReservedSize());
+    auto reserved = other.getReservedSize();
+    pool.allocate(100);
+    EXPECT_LT(0, pool.getReservedSize());
+    EXPECT_EQ(reserved, other.getReservedSize());
+
+    // all blocks are released at once; a slab is kept for the following allocations
+    other.release();
+    reserved = other.getReservedSize();
+    EXPECT_LT(0, reserved);
+    ASSERT_LE(reserved, detail::node_pool::maxRetainedSize);
+    other.allocate(100);
+    EXPECT_EQ(reserved, other.getReservedSize());
+}
+
+TEST(BTreeSet, NodePoolInterleaved) {
+    // a thread allocating from many pools in turn keeps using one chunk per pool
+    std::vector<detail::node_pool> pools(64);
+    for (int i = 0; i < 30; i++) {
+        for (auto& pool : pools) {
+            pool.allocate(100);
+        }
+    }
+    for (auto& pool : pools) {
+        EXPECT_EQ(4096, pool.getReservedSize());
+    }
+}
+
+TEST(BTreeSet, ClearAndReuse) {
+    using test_set = btree_set<std::string, detail::comparator<std::string>, std::allocator<std::string>, 64>;
+
+    // keys with destructors are destroyed on clear, reassignment and destruction
+    test_set t;
+    test_set s;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 1000; i++) {
+            t.insert(std::to_string(i) + std::string(32, 'x'));
+        }
+        EXPECT_EQ(1000, t.size());
+        EXPECT_TRUE(t.check());
+
+        s = t;
+        t.clear();
+        EXPECT_TRUE(t.empty());
+        EXPECT_EQ(1000, s.size());
+        EXPECT_TRUE(s.contains(std::to_string(999) + std::string(32, 'x')));
+
+        s.swap(t);
+        EXPECT_EQ(1000, t.size());
+        EXPECT_TRUE(s.empty());
+        t = s;
+        EXPECT_TRUE(t.empty());
+    }
+}
+
+TEST(BTreeSet, InsertAll) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (double fill : {0.5, 0.8, 1.0}) {
+        for (int N = 0; N < 200; N += 7) {
+            for (int M = 0; M < 200; M += 13) {
+                // even numbers in one set, multiples of three in the other
+                test_set a;
+                test_set b;
+                std::set<int> all;
+                for (int i = 0; i < N; i++) {
+                    a.insert(2 * i);
+                    all.insert(2 * i);
+                }
+                for (int i = 0; i < M; i++) {
+                    b.insert(3 * i);
+                    all.insert(3 * i);
+                }
+
+                a.insertAll(b, fill);
+                EXPECT_EQ(all.size(), a.size());
+                EXPECT_TRUE(a.check());
+                EXPECT_TRUE(std::equal(all.begin(), all.end(), a.begin()));
+
+                // the rebuilt tree is fully functional
+                a.insert(-1);
+                a.insert(1000);
+                EXPECT_TRUE(a.contains(-1));
+                EXPECT_TRUE(a.contains(1000));
+                EXPECT_EQ(all.size() + 2, a.size());
+                EXPECT_TRUE(a.check());
+            }
+        }
+    }
+}
+
+TEST(BTreeSet, ParallelInsertAll) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // large enough to be merged by key ranges in parallel, both by rebuilding and by inserting
+    for (int M : {100000, 5000}) {
+        test_set a;
+        test_set b;
+        std::set<int> all;
+        for (int i = 0; i < 100000; i++) {
+            a.insert(2 * i);
+            all.insert(2 * i);
+        }
+        for (int i = 0; i < M; i++) {
+            b.insert(3 * i);
+            all.insert(3 * i);
+        }
+
+        a.insertAll(b);
+        EXPECT_EQ(all.size(), a.size());
+        EXPECT_TRUE(a.check());
+        EXPECT_TRUE(std::equal(all.begin(), all.end(), a.begin()));
+    }
+}
+
+TEST(BTreeSet, Counted) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16,
+            detail::default_strategy<int>::type, detail::comparator<int>, detail::updater<int>, true>;
+
+    test_set t;
+    EXPECT_EQ(0, t.size());
+    EXPECT_EQ(0, t.rank(5));
+    EXPECT_EQ(0, t.count(0, 10));
+    EXPECT_TRUE(t.select(0) == t.end());
+
+    // odd numbers, inserted in shuffled order
+    std::vector<int> data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(2 * i + 1);
+    }
+    std::shuffle(data.begin(), data.end(), std::mt19937(7));
+    for (int i : data) {
+        t.insert(i);
+    }
+
+    for (std::size_t round = 0; round < 2; round++) {
+        const std::size_t n = t.size();
+        EXPECT_EQ(1000 + round * 500, n);
+        EXPECT_TRUE(t.check());
+
+        // ranks and selections agree with the order of the iterator
+        std::size_t pos = 0;
+        for (auto it = t.begin(); it != t.end(); ++it, ++pos) {
+            EXPECT_EQ(pos, t.rank(*it));
+            EXPECT_TRUE(t.select(pos) == it);
+        }
+        EXPECT_EQ(n, pos);
+        EXPECT_TRUE(t.select(n) == t.end());
+
+        // counts agree with the enumerated ranges
+        for (int a = -3; a < 2100; a += 97) {
+            for (int b = a - 5; b < 2100; b += 131) {
+                std::size_t expected = 0;
+                for (auto it = t.lower_bound(a); a <= b && it != t.upper_bound(b); ++it) {
+                    expected++;
+                }
+                EXPECT_EQ(expected, t.count(a, b));
+            }
+        }
+
+        // the cached sizes are refreshed after a modification
+        test_set other;
+        for (int i = 0; i < 500; i++) {
+            other.insert(4 * i);
+        }
+        t.insertAll(other);
+    }
+
+    t.clear();
+    EXPECT_EQ(0, t.size());
+    EXPECT_EQ(0, t.count(0, 10));
+    t.insert(3);
+    EXPECT_EQ(1, t.count(0, 10));
+    EXPECT_EQ(1, t.rank(4));
+
+    // trees without sub-tree sizes enumerate the elements instead
+    btree_set<int> plain;
+    for (int i = 0; i < 100; i++) {
+        plain.insert(i);
+    }
+    EXPECT_EQ(10, plain.rank(10));
+    EXPECT_EQ(5, plain.count(3, 7));
+    EXPECT_EQ(42, *plain.select(42));
+    EXPECT_TRUE(plain.select(100) == plain.end());
+}
+
 TEST(BTreeSet, ChunkSplit) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -728,6 +938,66 @@ TEST(Performance, Load) {
     time("bulk-load", [&]() { auto t = btree_set<int>::load(data.begin(), data.end()); });
 }
 
+TEST(Performance, InsertAll) {
+    //        int N = 1<<22;
+    int N = 1 << 18;
+
+    std::vector<int> data;
+    for (int i = 0; i < N; i++) {
+        data.push_back(i);
+    }
+
+    btree_set<int> full = btree_set<int>::load(data.begin(), data.end());
+    btree_set<int> delta;
+    for (int i = 0; i < N; i += 4) {
+        delta.insert(N / 2 + i);
+    }
+
+    // take time for conventional insertion
+    time("conventional insert", [&]() {
+        btree_set<int> t = full;
+        t.insert(delta.begin(), delta.end());
+    });
+
+    // take time for merging
+    time("merge", [&]() {
+        btree_set<int> t = full;
+        t.insertAll(delta);
+    });
+}
+
+TEST(Performance, Teardown) {
+    //        int N = 1<<24;
+    int N = 1 << 18;
+
+    std::vector<int> data;
+    for (int i = 0; i < N; i++) {
+        data.push_back(i);
+    }
+    std::random_device rd;
+    std::mt19937 generator(rd());
+    std::shuffle(data.begin(), data.end(), generator);
+
+    // take time for insertion and the bulk release of all nodes
+    btree_set<int> t;
+    time("insert", [&]() {
+        for (int cur : data) {
+            t.insert(cur);
+        }
+    });
+    time("clear", [&]() { t.clear(); });
+    EXPECT_TRUE(t.empty());
+
+    // reference: nodes allocated and freed one by one
+    std::set<int> s;
+    time("std::set insert", [&]() {
+        for (int cur : data) {
+            s.insert(cur);
+        }
+    });
+    time("std::set clear", [&]() { s.clear(); });
+}
+
 TEST(BTreeSet, Parallel) {
     //        const int N = 600000000;
     //        const int N = 100000;
@@ -865,5 +1135,39 @@ TEST(BTreeSet, ParallelScaling) {
     }
 }
 
+TEST(Performance, ParallelInsertTeardown) {
+    //        const int N = 60000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+
+    std::vector<int> data;
+    for (int i = 0; i < N; i++) {
+        data.push_back(i);
+    }
+    std::random_device rd;
+    std::mt19937 generator(rd());
+    std::shuffle(data.begin(), data.end(), generator);
+
+    // nodes are allocated from per-thread chunks of the pool of the tree
+    for (int i = 1; i <= 8; i *= 2) {
+        btree_set<int> t;
+        omp_set_num_threads(i);
+        std::cout << "Number of threads: " << i << "\n";
+        time("insert", [&]() {
+#pragma omp parallel
+            {
+                btree_set<int>::operation_hints ctxt;
+#pragma omp for
+                for (int j = 0; j < N; j++) {
+                    t.insert(data[j], ctxt);
+                }
+            }
+        });
+        EXPECT_EQ(N, t.size());
+        EXPECT_TRUE(t.check());
+        time("clear", [&]() { t.clear(); });
+        EXPECT_TRUE(t.empty());
+    }
+}
+
 #endif
 }  // namespace souffle::test
@@ -0,0 +1,262 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file checkpoint_test.cpp
+ *
+ * Tests writing and restoring checkpoints between strata.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "Checkpoint.h"
+#include "InterpreterIndex.h"
+#include "InterpreterProgInterface.h"
+#include "InterpreterRelation.h"
+#include "RamTypes.h"
+#include "RecordTable.h"
+#include "SouffleInterface.h"
+#include "SymbolTable.h"
+#include "utility/FileUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace souffle::test {
+
+namespace {
+
+const std::string checkpointDir = "checkpoint_test_dir";
+
+/** The relations of a program of a binary relation A and a unary relation B */
+struct Program {
+    Program() {
+        MinIndexSelection orderA{};
+        orderA.insertDefaultTotalIndex(2);
+        MinIndexSelection orderB{};
+        orderB.insertDefaultTotalIndex(1);
+        a = std::make_unique<InterpreterRelation>(2, 0, "A", std::vector<std::string>{"i", "s"}, orderA);
+        b = std::make_unique<InterpreterRelation>(1, 0, "B", std::vector<std::string>{"r"}, orderB);
+        aInt = std::make_unique<InterpreterRelInterface>(*a, symbolTable, "A",
+                std::vector<std::string>{"i", "s"}, std::vector<std::string>{"x", "y"}, 0);
+        bInt = std::make_unique<InterpreterRelInterface>(
+                *b, symbolTable, "B", std::vector<std::string>{"r"}, std::vector<std::string>{"x"}, 1);
+    }
+
+    std::unique_ptr<Checkpoint> getCheckpoint(const std::string& fingerprint = "program") {
+        return std::make_unique<Checkpoint>(checkpointDir, fingerprint, symbolTable, recordTable,
+                std::vector<Relation*>{aInt.get(), bInt.get()});
+    }
+
+    /** the symbol table holds the symbols of the program itself from the start */
+    SymbolTable symbolTable{"program"};
+    RecordTable recordTable;
+    std::unique_ptr<InterpreterRelation> a;
+    std::unique_ptr<InterpreterRelation> b;
+    std::unique_ptr<InterpreterRelInterface> aInt;
+    std::unique_ptr<InterpreterRelInterface> bInt;
+};
+
+void removeCheckpoints() {
+    for (size_t i = 0; i < 3; ++i) {
+        std::remove((checkpointDir + "/stratum_" + std::to_string(i) + ".bin").c_str());
+    }
+    std::remove((checkpointDir + "/snapshot.bin").c_str());
+    std::remove((checkpointDir + "/manifest").c_str());
+    rmdir(checkpointDir.c_str());
+}
+
+/**
+ * Evaluate and checkpoint the given number of strata, skipping those of the restored
+ * checkpoint: stratum 0 computes A, stratum 1 computes B of records, and stratum 2 clears A.
+ * The checkpoints are removed once all three strata are finished.
+ *
+ * @return the number of evaluated strata
+ */
+size_t runStrata(Program& program, size_t numStrata, const std::vector<std::string>& inputs = {}) {
+    auto checkpoint = program.getCheckpoint();
+    for (const auto& input : inputs) {
+        checkpoint->addInput(input);
+    }
+    const size_t first = checkpoint->restore();
+    for (size_t stratum = first; stratum < numStrata; ++stratum) {
+        if (stratum == 0) {
+            for (RamDomain i = 0; i < 1000; ++i) {
+                RamDomain symbol = program.symbolTable.lookup("s" + std::to_string(i % 100));
+                program.aInt->insert(tuple(program.aInt.get(), {i, symbol}));
+            }
+        } else if (stratum == 1) {
+            for (RamDomain i = 0; i < 10; ++i) {
+                RamDomain record[2] = {i, program.symbolTable.lookup("r" + std::to_string(i))};
+                program.bInt->insert(tuple(program.bInt.get(), {program.recordTable.pack(record, 2)}));
+            }
+        } else {
+            program.aInt->purge();
+        }
+        checkpoint->save(stratum);
+    }
+    if (numStrata == 3) {
+        checkpoint->finish();
+    }
+    return numStrata - std::min(first, numStrata);
+}
+
+}  // namespace
+
+TEST(Checkpoint, SaveRestore) {
+    removeCheckpoints();
+    Program original;
+    runStrata(original, 2);
+
+    Program restored;
+    EXPECT_EQ(2, restored.getCheckpoint()->restore());
+    EXPECT_EQ(original.symbolTable.size(), restored.symbolTable.size());
+    EXPECT_EQ(1000, restored.a->size());
+    EXPECT_EQ(10, restored.b->size());
+    EXPECT_EQ(10, restored.recordTable.size(2));
+    bool same = true;
+    for (size_t i = 0; i < original.symbolTable.size(); ++i) {
+        same = same && original.symbolTable.resolve(i) == restored.symbolTable.resolve(i);
+    }
+    for (const auto& view : restored.bInt->views()) {
+        const RamDomain* record = restored.recordTable.unpack(view[0], 2);
+        same = same && restored.symbolTable.resolve(record[1]) == "r" + std::to_string(record[0]);
+    }
+    EXPECT_TRUE(same);
+
+    // cleared relations stay cleared
+    Program cleared;
+    EXPECT_EQ(1, runStrata(cleared, 3));
+    EXPECT_EQ(0, cleared.a->size());
+    EXPECT_EQ(10, cleared.b->size());
+
+    // a different program ignores the checkpoint
+    Program other;
+    EXPECT_EQ(0, other.getCheckpoint("other")->restore());
+    EXPECT_FALSE(existFile(checkpointDir + "/manifest"));
+
+    removeCheckpoints();
+}
+
+TEST(Checkpoint, Rerun) {
+    removeCheckpoints();
+    Program interrupted;
+    EXPECT_EQ(2, runStrata(interrupted, 2));
+
+    // the run is completed from the checkpoint, which is removed once all strata are finished
+    Program completed;
+    EXPECT_EQ(1, runStrata(completed, 3));
+    EXPECT_FALSE(existFile(checkpointDir + "/manifest"));
+    EXPECT_FALSE(existFile(checkpointDir + "/stratum_0.bin"));
+
+    // hence a rerun evaluates all strata again rather than skipping them
+    Program rerun;
+    EXPECT_EQ(3, runStrata(rerun, 3));
+    EXPECT_EQ(0, rerun.a->size());
+    EXPECT_EQ(10, rerun.b->size());
+    EXPECT_EQ(completed.symbolTable.size(), rerun.symbolTable.size());
+
+    removeCheckpoints();
+}
+
+TEST(Checkpoint, ChangedInput) {
+    removeCheckpoints();
+    const std::string input = "checkpoint_test.facts";
+    std::ofstream(input) << "1\n";
+    Program original;
+    EXPECT_EQ(2, runStrata(original, 2, {input}));
+
+    auto restore = [&](Program& program, const std::string& path) {
+        auto checkpoint = program.getCheckpoint();
+        checkpoint->addInput(path);
+        return checkpoint->restore();
+    };
+
+    // an unchanged input resumes from the checkpoint
+    Program resumed;
+    EXPECT_EQ(2, restore(resumed, input));
+
+    // a different or changed input discards the checkpoint
+    Program missing;
+    EXPECT_EQ(0, restore(missing, input + ".missing"));
+    EXPECT_FALSE(existFile(checkpointDir + "/manifest"));
+    Program again;
+    EXPECT_EQ(2, runStrata(again, 2, {input}));
+    std::ofstream(input) << "1\n2\n";
+    Program changed;
+    EXPECT_EQ(3, runStrata(changed, 3, {input}));
+    EXPECT_EQ(10, changed.b->size());
+
+    std::remove(input.c_str());
+    removeCheckpoints();
+}
+
+TEST(Checkpoint, Snapshot) {
+    removeCheckpoints();
+    Program original;
+    runStrata(original, 2);
+
+    // continue from the checkpoint and take a snapshot after changing a relation
+    Program updated;
+    auto checkpoint = updated.getCheckpoint();
+    EXPECT_EQ(2, checkpoint->restore());
+    updated.aInt->purge();
+    checkpoint->saveAll();
+    checkpoint.reset();
+
+    // the snapshot replaces the checkpoints, but does not finish any strata
+    Program restored;
+    EXPECT_EQ(0, restored.getCheckpoint()->restore());
+    EXPECT_EQ(original.symbolTable.size(), restored.symbolTable.size());
+    EXPECT_EQ(0, restored.a->size());
+    EXPECT_EQ(10, restored.b->size());
+    EXPECT_EQ(10, restored.recordTable.size(2));
+    EXPECT_TRUE(existFile(checkpointDir + "/snapshot.bin"));
+
+    removeCheckpoints();
+}
+
+TEST(Performance, Checkpoint) {
+    // (use N = 10000000 for actual measurements)
+    const RamDomain N = 100000;
+    removeCheckpoints();
+
+    Program program;
+    auto checkpoint = program.getCheckpoint();
+    checkpoint->restore();
+
+    auto start = std::chrono::steady_clock::now();
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain symbol = program.symbolTable.lookup(std::to_string(i % 1000));
+        program.aInt->insert(tuple(program.aInt.get(), {i, symbol}));
+    }
+    auto mid = std::chrono::steady_clock::now();
+    checkpoint->save(0);
+    auto end = std::chrono::steady_clock::now();
+    checkpoint.reset();
+    auto written = std::chrono::steady_clock::now();
+
+    auto ms = [](auto duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    };
+    std::cout << N << " tuples - evaluation: " << ms(mid - start) << "ms, checkpoint: " << ms(end - mid)
+              << "ms (+" << ms(written - end) << "ms in the background)\n";
+
+    removeCheckpoints();
+}
+
+}  // namespace souffle::test
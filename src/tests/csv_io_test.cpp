@@ -0,0 +1,163 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file csv_io_test.cpp
+ *
+ * Tests reading CSV fact files in parallel chunks against reading them
+ * sequentially from a stream.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "RamTypes.h"
+#include "ReadStreamCSV.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+const std::string csvFile = "csv_io_test.facts";
+
+/** The IO directive of a relation of a number, a symbol and a record column */
+std::map<std::string, std::string> getDirective(bool headers) {
+    return {{"IO", "file"}, {"filename", csvFile}, {"name", "test"},
+            {"headers", headers ? "true" : "false"},
+            {"types", "{\"test\": {\"arity\": 3, \"auxArity\": 0, \"types\": [\"i:number\", "
+                      "\"s:symbol\", \"r:Pair\"]}, \"records\": {\"r:Pair\": {\"arity\": 2, "
+                      "\"types\": [\"i:number\", \"s:symbol\"]}}}"}};
+}
+
+/** Collects the tuples read from a file */
+struct Collector {
+    void insert(const RamDomain* tuple) {
+        tuples.insert(tuples.end(), tuple, tuple + 3);
+    }
+    std::vector<RamDomain> tuples;
+};
+
+/** The outcome of reading a file: the tuples and the error raised, if any */
+struct Result {
+    std::vector<RamDomain> tuples;
+    std::string error;
+    size_t numSymbols;
+    size_t numRecords;
+};
+
+template <typename Reader>
+Result read(Reader&& reader, SymbolTable& symbolTable, RecordTable& recordTable) {
+    Collector collector;
+    Result result;
+    try {
+        reader.readAll(collector);
+    } catch (const std::invalid_argument& e) {
+        result.error = e.what();
+    }
+    result.tuples = std::move(collector.tuples);
+    result.numSymbols = symbolTable.size();
+    result.numRecords = recordTable.size(2);
+    return result;
+}
+
+/** Read the lines through the parallel reader of the mapped file */
+Result readFile(const std::string& header, const std::string& lines) {
+    std::ofstream(csvFile, std::ios::binary) << header << lines;
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    Result result = read(ReadFileCSV(getDirective(!header.empty()), symbolTable, recordTable), symbolTable,
+            recordTable);
+    std::remove(csvFile.c_str());
+    return result;
+}
+
+/** Read the lines sequentially from a stream */
+Result readStream(const std::string& lines) {
+    std::istringstream stream(lines);
+    SymbolTable symbolTable;
+    RecordTable recordTable;
+    return read(ReadStreamCSV(stream, getDirective(false), symbolTable, recordTable), symbolTable,
+            recordTable);
+}
+
+/** Lines spanning several chunks of the parallel reader; every other line ends with CRLF */
+std::string generate(size_t n) {
+    std::stringstream lines;
+    for (size_t i = 0; i < n; ++i) {
+        lines << i << "\t\"quoted symbol " << i % 997 << "\"\t[" << i % 31 << ", r" << i % 13 << "]";
+        lines << (i % 2 == 0 ? "\r\n" : "\n");
+    }
+    return lines.str();
+}
+
+/** The line number reported by an error message */
+std::string reportedLine(const std::string& error) {
+    size_t pos = error.find("in line ");
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += 8;
+    return error.substr(pos, error.find_first_not_of("0123456789", pos) - pos);
+}
+
+}  // namespace
+
+TEST(CSV, ReadChunks) {
+    const size_t N = 100000;
+    const std::string lines = generate(N);
+    EXPECT_LT(size_t(3) << 20, lines.size());
+
+    const Result expected = readStream(lines);
+    EXPECT_EQ("", expected.error);
+    EXPECT_EQ(3 * N, expected.tuples.size());
+
+    // symbols and records are numbered as if read sequentially
+    for (const std::string& header : {std::string(), std::string("n\ts\tr\r\n")}) {
+        const Result result = readFile(header, lines);
+        EXPECT_EQ("", result.error);
+        EXPECT_EQ(expected.numSymbols, result.numSymbols);
+        EXPECT_EQ(expected.numRecords, result.numRecords);
+        EXPECT_TRUE(expected.tuples == result.tuples);
+    }
+}
+
+TEST(CSV, ReadErrors) {
+    const size_t N = 100000;
+    const std::string lines = generate(N);
+
+    // a malformed number and a malformed record in a later chunk
+    for (const std::string& bad : {std::string("x12\ta\t[1, b]\n"), std::string("12\ta\t[1, b\n")}) {
+        const size_t pos = lines.find("\n90000\t") + 1;
+        const std::string input = lines.substr(0, pos) + bad + lines.substr(pos);
+
+        const Result expected = readStream(input);
+        EXPECT_EQ("90001", reportedLine(expected.error));
+        EXPECT_EQ(3 * 90000, expected.tuples.size());
+
+        // the tuples preceding the error are read
+        const Result result = readFile("", input);
+        EXPECT_EQ(reportedLine(expected.error), reportedLine(result.error));
+        EXPECT_TRUE(expected.tuples == result.tuples);
+
+        // the header line is not counted, as for sequential reading
+        EXPECT_EQ("90001", reportedLine(readFile("n\ts\tr\n", input).error));
+    }
+}
+
+}  // namespace souffle::test
@@ -0,0 +1,158 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file group_table_test.cpp
+ *
+ * Tests the groups of group-by aggregates.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "AggregateOp.h"
+#include "GroupTable.h"
+#include "RamTypes.h"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace souffle::test {
+
+TEST(AggregateAccumulator, Merge) {
+    AggregateAccumulator a(AggregateOp::MIN);
+    AggregateAccumulator b(AggregateOp::MIN);
+    EXPECT_FALSE(a.hasResult());
+    a.add(5);
+    a.add(3);
+    b.add(4);
+    a.merge(b);
+    a.merge(AggregateAccumulator(AggregateOp::MIN));
+    EXPECT_TRUE(a.hasResult());
+    EXPECT_EQ(3, a.getResult());
+
+    AggregateAccumulator count(AggregateOp::COUNT);
+    EXPECT_TRUE(count.hasResult());
+    EXPECT_EQ(0, count.getResult());
+    count.add(0);
+    count.merge(count);
+    EXPECT_EQ(2, count.getResult());
+
+    AggregateAccumulator mean(AggregateOp::MEAN);
+    AggregateAccumulator other(AggregateOp::MEAN);
+    mean.add(ramBitCast(RamFloat(1)));
+    other.add(ramBitCast(RamFloat(2)));
+    mean.merge(other);
+    EXPECT_EQ(RamFloat(1.5), ramBitCast<RamFloat>(mean.getResult()));
+}
+
+TEST(ExactFloatSum, Order) {
+    // a naive sum loses the small values next to the large ones
+    std::vector<RamFloat> values = {RamFloat(1e8), 1, RamFloat(-1e8), 1, 1, 1};
+    ExactFloatSum forward;
+    for (RamFloat value : values) {
+        forward.add(value);
+    }
+    EXPECT_EQ(RamFloat(4), forward.getResult());
+
+    // the sum does not depend on how the values are split and merged
+    ExactFloatSum first;
+    ExactFloatSum second;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        (i % 2 == 0 ? first : second).add(values[values.size() - i - 1]);
+    }
+    second.merge(first);
+    EXPECT_EQ(forward.getResult(), second.getResult());
+
+    EXPECT_EQ(RamFloat(0), ExactFloatSum().getResult());
+}
+
+TEST(ExactFloatSum, Overflow) {
+    const RamFloat max = std::numeric_limits<RamFloat>::max();
+    const RamFloat inf = std::numeric_limits<RamFloat>::infinity();
+    auto sum = [](const std::vector<std::vector<RamFloat>>& partitions) {
+        ExactFloatSum res;
+        for (const auto& partition : partitions) {
+            ExactFloatSum cur;
+            for (RamFloat value : partition) {
+                cur.add(value);
+            }
+            res.merge(cur);
+        }
+        return res.getResult();
+    };
+
+    // partial sums beyond the range of floats do not matter as long as the sum is in range
+    EXPECT_EQ(max, sum({{max, max, -max}}));
+    EXPECT_EQ(max, sum({{max, max}, {-max}}));
+    EXPECT_EQ(max, sum({{max}, {max}, {-max}}));
+    EXPECT_EQ(-max, sum({{-max}, {-max, max}}));
+    EXPECT_EQ(RamFloat(1), sum({{max, max, max}, {1}, {-max, -max, -max}}));
+    EXPECT_EQ(RamFloat(1), sum({{max, max, max, 1}, {-max, -max}, {-max}}));
+
+    // only sums out of range are infinite
+    EXPECT_EQ(inf, sum({{max}, {max}}));
+    EXPECT_EQ(-inf, sum({{-max, -max, max}, {-max}}));
+
+    // sums next to the largest float are rounded correctly, whether or not they overflow
+    const RamFloat halfUlp = (max - std::nextafter(max, RamFloat(0))) / 2;
+    const RamFloat tiny = std::numeric_limits<RamFloat>::denorm_min();
+    EXPECT_EQ(inf, sum({{max, halfUlp}}));
+    EXPECT_EQ(max, sum({{max, max}, {halfUlp, -max, -tiny}}));
+    EXPECT_EQ(inf, sum({{max, max}, {halfUlp, -max, tiny}}));
+}
+
+TEST(GroupTable, Build) {
+    GroupTable groups(AggregateOp::SUM, 2);
+    EXPECT_FALSE(groups.isBuilt());
+
+    // the groups of key (1,2) and (3,4) are split across partitions
+    std::vector<GroupTable::Partition> partitions(3, groups.makePartition());
+    RamDomain a[2] = {1, 2};
+    RamDomain b[2] = {3, 4};
+    partitions[0].add(a, 1);
+    partitions[0].add(a, 2);
+    partitions[0].add(b, 10);
+    partitions[1].add(b, 20);
+    partitions[1].add(a, 4);
+    groups.build(partitions);
+    EXPECT_TRUE(groups.isBuilt());
+
+    const AggregateAccumulator* group = groups.lookup(a);
+    EXPECT_TRUE(group != nullptr);
+    EXPECT_EQ(7, group->getResult());
+    group = groups.lookup(b);
+    EXPECT_TRUE(group != nullptr);
+    EXPECT_EQ(30, group->getResult());
+
+    RamDomain c[2] = {1, 4};
+    EXPECT_TRUE(groups.lookup(c) == nullptr);
+
+    groups.reset();
+    EXPECT_FALSE(groups.isBuilt());
+}
+
+TEST(GroupTable, Charge) {
+    GroupTable groups(AggregateOp::COUNT, 1);
+    std::size_t calls = 0;
+    auto size = [&]() {
+        ++calls;
+        return std::size_t(10);
+    };
+
+    // only the lookup reaching the size of the relation builds the groups
+    EXPECT_FALSE(groups.charge(4, size));
+    EXPECT_FALSE(groups.charge(4, size));
+    EXPECT_TRUE(groups.charge(4, size));
+    EXPECT_FALSE(groups.charge(4, size));
+    EXPECT_EQ(1, calls);
+}
+
+}  // namespace souffle::test
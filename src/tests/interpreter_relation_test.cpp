@@ -16,14 +16,17 @@
 
 #include "tests/test.h"
 
+#include "InterpreterIndex.h"
 #include "InterpreterProgInterface.h"
 #include "InterpreterRelation.h"
 #include "RamIndexAnalysis.h"
 #include "SouffleInterface.h"
 #include "SymbolTable.h"
+#include <algorithm>
 #include <iosfwd>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace souffle::test {
 
@@ -64,6 +67,307 @@ TEST(Relation1, Construction) {
     EXPECT_EQ(4, rel.size());
 }
 
+TEST(Relation16, Construction) {
+    // create a relation wider than the templated indexes
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(16);
+    std::vector<std::string> types(16, "i");
+    InterpreterRelation rel(16, 0, "test", types, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", types, types, 0);
+
+    // add some values
+    EXPECT_EQ(0, rel.size());
+    for (RamDomain i = 0; i < 100; ++i) {
+        tuple t(&relInt);
+        for (RamDomain j = 0; j < 16; ++j) {
+            t << (i % 10 + j);
+        }
+        relInt.insert(t);
+    }
+    EXPECT_EQ(10, rel.size());
+
+    // iterate in order
+    RamDomain last = -1;
+    for (const auto& cur : relInt) {
+        EXPECT_LT(last, cur[0]);
+        EXPECT_EQ(cur[0] + 15, cur[15]);
+        last = cur[0];
+    }
+    EXPECT_EQ(9, last);
+}
+
+TEST(Relation16, Range) {
+    // an index over the last attribute first
+    std::vector<uint32_t> pos;
+    for (uint32_t i = 16; i > 0; --i) {
+        pos.push_back(i - 1);
+    }
+
+    for (auto factory : {&createBTreeIndex, &createBrieIndex}) {
+        auto index = factory(Order(pos));
+        DynTuple t(16);
+        for (RamDomain i = 0; i < 100; ++i) {
+            t[15] = i;
+            EXPECT_TRUE(index->insert(t));
+            EXPECT_FALSE(index->insert(t));
+        }
+        EXPECT_EQ(100, index->size());
+        EXPECT_TRUE(index->contains(t));
+
+        // query the range [10,19] of the last attribute
+        DynTuple low(16);
+        DynTuple high(16);
+        for (size_t i = 0; i < 15; ++i) {
+            low[i] = MIN_RAM_SIGNED;
+            high[i] = MAX_RAM_SIGNED;
+        }
+        low[15] = 10;
+        high[15] = 19;
+
+        RamDomain expected = 10;
+        for (const auto& cur : index->range(low, high)) {
+            EXPECT_EQ(expected++, cur[15]);
+        }
+        EXPECT_EQ(20, expected);
+
+        index->clear();
+        EXPECT_TRUE(index->empty());
+        EXPECT_FALSE(index->contains(t));
+    }
+}
+
+TEST(Relation16, ConcurrentInsert) {
+    auto index = createBTreeIndex(Order::create(16));
+
+    // every tuple is inserted by several threads, exactly one of which succeeds
+    const int N = 10000;
+    int inserted = 0;
+#pragma omp parallel for reduction(+ : inserted)
+    for (int i = 0; i < 4 * N; ++i) {
+        DynTuple t(16);
+        for (size_t j = 0; j < 16; ++j) {
+            t[j] = (i % N) * j;
+        }
+        if (index->insert(t)) {
+            ++inserted;
+        }
+    }
+    EXPECT_EQ(N, inserted);
+    EXPECT_EQ(N, index->size());
+
+    // the tuples in the index are intact
+    RamDomain expected = 0;
+    for (const auto& cur : index->scan()) {
+        EXPECT_EQ(expected * 15, cur[15]);
+        ++expected;
+    }
+    EXPECT_EQ(N, expected);
+}
+
+TEST(Relation2, PrefixRange) {
+    // create a binary relation
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "test", {"i", "i"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", {"i", "i"}, {"i", "i"}, 0);
+    for (RamDomain i = 0; i < 10; ++i) {
+        for (RamDomain j = 0; j < 10; ++j) {
+            relInt.insert(tuple(&relInt, {i, j}));
+        }
+    }
+
+    // the index-backed range and the filtered scan of the base class agree
+    std::vector<std::pair<std::vector<RamDomain>, size_t>> queries{
+            {{}, 100}, {{3}, 10}, {{3, 4}, 1}, {{42}, 0}};
+    for (const auto& [prefix, expected] : queries) {
+        for (auto range : {relInt.prefixRange(prefix), relInt.Relation::prefixRange(prefix)}) {
+            size_t count = 0;
+            for (auto it = range.first; it != range.second; ++it) {
+                EXPECT_TRUE(prefix.empty() || (*it)[0] == prefix[0]);
+                ++count;
+            }
+            EXPECT_EQ(expected, count);
+        }
+    }
+}
+
+TEST(Relation3, LowerUpperBound) {
+    // create a ternary relation with an index led by the second attribute
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    SearchSignature search(3);
+    search.set(1, AttributeConstraint::Equal);
+    order.addSearch(search);
+    order.solve();
+    std::vector<std::string> types{"i", "i", "i"};
+    InterpreterRelation rel(3, 0, "test", types, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", types, types, 0);
+    for (RamDomain i = 0; i < 10; ++i) {
+        for (RamDomain j = 0; j < 10; ++j) {
+            relInt.insert(tuple(&relInt, {i, j, i + j}));
+        }
+    }
+
+    // queries by index, by index and filter, and by a filtered scan agree with the base class
+    struct Query {
+        std::vector<RamDomain> low;
+        std::vector<RamDomain> high;
+        std::vector<bool> bound;
+        size_t expected;
+    };
+    std::vector<Query> queries{{{0, 3, 0}, {0, 3, 0}, {false, true, false}, 10},
+            {{0, 0, 4}, {0, 0, 4}, {false, false, true}, 5},
+            {{0, 2, 0}, {0, 4, 0}, {false, true, false}, 30},
+            {{1, 5, 0}, {2, 5, 0}, {true, true, false}, 2},
+            {{0, 42, 0}, {0, 42, 0}, {false, true, false}, 0}};
+    for (const auto& query : queries) {
+        for (auto range : {relInt.lowerUpperBound(query.low, query.high, query.bound),
+                     relInt.Relation::lowerUpperBound(query.low, query.high, query.bound)}) {
+            size_t count = 0;
+            for (auto it = range.first; it != range.second; ++it) {
+                for (size_t i = 0; i < 3; ++i) {
+                    EXPECT_TRUE(!query.bound[i] || (query.low[i] <= (*it)[i] && (*it)[i] <= query.high[i]));
+                }
+                ++count;
+            }
+            EXPECT_EQ(query.expected, count);
+        }
+    }
+
+    // an equality query on the indexed attribute
+    auto range = relInt.equalRange({0, 7, 0}, {false, true, false});
+    EXPECT_TRUE(range.first != range.second);
+    EXPECT_EQ(7, (*range.first)[1]);
+}
+
+TEST(Relation2, Views) {
+    // create a relation of a number and a symbol
+    SymbolTable symbolTable;
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "test", {"i", "s"}, order);
+    InterpreterRelInterface relInt(rel, symbolTable, "test", {"i", "s"}, {"i", "s"}, 0);
+    for (RamDomain i = 0; i < 2500; ++i) {
+        relInt.insert(tuple(&relInt, {i, symbolTable.lookup(std::to_string(i))}));
+    }
+
+    // views refer to the stored elements
+    RamDomain expected = 0;
+    for (tuple_view t : relInt.views()) {
+        EXPECT_EQ(2, t.size());
+        EXPECT_EQ(expected, t.getSigned(0));
+        EXPECT_EQ(std::to_string(expected), t.getSymbol(1));
+        ++expected;
+    }
+    EXPECT_EQ(2500, expected);
+
+    // batches are read until the end of the relation
+    std::vector<RamDomain> buffer(2 * 1000);
+    std::vector<size_t> batches;
+    auto it = relInt.begin();
+    const auto end = relInt.end();
+    while (size_t n = relInt.read(it, end, buffer.data(), 1000)) {
+        EXPECT_EQ(RamDomain(batches.size() * 1000), buffer[0]);
+        batches.push_back(n);
+    }
+    EXPECT_EQ((std::vector<size_t>{1000, 1000, 500}), batches);
+
+    // columns hold the elements of all tuples in iteration order
+    auto columns = relInt.exportColumns();
+    EXPECT_EQ(2, columns.size());
+    EXPECT_EQ(2500, columns[0].size());
+    EXPECT_EQ(2500, columns[1].size());
+    EXPECT_EQ(1234, columns[0][1234]);
+    EXPECT_EQ("1234", symbolTable.resolve(columns[1][1234]));
+}
+
+TEST(Relation2, Merge) {
+    // indexes of the same order are merged, others are filled tuple by tuple
+    auto trg = createBTreeIndex(Order({0, 1}));
+    auto same = createBTreeIndex(Order({0, 1}));
+    auto other = createBTreeIndex(Order({1, 0}));
+    EXPECT_TRUE(trg->canMerge(*same));
+    EXPECT_FALSE(trg->canMerge(*other));
+    EXPECT_FALSE(trg->canMerge(*createBrieIndex(Order({0, 1}))));
+
+    for (RamDomain i = 0; i < 1000; ++i) {
+        RamDomain a[2] = {i, i % 7};
+        RamDomain b[2] = {i + 500, (i + 500) % 7};
+        trg->insert(TupleRef(a, 2));
+        same->insert(TupleRef(b, 2));
+        other->insert(TupleRef(b, 2));
+    }
+    trg->insert(*same);
+    EXPECT_EQ(1500, trg->size());
+    trg->insert(*other);
+    EXPECT_EQ(1500, trg->size());
+
+    RamDomain prev = -1;
+    for (const auto& cur : trg->scan()) {
+        EXPECT_LT(prev, cur[0]);
+        prev = cur[0];
+    }
+
+    // merge whole relations
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel1(2, 0, "rel1", {"i", "i"}, order);
+    InterpreterRelation rel2(2, 0, "rel2", {"i", "i"}, order);
+    for (RamDomain i = 0; i < 100; ++i) {
+        RamDomain a[2] = {i, i};
+        RamDomain b[2] = {i + 50, i + 50};
+        rel1.insert(a);
+        rel2.insert(b);
+    }
+    rel1.insert(rel2);
+    EXPECT_EQ(150, rel1.size());
+    RamDomain t[2] = {149, 149};
+    EXPECT_TRUE(rel1.contains(TupleRef(t, 2)));
+}
+
+TEST(Relation2, InsertSorted) {
+    // sorted tuples, of which every third one is present already
+    std::vector<RamDomain> tuples;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        tuples.push_back(i);
+        tuples.push_back((i * 37) % 101);
+    }
+    for (const Order& order : {Order({0, 1}), Order({1, 0})}) {
+        auto index = createBTreeIndex(order);
+        for (RamDomain i = 0; i < 1000; i += 3) {
+            index->insert(TupleRef(&tuples[2 * i], 2));
+        }
+        index->insertSorted(tuples.data(), 1000);
+        EXPECT_EQ(1000, index->size());
+        for (RamDomain i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(index->contains(TupleRef(&tuples[2 * i], 2)));
+        }
+
+        // the index enumerates its tuples in its own order
+        std::vector<std::pair<RamDomain, RamDomain>> scanned;
+        for (const auto& cur : index->scan()) {
+            scanned.push_back(order == Order({0, 1}) ? std::make_pair(cur[0], cur[1])
+                                                     : std::make_pair(cur[1], cur[0]));
+        }
+        EXPECT_TRUE(std::is_sorted(scanned.begin(), scanned.end()));
+
+        // few tuples are inserted into a large index one by one
+        RamDomain more[4] = {2000, 0, 2001, 0};
+        index->insertSorted(more, 2);
+        EXPECT_EQ(1002, index->size());
+        EXPECT_TRUE(index->contains(TupleRef(more + 2, 2)));
+    }
+
+    MinIndexSelection order{};
+    order.insertDefaultTotalIndex(2);
+    InterpreterRelation rel(2, 0, "rel", {"i", "i"}, order);
+    rel.insertSorted(tuples.data(), 1000);
+    rel.insertSorted(tuples.data(), 1000);
+    EXPECT_EQ(1000, rel.size());
+}
+
 TEST(Basic, Iteration) {
     // create a relation
     SymbolTable symbolTable;
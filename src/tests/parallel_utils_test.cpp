@@ -17,7 +17,15 @@
 #include "tests/test.h"
 
 #include "utility/ParallelUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace souffle {
 
@@ -93,5 +101,168 @@ TEST(ParallelUtils, OptimisticReadWriteLock) {
 
     EXPECT_EQ(2 * (N / K), c);
 }
+
+TEST(ParallelUtils, WorkStealingLoop) {
+    const std::size_t N = 10000;
+
+    // each iteration has to be processed exactly once, whatever the number of threads
+    for (int threads : {1, 2, 4}) {
+        std::vector<std::atomic<int>> counts(N);
+        WorkStealingLoop tasks(N, 4);
+
+#pragma omp parallel num_threads(threads)
+        for (std::size_t i : tasks) {
+            counts[i]++;
+        }
+
+        bool once = true;
+        for (const auto& cur : counts) {
+            once = once && cur == 1;
+        }
+        EXPECT_TRUE(once);
+    }
+
+    // more threads than shares, such that several threads draw from and steal into the same share
+    for (std::size_t numShares : {1, 3}) {
+        std::vector<std::atomic<int>> counts(N);
+        WorkStealingLoop tasks(N, numShares);
+
+#pragma omp parallel num_threads(8)
+        for (std::size_t i : tasks) {
+            counts[i]++;
+            std::this_thread::yield();
+        }
+
+        bool once = true;
+        for (const auto& cur : counts) {
+            once = once && cur == 1;
+        }
+        EXPECT_TRUE(once);
+    }
+
+    // an empty loop terminates immediately
+    WorkStealingLoop empty(0);
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(ParallelUtils, ParallelFor) {
+    const std::size_t N = 1000;
+
+    // each iteration is run once, also within a parallel region
+    for (bool nested : {false, true}) {
+        std::vector<std::atomic<int>> counts(N);
+        std::vector<int> threads(N);
+        auto body = [&](std::size_t i) {
+            counts[i]++;
+#ifdef _OPENMP
+            threads[i] = omp_get_thread_num();
+#endif
+            std::this_thread::yield();
+        };
+        if (nested) {
+#pragma omp parallel num_threads(4)
+#pragma omp single
+            parallelFor(N, body);
+        } else {
+            parallelFor(N, body);
+        }
+
+        bool once = true;
+        for (const auto& cur : counts) {
+            once = once && cur == 1;
+        }
+        EXPECT_TRUE(once);
+
+#ifdef _OPENMP
+        // the idle threads of the enclosing region take part
+        if (nested) {
+            EXPECT_TRUE(std::any_of(threads.begin(), threads.end(), [&](int t) { return t != threads[0]; }));
+        }
+#endif
+    }
+}
+
+TEST(ParallelUtils, TaskGraph) {
+    // a chain 0 -> 1 -> 2 next to independent tasks 3 .. 9, and a task 10 waiting for 2 and 3
+    std::vector<std::vector<std::size_t>> predecessors(11);
+    predecessors[1] = {0};
+    predecessors[2] = {1};
+    predecessors[10] = {2, 3};
+
+    for (std::size_t workers : {1, 2, 4}) {
+        std::atomic<int> clock{0};
+        std::vector<int> started(predecessors.size(), -1);
+        std::vector<int> finished(predecessors.size(), -1);
+        runTaskGraph(predecessors, workers, [&](std::size_t task) {
+            started[task] = clock++;
+            finished[task] = clock++;
+        });
+
+        // each task is run once, after all its predecessors have finished
+        bool ordered = true;
+        for (std::size_t task = 0; task < predecessors.size(); ++task) {
+            ordered = ordered && started[task] >= 0;
+            for (std::size_t pred : predecessors[task]) {
+                ordered = ordered && finished[pred] < started[task];
+            }
+        }
+        EXPECT_TRUE(ordered);
+    }
+
+    // a failing task is reported once the running tasks are done, and its successors are not run
+    for (std::size_t workers : {1, 2, 4}) {
+        std::vector<std::atomic<int>> runs(predecessors.size());
+        std::string error;
+        try {
+            runTaskGraph(predecessors, workers, [&](std::size_t task) {
+                runs[task]++;
+                if (task == 1) {
+                    throw std::runtime_error("task 1 failed");
+                }
+            });
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+        EXPECT_EQ("task 1 failed", error);
+        EXPECT_EQ(1, runs[1]);
+        EXPECT_EQ(0, runs[2]);
+        EXPECT_EQ(0, runs[10]);
+    }
+}
+
+#ifdef _OPENMP
+TEST(Performance, WorkStealingScaling) {
+    // skewed work: the first few iterations dominate, as for partitions of clustered relations
+    // (use N = 1 << 16 and thread counts up to 64 for actual measurements)
+    const std::size_t N = 1 << 12;
+    auto work = [](std::size_t i) {
+        volatile std::size_t x = 0;
+        for (std::size_t j = 0, n = (i < 64) ? 20000 : 100; j < n; ++j) {
+            x = x + j;
+        }
+    };
+
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for schedule(static) num_threads(threads)
+        for (std::size_t i = 0; i < N; i++) {
+            work(i);
+        }
+        auto mid = std::chrono::steady_clock::now();
+        WorkStealingLoop tasks(N, threads);
+#pragma omp parallel num_threads(threads)
+        for (std::size_t i : tasks) {
+            work(i);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << threads << " threads - static: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count()
+                  << "us, work stealing: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count() << "us\n";
+    }
+}
+#endif
+
 }  // namespace test
 }  // end namespace souffle
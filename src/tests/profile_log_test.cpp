@@ -0,0 +1,209 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file profile_log_test.cpp
+ *
+ * Tests writing and replaying the binary profile log, and the statistics
+ * of profiled relations.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "EventProcessor.h"
+#include "ProfileDatabase.h"
+#include "ProfileEvent.h"
+#include "ProfileLog.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace souffle::profile::test {
+
+namespace {
+
+const std::string logFile = "profile_log_test.log";
+
+/** Log the number of tuples of the given number of rules of a relation */
+void logRules(ProfileLog& log, const std::string& relation, size_t numRules) {
+    for (size_t i = 0; i < numRules; ++i) {
+        std::string text = "@n-nonrecursive-rule;" + relation + ";loc;rule" + std::to_string(i);
+        log.append(LogRecordKind::Quantity, text, {i, 0});
+    }
+}
+
+/** Return the number of tuples of a rule in the database, or 0 if there is none */
+size_t getRuleSize(const ProfileDatabase& db, const std::string& relation, size_t rule) {
+    auto* entry = dynamic_cast<SizeEntry*>(db.lookupEntry({"program", "relation", relation,
+            "non-recursive-rule", "rule" + std::to_string(rule), "num-tuples"}));
+    return entry == nullptr ? 0 : entry->getSize();
+}
+
+/** Replay the log file */
+bool replayFile(ProfileDatabase& db) {
+    std::ifstream in(logFile, std::ios::binary);
+    return ProfileLog::replay(in, db);
+}
+
+}  // namespace
+
+TEST(ProfileLog, WriteReplay) {
+    const size_t numThreads = 4;
+    // more events than fit into the buffer of a thread
+    const size_t numRules = 3 * ProfileLog::bufferSize;
+    {
+        ProfileLog log;
+        EXPECT_TRUE(log.open(logFile));
+        log.append(LogRecordKind::Config, "jobs", {log.intern("4")});
+        log.append(LogRecordKind::Timing, "@runtime;", {10, 20, 0, 0, 0, 0});
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t]() { logRules(log, "R" + std::to_string(t), numRules); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    ProfileDatabase db;
+    EXPECT_TRUE(replayFile(db));
+    EXPECT_EQ("4", db.getStringMap({"program", "configuration"})["jobs"]);
+    auto* runtime = dynamic_cast<DurationEntry*>(db.lookupEntry({"program", "runtime"}));
+    EXPECT_TRUE(runtime != nullptr);
+    EXPECT_EQ(10, runtime->getStart().count());
+    EXPECT_EQ(20, runtime->getEnd().count());
+    bool complete = true;
+    for (size_t t = 0; t < numThreads; ++t) {
+        for (size_t i = 0; i < numRules; ++i) {
+            complete = complete && getRuleSize(db, "R" + std::to_string(t), i) == i;
+        }
+    }
+    EXPECT_TRUE(complete);
+
+    std::remove(logFile.c_str());
+}
+
+TEST(ProfileLog, Pending) {
+    {
+        // events are held until the log has a file
+        ProfileLog log;
+        logRules(log, "R", 10);
+        ProfileDatabase live;
+        log.replayInto(live);
+        EXPECT_EQ(9, getRuleSize(live, "R", 9));
+        EXPECT_TRUE(log.open(logFile));
+        logRules(log, "S", 10);
+        log.close();
+        EXPECT_EQ(9, getRuleSize(live, "S", 9));
+    }
+
+    ProfileDatabase db;
+    EXPECT_TRUE(replayFile(db));
+    EXPECT_EQ(9, getRuleSize(db, "R", 9));
+    EXPECT_EQ(9, getRuleSize(db, "S", 9));
+
+    std::remove(logFile.c_str());
+}
+
+TEST(ProfileLog, Truncated) {
+    {
+        ProfileLog log;
+        log.open(logFile);
+        logRules(log, "R", 10);
+    }
+    // a crash cuts off the last record
+    std::ifstream in(logFile, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(0, truncate(logFile.c_str(), static_cast<size_t>(in.tellg()) - 10));
+
+    ProfileDatabase db;
+    EXPECT_TRUE(replayFile(db));
+    EXPECT_EQ(8, getRuleSize(db, "R", 8));
+    EXPECT_EQ(0, getRuleSize(db, "R", 9));
+
+    // JSON profile databases are not binary logs
+    {
+        std::ofstream out(logFile);
+        db.print(out);
+    }
+    ProfileDatabase json;
+    EXPECT_FALSE(replayFile(json));
+    EXPECT_EQ(8, getRuleSize(ProfileDatabase(logFile), "R", 8));
+
+    std::remove(logFile.c_str());
+}
+
+TEST(DistinctCounter, Count) {
+    // counts are exact for few distinct values
+    DistinctCounter few;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        few.insert(i % 100);
+    }
+    EXPECT_EQ(100, few.count());
+
+    // and estimated for many
+    DistinctCounter many;
+    for (RamDomain i = 0; i < 200000; ++i) {
+        many.insert(-i / 2);
+    }
+    EXPECT_LT(90000, many.count());
+    EXPECT_LT(many.count(), 110000);
+}
+
+TEST(Performance, ProfileLog) {
+    // (use N = 10000000 for actual measurements)
+    const size_t N = 100000;
+    const size_t numThreads = 4;
+    const std::string text = "@t-nonrecursive-rule;R;loc;R(x) :- S(x).";
+
+    auto ms = [](auto duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    };
+    auto run = [&](auto event) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&]() {
+                for (size_t i = 0; i < N / numThreads; ++i) {
+                    event(i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return ms(std::chrono::steady_clock::now() - start);
+    };
+
+    ProfileDatabase db;
+    auto database = run([&](size_t i) {
+        EventProcessorSingleton::instance().process(db, text.c_str(), microseconds(i), microseconds(i + 1),
+                size_t(0), size_t(0), i, size_t(0));
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    ProfileLog log;
+    log.open(logFile);
+    auto binary = run([&](size_t i) { log.append(LogRecordKind::Timing, text, {i, i + 1, 0, 0, i, 0}); });
+    log.close();
+    auto written = ms(std::chrono::steady_clock::now() - start);
+
+    std::cout << N << " timing events - profile database: " << database << "ms, binary log: " << binary
+              << "ms (" << written << "ms written)\n";
+
+    std::remove(logFile.c_str());
+}
+
+}  // namespace souffle::profile::test
@@ -354,6 +354,32 @@ TEST(RamAggregate, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamParallelAggregate, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"x", "y"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // t0.0 = SUM t0.1 PARALLEL FOR ALL t0 IN edge
+    //  RETURN t0.0
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto a_return = std::make_unique<RamSubroutineReturn>(std::move(a_return_args));
+    RamParallelAggregate a(std::move(a_return), AggregateOp::SUM,
+            std::make_unique<RamRelationReference>(&edge), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), 0);
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto b_return = std::make_unique<RamSubroutineReturn>(std::move(b_return_args));
+    RamParallelAggregate b(std::move(b_return), AggregateOp::SUM,
+            std::make_unique<RamRelationReference>(&edge), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), 0);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamParallelAggregate* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamIndexAggregate, CloneAndEquals) {
     RamRelation sqrt("sqrt", 2, 1, {"nth", "value"}, {"i", "i"}, RelationRepresentation::DEFAULT);
     // t0.0 = MIN t1.1 SEARCH t1 IN sqrt ON INDEX t1.0 = ⊥ AND t1.1 = ⊥
@@ -393,6 +419,112 @@ TEST(RamIndexAggregate, CloneAndEquals) {
     delete c;
 }
 
+TEST(RamParallelIndexAggregate, CloneAndEquals) {
+    RamRelation sqrt("sqrt", 2, 1, {"nth", "value"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // t0.0 = MEAN t0.1 PARALLEL SEARCH t0 IN sqrt ON INDEX t0.0 = 1 AND t0.1 = ⊥
+    //  RETURN t0.0
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto a_return = std::make_unique<RamSubroutineReturn>(std::move(a_return_args));
+    RamPattern a_criteria;
+    a_criteria.first.emplace_back(new RamSignedConstant(1));
+    a_criteria.first.emplace_back(new RamUndefValue);
+    a_criteria.second.emplace_back(new RamSignedConstant(1));
+    a_criteria.second.emplace_back(new RamUndefValue);
+    RamParallelIndexAggregate a(std::move(a_return), AggregateOp::MEAN,
+            std::make_unique<RamRelationReference>(&sqrt), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), std::move(a_criteria), 0);
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto b_return = std::make_unique<RamSubroutineReturn>(std::move(b_return_args));
+    RamPattern b_criteria;
+    b_criteria.first.emplace_back(new RamSignedConstant(1));
+    b_criteria.first.emplace_back(new RamUndefValue);
+    b_criteria.second.emplace_back(new RamSignedConstant(1));
+    b_criteria.second.emplace_back(new RamUndefValue);
+    RamParallelIndexAggregate b(std::move(b_return), AggregateOp::MEAN,
+            std::make_unique<RamRelationReference>(&sqrt), std::make_unique<RamTupleElement>(0, 1),
+            std::make_unique<RamTrue>(), std::move(b_criteria), 0);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamParallelIndexAggregate* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(RamRangeAggregate, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"src", "dest"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // t0.0 = MIN t0.1 RANGE SEARCH t0 IN edge ON INDEX t0.0 = 1 AND t0.1 = ⊥
+    //  RETURN t0.0
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto a_return = std::make_unique<RamSubroutineReturn>(std::move(a_return_args));
+    RamPattern a_criteria;
+    a_criteria.first.emplace_back(new RamSignedConstant(1));
+    a_criteria.first.emplace_back(new RamUndefValue);
+    a_criteria.second.emplace_back(new RamSignedConstant(1));
+    a_criteria.second.emplace_back(new RamUndefValue);
+    RamRangeAggregate a(std::move(a_return), AggregateOp::MIN, std::make_unique<RamRelationReference>(&edge),
+            std::make_unique<RamTupleElement>(0, 1), std::make_unique<RamTrue>(), std::move(a_criteria), 0);
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(0, 0));
+    auto b_return = std::make_unique<RamSubroutineReturn>(std::move(b_return_args));
+    RamPattern b_criteria;
+    b_criteria.first.emplace_back(new RamSignedConstant(1));
+    b_criteria.first.emplace_back(new RamUndefValue);
+    b_criteria.second.emplace_back(new RamSignedConstant(1));
+    b_criteria.second.emplace_back(new RamUndefValue);
+    RamRangeAggregate b(std::move(b_return), AggregateOp::MIN, std::make_unique<RamRelationReference>(&edge),
+            std::make_unique<RamTupleElement>(0, 1), std::make_unique<RamTrue>(), std::move(b_criteria), 0);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamRangeAggregate* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(RamGroupAggregate, CloneAndEquals) {
+    RamRelation edge("edge", 2, 1, {"src", "dest"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    // t1.0 = COUNT GROUP SEARCH t1 IN edge ON INDEX t1.0 = t0.0 AND t1.1 = ⊥
+    //  RETURN t1.0
+    std::vector<std::unique_ptr<RamExpression>> a_return_args;
+    a_return_args.emplace_back(new RamTupleElement(1, 0));
+    auto a_return = std::make_unique<RamSubroutineReturn>(std::move(a_return_args));
+    RamPattern a_criteria;
+    a_criteria.first.emplace_back(new RamTupleElement(0, 0));
+    a_criteria.first.emplace_back(new RamUndefValue);
+    a_criteria.second.emplace_back(new RamTupleElement(0, 0));
+    a_criteria.second.emplace_back(new RamUndefValue);
+    RamGroupAggregate a(std::move(a_return), AggregateOp::COUNT,
+            std::make_unique<RamRelationReference>(&edge), std::make_unique<RamUndefValue>(),
+            std::make_unique<RamTrue>(), std::move(a_criteria), 1);
+
+    std::vector<std::unique_ptr<RamExpression>> b_return_args;
+    b_return_args.emplace_back(new RamTupleElement(1, 0));
+    auto b_return = std::make_unique<RamSubroutineReturn>(std::move(b_return_args));
+    RamPattern b_criteria;
+    b_criteria.first.emplace_back(new RamTupleElement(0, 0));
+    b_criteria.first.emplace_back(new RamUndefValue);
+    b_criteria.second.emplace_back(new RamTupleElement(0, 0));
+    b_criteria.second.emplace_back(new RamUndefValue);
+    RamGroupAggregate b(std::move(b_return), AggregateOp::COUNT,
+            std::make_unique<RamRelationReference>(&edge), std::make_unique<RamUndefValue>(),
+            std::make_unique<RamTrue>(), std::move(b_criteria), 1);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamGroupAggregate* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(RamUnpackedRecord, CloneAndEquals) {
     // UNPACK (t0.0, t0.2) INTO t1
     // RETURN number(0)
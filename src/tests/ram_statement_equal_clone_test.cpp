@@ -255,6 +255,47 @@ TEST(RamParallel, CloneAndEquals) {
     EXPECT_NE(&a, c);
     delete c;
 }
+TEST(RamAdaptiveQuery, CloneAndEquals) {
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamRelation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamRelation C("C", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+
+    /* ADAPTIVE TEXT "Log message"
+     *  QUERY
+     *   FOR t0 IN A
+     *    PROJECT (t0.0) INTO C
+     *  QUERY
+     *   FOR t0 IN B
+     *    PROJECT (t0.0) INTO C
+     * END ADAPTIVE
+     * */
+    auto makeQuery = [&](RamRelation* rel) {
+        std::vector<std::unique_ptr<RamExpression>> expressions;
+        expressions.emplace_back(new RamTupleElement(0, 0));
+        auto project = std::make_unique<RamProject>(
+                std::make_unique<RamRelationReference>(&C), std::move(expressions));
+        auto scan = std::make_unique<RamScan>(
+                std::make_unique<RamRelationReference>(rel), 0, std::move(project), "");
+        return std::make_unique<RamQuery>(std::move(scan));
+    };
+    std::vector<std::unique_ptr<RamStatement>> a_alternatives;
+    a_alternatives.push_back(makeQuery(&A));
+    a_alternatives.push_back(makeQuery(&B));
+    RamAdaptiveQuery a(std::move(a_alternatives), "Log message");
+
+    std::vector<std::unique_ptr<RamStatement>> b_alternatives;
+    b_alternatives.push_back(makeQuery(&A));
+    b_alternatives.push_back(makeQuery(&B));
+    RamAdaptiveQuery b(std::move(b_alternatives), "Log message");
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamAdaptiveQuery* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
 TEST(RamLoop, CloneAndEquals) {
     RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
     RamRelation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -445,5 +486,18 @@ TEST(RamLogSize, CloneAndEquals) {
     EXPECT_NE(&a, c);
     delete c;
 }
+
+TEST(RamLogStatistics, CloneAndEquals) {
+    RamRelation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    RamLogStatistics a(std::make_unique<RamRelationReference>(&A), "Log message");
+    RamLogStatistics b(std::make_unique<RamRelationReference>(&A), "Log message");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    RamLogStatistics* c = a.clone();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
 }  // end namespace test
 }  // end namespace souffle
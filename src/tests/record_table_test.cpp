@@ -28,6 +28,10 @@
 
 #include <cstddef>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace souffle::test {
 
 #define NUMBER_OF_TESTS 100
@@ -111,4 +115,99 @@ TEST(PackUnpack, Vector) {
     }
 }
 
+// Pack the same records repeatedly and
+// check that references are stable and unique
+TEST(PackUnpack, Duplicates) {
+    constexpr size_t tupleSize = 2;
+    constexpr size_t N = 10000;
+
+    RecordTable recordTable;
+
+    std::vector<RamDomain> refs(N);
+    for (size_t i = 0; i < N; ++i) {
+        RamDomain tuple[tupleSize] = {static_cast<RamDomain>(i), static_cast<RamDomain>(i % 7)};
+        refs[i] = recordTable.pack(tuple, tupleSize);
+    }
+
+    std::set<RamDomain> unique(refs.begin(), refs.end());
+    EXPECT_EQ(N, unique.size());
+    EXPECT_TRUE(unique.find(0) == unique.end());
+
+    for (size_t i = 0; i < N; ++i) {
+        RamDomain tuple[tupleSize] = {static_cast<RamDomain>(i), static_cast<RamDomain>(i % 7)};
+        EXPECT_EQ(refs[i], recordTable.pack(tuple, tupleSize));
+        const RamDomain* unpacked = recordTable.unpack(refs[i], tupleSize);
+        EXPECT_EQ(tuple[0], unpacked[0]);
+        EXPECT_EQ(tuple[1], unpacked[1]);
+    }
+}
+
+// Records of different arities do not interfere
+TEST(PackUnpack, MixedArity) {
+    RecordTable recordTable;
+
+    RamDomain empty[1] = {0};
+    RamDomain single[1] = {42};
+    RamDomain pair[2] = {42, 42};
+
+    RamDomain refEmpty = recordTable.pack(empty, 0);
+    RamDomain refSingle = recordTable.pack(single, 1);
+    RamDomain refPair = recordTable.pack(pair, 2);
+
+    EXPECT_EQ(refEmpty, recordTable.pack(empty, 0));
+    EXPECT_EQ(refSingle, recordTable.pack(single, 1));
+    EXPECT_EQ(refPair, recordTable.pack(pair, 2));
+
+    EXPECT_EQ(42, recordTable.unpack(refSingle, 1)[0]);
+    EXPECT_EQ(42, recordTable.unpack(refPair, 2)[0]);
+    EXPECT_EQ(42, recordTable.unpack(refPair, 2)[1]);
+}
+
+#ifdef _OPENMP
+
+// Pack overlapping records from many threads
+TEST(PackUnpack, ParallelScaling) {
+    constexpr size_t tupleSize = 3;
+
+    //        const int N = 10000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        RecordTable recordTable;
+        std::vector<RamDomain> refs(N);
+
+        omp_set_num_threads(threads);
+
+        double start = omp_get_wtime();
+
+        // every record is packed twice, by (likely) different threads
+#pragma omp parallel for
+        for (int i = 0; i < 2 * N; ++i) {
+            int j = i % N;
+            RamDomain tuple[tupleSize] = {j, j / 3, j % 5};
+            RamDomain ref = recordTable.pack(tuple, tupleSize);
+            if (i < N) {
+                refs[j] = ref;
+            }
+        }
+
+        double end = omp_get_wtime();
+
+        std::cout << "Number of threads: " << threads << " [" << (end - start) << "s]\n";
+
+        std::set<RamDomain> unique(refs.begin(), refs.end());
+        EXPECT_EQ((size_t)N, unique.size());
+
+        bool allMatch = true;
+#pragma omp parallel for reduction(&& : allMatch)
+        for (int j = 0; j < N; ++j) {
+            const RamDomain* unpacked = recordTable.unpack(refs[j], tupleSize);
+            allMatch = allMatch && unpacked[0] == j && unpacked[1] == j / 3 && unpacked[2] == j % 5;
+        }
+        EXPECT_TRUE(allMatch);
+    }
+}
+
+#endif
+
 }  // namespace souffle::test
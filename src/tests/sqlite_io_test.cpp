@@ -0,0 +1,183 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file sqlite_io_test.cpp
+ *
+ * Tests writing relations to and reading relations from SQLite databases.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "CompiledTuple.h"
+#include "RamTypes.h"
+#include "ReadStreamSQLite.h"
+#include "RecordTable.h"
+#include "SymbolTable.h"
+#include "WriteStreamSQLite.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+using Tuple2 = Tuple<RamDomain, 2>;
+
+const std::string dbFile = "sqlite_io_test.db";
+
+/** The IO directive of a binary relation of a number and a symbol column */
+std::map<std::string, std::string> getDirective(const std::string& name) {
+    return {{"IO", "sqlite"}, {"filename", dbFile}, {"name", name},
+            {"types", "{\"" + name +
+                              "\": {\"arity\": 2, \"auxArity\": 0, \"types\": [\"i:number\", "
+                              "\"s:symbol\"]}, \"records\": {}}"}};
+}
+
+/** Collects the tuples read from a database */
+struct Collector {
+    void insert(const RamDomain* tuple) {
+        tuples.push_back({{tuple[0], tuple[1]}});
+    }
+    std::vector<Tuple2> tuples;
+};
+
+void write(const std::string& name, const std::vector<Tuple2>& tuples, const SymbolTable& symbolTable) {
+    RecordTable recordTable;
+    WriteStreamSQLite(getDirective(name), symbolTable, recordTable).writeAll(tuples);
+}
+
+std::vector<Tuple2> read(const std::string& name, SymbolTable& symbolTable) {
+    RecordTable recordTable;
+    Collector collector;
+    ReadStreamSQLite(getDirective(name), symbolTable, recordTable).readAll(collector);
+    return collector.tuples;
+}
+
+}  // namespace
+
+TEST(SQLite, WriteRead) {
+    std::remove(dbFile.c_str());
+
+    // two relations sharing the symbol table of the database
+    SymbolTable symbolTable;
+    std::vector<Tuple2> first;
+    std::vector<Tuple2> second;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        first.push_back({{i, symbolTable.unsafeLookup("a" + std::to_string(i % 100))}});
+        second.push_back({{-i, symbolTable.unsafeLookup("b" + std::to_string(i))}});
+    }
+    write("first", first, symbolTable);
+    write("second", second, symbolTable);
+
+    // read both relations into a fresh symbol table
+    SymbolTable readSymbols;
+    std::vector<Tuple2> readSecond = read("second", readSymbols);
+    std::vector<Tuple2> readFirst = read("first", readSymbols);
+    EXPECT_EQ(first.size(), readFirst.size());
+    EXPECT_EQ(second.size(), readSecond.size());
+
+    bool same = true;
+    for (size_t i = 0; i < first.size() && i < readFirst.size(); ++i) {
+        same = same && first[i][0] == readFirst[i][0] &&
+               symbolTable.resolve(first[i][1]) == readSymbols.resolve(readFirst[i][1]);
+    }
+    for (size_t i = 0; i < second.size() && i < readSecond.size(); ++i) {
+        same = same && second[i][0] == readSecond[i][0] &&
+               symbolTable.resolve(second[i][1]) == readSymbols.resolve(readSecond[i][1]);
+    }
+    EXPECT_TRUE(same);
+
+    // rewriting a relation replaces its tuples
+    first.resize(10);
+    write("first", first, symbolTable);
+    EXPECT_EQ(10, read("first", readSymbols).size());
+
+    // symbols added since the last write, and symbols of a replaced database, are stored
+    for (bool replace : {false, true}) {
+        if (replace) {
+            std::remove(dbFile.c_str());
+        }
+        std::vector<Tuple2> third;
+        for (RamDomain i = 0; i < 100; ++i) {
+            third.push_back({{i, symbolTable.unsafeLookup("c" + std::to_string(i % 50 + replace * 50))}});
+        }
+        third.push_back({{100, symbolTable.unsafeLookup("a0")}});
+        write("third", third, symbolTable);
+
+        std::vector<Tuple2> readThird = read("third", readSymbols);
+        EXPECT_EQ(third.size(), readThird.size());
+        bool stored = true;
+        for (size_t i = 0; i < third.size() && i < readThird.size(); ++i) {
+            stored = stored && symbolTable.resolve(third[i][1]) == readSymbols.resolve(readThird[i][1]);
+        }
+        EXPECT_TRUE(stored);
+    }
+
+    std::remove(dbFile.c_str());
+}
+
+TEST(SQLite, FreshSymbolTables) {
+    std::remove(dbFile.c_str());
+
+    // symbol tables created one after the other, possibly at the same address, holding the
+    // same number of symbols in different orders but for the last one
+    for (int order = 0; order < 2; ++order) {
+        SymbolTable symbolTable;
+        std::vector<Tuple2> tuples;
+        for (RamDomain i = 0; i < 100; ++i) {
+            const RamDomain n = (order == 0 || i == 99) ? i : 98 - i;
+            tuples.push_back({{n, symbolTable.unsafeLookup("s" + std::to_string(n))}});
+        }
+        write("fresh", tuples, symbolTable);
+
+        SymbolTable readSymbols;
+        bool stored = true;
+        for (const auto& tuple : read("fresh", readSymbols)) {
+            stored = stored && readSymbols.resolve(tuple[1]) == "s" + std::to_string(tuple[0]);
+        }
+        EXPECT_TRUE(stored);
+    }
+
+    std::remove(dbFile.c_str());
+}
+
+TEST(Performance, SQLiteThroughput) {
+    // (use N = 10000000 for actual measurements)
+    const RamDomain N = 100000;
+    std::remove(dbFile.c_str());
+
+    SymbolTable symbolTable;
+    std::vector<Tuple2> tuples;
+    for (RamDomain i = 0; i < N; ++i) {
+        tuples.push_back({{i, symbolTable.unsafeLookup(std::to_string(i % 1000))}});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    write("throughput", tuples, symbolTable);
+    auto mid = std::chrono::steady_clock::now();
+    SymbolTable readSymbols;
+    EXPECT_EQ(N, read("throughput", readSymbols).size());
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << N << " tuples - write: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count()
+              << "ms, read: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count()
+              << "ms\n";
+
+    std::remove(dbFile.c_str());
+}
+
+}  // namespace souffle::test
@@ -24,6 +24,10 @@
 #include <string>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace souffle::test {
 
 TEST(SymbolTable, Basics) {
@@ -140,4 +144,111 @@ TEST(SymbolTable, Inserts) {
     }
 }
 
+TEST(SymbolTable, DenseIndices) {
+    SymbolTable table;
+
+    const size_t N = 10000;
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_EQ((RamDomain)i, table.lookup(std::to_string(i)));
+    }
+    EXPECT_EQ(N, table.size());
+
+    // existing symbols keep their indices
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_EQ((RamDomain)i, table.lookupExisting(std::to_string(i)));
+        EXPECT_EQ(std::to_string(i), table.resolve(i));
+    }
+    EXPECT_TRUE(table.contains("42"));
+    EXPECT_FALSE(table.contains("-1"));
+    EXPECT_TRUE(table.contains((RamDomain)(N - 1)));
+    EXPECT_FALSE(table.contains((RamDomain)N));
+
+    // copies preserve indices
+    SymbolTable copy(table);
+    SymbolTable moved(std::move(copy));
+    EXPECT_EQ(N, moved.size());
+    EXPECT_EQ(0, copy.size());
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_EQ(table.resolve(i), moved.resolve(i));
+    }
+}
+
+#ifdef _OPENMP
+
+TEST(SymbolTable, ParallelScaling) {
+    //        const int N = 10000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+
+    std::vector<std::string> symbols;
+    symbols.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        symbols.push_back(std::to_string(i) + "string");
+    }
+
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        SymbolTable table;
+        std::vector<RamDomain> indices(N);
+
+        omp_set_num_threads(threads);
+
+        double start = omp_get_wtime();
+
+        // every symbol is looked up twice, by (likely) different threads
+#pragma omp parallel for
+        for (int i = 0; i < 2 * N; ++i) {
+            RamDomain index = table.lookup(symbols[i % N]);
+            if (i < N) {
+                indices[i] = index;
+            }
+        }
+
+        double mid = omp_get_wtime();
+
+        bool allResolved = true;
+#pragma omp parallel for reduction(&& : allResolved)
+        for (int i = 0; i < N; ++i) {
+            allResolved = allResolved && table.resolve(indices[i]) == symbols[i];
+        }
+
+        double end = omp_get_wtime();
+
+        std::cout << "Number of threads: " << threads << " [lookup " << (mid - start) << "s, resolve "
+                  << (end - mid) << "s]\n";
+
+        EXPECT_TRUE(allResolved);
+        EXPECT_EQ((size_t)N, table.size());
+
+        // indices are dense
+        std::vector<bool> seen(N, false);
+        for (int i = 0; i < N; ++i) {
+            ASSERT_LE(indices[i], N - 1);
+            EXPECT_FALSE(seen[indices[i]]);
+            seen[indices[i]] = true;
+        }
+    }
+}
+
+TEST(SymbolTable, ConcurrentResolve) {
+    const int N = 100000;
+    SymbolTable table;
+
+    // readers resolve every symbol below the size seen while writers insert
+    bool allConstructed = true;
+#pragma omp parallel for reduction(&& : allConstructed)
+    for (int i = 0; i < 2 * N; ++i) {
+        if (i % 2 == 0) {
+            table.lookup("symbol" + std::to_string(i / 2));
+        } else {
+            const size_t n = table.size();
+            if (n > 0) {
+                allConstructed = allConstructed && table.resolve(n - 1).rfind("symbol", 0) == 0;
+            }
+        }
+    }
+    EXPECT_TRUE(allConstructed);
+    EXPECT_EQ((size_t)N, table.size());
+}
+
+#endif
+
 }  // namespace souffle::test
@@ -49,10 +49,10 @@ namespace details {
 template <typename A>
 A symbol2numeric(const std::string& s);
 
-#define SYM_2_NUMERIC_OVERLOAD(ty)                \
-    template <>                                   \
-    ty symbol2numeric<ty>(const std::string& s) { \
-        return ty##FromString(s);                 \
+#define SYM_2_NUMERIC_OVERLOAD(ty)                       \
+    template <>                                          \
+    inline ty symbol2numeric<ty>(const std::string& s) { \
+        return ty##FromString(s);                        \
     }
 
 SYM_2_NUMERIC_OVERLOAD(RamFloat)
@@ -22,10 +22,15 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 #include <sys/stat.h>
 
 #ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #else
 #include <fcntl.h>
@@ -80,6 +85,31 @@ inline bool existDir(const std::string& name) {
     return false;
 }
 
+/**
+ * List the names of the entries of a directory; the list is empty if it cannot be read
+ */
+inline std::vector<std::string> listDir(const std::string& name) {
+    std::vector<std::string> entries;
+#ifndef _WIN32
+    if (DIR* dir = opendir(name.c_str())) {
+        while (const dirent* entry = readdir(dir)) {
+            entries.emplace_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+#else
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((name + "\\*").c_str(), &data);
+    if (handle != INVALID_HANDLE_VALUE) {
+        do {
+            entries.emplace_back(data.cFileName);
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+    }
+#endif
+    return entries;
+}
+
 /**
  * Check whether a given file exists and it is an executable
  */
@@ -290,4 +320,58 @@ public:
     }
 };
 
+/**
+ * A read-only memory mapping of a whole file.
+ *
+ * The mapping is left empty if the file is not a regular, non-empty file or
+ * cannot be mapped (e.g. on Windows); clients are expected to fall back to
+ * stream-based reading in that case.
+ */
+class MemoryMappedFile {
+public:
+    explicit MemoryMappedFile(const std::string& fileName) {
+#ifndef _WIN32
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, info.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+                length = info.st_size;
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    ~MemoryMappedFile() {
+#ifndef _WIN32
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), length);
+        }
+#endif
+    }
+
+    /** Check whether the file has been mapped */
+    bool isMapped() const {
+        return data != nullptr;
+    }
+
+    /** Obtain the contents of the file */
+    std::string_view contents() const {
+        return std::string_view(data, length);
+    }
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+};
+
 }  // namespace souffle
@@ -17,7 +17,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 #ifdef _OPENMP
 
@@ -570,4 +580,306 @@ inline Lock& getOutputLock() {
     return outputLock;
 }
 
+/**
+ * A work-stealing schedule of the iterations [0,n) of a loop that is executed by
+ * all threads of a parallel region, e.g., over the chunks of a partitioned relation:
+ *
+ *     WorkStealingLoop tasks(part.size());
+ *     PARALLEL_START
+ *         for (std::size_t i : tasks) { ... part[i] ... }
+ *     PARALLEL_END
+ *
+ * Each thread starts with an equal share of the iterations and processes it from
+ * the front. A thread running out of work steals the back half of the largest
+ * remaining share, such that skewed chunks are balanced on demand. Shares of
+ * threads absent from the region (e.g., a nested region) are stolen alike.
+ */
+class WorkStealingLoop {
+    /** the remaining iterations [begin,end) of a thread */
+    struct alignas(64) Share {
+        SpinLock lock;
+        std::atomic<std::size_t> begin{0};
+        std::atomic<std::size_t> end{0};
+    };
+
+    /** the number of shares, one per thread */
+    const std::size_t numShares;
+
+    /** the shares of the threads */
+    std::unique_ptr<Share[]> shares;
+
+    /** takes the next iteration of the given share */
+    bool pop(Share& share, std::size_t& i) {
+        share.lock.lock();
+        i = share.begin.load(std::memory_order_relaxed);
+        const bool found = i < share.end.load(std::memory_order_relaxed);
+        if (found) {
+            share.begin.store(i + 1, std::memory_order_relaxed);
+        }
+        share.lock.unlock();
+        return found;
+    }
+
+    /**
+     * Moves the back half of the largest other share into the given one, unless the given
+     * one has been refilled by another thread sharing it in the mean-time.
+     */
+    bool steal(std::size_t self) {
+        while (true) {
+            // select the victim with the most remaining iterations
+            std::size_t victim = numShares;
+            std::size_t most = 0;
+            for (std::size_t v = 0; v < numShares; ++v) {
+                const std::size_t b = shares[v].begin.load(std::memory_order_relaxed);
+                const std::size_t e = shares[v].end.load(std::memory_order_relaxed);
+                if (v != self && b < e && e - b > most) {
+                    victim = v;
+                    most = e - b;
+                }
+            }
+            if (victim == numShares) {
+                return false;
+            }
+
+            // lock both shares in the order of their indices; with more threads than shares,
+            // the own share may be shared with (and refilled by) another thread
+            Share& share = shares[victim];
+            Share& own = shares[self];
+            Share& first = (self < victim) ? own : share;
+            Share& second = (self < victim) ? share : own;
+            first.lock.lock();
+            second.lock.lock();
+            const bool refilled =
+                    own.begin.load(std::memory_order_relaxed) < own.end.load(std::memory_order_relaxed);
+            const std::size_t b = share.begin.load(std::memory_order_relaxed);
+            const std::size_t e = share.end.load(std::memory_order_relaxed);
+            const bool dry = b >= e;
+            if (!refilled && !dry) {
+                // split the remaining iterations of the victim
+                const std::size_t mid = e - (e - b + 1) / 2;
+                share.end.store(mid, std::memory_order_relaxed);
+                own.begin.store(mid, std::memory_order_relaxed);
+                own.end.store(e, std::memory_order_relaxed);
+            }
+            second.lock.unlock();
+            first.lock.unlock();
+
+            // the victim may have run dry in the mean-time
+            if (refilled || !dry) {
+                return true;
+            }
+        }
+    }
+
+    /** obtains the next iteration for the given share */
+    bool next(std::size_t self, std::size_t& i) {
+        while (!pop(shares[self], i)) {
+            if (!steal(self)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    /** an iterator enumerating the iterations processed by the calling thread */
+    class iterator {
+        WorkStealingLoop* loop = nullptr;
+        std::size_t self = 0;
+        std::size_t cur = 0;
+
+    public:
+        iterator() = default;
+
+        iterator(WorkStealingLoop* loop, std::size_t self) : loop(loop), self(self) {
+            ++(*this);
+        }
+
+        std::size_t operator*() const {
+            return cur;
+        }
+
+        iterator& operator++() {
+            if (!loop->next(self, cur)) {
+                loop = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return loop == other.loop;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return loop != other.loop;
+        }
+    };
+
+    explicit WorkStealingLoop(std::size_t n, std::size_t numThreads = MAX_THREADS)
+            : numShares(std::max<std::size_t>(numThreads, 1)), shares(new Share[numShares]) {
+        for (std::size_t t = 0; t < numShares; ++t) {
+            shares[t].begin.store(n * t / numShares, std::memory_order_relaxed);
+            shares[t].end.store(n * (t + 1) / numShares, std::memory_order_relaxed);
+        }
+    }
+
+    WorkStealingLoop(const WorkStealingLoop&) = delete;
+    WorkStealingLoop& operator=(const WorkStealingLoop&) = delete;
+
+    /**
+     * Starts the processing of iterations by the calling thread. With more threads than
+     * shares, several threads process the same share.
+     */
+    iterator begin() {
+#ifdef IS_PARALLEL
+        return iterator(this, static_cast<std::size_t>(omp_get_thread_num()) % numShares);
+#else
+        return iterator(this, 0);
+#endif
+    }
+
+    iterator end() {
+        return iterator();
+    }
+};
+
+/**
+ * Runs the iterations [0,n) of a loop in parallel, balancing skewed iterations.
+ * Within a parallel region, e.g. of a parallel scan, a nested region would only
+ * have a single thread; the iterations are hence issued as tasks instead, which
+ * the threads of the enclosing team run once they are idle, while the calling
+ * thread runs the remaining ones itself.
+ *
+ * @param n .. the number of iterations
+ * @param body .. the function running an iteration given its index
+ */
+template <typename Body>
+void parallelFor(std::size_t n, const Body& body) {
+#ifdef IS_PARALLEL
+    if (n > 0 && omp_in_parallel()) {
+        // a task loop exceeding 64 tasks per thread is run by the calling thread alone
+        const std::size_t numTasks = std::min<std::size_t>(n, 16 * omp_get_num_threads());
+#pragma omp taskloop num_tasks(numTasks) shared(body)
+        for (std::size_t i = 0; i < n; ++i) {
+            body(i);
+        }
+        return;
+    }
+    WorkStealingLoop tasks(n);
+#pragma omp parallel
+    for (std::size_t i : tasks) {
+        body(i);
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i) {
+        body(i);
+    }
+#endif
+}
+
+/**
+ * Runs the tasks of a dependency graph on up to the given number of worker threads.
+ * Each task only starts after its predecessors, which have smaller indices, have
+ * completed; among the ready tasks, the one with the smallest index is started
+ * first. The OpenMP threads are split evenly among the workers. Once a task throws,
+ * no further tasks are started, and the first exception is rethrown after the
+ * running tasks have completed.
+ *
+ * @param predecessors .. the predecessors of each task
+ * @param numWorkers .. the maximal number of tasks running concurrently
+ * @param task .. the function running a task given its index
+ */
+inline void runTaskGraph(const std::vector<std::vector<std::size_t>>& predecessors, std::size_t numWorkers,
+        const std::function<void(std::size_t)>& task) {
+    const std::size_t n = predecessors.size();
+#ifdef IS_PARALLEL
+    numWorkers = std::min(numWorkers, n);
+#else
+    numWorkers = 1;
+#endif
+    if (numWorkers <= 1) {
+        for (std::size_t i = 0; i < n; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+#ifdef IS_PARALLEL
+    // count the pending predecessors of each task
+    std::vector<std::vector<std::size_t>> successors(n);
+    std::vector<std::size_t> pending(n);
+    std::set<std::size_t> ready;
+    for (std::size_t i = 0; i < n; ++i) {
+        pending[i] = predecessors[i].size();
+        for (std::size_t pred : predecessors[i]) {
+            successors[pred].push_back(i);
+        }
+        if (pending[i] == 0) {
+            ready.insert(i);
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::size_t done = 0;
+    std::exception_ptr error;
+    const int maxThreads = MAX_THREADS;
+    const int threadsPerWorker = std::max<int>(1, maxThreads / static_cast<int>(numWorkers));
+
+    // the first failing task stops the scheduling; running tasks are completed
+    auto work = [&]() {
+        omp_set_num_threads(threadsPerWorker);
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            changed.wait(guard, [&]() { return !ready.empty() || done == n || error; });
+            if (ready.empty() || error) {
+                return;
+            }
+            const std::size_t cur = *ready.begin();
+            ready.erase(ready.begin());
+            guard.unlock();
+            try {
+                task(cur);
+            } catch (...) {
+                guard.lock();
+                if (!error) {
+                    error = std::current_exception();
+                }
+                changed.notify_all();
+                return;
+            }
+            guard.lock();
+            ++done;
+            for (std::size_t succ : successors[cur]) {
+                if (--pending[succ] == 0) {
+                    ready.insert(succ);
+                }
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < numWorkers; ++i) {
+        workers.emplace_back(work);
+    }
+    try {
+        work();
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!error) {
+            error = std::current_exception();
+        }
+        changed.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    omp_set_num_threads(maxThreads);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+#endif
+}
+
 }  // end of namespace souffle
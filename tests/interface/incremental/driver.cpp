@@ -0,0 +1,85 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2020 The Souffle Developers. All Rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program updating the relations of an incremental Souffle program
+ * by insertions into and deletions from an input relation
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+void printRelations(std::unique_ptr<SouffleProgram>& prog, const std::string& run) {
+    std::cout << "path - " << run << std::endl;
+    for (tuple t : *prog->getRelation("path")) {
+        std::string from;
+        std::string to;
+        t >> from >> to;
+        std::cout << from << "-" << to << std::endl;
+    }
+    std::cout << "unreachable - " << run << ": " << prog->getRelation("unreachable")->size() << std::endl;
+    std::cout << "reach - " << run << std::endl;
+    for (tuple t : *prog->getRelation("reach")) {
+        std::string node;
+        RamDomain n;
+        t >> node >> n;
+        std::cout << node << ": " << n << std::endl;
+    }
+}
+
+void insertEdge(Relation* edge, const std::string& from, const std::string& to) {
+    tuple t(edge);
+    t << from << to;
+    edge->insert(t);
+}
+
+/**
+ * Main program
+ */
+int main(int argc, char** argv) {
+    std::unique_ptr<SouffleProgram> prog(ProgramFactory::newInstance("incremental"));
+    if (prog == nullptr) {
+        error("failed to create souffle program");
+    }
+    prog->loadAll(argv[1]);
+    prog->run();
+    printRelations(prog, "run 1");
+
+    // insert a cycle
+    Relation* edge = prog->getRelation("edge");
+    insertEdge(edge, "D", "A");
+    prog->run();
+    printRelations(prog, "run 2");
+
+    // replace the edges, deleting C-D and D-A
+    edge->purge();
+    std::vector<std::pair<std::string, std::string>> edges{{"A", "B"}, {"B", "C"}, {"C", "A"}, {"D", "E"}};
+    for (const auto& cur : edges) {
+        insertEdge(edge, cur.first, cur.second);
+    }
+    prog->run();
+    printRelations(prog, "run 3");
+}